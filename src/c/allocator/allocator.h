@@ -0,0 +1,236 @@
+/*!
+ * @file allocator.h
+ *
+ * @brief This file contains a pluggable allocator interface for the
+ *          containers in this repository.
+ *
+ *          An allocator is a table of functions plus a context pointer.
+ *              Containers created with an allocator route every
+ *              allocation of their own through it, so they may draw
+ *              memory from an arena, a per-thread pool or any other
+ *              source. A NULL allocator stands for the standard library.
+ *
+ *          The allocator is told the size of every block it frees or
+ *              reallocates, so it need not record sizes itself. The
+ *              realloc and free functions are optional: without realloc
+ *              a block is moved with alloc and free, and without free
+ *              blocks are simply never returned, as suits a region that
+ *              is released all at once.
+ *
+ *          Functions included are as follows:
+ *
+ *              - allocator_alloc
+ *              - allocator_calloc
+ *              - allocator_realloc
+ *              - allocator_free
+ */
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/*!
+ * @brief This datatype defines a function template for allocating a
+ *          block of memory.
+ *
+ * @param p_ctx The allocator context.
+ * @param size The size in bytes of the block.
+ *
+ * @return Pointer to the block, aligned for any type. NULL on error.
+ */
+typedef void * (*allocator_alloc_f)(void * p_ctx, size_t size);
+
+/*!
+ * @brief This datatype defines a function template for resizing a block
+ *          of memory.
+ *
+ * @param p_ctx The allocator context.
+ * @param p_ptr The block to resize. Never NULL.
+ * @param old_size The size in bytes the block was allocated with.
+ * @param new_size The size in bytes wanted.
+ *
+ * @return Pointer to the resized block, holding the block's contents up
+ *          to the smaller of the two sizes. NULL on error, in which case
+ *          the original block is left intact.
+ */
+typedef void * (*allocator_realloc_f)(void * p_ctx,
+                                      void * p_ptr,
+                                      size_t old_size,
+                                      size_t new_size);
+
+/*!
+ * @brief This datatype defines a function template for releasing a
+ *          block of memory.
+ *
+ * @param p_ctx The allocator context.
+ * @param p_ptr The block to release. Never NULL.
+ * @param size The size in bytes the block was allocated with.
+ *
+ * @return No return value expected.
+ */
+typedef void (*allocator_free_f)(void * p_ctx, void * p_ptr, size_t size);
+
+/*!
+ * @brief This datatype defines an allocator.
+ *
+ *          The allocator must outlive every container created with it.
+ *
+ * @param alloc_func The function allocating a block. Required.
+ * @param realloc_func The function resizing a block. May be NULL.
+ * @param free_func The function releasing a block. May be NULL.
+ * @param p_ctx The context passed to each function.
+ */
+typedef struct _allocator
+{
+    allocator_alloc_f   alloc_func;
+    allocator_realloc_f realloc_func;
+    allocator_free_f    free_func;
+    void *              p_ctx;
+} allocator_t;
+
+/*!
+ * @brief This function allocates a block of memory.
+ *
+ * @param[in] p_alloc The allocator, or NULL for the standard library.
+ * @param[in] size The size in bytes of the block.
+ *
+ * @return Pointer to the block. NULL on error.
+ */
+static inline void *
+allocator_alloc (const allocator_t * p_alloc, const size_t size)
+{
+    void * p_ptr = NULL;
+    if (NULL == p_alloc)
+    {
+        p_ptr = malloc(size);
+    }
+    else
+    {
+        p_ptr = p_alloc->alloc_func(p_alloc->p_ctx, size);
+    }
+    return p_ptr;
+}
+
+/*!
+ * @brief This function allocates a zeroed array.
+ *
+ * @param[in] p_alloc The allocator, or NULL for the standard library.
+ * @param[in] count The number of elements in the array.
+ * @param[in] size The size in bytes of an element.
+ *
+ * @return Pointer to the array. NULL on error or overflow.
+ */
+static inline void *
+allocator_calloc (const allocator_t * p_alloc,
+                  const size_t count,
+                  const size_t size)
+{
+    void * p_ptr = NULL;
+    if (NULL == p_alloc)
+    {
+        p_ptr = calloc(count, size);
+        goto EXIT;
+    }
+    if ((0 != size) &&
+        (count > (SIZE_MAX / size)))
+    {
+        goto EXIT;
+    }
+
+    p_ptr = p_alloc->alloc_func(p_alloc->p_ctx, count * size);
+    if (NULL != p_ptr)
+    {
+        memset(p_ptr, 0, count * size);
+    }
+
+    EXIT:
+        return p_ptr;
+}
+
+/*!
+ * @brief This function resizes a block of memory.
+ *
+ * @param[in] p_alloc The allocator, or NULL for the standard library.
+ * @param[in/out] p_ptr The block to resize, or NULL to allocate a new one.
+ * @param[in] old_size The size in bytes the block was allocated with.
+ * @param[in] new_size The size in bytes wanted.
+ *
+ * @return Pointer to the resized block. NULL on error, in which case the
+ *          original block is left intact.
+ */
+static inline void *
+allocator_realloc (const allocator_t * p_alloc,
+                   void * p_ptr,
+                   const size_t old_size,
+                   const size_t new_size)
+{
+    void * p_new = NULL;
+    if (NULL == p_alloc)
+    {
+        p_new = realloc(p_ptr, new_size);
+        goto EXIT;
+    }
+    if (NULL == p_ptr)
+    {
+        p_new = p_alloc->alloc_func(p_alloc->p_ctx, new_size);
+        goto EXIT;
+    }
+    if (NULL != p_alloc->realloc_func)
+    {
+        p_new = p_alloc->realloc_func(p_alloc->p_ctx, p_ptr, old_size,
+                                      new_size);
+        goto EXIT;
+    }
+
+    // Without a realloc function, move the block by hand.
+    p_new = p_alloc->alloc_func(p_alloc->p_ctx, new_size);
+    if (NULL == p_new)
+    {
+        goto EXIT;
+    }
+    memcpy(p_new, p_ptr, (old_size < new_size) ? old_size : new_size);
+    if (NULL != p_alloc->free_func)
+    {
+        p_alloc->free_func(p_alloc->p_ctx, p_ptr, old_size);
+    }
+
+    EXIT:
+        return p_new;
+}
+
+/*!
+ * @brief This function releases a block of memory.
+ *
+ * @param[in] p_alloc The allocator, or NULL for the standard library.
+ * @param[in/out] p_ptr The block to release. May be NULL.
+ * @param[in] size The size in bytes the block was allocated with.
+ *
+ * @return No return value expected.
+ */
+static inline void
+allocator_free (const allocator_t * p_alloc, void * p_ptr, const size_t size)
+{
+    if (NULL == p_ptr)
+    {
+        goto EXIT;
+    }
+
+    if (NULL == p_alloc)
+    {
+        free(p_ptr);
+    }
+    else if (NULL != p_alloc->free_func)
+    {
+        p_alloc->free_func(p_alloc->p_ctx, p_ptr, size);
+    }
+
+    EXIT:
+        return;
+}
+
+#endif // ALLOCATOR_H
+
+/***   end of file   ***/
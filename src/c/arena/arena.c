@@ -0,0 +1,576 @@
+/*!
+ * @file arena.c
+ *
+ * @brief This file contains a bump-pointer arena allocator.
+ *
+ *          Functions included are as follows:
+ *
+ *              - arena_create
+ *              - arena_destroy
+ *              - arena_alloc
+ *              - arena_alloc_aligned
+ *              - arena_calloc
+ *              - arena_mark
+ *              - arena_rewind
+ *              - arena_reset
+ *              - arena_allocator
+ *              - arena_thread_local
+ *              - arena_thread_local_destroy
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "arena.h"
+
+/*** Size of a chunk header, rounded up so chunk memory is aligned. ***/
+#define ARENA_CHUNK_HEADER ((sizeof(arena_chunk_t) + \
+                             ARENA_DEFAULT_ALIGN - 1) & \
+                            ~(ARENA_DEFAULT_ALIGN - 1))
+
+// The calling thread's arena, and the key whose destructor destroys it
+// when the thread exits.
+static _Thread_local arena_t * gp_arena = NULL;
+static pthread_key_t g_arena_key;
+static pthread_once_t g_arena_once = PTHREAD_ONCE_INIT;
+static int g_arena_key_status = -1;
+
+/*!
+ * @brief This is a static function that returns the memory of a chunk.
+ *
+ * @param[in] p_chunk The chunk.
+ *
+ * @return Pointer to the first byte following the chunk header.
+ */
+static inline unsigned char *
+arena_chunk_data (arena_chunk_t * p_chunk)
+{
+    return (unsigned char *) p_chunk + ARENA_CHUNK_HEADER;
+}
+
+/*!
+ * @brief This is a static function that allocates a new chunk.
+ *
+ * @param[in] cap The number of bytes of memory in the chunk.
+ *
+ * @return Pointer to the chunk. NULL on error or overflow.
+ */
+static arena_chunk_t *
+arena_chunk_create (const size_t cap)
+{
+    arena_chunk_t * p_chunk = NULL;
+    if (cap > (SIZE_MAX - ARENA_CHUNK_HEADER))
+    {
+        goto EXIT;
+    }
+    
+    p_chunk = malloc(ARENA_CHUNK_HEADER + cap);
+    if (NULL == p_chunk)
+    {
+        goto EXIT;
+    }
+    p_chunk->p_next = NULL;
+    p_chunk->cap = cap;
+    
+    EXIT:
+        return p_chunk;
+}
+
+/*!
+ * @brief This is a static function that carves a block out of the
+ *          current chunk.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[in] size The size in bytes of the block.
+ * @param[in] align The alignment of the block. A power of two.
+ *
+ * @return Pointer to the block. NULL if the current chunk is too full.
+ */
+static void *
+arena_bump (arena_t * p_arena, const size_t size, const size_t align)
+{
+    void * p_block = NULL;
+    unsigned char * p_base = arena_chunk_data(p_arena->p_curr);
+    size_t avail = p_arena->p_curr->cap - p_arena->used;
+    size_t pad = (0 - ((uintptr_t) p_base + p_arena->used)) & (align - 1);
+    if ((pad > avail) ||
+        (size > (avail - pad)))
+    {
+        goto EXIT;
+    }
+    
+    p_block = p_base + p_arena->used + pad;
+    p_arena->used += pad + size;
+    
+    EXIT:
+        return p_block;
+}
+
+/*!
+ * @brief This is a static function that tells whether a block is the
+ *          most recent one carved from the current chunk.
+ *
+ * @param[in] p_arena The arena context.
+ * @param[in] p_ptr The block.
+ * @param[in] size The size in bytes of the block.
+ *
+ * @return true if the block ends where the current chunk's used memory
+ *          ends, false otherwise.
+ */
+static bool
+arena_is_last (arena_t * p_arena, const void * p_ptr, const size_t size)
+{
+    uintptr_t base = (uintptr_t) arena_chunk_data(p_arena->p_curr);
+    uintptr_t addr = (uintptr_t) p_ptr;
+    return ((addr >= base) &&
+            ((addr - base) <= p_arena->used) &&
+            (size == (p_arena->used - (addr - base))));
+}
+
+/*!
+ * @brief This is a static function that allocates through an arena on
+ *          behalf of an allocator_t.
+ *
+ * @param[in/out] p_ctx A void pointer to the arena context.
+ * @param[in] size The size in bytes of the block.
+ *
+ * @return Pointer to the block. NULL on error.
+ */
+static void *
+arena_allocator_alloc (void * p_ctx, size_t size)
+{
+    return arena_alloc(p_ctx, size);
+}
+
+/*!
+ * @brief This is a static function that resizes a block on behalf of an
+ *          allocator_t, in place if it is the arena's most recent block.
+ *
+ * @param[in/out] p_ctx A void pointer to the arena context.
+ * @param[in/out] p_ptr The block to resize.
+ * @param[in] old_size The size in bytes the block was allocated with.
+ * @param[in] new_size The size in bytes wanted.
+ *
+ * @return Pointer to the resized block. NULL on error.
+ */
+static void *
+arena_allocator_realloc (void * p_ctx,
+                         void * p_ptr,
+                         size_t old_size,
+                         size_t new_size)
+{
+    arena_t * p_arena = p_ctx;
+    void * p_new = NULL;
+    if (arena_is_last(p_arena, p_ptr, old_size))
+    {
+        size_t offset = (size_t) ((unsigned char *) p_ptr -
+                                  arena_chunk_data(p_arena->p_curr));
+        if (new_size <= (p_arena->p_curr->cap - offset))
+        {
+            p_arena->used = offset + new_size;
+            p_new = p_ptr;
+            goto EXIT;
+        }
+    }
+    
+    // The old block is left behind until the arena is rewound or reset.
+    p_new = arena_alloc(p_arena, new_size);
+    if (NULL == p_new)
+    {
+        goto EXIT;
+    }
+    memcpy(p_new, p_ptr, (old_size < new_size) ? old_size : new_size);
+    
+    EXIT:
+        return p_new;
+}
+
+/*!
+ * @brief This is a static function that releases a block on behalf of an
+ *          allocator_t, if it is the arena's most recent block.
+ *
+ * @param[in/out] p_ctx A void pointer to the arena context.
+ * @param[in] p_ptr The block to release.
+ * @param[in] size The size in bytes the block was allocated with.
+ *
+ * @return No return value expected.
+ */
+static void
+arena_allocator_free (void * p_ctx, void * p_ptr, size_t size)
+{
+    arena_t * p_arena = p_ctx;
+    if (arena_is_last(p_arena, p_ptr, size))
+    {
+        p_arena->used -= size;
+    }
+}
+
+/*!
+ * @brief This is a static function that destroys a thread's arena when
+ *          the thread exits.
+ *
+ * @param[in/out] vp_arena A void pointer to the arena context.
+ *
+ * @return No return value expected.
+ */
+static void
+arena_thread_exit (void * vp_arena)
+{
+    arena_destroy(vp_arena);
+}
+
+/*!
+ * @brief This is a static function that creates the key for thread-local
+ *          arenas, once per process.
+ *
+ * @return No return value expected.
+ */
+static void
+arena_key_create (void)
+{
+    if (0 == pthread_key_create(&g_arena_key, arena_thread_exit))
+    {
+        g_arena_key_status = 0;
+    }
+}
+
+/*!
+ * @brief This function instantiates a new arena.
+ *
+ *          The first chunk is allocated up front.
+ *
+ * @param[in] chunk_size The smallest size in bytes of a chunk. Zero for
+ *              ARENA_DEFAULT_CHUNK.
+ *
+ * @return Pointer to new arena context. NULL on error.
+ */
+arena_t *
+arena_create (const size_t chunk_size)
+{
+    arena_t * p_arena = calloc(1, sizeof(arena_t));
+    if (NULL == p_arena)
+    {
+        goto EXIT;
+    }
+    p_arena->chunk_size = (0 == chunk_size) ? ARENA_DEFAULT_CHUNK : chunk_size;
+    p_arena->p_first = arena_chunk_create(p_arena->chunk_size);
+    if (NULL == p_arena->p_first)
+    {
+        free(p_arena);
+        p_arena = NULL;
+        goto EXIT;
+    }
+    p_arena->p_curr = p_arena->p_first;
+    p_arena->used = 0;
+    
+    EXIT:
+        return p_arena;
+}
+
+/*!
+ * @brief This function destroys an arena and every block allocated from
+ *          it.
+ *
+ * @param[in/out] p_arena The arena context.
+ *
+ * @return No return value expected.
+ */
+void
+arena_destroy (arena_t * p_arena)
+{
+    if (NULL == p_arena)
+    {
+        goto EXIT;
+    }
+    
+    arena_chunk_t * p_chunk = p_arena->p_first;
+    while (NULL != p_chunk)
+    {
+        arena_chunk_t * p_next = p_chunk->p_next;
+        free(p_chunk);
+        p_chunk = p_next;
+    }
+    free(p_arena);
+    p_arena = NULL;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function allocates a block from the arena, aligned to
+ *          ARENA_DEFAULT_ALIGN.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[in] size The size in bytes of the block.
+ *
+ * @return Pointer to the block. NULL on error.
+ */
+void *
+arena_alloc (arena_t * p_arena, const size_t size)
+{
+    return arena_alloc_aligned(p_arena, size, ARENA_DEFAULT_ALIGN);
+}
+
+/*!
+ * @brief This function allocates a block from the arena with a given
+ *          alignment.
+ *
+ *          When the current chunk is full, the arena moves on to the next
+ *              chunk if a previous rewind or reset left one large enough,
+ *              and otherwise links in a new chunk after the current one.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[in] size The size in bytes of the block.
+ * @param[in] align The alignment of the block. A power of two.
+ *
+ * @return Pointer to the block. NULL on error.
+ */
+void *
+arena_alloc_aligned (arena_t * p_arena, const size_t size, const size_t align)
+{
+    void * p_block = NULL;
+    if ((NULL == p_arena) ||
+        (0 == align) ||
+        (0 != (align & (align - 1))) ||
+        (size > (SIZE_MAX - align)))
+    {
+        goto EXIT;
+    }
+    
+    p_block = arena_bump(p_arena, size, align);
+    if (NULL != p_block)
+    {
+        goto EXIT;
+    }
+    
+    // A chunk of size + align - 1 bytes fits the block at any alignment.
+    size_t need = size + align - 1;
+    arena_chunk_t * p_next = p_arena->p_curr->p_next;
+    if ((NULL == p_next) ||
+        (p_next->cap < need))
+    {
+        p_next = arena_chunk_create((need > p_arena->chunk_size) ?
+                                    need : p_arena->chunk_size);
+        if (NULL == p_next)
+        {
+            goto EXIT;
+        }
+        p_next->p_next = p_arena->p_curr->p_next;
+        p_arena->p_curr->p_next = p_next;
+    }
+    p_arena->p_curr = p_next;
+    p_arena->used = 0;
+    p_block = arena_bump(p_arena, size, align);
+    
+    EXIT:
+        return p_block;
+}
+
+/*!
+ * @brief This function allocates a zeroed array from the arena.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[in] count The number of elements in the array.
+ * @param[in] size The size in bytes of an element.
+ *
+ * @return Pointer to the array. NULL on error or overflow.
+ */
+void *
+arena_calloc (arena_t * p_arena, const size_t count, const size_t size)
+{
+    void * p_block = NULL;
+    if ((0 != size) &&
+        (count > (SIZE_MAX / size)))
+    {
+        goto EXIT;
+    }
+    
+    p_block = arena_alloc(p_arena, count * size);
+    if (NULL != p_block)
+    {
+        memset(p_block, 0, count * size);
+    }
+    
+    EXIT:
+        return p_block;
+}
+
+/*!
+ * @brief This function records the arena's current position.
+ *
+ * @param[in] p_arena The arena context.
+ *
+ * @return The marker. A marker with a NULL chunk on error.
+ */
+arena_mark_t
+arena_mark (const arena_t * p_arena)
+{
+    arena_mark_t mark = { NULL, 0 };
+    if (NULL == p_arena)
+    {
+        goto EXIT;
+    }
+    
+    mark.p_chunk = p_arena->p_curr;
+    mark.used = p_arena->used;
+    
+    EXIT:
+        return mark;
+}
+
+/*!
+ * @brief This function releases every block allocated since a marker
+ *          was taken.
+ *
+ *          Chunks past the marker are kept for reuse.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[in] mark A marker taken from this arena.
+ *
+ * @return 0 on success, -1 on error or if the arena has already been
+ *          rewound past the marker.
+ */
+int
+arena_rewind (arena_t * p_arena, const arena_mark_t mark)
+{
+    int status = -1;
+    if ((NULL == p_arena) ||
+        (NULL == mark.p_chunk))
+    {
+        goto EXIT;
+    }
+    
+    // The marker's chunk must be at or before the current one.
+    arena_chunk_t * p_chunk = p_arena->p_first;
+    while ((p_chunk != mark.p_chunk) &&
+           (p_chunk != p_arena->p_curr))
+    {
+        p_chunk = p_chunk->p_next;
+    }
+    if ((p_chunk != mark.p_chunk) ||
+        ((p_chunk == p_arena->p_curr) &&
+         (mark.used > p_arena->used)))
+    {
+        goto EXIT;
+    }
+    
+    p_arena->p_curr = mark.p_chunk;
+    p_arena->used = mark.used;
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function releases every block allocated from the arena,
+ *          keeping its chunks for reuse.
+ *
+ * @param[in/out] p_arena The arena context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+arena_reset (arena_t * p_arena)
+{
+    int status = -1;
+    if (NULL == p_arena)
+    {
+        goto EXIT;
+    }
+    
+    p_arena->p_curr = p_arena->p_first;
+    p_arena->used = 0;
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function fills in an allocator that draws from the arena.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[out] p_alloc The allocator to fill in.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+arena_allocator (arena_t * p_arena, allocator_t * p_alloc)
+{
+    int status = -1;
+    if ((NULL == p_arena) ||
+        (NULL == p_alloc))
+    {
+        goto EXIT;
+    }
+    
+    p_alloc->alloc_func = arena_allocator_alloc;
+    p_alloc->realloc_func = arena_allocator_realloc;
+    p_alloc->free_func = arena_allocator_free;
+    p_alloc->p_ctx = p_arena;
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function returns the calling thread's arena, creating it
+ *          on first use.
+ *
+ * @return Pointer to the thread's arena context. NULL on error.
+ */
+arena_t *
+arena_thread_local (void)
+{
+    if (NULL != gp_arena)
+    {
+        goto EXIT;
+    }
+    
+    pthread_once(&g_arena_once, arena_key_create);
+    if (0 != g_arena_key_status)
+    {
+        goto EXIT;
+    }
+    gp_arena = arena_create(0);
+    if (NULL == gp_arena)
+    {
+        goto EXIT;
+    }
+    if (0 != pthread_setspecific(g_arena_key, gp_arena))
+    {
+        arena_destroy(gp_arena);
+        gp_arena = NULL;
+    }
+    
+    EXIT:
+        return gp_arena;
+}
+
+/*!
+ * @brief This function destroys the calling thread's arena, if it has one.
+ *
+ * @return No return value expected.
+ */
+void
+arena_thread_local_destroy (void)
+{
+    if (NULL == gp_arena)
+    {
+        goto EXIT;
+    }
+    
+    pthread_setspecific(g_arena_key, NULL);
+    arena_destroy(gp_arena);
+    gp_arena = NULL;
+    
+    EXIT:
+        return;
+}
+
+/***   end of file   ***/
\ No newline at end of file
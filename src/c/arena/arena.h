@@ -0,0 +1,222 @@
+/*!
+ * @file arena.h
+ *
+ * @brief This file contains a bump-pointer arena allocator.
+ *
+ *          An arena hands out memory by advancing an offset through a
+ *              chunk, and grows by linking in further chunks. Blocks are
+ *              not freed one by one. Instead the whole arena is reset,
+ *              or rewound to a marker taken earlier, which releases every
+ *              block allocated since in one step. Chunks are kept for
+ *              reuse until the arena is destroyed.
+ *
+ *          An arena is not thread-safe. Each thread may instead use its
+ *              own arena from arena_thread_local, which is destroyed
+ *              when the thread exits.
+ *
+ *          Functions included are as follows:
+ *
+ *              - arena_create
+ *              - arena_destroy
+ *              - arena_alloc
+ *              - arena_alloc_aligned
+ *              - arena_calloc
+ *              - arena_mark
+ *              - arena_rewind
+ *              - arena_reset
+ *              - arena_allocator
+ *              - arena_thread_local
+ *              - arena_thread_local_destroy
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "src/c/allocator/allocator.h"
+
+/*** Default size in bytes of an arena chunk. ***/
+#define ARENA_DEFAULT_CHUNK (64 * 1024)
+
+/*** Alignment of blocks returned by arena_alloc. ***/
+#define ARENA_DEFAULT_ALIGN (_Alignof(max_align_t))
+
+/*!
+ * @brief This datatype defines a chunk of arena memory.
+ *
+ * @param p_next The next chunk, holding no live blocks until the arena
+ *          moves on to it.
+ * @param cap The number of bytes of memory following the header.
+ */
+typedef struct _arena_chunk
+{
+    struct _arena_chunk * p_next;
+    size_t                cap;
+} arena_chunk_t;
+
+/*!
+ * @brief This datatype defines an arena.
+ *
+ * @param p_first The first chunk.
+ * @param p_curr The chunk blocks are currently allocated from.
+ * @param used The number of bytes used in the current chunk.
+ * @param chunk_size The smallest size of a new chunk.
+ */
+typedef struct _arena
+{
+    arena_chunk_t * p_first;
+    arena_chunk_t * p_curr;
+    size_t          used;
+    size_t          chunk_size;
+} arena_t;
+
+/*!
+ * @brief This datatype defines a position in an arena to rewind to.
+ *
+ * @param p_chunk The chunk that was current.
+ * @param used The number of bytes that were used in that chunk.
+ */
+typedef struct _arena_mark
+{
+    arena_chunk_t * p_chunk;
+    size_t          used;
+} arena_mark_t;
+
+/*!
+ * @brief This function instantiates a new arena.
+ *
+ * @param[in] chunk_size The smallest size in bytes of a chunk. Zero for
+ *              ARENA_DEFAULT_CHUNK.
+ *
+ * @return Pointer to new arena context. NULL on error.
+ */
+arena_t *
+arena_create (const size_t chunk_size);
+
+/*!
+ * @brief This function destroys an arena and every block allocated from
+ *          it.
+ *
+ * @param[in/out] p_arena The arena context.
+ *
+ * @return No return value expected.
+ */
+void
+arena_destroy (arena_t * p_arena);
+
+/*!
+ * @brief This function allocates a block from the arena, aligned to
+ *          ARENA_DEFAULT_ALIGN.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[in] size The size in bytes of the block.
+ *
+ * @return Pointer to the block. NULL on error.
+ */
+void *
+arena_alloc (arena_t * p_arena, const size_t size);
+
+/*!
+ * @brief This function allocates a block from the arena with a given
+ *          alignment.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[in] size The size in bytes of the block.
+ * @param[in] align The alignment of the block. A power of two.
+ *
+ * @return Pointer to the block. NULL on error.
+ */
+void *
+arena_alloc_aligned (arena_t * p_arena, const size_t size, const size_t align);
+
+/*!
+ * @brief This function allocates a zeroed array from the arena.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[in] count The number of elements in the array.
+ * @param[in] size The size in bytes of an element.
+ *
+ * @return Pointer to the array. NULL on error or overflow.
+ */
+void *
+arena_calloc (arena_t * p_arena, const size_t count, const size_t size);
+
+/*!
+ * @brief This function records the arena's current position.
+ *
+ * @param[in] p_arena The arena context.
+ *
+ * @return The marker. It stays valid until the arena is rewound past it
+ *          or reset.
+ */
+arena_mark_t
+arena_mark (const arena_t * p_arena);
+
+/*!
+ * @brief This function releases every block allocated since a marker
+ *          was taken.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[in] mark A marker taken from this arena.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+arena_rewind (arena_t * p_arena, const arena_mark_t mark);
+
+/*!
+ * @brief This function releases every block allocated from the arena,
+ *          keeping its chunks for reuse.
+ *
+ * @param[in/out] p_arena The arena context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+arena_reset (arena_t * p_arena);
+
+/*!
+ * @brief This function fills in an allocator that draws from the arena,
+ *          for use with the containers' *_create_with_allocator
+ *          functions.
+ *
+ *          Freeing or resizing the most recent block of the arena adjusts
+ *              it in place. Any other block is only released by a rewind
+ *              or reset.
+ *
+ * @param[in/out] p_arena The arena context.
+ * @param[out] p_alloc The allocator to fill in.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+arena_allocator (arena_t * p_arena, allocator_t * p_alloc);
+
+/*!
+ * @brief This function returns the calling thread's arena, creating it
+ *          on first use.
+ *
+ *          The arena is destroyed when the thread exits through
+ *              pthread_exit or by returning from its start routine.
+ *
+ * @return Pointer to the thread's arena context. NULL on error.
+ */
+arena_t *
+arena_thread_local (void);
+
+/*!
+ * @brief This function destroys the calling thread's arena, if it has one.
+ *
+ *          This is needed for the main thread, whose arena is not
+ *              destroyed when the process exits.
+ *
+ * @return No return value expected.
+ */
+void
+arena_thread_local_destroy (void);
+
+#endif // ARENA_H
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,20 @@
+/*!
+ * @file cache_line.h
+ *
+ * @brief This file contains the cache line size shared by the concurrent
+ *          containers in this repository.
+ *
+ *          Fields written by different threads are padded apart to this
+ *              size so that they never share a cache line and a write to
+ *              one does not invalidate the line holding the other.
+ */
+
+#ifndef CACHE_LINE_H
+#define CACHE_LINE_H
+
+/*** Assumed size in bytes of a cache line. ***/
+#define CACHE_LINE_SIZE 64
+
+#endif // CACHE_LINE_H
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,391 @@
+/*!
+ * @file mpmc_queue.c
+ *
+ * @brief This file contains a bounded lock-free queue that any number of
+ *          threads may enqueue to and dequeue from at once.
+ *
+ *          The algorithm is Dmitry Vyukov's bounded MPMC queue. Cell i
+ *              starts with sequence number i. A producer that claims
+ *              position pos writes the cell whose sequence is pos, then
+ *              sets it to pos + 1. A consumer that claims pos reads the
+ *              cell whose sequence is pos + 1, then sets it to
+ *              pos + capacity, handing it to the producer of the next
+ *              lap.
+ *
+ *          Functions included are as follows:
+ *
+ *              - mpmc_queue_create
+ *              - mpmc_queue_destroy
+ *              - mpmc_queue_try_enq
+ *              - mpmc_queue_try_deq
+ *              - mpmc_queue_enq
+ *              - mpmc_queue_deq
+ *              - mpmc_queue_size
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sched.h>
+
+#include "mpmc_queue.h"
+
+/*** Alignment of the element stored in each cell. ***/
+#define MPMC_QUEUE_ALIGN _Alignof(max_align_t)
+
+/*!
+ * @brief This is a static function that returns the sequence number of
+ *          a cell.
+ *
+ * @param[in] p_queue The queue context.
+ * @param[in] pos The position the cell is found at.
+ *
+ * @return Pointer to the cell's sequence number.
+ */
+static _Atomic size_t *
+mpmc_queue_seq (mpmc_queue_t * p_queue, const size_t pos)
+{
+    return (_Atomic size_t *) (p_queue->p_cells +
+                               ((pos & p_queue->mask) * p_queue->stride));
+}
+
+/*!
+ * @brief This is a static function that returns the element of a cell.
+ *
+ * @param[in] p_queue The queue context.
+ * @param[in] pos The position the cell is found at.
+ *
+ * @return Pointer to the cell's element.
+ */
+static void *
+mpmc_queue_elem (mpmc_queue_t * p_queue, const size_t pos)
+{
+    return p_queue->p_cells + ((pos & p_queue->mask) * p_queue->stride) +
+           MPMC_QUEUE_ALIGN;
+}
+
+/*!
+ * @brief This function instantiates a new empty queue.
+ *
+ * @param[in] cap The number of elements the queue can hold. This is
+ *              rounded up to a power of two.
+ * @param[in] elem_size The size in bytes of a single element.
+ *
+ * @return Pointer to new queue context. NULL on error.
+ */
+mpmc_queue_t *
+mpmc_queue_create (const size_t cap, const size_t elem_size)
+{
+    int status = -1;
+    mpmc_queue_t * p_queue = NULL;
+    // Capacities past the largest power of two in a size_t cannot be
+    // rounded up, and neither may a cell's size overflow.
+    if ((0 == cap) ||
+        (0 == elem_size) ||
+        (cap > ((SIZE_MAX / 2) + 1)) ||
+        (elem_size > (SIZE_MAX - (2 * MPMC_QUEUE_ALIGN))))
+    {
+        goto EXIT;
+    }
+    
+    p_queue = calloc(1, sizeof(mpmc_queue_t));
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    // Round the capacity up to a power of two.
+    size_t pow2 = 2;
+    while (pow2 < cap)
+    {
+        pow2 <<= 1;
+    }
+    
+    // Each cell is a sequence number followed by an aligned element.
+    p_queue->mask = pow2 - 1;
+    p_queue->elem_size = elem_size;
+    p_queue->stride = ((MPMC_QUEUE_ALIGN + elem_size + MPMC_QUEUE_ALIGN - 1)
+                       / MPMC_QUEUE_ALIGN) * MPMC_QUEUE_ALIGN;
+    if (pow2 > (SIZE_MAX / p_queue->stride))
+    {
+        goto EXIT;
+    }
+    p_queue->p_cells = calloc(pow2, p_queue->stride);
+    if (NULL == p_queue->p_cells)
+    {
+        goto EXIT;
+    }
+    for (size_t pos = 0; pos < pow2; ++pos)
+    {
+        atomic_init(mpmc_queue_seq(p_queue, pos), pos);
+    }
+    atomic_init(&(p_queue->tail), 0);
+    atomic_init(&(p_queue->head), 0);
+    
+    status = 0;
+    
+    EXIT:
+        if ((-1 == status) &&
+            (NULL != p_queue))
+        {
+            mpmc_queue_destroy(p_queue);
+            p_queue = NULL;
+        }
+        return p_queue;
+}
+
+/*!
+ * @brief This function destroys a queue context.
+ *
+ *          No other thread may access the queue during or after
+ *              this call.
+ *
+ * @param[in/out] p_queue The queue context.
+ *
+ * @return No return value expected.
+ */
+void
+mpmc_queue_destroy (mpmc_queue_t * p_queue)
+{
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    if (NULL != p_queue->p_cells)
+    {
+        free(p_queue->p_cells);
+        p_queue->p_cells = NULL;
+    }
+    free(p_queue);
+    p_queue = NULL;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function copies an element into the queue if there is
+ *          room for it.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] p_elem The element to enqueue.
+ *
+ * @return 0 on success, -1 on error or full queue.
+ */
+int
+mpmc_queue_try_enq (mpmc_queue_t * p_queue, const void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_queue) ||
+        (NULL == p_elem))
+    {
+        goto EXIT;
+    }
+    
+    // Claim the tail position once its cell is free on this lap.
+    size_t pos = atomic_load_explicit(&(p_queue->tail), memory_order_relaxed);
+    for (;;)
+    {
+        size_t seq = atomic_load_explicit(mpmc_queue_seq(p_queue, pos),
+                                          memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+        if (0 == diff)
+        {
+            if (atomic_compare_exchange_weak_explicit(
+                    &(p_queue->tail), &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The cell has not been read since the last lap. Full queue.
+            goto EXIT;
+        }
+        else
+        {
+            // Another producer claimed this position first.
+            pos = atomic_load_explicit(&(p_queue->tail),
+                                       memory_order_relaxed);
+        }
+    }
+    
+    // Write the element, then hand the cell to the consumers.
+    memcpy(mpmc_queue_elem(p_queue, pos), p_elem, p_queue->elem_size);
+    atomic_store_explicit(mpmc_queue_seq(p_queue, pos), pos + 1,
+                          memory_order_release);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function copies the oldest element out of the queue if
+ *          there is one.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[out] p_elem Receives the dequeued element.
+ *
+ * @return 0 on success, -1 on error or empty queue.
+ */
+int
+mpmc_queue_try_deq (mpmc_queue_t * p_queue, void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_queue) ||
+        (NULL == p_elem))
+    {
+        goto EXIT;
+    }
+    
+    // Claim the head position once its cell has been written on this lap.
+    size_t pos = atomic_load_explicit(&(p_queue->head), memory_order_relaxed);
+    for (;;)
+    {
+        size_t seq = atomic_load_explicit(mpmc_queue_seq(p_queue, pos),
+                                          memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+        if (0 == diff)
+        {
+            if (atomic_compare_exchange_weak_explicit(
+                    &(p_queue->head), &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The cell has not been written on this lap. Empty queue.
+            goto EXIT;
+        }
+        else
+        {
+            // Another consumer claimed this position first.
+            pos = atomic_load_explicit(&(p_queue->head),
+                                       memory_order_relaxed);
+        }
+    }
+    
+    // Read the element, then hand the cell to the next lap's producer.
+    memcpy(p_elem, mpmc_queue_elem(p_queue, pos), p_queue->elem_size);
+    atomic_store_explicit(mpmc_queue_seq(p_queue, pos),
+                          pos + p_queue->mask + 1, memory_order_release);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function copies an element into the queue, waiting for
+ *          room if it is full.
+ *
+ *          A full queue is polled, spinning at first and then yielding
+ *              the processor between attempts.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] p_elem The element to enqueue.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+mpmc_queue_enq (mpmc_queue_t * p_queue, const void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_queue) ||
+        (NULL == p_elem))
+    {
+        goto EXIT;
+    }
+    
+    size_t attempts = 0;
+    while (-1 == mpmc_queue_try_enq(p_queue, p_elem))
+    {
+        if (++attempts >= MPMC_QUEUE_SPIN)
+        {
+            sched_yield();
+        }
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function copies the oldest element out of the queue,
+ *          waiting for one if it is empty.
+ *
+ *          An empty queue is polled, spinning at first and then
+ *              yielding the processor between attempts.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[out] p_elem Receives the dequeued element.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+mpmc_queue_deq (mpmc_queue_t * p_queue, void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_queue) ||
+        (NULL == p_elem))
+    {
+        goto EXIT;
+    }
+    
+    size_t attempts = 0;
+    while (-1 == mpmc_queue_try_deq(p_queue, p_elem))
+    {
+        if (++attempts >= MPMC_QUEUE_SPIN)
+        {
+            sched_yield();
+        }
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function returns an estimate of the number of elements in
+ *          the queue. The result may be stale by the time it is used.
+ *
+ * @param[in] p_queue The queue context.
+ *
+ * @return The estimated number of elements.
+ */
+size_t
+mpmc_queue_size (mpmc_queue_t * p_queue)
+{
+    size_t size = 0;
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    size_t head = atomic_load_explicit(&(p_queue->head), memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&(p_queue->tail), memory_order_relaxed);
+    if ((intptr_t) (tail - head) > 0)
+    {
+        size = tail - head;
+    }
+    if (size > (p_queue->mask + 1))
+    {
+        size = p_queue->mask + 1;
+    }
+    
+    EXIT:
+        return size;
+}
+
+/***   end of file   ***/
\ No newline at end of file
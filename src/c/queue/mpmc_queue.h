@@ -0,0 +1,163 @@
+/*!
+ * @file mpmc_queue.h
+ *
+ * @brief This file contains a bounded lock-free queue that any number of
+ *          threads may enqueue to and dequeue from at once.
+ *
+ *          Elements are copied by value into a circular buffer of
+ *              cells. Each cell carries a sequence number recording
+ *              whether it is waiting to be written or to be read on the
+ *              current lap, so a producer or consumer only has to claim
+ *              a position with a single compare-and-swap and never
+ *              touches the cells other threads are working on.
+ *
+ *          The capacity is fixed at creation. Elements are stored
+ *              inline, so a queue of job_t can stand in for the
+ *              threadpool's job queue without allocating per job.
+ *
+ *          Functions included are as follows:
+ *
+ *              - mpmc_queue_create
+ *              - mpmc_queue_destroy
+ *              - mpmc_queue_try_enq
+ *              - mpmc_queue_try_deq
+ *              - mpmc_queue_enq
+ *              - mpmc_queue_deq
+ *              - mpmc_queue_size
+ */
+
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "src/c/cache_line/cache_line.h"
+
+/*** Failed attempts a blocking call spins for before yielding. ***/
+#define MPMC_QUEUE_SPIN 64
+
+/*!
+ * @brief This datatype defines a bounded multi-producer, multi-consumer
+ *          queue context.
+ *
+ *          The enqueue and dequeue positions sit on cache lines of
+ *              their own, so producers and consumers do not contend
+ *              with each other.
+ *
+ * @param mask The number of cells minus one. The cell count is always a
+ *          power of two.
+ * @param elem_size The size in bytes of a single element.
+ * @param stride The distance in bytes between cells.
+ * @param p_cells The cells. Each holds a sequence number followed by an
+ *          element.
+ * @param tail The position the next element is enqueued at.
+ * @param head The position the next element is dequeued from.
+ */
+typedef struct _mpmc_queue
+{
+    size_t          mask;
+    size_t          elem_size;
+    size_t          stride;
+    unsigned char * p_cells;
+    char            pad_cells[CACHE_LINE_SIZE - (3 * sizeof(size_t))
+                              - sizeof(unsigned char *)];
+    _Atomic size_t  tail;
+    char            pad_tail[CACHE_LINE_SIZE - sizeof(size_t)];
+    _Atomic size_t  head;
+    char            pad_head[CACHE_LINE_SIZE - sizeof(size_t)];
+} mpmc_queue_t;
+
+/*!
+ * @brief This function instantiates a new empty queue.
+ *
+ * @param[in] cap The number of elements the queue can hold. This is
+ *              rounded up to a power of two.
+ * @param[in] elem_size The size in bytes of a single element.
+ *
+ * @return Pointer to new queue context. NULL on error.
+ */
+mpmc_queue_t *
+mpmc_queue_create (const size_t cap, const size_t elem_size);
+
+/*!
+ * @brief This function destroys a queue context.
+ *
+ *          No other thread may access the queue during or after
+ *              this call.
+ *
+ * @param[in/out] p_queue The queue context.
+ *
+ * @return No return value expected.
+ */
+void
+mpmc_queue_destroy (mpmc_queue_t * p_queue);
+
+/*!
+ * @brief This function copies an element into the queue if there is
+ *          room for it.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] p_elem The element to enqueue.
+ *
+ * @return 0 on success, -1 on error or full queue.
+ */
+int
+mpmc_queue_try_enq (mpmc_queue_t * p_queue, const void * p_elem);
+
+/*!
+ * @brief This function copies the oldest element out of the queue if
+ *          there is one.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[out] p_elem Receives the dequeued element.
+ *
+ * @return 0 on success, -1 on error or empty queue.
+ */
+int
+mpmc_queue_try_deq (mpmc_queue_t * p_queue, void * p_elem);
+
+/*!
+ * @brief This function copies an element into the queue, waiting for
+ *          room if it is full.
+ *
+ *          A full queue is polled, spinning at first and then yielding
+ *              the processor between attempts.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] p_elem The element to enqueue.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+mpmc_queue_enq (mpmc_queue_t * p_queue, const void * p_elem);
+
+/*!
+ * @brief This function copies the oldest element out of the queue,
+ *          waiting for one if it is empty.
+ *
+ *          An empty queue is polled, spinning at first and then
+ *              yielding the processor between attempts.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[out] p_elem Receives the dequeued element.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+mpmc_queue_deq (mpmc_queue_t * p_queue, void * p_elem);
+
+/*!
+ * @brief This function returns an estimate of the number of elements in
+ *          the queue. The result may be stale by the time it is used.
+ *
+ * @param[in] p_queue The queue context.
+ *
+ * @return The estimated number of elements.
+ */
+size_t
+mpmc_queue_size (mpmc_queue_t * p_queue);
+
+#endif // MPMC_QUEUE_H
+
+/***   end of file   ***/
\ No newline at end of file
@@ -2,38 +2,139 @@
  * @file queue.c
  *
  * @brief This file contains a generic queue implementation using
- *          a singly linked list.
+ *          a circular buffer.
  *
  *          The queue will contain references to any type of data,
  *              but will not be responsible for allocation or
  *              deallocation of referenced data.
  *
+ *          References are stored contiguously in a power-of-two buffer
+ *              that doubles in size when full, so a queue that has
+ *              reached its working size performs no further allocation
+ *              and costs one pointer per element. The number of spare
+ *              slots kept once the queue drains may be capped.
+ *
  *          Function supported are as follows:
  *
  *              - queue_create
+ *              - queue_create_with_allocator
  *              - queue_destroy
  *              - queue_enq
  *              - queue_deq
+ *              - queue_reserve
+ *              - queue_trim
+ *              - queue_set_spare_limit
  */
 
+#include <string.h>
+
 #include "queue.h"
 
+/*!
+ * @brief This is a static function that moves the queue into a buffer
+ *          of a new size, keeping the first reference in slot 0 when
+ *          shrinking.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] new_cap The new number of slots. Zero or a power of two no
+ *              smaller than the queue's size.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+queue_resize (queue_t * p_queue, const size_t new_cap)
+{
+    int status = -1;
+    size_t first = p_queue->cap - p_queue->head;
+    if (first > p_queue->size)
+    {
+        first = p_queue->size;
+    }
+    
+    // Growing keeps the buffer in place where possible. Only the
+    // references that had wrapped around to the front have to move, and
+    // they move to just past the old end.
+    if (new_cap > p_queue->cap)
+    {
+        void ** pp_new = allocator_realloc(p_queue->p_alloc,
+                                           p_queue->pp_slots,
+                                           p_queue->cap * sizeof(void *),
+                                           new_cap * sizeof(void *));
+        if (NULL == pp_new)
+        {
+            goto EXIT;
+        }
+        memcpy(pp_new + p_queue->cap, pp_new,
+               (p_queue->size - first) * sizeof(void *));
+        p_queue->pp_slots = pp_new;
+        p_queue->cap = new_cap;
+        status = 0;
+        goto EXIT;
+    }
+    
+    // Shrinking copies the references, in order, into a fresh buffer.
+    void ** pp_new = NULL;
+    if (0 != new_cap)
+    {
+        pp_new = allocator_calloc(p_queue->p_alloc, new_cap,
+                                  sizeof(void *));
+        if (NULL == pp_new)
+        {
+            goto EXIT;
+        }
+        memcpy(pp_new, p_queue->pp_slots + p_queue->head,
+               first * sizeof(void *));
+        memcpy(pp_new + first, p_queue->pp_slots,
+               (p_queue->size - first) * sizeof(void *));
+    }
+    allocator_free(p_queue->p_alloc, p_queue->pp_slots,
+                   p_queue->cap * sizeof(void *));
+    p_queue->pp_slots = pp_new;
+    p_queue->cap = new_cap;
+    p_queue->head = 0;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
 /*!
  * @brief This function instantiates a new empty queue.
  *
+ *          No buffer is allocated until the first enqueue.
+ *
  * @return Pointer to new queue context. NULL on error.
  */
 queue_t *
 queue_create (void)
 {
-    queue_t * p_queue = calloc(1, sizeof(queue_t));
+    return queue_create_with_allocator(NULL);
+}
+
+/*!
+ * @brief This function instantiates a new empty queue that allocates
+ *          through a given allocator.
+ *
+ * @param[in] p_alloc The allocator for the context and its buffer. NULL
+ *              for the standard library.
+ *
+ * @return Pointer to new queue context. NULL on error.
+ */
+queue_t *
+queue_create_with_allocator (const allocator_t * p_alloc)
+{
+    queue_t * p_queue = allocator_calloc(p_alloc, 1, sizeof(queue_t));
     if (NULL == p_queue)
     {
         goto EXIT;
     }
-    p_queue->p_head = NULL;
-    p_queue->p_tail = NULL;
+    p_queue->pp_slots = NULL;
+    p_queue->cap = 0;
+    p_queue->head = 0;
     p_queue->size = 0;
+    p_queue->spare_limit = QUEUE_SPARE_UNLIMITED;
+    p_queue->p_alloc = p_alloc;
     
     EXIT:
         return p_queue;
@@ -54,29 +155,21 @@ queue_create (void)
 void
 queue_destroy (queue_t * p_queue)
 {
-    if ((NULL == p_queue) ||
-        (NULL == p_queue->p_head))
+    if (NULL == p_queue)
     {
         goto EXIT;
     }
     
-    // Free each node in the queue.
-    queue_node_t * p_curr = p_queue->p_head;
-    queue_node_t * p_next = NULL;
-    
-    while (NULL != p_curr)
+    if (NULL != p_queue->pp_slots)
     {
-        p_next = p_curr->p_next;
-        free(p_curr);
-        p_curr = p_next;
+        allocator_free(p_queue->p_alloc, p_queue->pp_slots,
+                       p_queue->cap * sizeof(void *));
+        p_queue->pp_slots = NULL;
     }
+    allocator_free(p_queue->p_alloc, p_queue, sizeof(queue_t));
+    p_queue = NULL;
     
     EXIT:
-        if (NULL != p_queue)
-        {
-            free(p_queue);
-            p_queue = NULL;
-        }
         return;
 }
 
@@ -98,25 +191,20 @@ queue_enq (queue_t * p_queue, void * p_data)
         goto EXIT;
     }
     
-    // Create a new node.
-    queue_node_t * p_new = calloc(1, sizeof(queue_node_t));
-    if (NULL == p_new)
+    // If the buffer is full, double it.
+    if (p_queue->size == p_queue->cap)
     {
-        goto EXIT;
+        size_t new_cap = (0 == p_queue->cap) ? QUEUE_INIT_CAP
+                                             : (p_queue->cap * 2);
+        if (-1 == queue_resize(p_queue, new_cap))
+        {
+            goto EXIT;
+        }
     }
-    p_new->p_data = p_data;
-    p_new->p_next = NULL;
     
-    // Enqueue new node.
-    if (NULL == p_queue->p_head)
-    {
-        p_queue->p_head = p_new;
-    }
-    else
-    {
-        p_queue->p_tail->p_next = p_new;
-    }
-    p_queue->p_tail = p_new;
+    // Enqueue the reference behind the last one.
+    size_t tail = (p_queue->head + p_queue->size) & (p_queue->cap - 1);
+    p_queue->pp_slots[tail] = p_data;
     p_queue->size++;
     
     status = 0;
@@ -126,11 +214,11 @@ queue_enq (queue_t * p_queue, void * p_data)
 }
 
 /*!
- * @brief This function dequeues the first node in the queue.
+ * @brief This function dequeues the first reference in the queue.
  *
  * @param[in/out] p_queue The queue context.
  *
- * @return Pointer to the data held in the first node of the queue.
+ * @return Pointer to the data first in the queue.
  *          NULL on error or empty queue.
  */
 void *
@@ -138,24 +226,142 @@ queue_deq (queue_t * p_queue)
 {
     void * p_result = NULL;
     if ((NULL == p_queue) ||
-        (NULL == p_queue->p_head))
+        (0 == p_queue->size))
     {
         goto EXIT;
     }
     
-    queue_node_t * p_next = p_queue->p_head->p_next;
-    p_result = p_queue->p_head->p_data;
-    free(p_queue->p_head);
-    p_queue->p_head = p_next;
+    p_result = p_queue->pp_slots[p_queue->head];
+    p_queue->head = (p_queue->head + 1) & (p_queue->cap - 1);
+    p_queue->size--;
     
-    if (NULL == p_queue->p_head)
+    // Give back memory once the queue has drained well past its spare
+    // limit: more than twice the limit empty and at most a quarter full.
+    // The buffer is then halved no further than twice the queue's size,
+    // so a queue holding steady near a boundary does not reallocate on
+    // every operation.
+    size_t spare = p_queue->cap - p_queue->size;
+    if (((spare / 2) > p_queue->spare_limit) &&
+        (p_queue->size <= (p_queue->cap / 4)))
     {
-        p_queue->p_tail = NULL;
+        queue_trim(p_queue, (p_queue->spare_limit > p_queue->size) ?
+                            p_queue->spare_limit : p_queue->size);
     }
-    p_queue->size--;
     
     EXIT:
         return p_result;
 }
 
-/***   end of file   ***/
+/*!
+ * @brief This function makes sure the queue has enough empty slots that
+ *          the next count enqueues will not allocate.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] count The number of empty slots wanted.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+queue_reserve (queue_t * p_queue, const size_t count)
+{
+    int status = -1;
+    if ((NULL == p_queue) ||
+        (count > (SIZE_MAX / sizeof(void *)) - p_queue->size))
+    {
+        goto EXIT;
+    }
+    
+    // Grow to the next power of two that fits.
+    size_t new_cap = (0 == p_queue->cap) ? QUEUE_INIT_CAP : p_queue->cap;
+    while (new_cap < (p_queue->size + count))
+    {
+        new_cap *= 2;
+    }
+    if ((new_cap > p_queue->cap) &&
+        (-1 == queue_resize(p_queue, new_cap)))
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function shrinks the buffer to the smallest power of two
+ *          that holds the queue plus a given number of empty slots.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] keep The number of empty slots to keep.
+ *
+ * @return No return value expected.
+ */
+void
+queue_trim (queue_t * p_queue, const size_t keep)
+{
+    if ((NULL == p_queue) ||
+        (keep >= (p_queue->cap - p_queue->size)))
+    {
+        goto EXIT;
+    }
+    
+    // Halve the buffer for as long as everything still fits.
+    size_t want = p_queue->size + keep;
+    size_t new_cap = p_queue->cap;
+    while ((new_cap > 0) &&
+           ((new_cap / 2) >= want))
+    {
+        new_cap /= 2;
+    }
+    if (new_cap < QUEUE_INIT_CAP)
+    {
+        new_cap = (0 == want) ? 0 : QUEUE_INIT_CAP;
+    }
+    
+    // A failed shrink leaves the queue as it was, which is harmless.
+    if (new_cap < p_queue->cap)
+    {
+        (void) queue_resize(p_queue, new_cap);
+    }
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function caps the number of empty slots the queue keeps.
+ *          A dequeue that leaves more than twice this many empty slots,
+ *          with the queue at most a quarter full, shrinks the buffer.
+ *
+ *          The shrunk buffer keeps room for at least as many references
+ *              again as the queue holds, so alternating enqueues and
+ *              dequeues never reallocate. The queue starts out with no
+ *              cap (QUEUE_SPARE_UNLIMITED). The buffer is trimmed to the
+ *              new cap at once.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] limit The most empty slots to keep.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+queue_set_spare_limit (queue_t * p_queue, const size_t limit)
+{
+    int status = -1;
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    p_queue->spare_limit = limit;
+    queue_trim(p_queue, limit);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -2,50 +2,63 @@
  * @file queue.h
  *
  * @brief This file contains a generic queue implementation using
- *          a singly linked list.
+ *          a circular buffer.
  *
  *          The queue will contain references to any type of data,
  *              but will not be responsible for allocation or
  *              deallocation of referenced data.
  *
+ *          References are stored contiguously in a power-of-two buffer
+ *              that doubles in size when full, so a queue that has
+ *              reached its working size performs no further allocation
+ *              and costs one pointer per element. The number of spare
+ *              slots kept once the queue drains may be capped.
+ *
  *          Function supported are as follows:
  *
  *              - queue_create
+ *              - queue_create_with_allocator
  *              - queue_destroy
  *              - queue_enq
  *              - queue_deq
+ *              - queue_reserve
+ *              - queue_trim
+ *              - queue_set_spare_limit
  */
 
 #ifndef QUEUE_H
 #define QUEUE_H
 
 #include <stdlib.h>
+#include <stdint.h>
 
-/*!
- * @brief This datatype defines a node for the linked list.
- *
- * @param p_data Pointer to the referenced data.
- * @param p_next Pointer to the next node in the queue.
- */
-typedef struct _queue_node queue_node_t;
-struct _queue_node
-{
-    void * p_data;
-    queue_node_t * p_next;
-};
+#include "src/c/allocator/allocator.h"
+
+/*** Spare limit under which the buffer is never shrunk. ***/
+#define QUEUE_SPARE_UNLIMITED SIZE_MAX
+
+/*** Number of slots allocated by the first enqueue. Power of two. ***/
+#define QUEUE_INIT_CAP 8
 
 /*!
  * @brief This datatype defines a queue context.
  *
- * @param p_head The first node in the queue.
- * @param p_tail The last node in the queue.
- * @param size The number of nodes in the queue.
+ * @param pp_slots The circular buffer of references.
+ * @param cap The number of slots. Zero or a power of two.
+ * @param head The slot holding the first reference in the queue.
+ * @param size The number of references in the queue.
+ * @param spare_limit The empty slots a dequeue keeps before shrinking.
+ * @param p_alloc The allocator for the context and its buffer. NULL for
+ *          the standard library.
  */
 typedef struct _queue
 {
-    queue_node_t * p_head;
-    queue_node_t * p_tail;
+    void ** pp_slots;
+    size_t cap;
+    size_t head;
     size_t size;
+    size_t spare_limit;
+    const allocator_t * p_alloc;
 } queue_t;
 
 /*!
@@ -56,6 +69,18 @@ typedef struct _queue
 queue_t *
 queue_create (void);
 
+/*!
+ * @brief This function instantiates a new empty queue that allocates
+ *          through a given allocator.
+ *
+ * @param[in] p_alloc The allocator for the context and its buffer. NULL
+ *              for the standard library.
+ *
+ * @return Pointer to new queue context. NULL on error.
+ */
+queue_t *
+queue_create_with_allocator (const allocator_t * p_alloc);
+
 /*!
  * @brief This function destroys a queue context.
  *
@@ -83,16 +108,59 @@ int
 queue_enq (queue_t * p_queue, void * p_data);
 
 /*!
- * @brief This function dequeues the first node in the queue.
+ * @brief This function dequeues the first reference in the queue.
  *
  * @param[in/out] p_queue The queue context.
  *
- * @return Pointer to the data held in the first node of the queue.
+ * @return Pointer to the data first in the queue.
  *          NULL on error or empty queue.
  */
 void *
 queue_deq (queue_t * p_queue);
 
+/*!
+ * @brief This function makes sure the queue has enough empty slots that
+ *          the next count enqueues will not allocate.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] count The number of empty slots wanted.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+queue_reserve (queue_t * p_queue, const size_t count);
+
+/*!
+ * @brief This function shrinks the buffer to the smallest power of two
+ *          that holds the queue plus a given number of empty slots.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] keep The number of empty slots to keep.
+ *
+ * @return No return value expected.
+ */
+void
+queue_trim (queue_t * p_queue, const size_t keep);
+
+/*!
+ * @brief This function caps the number of empty slots the queue keeps.
+ *          A dequeue that leaves more than twice this many empty slots,
+ *          with the queue at most a quarter full, shrinks the buffer.
+ *
+ *          The shrunk buffer keeps room for at least as many references
+ *              again as the queue holds, so alternating enqueues and
+ *              dequeues never reallocate. The queue starts out with no
+ *              cap (QUEUE_SPARE_UNLIMITED). The buffer is trimmed to the
+ *              new cap at once.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] limit The most empty slots to keep.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+queue_set_spare_limit (queue_t * p_queue, const size_t limit);
+
 #endif // QUEUE_H
 
-/***   end of file   ***/
+/***   end of file   ***/
\ No newline at end of file
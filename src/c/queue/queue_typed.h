@@ -0,0 +1,166 @@
+/*!
+ * @file queue_typed.h
+ *
+ * @brief This file contains a macro that generates a queue specialized
+ *          for a single element type.
+ *
+ *          queue_t erases the element type behind void pointers and
+ *              out-of-line calls. A queue generated here stores its
+ *              elements directly in a typed circular buffer, and every
+ *              function is static inline, so enqueueing and dequeueing
+ *              compile down to a masked load or store.
+ *
+ *          For example, QUEUE_DEFINE(int32_t, queue_i32) defines the type
+ *              queue_i32_t along with queue_i32_init, queue_i32_enq and
+ *              so on. The context is meant to be embedded by value and
+ *              set up with the init function rather than allocated.
+ *
+ *          Functions generated are as follows:
+ *
+ *              - <name>_init
+ *              - <name>_fini
+ *              - <name>_enq
+ *              - <name>_deq
+ *              - <name>_peek
+ */
+
+#ifndef QUEUE_TYPED_H
+#define QUEUE_TYPED_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*** Number of slots allocated by the first enqueue. Power of two. ***/
+#define QUEUE_TYPED_INIT_CAP 8
+
+/*!
+ * @brief This macro defines a queue type holding elements of type T by
+ *          value, along with its functions, all prefixed with name.
+ *
+ *          The generated functions behave as follows:
+ *
+ *              - name_init(p) sets up an empty queue.
+ *              - name_fini(p) frees the queue's buffer. The context may
+ *                  be initialized again afterwards.
+ *              - name_enq(p, value) enqueues a copy of value, doubling
+ *                  the buffer when full. Returns 0 on success, -1 on
+ *                  error.
+ *              - name_deq(p, p_out) dequeues the first element into
+ *                  p_out, which may be NULL. Returns 0 on success, -1 on
+ *                  error or empty queue.
+ *              - name_peek(p) returns a pointer to the first element.
+ *                  NULL on empty queue.
+ *
+ * @param T The element type.
+ * @param name The prefix for the generated type and functions.
+ */
+#define QUEUE_DEFINE(T, name)                                                \
+                                                                             \
+typedef struct _##name                                                       \
+{                                                                            \
+    T *    p_slots;                                                          \
+    size_t cap;                                                              \
+    size_t head;                                                             \
+    size_t size;                                                             \
+} name##_t;                                                                  \
+                                                                             \
+static inline void                                                           \
+name##_init (name##_t * p_queue)                                             \
+{                                                                            \
+    p_queue->p_slots = NULL;                                                 \
+    p_queue->cap = 0;                                                        \
+    p_queue->head = 0;                                                       \
+    p_queue->size = 0;                                                       \
+}                                                                            \
+                                                                             \
+static inline void                                                           \
+name##_fini (name##_t * p_queue)                                             \
+{                                                                            \
+    free(p_queue->p_slots);                                                  \
+    name##_init(p_queue);                                                    \
+}                                                                            \
+                                                                             \
+static inline int                                                            \
+name##_grow (name##_t * p_queue)                                             \
+{                                                                            \
+    int status = -1;                                                         \
+    size_t new_cap = (0 == p_queue->cap) ? QUEUE_TYPED_INIT_CAP              \
+                                         : (p_queue->cap * 2);               \
+    if (new_cap > (SIZE_MAX / sizeof(T)))                                    \
+    {                                                                        \
+        goto EXIT;                                                           \
+    }                                                                        \
+                                                                             \
+    T * p_new = realloc(p_queue->p_slots, new_cap * sizeof(T));              \
+    if (NULL == p_new)                                                       \
+    {                                                                        \
+        goto EXIT;                                                           \
+    }                                                                        \
+                                                                             \
+    /* Move the elements that had wrapped around to just past the old */     \
+    /* end, so they follow on from the rest. */                              \
+    size_t first = p_queue->cap - p_queue->head;                             \
+    for (size_t idx = 0; idx < (p_queue->size - first); ++idx)               \
+    {                                                                        \
+        p_new[p_queue->cap + idx] = p_new[idx];                              \
+    }                                                                        \
+    p_queue->p_slots = p_new;                                                \
+    p_queue->cap = new_cap;                                                  \
+                                                                             \
+    status = 0;                                                              \
+                                                                             \
+    EXIT:                                                                    \
+        return status;                                                       \
+}                                                                            \
+                                                                             \
+static inline int                                                            \
+name##_enq (name##_t * p_queue, T value)                                     \
+{                                                                            \
+    int status = -1;                                                         \
+    if ((p_queue->size == p_queue->cap) &&                                   \
+        (-1 == name##_grow(p_queue)))                                        \
+    {                                                                        \
+        goto EXIT;                                                           \
+    }                                                                        \
+                                                                             \
+    p_queue->p_slots[(p_queue->head + p_queue->size) &                       \
+                     (p_queue->cap - 1)] = value;                            \
+    p_queue->size++;                                                         \
+                                                                             \
+    status = 0;                                                              \
+                                                                             \
+    EXIT:                                                                    \
+        return status;                                                       \
+}                                                                            \
+                                                                             \
+static inline int                                                            \
+name##_deq (name##_t * p_queue, T * p_out)                                   \
+{                                                                            \
+    int status = -1;                                                         \
+    if (0 == p_queue->size)                                                  \
+    {                                                                        \
+        goto EXIT;                                                           \
+    }                                                                        \
+                                                                             \
+    if (NULL != p_out)                                                       \
+    {                                                                        \
+        *p_out = p_queue->p_slots[p_queue->head];                            \
+    }                                                                        \
+    p_queue->head = (p_queue->head + 1) & (p_queue->cap - 1);                \
+    p_queue->size--;                                                         \
+                                                                             \
+    status = 0;                                                              \
+                                                                             \
+    EXIT:                                                                    \
+        return status;                                                       \
+}                                                                            \
+                                                                             \
+static inline T *                                                            \
+name##_peek (name##_t * p_queue)                                             \
+{                                                                            \
+    return (0 != p_queue->size) ? (p_queue->p_slots + p_queue->head) : NULL; \
+}
+
+#endif // QUEUE_TYPED_H
+
+/***   end of file   ***/
\ No newline at end of file
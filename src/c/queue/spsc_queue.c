@@ -0,0 +1,356 @@
+/*!
+ * @file spsc_queue.c
+ *
+ * @brief This file contains a bounded wait-free queue connecting exactly
+ *          one producer thread to exactly one consumer thread.
+ *
+ *          The head and tail indices run freely and are only masked when
+ *              a slot is accessed, so tail - head is always the number of
+ *              references held and a full queue uses every slot.
+ *
+ *          Functions included are as follows:
+ *
+ *              - spsc_queue_create
+ *              - spsc_queue_destroy
+ *              - spsc_queue_push
+ *              - spsc_queue_pop
+ *              - spsc_queue_push_n
+ *              - spsc_queue_pop_n
+ *              - spsc_queue_size
+ */
+
+#include <stdint.h>
+
+#include "spsc_queue.h"
+
+/*!
+ * @brief This is a static function that returns how many slots the
+ *          producer may fill, reloading the head index only if its cached
+ *          copy shows fewer than wanted.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] tail The current tail index.
+ * @param[in] want The number of slots the producer would like.
+ *
+ * @return The number of free slots.
+ */
+static size_t
+spsc_queue_free (spsc_queue_t * p_queue, const size_t tail, const size_t want)
+{
+    size_t cap = p_queue->mask + 1;
+    size_t avail = cap - (tail - p_queue->head_cache);
+    if (avail < want)
+    {
+        p_queue->head_cache = atomic_load_explicit(&(p_queue->head),
+                                                   memory_order_acquire);
+        avail = cap - (tail - p_queue->head_cache);
+    }
+    return avail;
+}
+
+/*!
+ * @brief This is a static function that returns how many references the
+ *          consumer may take, reloading the tail index only if its cached
+ *          copy shows fewer than wanted.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] head The current head index.
+ * @param[in] want The number of references the consumer would like.
+ *
+ * @return The number of references held.
+ */
+static size_t
+spsc_queue_held (spsc_queue_t * p_queue, const size_t head, const size_t want)
+{
+    size_t avail = p_queue->tail_cache - head;
+    if (avail < want)
+    {
+        p_queue->tail_cache = atomic_load_explicit(&(p_queue->tail),
+                                                   memory_order_acquire);
+        avail = p_queue->tail_cache - head;
+    }
+    return avail;
+}
+
+/*!
+ * @brief This function instantiates a new empty queue.
+ *
+ * @param[in] cap The number of references the queue can hold. This is
+ *              rounded up to a power of two.
+ *
+ * @return Pointer to new queue context. NULL on error.
+ */
+spsc_queue_t *
+spsc_queue_create (const size_t cap)
+{
+    int status = -1;
+    spsc_queue_t * p_queue = NULL;
+    // Capacities past the largest power of two in a size_t cannot be
+    // rounded up.
+    if ((0 == cap) ||
+        (cap > ((SIZE_MAX / 2) + 1)))
+    {
+        goto EXIT;
+    }
+    
+    p_queue = calloc(1, sizeof(spsc_queue_t));
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    // Round the capacity up to a power of two.
+    size_t pow2 = 2;
+    while (pow2 < cap)
+    {
+        pow2 <<= 1;
+    }
+    
+    p_queue->mask = pow2 - 1;
+    p_queue->pp_slots = calloc(pow2, sizeof(void *));
+    if (NULL == p_queue->pp_slots)
+    {
+        goto EXIT;
+    }
+    atomic_init(&(p_queue->tail), 0);
+    atomic_init(&(p_queue->head), 0);
+    p_queue->head_cache = 0;
+    p_queue->tail_cache = 0;
+    
+    status = 0;
+    
+    EXIT:
+        if ((-1 == status) &&
+            (NULL != p_queue))
+        {
+            spsc_queue_destroy(p_queue);
+            p_queue = NULL;
+        }
+        return p_queue;
+}
+
+/*!
+ * @brief This function destroys a queue context.
+ *
+ *          This will not deallocate any data referenced by the queue.
+ *              Neither thread may access the queue during or after this
+ *              call.
+ *
+ * @param[in/out] p_queue The queue context.
+ *
+ * @return No return value expected.
+ */
+void
+spsc_queue_destroy (spsc_queue_t * p_queue)
+{
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    if (NULL != p_queue->pp_slots)
+    {
+        free(p_queue->pp_slots);
+        p_queue->pp_slots = NULL;
+    }
+    free(p_queue);
+    p_queue = NULL;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function pushes a reference onto the queue if there is
+ *          room for it.
+ *
+ *          This may only be called by the producer.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in/out] p_data The data to push.
+ *
+ * @return 0 on success, -1 on error or full queue.
+ */
+int
+spsc_queue_push (spsc_queue_t * p_queue, void * p_data)
+{
+    int status = -1;
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    size_t tail = atomic_load_explicit(&(p_queue->tail), memory_order_relaxed);
+    if (0 == spsc_queue_free(p_queue, tail, 1))
+    {
+        goto EXIT;
+    }
+    
+    // Fill the slot, then publish it.
+    p_queue->pp_slots[tail & p_queue->mask] = p_data;
+    atomic_store_explicit(&(p_queue->tail), tail + 1, memory_order_release);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function pops the oldest reference from the queue if there
+ *          is one.
+ *
+ *          This may only be called by the consumer.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[out] pp_data Receives the popped data.
+ *
+ * @return 0 on success, -1 on error or empty queue.
+ */
+int
+spsc_queue_pop (spsc_queue_t * p_queue, void ** pp_data)
+{
+    int status = -1;
+    if ((NULL == p_queue) ||
+        (NULL == pp_data))
+    {
+        goto EXIT;
+    }
+    
+    size_t head = atomic_load_explicit(&(p_queue->head), memory_order_relaxed);
+    if (0 == spsc_queue_held(p_queue, head, 1))
+    {
+        goto EXIT;
+    }
+    
+    // Read the slot, then hand it back to the producer.
+    *pp_data = p_queue->pp_slots[head & p_queue->mask];
+    atomic_store_explicit(&(p_queue->head), head + 1, memory_order_release);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function pushes as many references from an array onto the
+ *          queue as there is room for, publishing them all at once.
+ *
+ *          This may only be called by the producer.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] pp_data The data to push, in order.
+ * @param[in] count The number of references in pp_data.
+ *
+ * @return The number of references pushed, from the front of pp_data.
+ */
+size_t
+spsc_queue_push_n (spsc_queue_t * p_queue,
+                   void ** pp_data,
+                   const size_t count)
+{
+    size_t num_pushed = 0;
+    if ((NULL == p_queue) ||
+        (NULL == pp_data))
+    {
+        goto EXIT;
+    }
+    
+    size_t tail = atomic_load_explicit(&(p_queue->tail), memory_order_relaxed);
+    num_pushed = spsc_queue_free(p_queue, tail, count);
+    if (num_pushed > count)
+    {
+        num_pushed = count;
+    }
+    
+    // Fill every slot, then publish them with a single store.
+    for (size_t idx = 0; idx < num_pushed; ++idx)
+    {
+        p_queue->pp_slots[(tail + idx) & p_queue->mask] = pp_data[idx];
+    }
+    if (0 != num_pushed)
+    {
+        atomic_store_explicit(&(p_queue->tail), tail + num_pushed,
+                              memory_order_release);
+    }
+    
+    EXIT:
+        return num_pushed;
+}
+
+/*!
+ * @brief This function pops up to a given number of references from the
+ *          queue into an array, releasing their slots all at once.
+ *
+ *          This may only be called by the consumer.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[out] pp_data Receives the popped data, oldest first.
+ * @param[in] count The most references to pop.
+ *
+ * @return The number of references popped.
+ */
+size_t
+spsc_queue_pop_n (spsc_queue_t * p_queue,
+                  void ** pp_data,
+                  const size_t count)
+{
+    size_t num_popped = 0;
+    if ((NULL == p_queue) ||
+        (NULL == pp_data))
+    {
+        goto EXIT;
+    }
+    
+    size_t head = atomic_load_explicit(&(p_queue->head), memory_order_relaxed);
+    num_popped = spsc_queue_held(p_queue, head, count);
+    if (num_popped > count)
+    {
+        num_popped = count;
+    }
+    
+    // Read every slot, then release them with a single store.
+    for (size_t idx = 0; idx < num_popped; ++idx)
+    {
+        pp_data[idx] = p_queue->pp_slots[(head + idx) & p_queue->mask];
+    }
+    if (0 != num_popped)
+    {
+        atomic_store_explicit(&(p_queue->head), head + num_popped,
+                              memory_order_release);
+    }
+    
+    EXIT:
+        return num_popped;
+}
+
+/*!
+ * @brief This function returns an estimate of the number of references
+ *          in the queue. The result may be stale by the time it is used.
+ *
+ * @param[in] p_queue The queue context.
+ *
+ * @return The estimated number of references.
+ */
+size_t
+spsc_queue_size (spsc_queue_t * p_queue)
+{
+    size_t size = 0;
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    size_t head = atomic_load_explicit(&(p_queue->head), memory_order_acquire);
+    size_t tail = atomic_load_explicit(&(p_queue->tail), memory_order_acquire);
+    if ((tail - head) <= (p_queue->mask + 1))
+    {
+        size = tail - head;
+    }
+    
+    EXIT:
+        return size;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,169 @@
+/*!
+ * @file spsc_queue.h
+ *
+ * @brief This file contains a bounded wait-free queue connecting exactly
+ *          one producer thread to exactly one consumer thread.
+ *
+ *          The queue holds references in a power-of-two circular
+ *              buffer. Only the producer writes the tail index and only
+ *              the consumer writes the head index, so neither side ever
+ *              retries: an operation completes in a bounded number of
+ *              steps using plain acquire loads and release stores.
+ *
+ *          Each side also keeps a private copy of the other side's
+ *              index, and only reloads the shared one when its copy says
+ *              the queue is full (or empty). In a busy pipeline this keeps
+ *              the two threads from trading the index cache lines on
+ *              every operation.
+ *
+ *          Like queue_t, the queue will not allocate or deallocate the
+ *              referenced data.
+ *
+ *          Functions included are as follows:
+ *
+ *              - spsc_queue_create
+ *              - spsc_queue_destroy
+ *              - spsc_queue_push
+ *              - spsc_queue_pop
+ *              - spsc_queue_push_n
+ *              - spsc_queue_pop_n
+ *              - spsc_queue_size
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "src/c/cache_line/cache_line.h"
+
+/*!
+ * @brief This datatype defines a single-producer, single-consumer queue
+ *          context.
+ *
+ * @param mask The number of slots minus one. The slot count is always a
+ *          power of two.
+ * @param pp_slots The slots.
+ * @param tail The index the next reference is pushed at. Written by the
+ *          producer only.
+ * @param head_cache The producer's last view of the head index.
+ * @param head The index the next reference is popped from. Written by the
+ *          consumer only.
+ * @param tail_cache The consumer's last view of the tail index.
+ */
+typedef struct _spsc_queue
+{
+    size_t         mask;
+    void **        pp_slots;
+    char           pad_slots[CACHE_LINE_SIZE - sizeof(size_t)
+                             - sizeof(void **)];
+    _Atomic size_t tail;
+    size_t         head_cache;
+    char           pad_tail[CACHE_LINE_SIZE - (2 * sizeof(size_t))];
+    _Atomic size_t head;
+    size_t         tail_cache;
+    char           pad_head[CACHE_LINE_SIZE - (2 * sizeof(size_t))];
+} spsc_queue_t;
+
+/*!
+ * @brief This function instantiates a new empty queue.
+ *
+ * @param[in] cap The number of references the queue can hold. This is
+ *              rounded up to a power of two.
+ *
+ * @return Pointer to new queue context. NULL on error.
+ */
+spsc_queue_t *
+spsc_queue_create (const size_t cap);
+
+/*!
+ * @brief This function destroys a queue context.
+ *
+ *          This will not deallocate any data referenced by the queue.
+ *              Neither thread may access the queue during or after this
+ *              call.
+ *
+ * @param[in/out] p_queue The queue context.
+ *
+ * @return No return value expected.
+ */
+void
+spsc_queue_destroy (spsc_queue_t * p_queue);
+
+/*!
+ * @brief This function pushes a reference onto the queue if there is
+ *          room for it.
+ *
+ *          This may only be called by the producer.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in/out] p_data The data to push.
+ *
+ * @return 0 on success, -1 on error or full queue.
+ */
+int
+spsc_queue_push (spsc_queue_t * p_queue, void * p_data);
+
+/*!
+ * @brief This function pops the oldest reference from the queue if there
+ *          is one.
+ *
+ *          This may only be called by the consumer.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[out] pp_data Receives the popped data.
+ *
+ * @return 0 on success, -1 on error or empty queue.
+ */
+int
+spsc_queue_pop (spsc_queue_t * p_queue, void ** pp_data);
+
+/*!
+ * @brief This function pushes as many references from an array onto the
+ *          queue as there is room for, publishing them all at once.
+ *
+ *          This may only be called by the producer.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[in] pp_data The data to push, in order.
+ * @param[in] count The number of references in pp_data.
+ *
+ * @return The number of references pushed, from the front of pp_data.
+ */
+size_t
+spsc_queue_push_n (spsc_queue_t * p_queue,
+                   void ** pp_data,
+                   const size_t count);
+
+/*!
+ * @brief This function pops up to a given number of references from the
+ *          queue into an array, releasing their slots all at once.
+ *
+ *          This may only be called by the consumer.
+ *
+ * @param[in/out] p_queue The queue context.
+ * @param[out] pp_data Receives the popped data, oldest first.
+ * @param[in] count The most references to pop.
+ *
+ * @return The number of references popped.
+ */
+size_t
+spsc_queue_pop_n (spsc_queue_t * p_queue,
+                  void ** pp_data,
+                  const size_t count);
+
+/*!
+ * @brief This function returns an estimate of the number of references
+ *          in the queue. The result may be stale by the time it is used.
+ *
+ * @param[in] p_queue The queue context.
+ *
+ * @return The estimated number of references.
+ */
+size_t
+spsc_queue_size (spsc_queue_t * p_queue);
+
+#endif // SPSC_QUEUE_H
+
+/***   end of file   ***/
\ No newline at end of file
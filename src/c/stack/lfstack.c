@@ -0,0 +1,385 @@
+/*!
+ * @file lfstack.c
+ *
+ * @brief This file contains a lock-free stack that any number of threads
+ *          may push to and pop from at once.
+ *
+ *          Functions supported are as follows:
+ *
+ *              - lfstack_create
+ *              - lfstack_destroy
+ *              - lfstack_reserve
+ *              - lfstack_push
+ *              - lfstack_pop
+ *              - lfstack_pop_all
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "lfstack.h"
+
+// A list head is swapped as one word where the target has a compare-and-
+// swap twice the width of a pointer. On x86-64 that takes cmpxchg16b,
+// enabled by -mcx16. Elsewhere the swap goes through libatomic, which may
+// fall back to a lock.
+#if (8 == __SIZEOF_POINTER__) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+typedef unsigned __int128 lfstack_word_t;
+#define LFSTACK_LOCK_FREE 1
+#elif (4 == __SIZEOF_POINTER__) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)
+typedef uint64_t lfstack_word_t;
+#define LFSTACK_LOCK_FREE 1
+#else
+#define LFSTACK_LOCK_FREE 0
+#endif
+
+/*!
+ * @brief This is a static function that reads a list head.
+ *
+ *          The tag is read before the node. A read torn by a concurrent
+ *              swap then always fails the swap that follows, since the
+ *              tag it carries is no longer current, and a read that
+ *              passes saw a node that was on top the whole time.
+ *
+ * @param[in] p_head The list head.
+ *
+ * @return A copy of the head.
+ */
+static inline lfstack_head_t
+lfstack_head_load (lfstack_head_t * p_head)
+{
+    lfstack_head_t head;
+#if LFSTACK_LOCK_FREE
+    // The halves are read with two pointer-sized atomic loads, while
+    // lfstack_head_cas writes both with one double-width compare-and-
+    // swap. Mixing access sizes on one object is outside the C11 model,
+    // but on the targets taking this path (cmpxchg16b on x86-64, casp or
+    // ldxp/stxp on AArch64) an aligned pointer-sized load is single-copy
+    // atomic against the wider write, so each half is a value that half
+    // really held. The tag is read first, and tags only grow: a node
+    // newer than the tag is paired with a tag that is no longer current,
+    // so the compare-and-swap that follows fails and the caller reads
+    // again. A true double-width load would cost a locked instruction,
+    // or a call into libatomic, on every read.
+    head.tag = __atomic_load_n(&(p_head->tag), __ATOMIC_ACQUIRE);
+    head.p_node = __atomic_load_n(&(p_head->p_node), __ATOMIC_ACQUIRE);
+#else
+    __atomic_load(p_head, &head, __ATOMIC_ACQUIRE);
+#endif
+    return head;
+}
+
+/*!
+ * @brief This is a static function that swaps a list head if it still
+ *          holds an expected node and tag.
+ *
+ * @param[in/out] p_head The list head.
+ * @param[in] expected The head the caller read.
+ * @param[in] desired The head to install.
+ *
+ * @return true if the head was swapped, false otherwise.
+ */
+static inline bool
+lfstack_head_cas (lfstack_head_t * p_head,
+                  lfstack_head_t expected,
+                  lfstack_head_t desired)
+{
+#if LFSTACK_LOCK_FREE
+    lfstack_word_t old_word;
+    lfstack_word_t new_word;
+    memcpy(&old_word, &expected, sizeof(old_word));
+    memcpy(&new_word, &desired, sizeof(new_word));
+    return __sync_bool_compare_and_swap((lfstack_word_t *) p_head,
+                                        old_word, new_word);
+#else
+    return __atomic_compare_exchange(p_head, &expected, &desired, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/*!
+ * @brief This is a static function that pushes a chain of nodes onto a
+ *          list.
+ *
+ * @param[in/out] p_head The list head.
+ * @param[in/out] p_first The first node of the chain.
+ * @param[in/out] p_last The last node of the chain.
+ *
+ * @return No return value expected.
+ */
+static void
+lfstack_head_push (lfstack_head_t * p_head,
+                   lfstack_node_t * p_first,
+                   lfstack_node_t * p_last)
+{
+    lfstack_head_t old_head;
+    lfstack_head_t new_head;
+    do
+    {
+        old_head = lfstack_head_load(p_head);
+        atomic_store_explicit(&(p_last->p_next), old_head.p_node,
+                              memory_order_relaxed);
+        new_head.p_node = p_first;
+        new_head.tag = old_head.tag + 1;
+    } while (!lfstack_head_cas(p_head, old_head, new_head));
+}
+
+/*!
+ * @brief This is a static function that pops the first node off a list.
+ *
+ *          The node read may be popped, recycled and pushed again by other
+ *              threads before the swap. Nodes are never freed while the
+ *              stack is in use, so reading it stays safe, and the tag
+ *              makes the swap fail.
+ *
+ * @param[in/out] p_head The list head.
+ *
+ * @return Pointer to the node. NULL if the list is empty.
+ */
+static lfstack_node_t *
+lfstack_head_pop (lfstack_head_t * p_head)
+{
+    lfstack_head_t old_head;
+    lfstack_head_t new_head;
+    do
+    {
+        old_head = lfstack_head_load(p_head);
+        if (NULL == old_head.p_node)
+        {
+            break;
+        }
+        new_head.p_node = atomic_load_explicit(&(old_head.p_node->p_next),
+                                               memory_order_relaxed);
+        new_head.tag = old_head.tag + 1;
+    } while (!lfstack_head_cas(p_head, old_head, new_head));
+    return old_head.p_node;
+}
+
+/*!
+ * @brief This is a static function that frees every node of a chain.
+ *
+ * @param[in/out] p_node The first node of the chain.
+ *
+ * @return No return value expected.
+ */
+static void
+lfstack_chain_free (lfstack_node_t * p_node)
+{
+    while (NULL != p_node)
+    {
+        lfstack_node_t * p_next = atomic_load_explicit(&(p_node->p_next),
+                                                       memory_order_relaxed);
+        free(p_node);
+        p_node = p_next;
+    }
+}
+
+/*!
+ * @brief This function instantiates a new empty lock-free stack.
+ *
+ * @return Pointer to new lock-free stack context. NULL on error.
+ */
+lfstack_t *
+lfstack_create (void)
+{
+    lfstack_t * p_stack = aligned_alloc(CACHE_LINE_SIZE,
+                                        sizeof(lfstack_t));
+    if (NULL == p_stack)
+    {
+        goto EXIT;
+    }
+    memset(p_stack, 0, sizeof(lfstack_t));
+    p_stack->head.p_node = NULL;
+    p_stack->head.tag = 0;
+    p_stack->free.p_node = NULL;
+    p_stack->free.tag = 0;
+    
+    EXIT:
+        return p_stack;
+}
+
+/*!
+ * @brief This function destroys a lock-free stack context along with its
+ *          nodes.
+ *
+ * @param[in/out] p_stack The lock-free stack context.
+ *
+ * @return No return value expected.
+ */
+void
+lfstack_destroy (lfstack_t * p_stack)
+{
+    if (NULL == p_stack)
+    {
+        goto EXIT;
+    }
+    
+    lfstack_chain_free(p_stack->head.p_node);
+    lfstack_chain_free(p_stack->free.p_node);
+    free(p_stack);
+    p_stack = NULL;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function allocates nodes onto the free list.
+ *
+ * @param[in/out] p_stack The lock-free stack context.
+ * @param[in] count The number of nodes to add.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+lfstack_reserve (lfstack_t * p_stack, const size_t count)
+{
+    int status = -1;
+    if (NULL == p_stack)
+    {
+        goto EXIT;
+    }
+    
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        lfstack_node_t * p_node = calloc(1, sizeof(lfstack_node_t));
+        if (NULL == p_node)
+        {
+            goto EXIT;
+        }
+        lfstack_head_push(&(p_stack->free), p_node, p_node);
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function pushes data onto the stack.
+ *
+ * @param[in/out] p_stack The lock-free stack context.
+ * @param[in/out] p_data The data to push.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+lfstack_push (lfstack_t * p_stack, void * p_data)
+{
+    int status = -1;
+    if ((NULL == p_stack) ||
+        (NULL == p_data))
+    {
+        goto EXIT;
+    }
+    
+    // Take a spare node, or create a new one.
+    lfstack_node_t * p_node = lfstack_head_pop(&(p_stack->free));
+    if (NULL == p_node)
+    {
+        p_node = calloc(1, sizeof(lfstack_node_t));
+        if (NULL == p_node)
+        {
+            goto EXIT;
+        }
+    }
+    p_node->p_data = p_data;
+    lfstack_head_push(&(p_stack->head), p_node, p_node);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function pops the most recently pushed data off the stack.
+ *
+ * @param[in/out] p_stack The lock-free stack context.
+ *
+ * @return Pointer to the popped data. NULL on error or empty stack.
+ */
+void *
+lfstack_pop (lfstack_t * p_stack)
+{
+    void * p_result = NULL;
+    if (NULL == p_stack)
+    {
+        goto EXIT;
+    }
+    
+    lfstack_node_t * p_node = lfstack_head_pop(&(p_stack->head));
+    if (NULL == p_node)
+    {
+        goto EXIT;
+    }
+    p_result = p_node->p_data;
+    p_node->p_data = NULL;
+    lfstack_head_push(&(p_stack->free), p_node, p_node);
+    
+    EXIT:
+        return p_result;
+}
+
+/*!
+ * @brief This function empties the stack with a single swap and passes
+ *          every removed reference to a function, most recent first.
+ *
+ *          The removed nodes are returned to the free list with a single
+ *              swap as well.
+ *
+ * @param[in/out] p_stack The lock-free stack context.
+ * @param[in] visit_func The function receiving each reference. May be
+ *              NULL to discard them.
+ * @param[in/out] p_arg The argument passed to visit_func.
+ *
+ * @return The number of references removed. 0 on error or empty stack.
+ */
+size_t
+lfstack_pop_all (lfstack_t * p_stack,
+                 lfstack_visit_f visit_func,
+                 void * p_arg)
+{
+    size_t count = 0;
+    if (NULL == p_stack)
+    {
+        goto EXIT;
+    }
+    
+    // Detach the whole list.
+    lfstack_head_t old_head;
+    lfstack_head_t new_head;
+    do
+    {
+        old_head = lfstack_head_load(&(p_stack->head));
+        if (NULL == old_head.p_node)
+        {
+            goto EXIT;
+        }
+        new_head.p_node = NULL;
+        new_head.tag = old_head.tag + 1;
+    } while (!lfstack_head_cas(&(p_stack->head), old_head, new_head));
+    
+    // The chain now belongs to this thread alone.
+    lfstack_node_t * p_node = old_head.p_node;
+    lfstack_node_t * p_last = NULL;
+    while (NULL != p_node)
+    {
+        if (NULL != visit_func)
+        {
+            visit_func(p_node->p_data, p_arg);
+        }
+        p_node->p_data = NULL;
+        p_last = p_node;
+        p_node = atomic_load_explicit(&(p_node->p_next),
+                                      memory_order_relaxed);
+        count++;
+    }
+    lfstack_head_push(&(p_stack->free), old_head.p_node, p_last);
+    
+    EXIT:
+        return count;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,180 @@
+/*!
+ * @file lfstack.h
+ *
+ * @brief This file contains a lock-free stack that any number of threads
+ *          may push to and pop from at once.
+ *
+ *          The stack is a Treiber stack: a singly linked list whose head
+ *              is swapped with a compare-and-swap. The head pairs the top
+ *              node with a tag that every successful swap increments, and
+ *              both are swapped with one double-width compare-and-swap.
+ *              A thread that read the head before another thread popped
+ *              the top node and pushed it back therefore sees a changed
+ *              tag and retries, instead of corrupting the list (the ABA
+ *              problem).
+ *
+ *          Nodes popped from the stack go onto an internal free list, kept
+ *              the same way, and are reused by later pushes. They are only
+ *              freed by lfstack_destroy, so a thread that still holds a
+ *              stale pointer to a node can always read it safely.
+ *
+ *          The stack will contain references to any type of data,
+ *              but will not be responsible for allocation or
+ *              deallocation of referenced data.
+ *
+ *          Functions supported are as follows:
+ *
+ *              - lfstack_create
+ *              - lfstack_destroy
+ *              - lfstack_reserve
+ *              - lfstack_push
+ *              - lfstack_pop
+ *              - lfstack_pop_all
+ */
+
+#ifndef LFSTACK_H
+#define LFSTACK_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "src/c/cache_line/cache_line.h"
+
+/*!
+ * @brief This datatype defines a function template for visiting the
+ *          references removed by lfstack_pop_all.
+ *
+ * @param p_data The reference.
+ * @param p_arg The argument passed to lfstack_pop_all.
+ *
+ * @return No return value expected.
+ */
+typedef void (*lfstack_visit_f)(void * p_data, void * p_arg);
+
+/*!
+ * @brief This datatype defines a node for the linked list.
+ *
+ * @param p_next Pointer to the next node in the list.
+ * @param p_data Pointer to the referenced data.
+ */
+typedef struct _lfstack_node
+{
+    _Atomic(struct _lfstack_node *) p_next;
+    void *                          p_data;
+} lfstack_node_t;
+
+/*!
+ * @brief This datatype defines the head of a list, swapped as a whole.
+ *
+ * @param p_node The first node in the list.
+ * @param tag The number of times the head has been swapped.
+ */
+typedef struct _lfstack_head
+{
+    _Alignas(2 * sizeof(void *)) lfstack_node_t * p_node;
+    uintptr_t                                     tag;
+} lfstack_head_t;
+
+/*!
+ * @brief This datatype defines a lock-free stack context.
+ *
+ *          Each head sits on a cache line of its own, so pushes and pops
+ *              on the stack do not contend with recycling on the free
+ *              list.
+ *
+ * @param head The head of the stack.
+ * @param free The head of the free list of nodes.
+ */
+typedef struct _lfstack
+{
+    lfstack_head_t head;
+    char           pad_head[CACHE_LINE_SIZE - sizeof(lfstack_head_t)];
+    lfstack_head_t free;
+    char           pad_free[CACHE_LINE_SIZE - sizeof(lfstack_head_t)];
+} lfstack_t;
+
+/*!
+ * @brief This function instantiates a new empty lock-free stack.
+ *
+ * @return Pointer to new lock-free stack context. NULL on error.
+ */
+lfstack_t *
+lfstack_create (void);
+
+/*!
+ * @brief This function destroys a lock-free stack context along with its
+ *          nodes.
+ *
+ *          No other thread may access the stack during or after this
+ *              call. This will not deallocate any data referenced by the
+ *              stack.
+ *
+ * @param[in/out] p_stack The lock-free stack context.
+ *
+ * @return No return value expected.
+ */
+void
+lfstack_destroy (lfstack_t * p_stack);
+
+/*!
+ * @brief This function allocates nodes onto the free list, so that the
+ *          next count pushes will not allocate.
+ *
+ *          A push that finds the free list empty calls malloc, which may
+ *              take a lock. Reserving ahead keeps pushes lock-free.
+ *
+ * @param[in/out] p_stack The lock-free stack context.
+ * @param[in] count The number of nodes to add.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+lfstack_reserve (lfstack_t * p_stack, const size_t count);
+
+/*!
+ * @brief This function pushes data onto the stack. It is safe to call from
+ *          any number of threads at once.
+ *
+ * @param[in/out] p_stack The lock-free stack context.
+ * @param[in/out] p_data The data to push.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+lfstack_push (lfstack_t * p_stack, void * p_data);
+
+/*!
+ * @brief This function pops the most recently pushed data off the stack.
+ *          It is safe to call from any number of threads at once.
+ *
+ * @param[in/out] p_stack The lock-free stack context.
+ *
+ * @return Pointer to the popped data. NULL on error or empty stack.
+ */
+void *
+lfstack_pop (lfstack_t * p_stack);
+
+/*!
+ * @brief This function empties the stack with a single swap and passes
+ *          every removed reference to a function, most recent first.
+ *
+ *          The references are removed at one instant, so pushes racing
+ *              with the call land either wholly before it or on the
+ *              emptied stack.
+ *
+ * @param[in/out] p_stack The lock-free stack context.
+ * @param[in] visit_func The function receiving each reference. May be
+ *              NULL to discard them.
+ * @param[in/out] p_arg The argument passed to visit_func.
+ *
+ * @return The number of references removed. 0 on error or empty stack.
+ */
+size_t
+lfstack_pop_all (lfstack_t * p_stack,
+                 lfstack_visit_f visit_func,
+                 void * p_arg);
+
+#endif // LFSTACK_H
+
+/***   end of file   ***/
\ No newline at end of file
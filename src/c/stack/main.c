@@ -3,7 +3,7 @@
  *
  * @desc This project is a generic Stack implementation
  *
- *          The Stack should be a singly-linked list that can
+ *          The Stack should be a contiguous array that can
  *              hold a reference to any type of data.
  *
  *          Functions supported are as follows:
@@ -26,18 +26,16 @@ display (stack_t * p_q)
         goto EXIT;
     }
     
-    stack_node_t * p_curr = p_q->p_head;
     printf("[");
-    while (NULL != p_curr)
+    for (size_t idx = p_q->size; idx > 0; --idx)
     {
-        int * p_i = p_curr->p_data;
+        int * p_i = p_q->pp_data[idx - 1];
         if (NULL == p_i)
         {
             goto EXIT;
         }
         printf("%d", *p_i);
-        p_curr = p_curr->p_next;
-        if (NULL != p_curr)
+        if (1 != idx)
         {
             printf(", ");
         }
@@ -2,22 +2,150 @@
  * @file stack.c
  *
  * @brief This file contains a generic stack implementation using
- *          a singly linked list.
+ *          a contiguous array.
  *
  *          The stack will contain references to any type of data,
  *              but will not be responsible for allocation or
  *              deallocation of referenced data.
  *
+ *          The references are stored bottom first in one array, so a push
+ *              or a pop is a single store or load and an index update.
+ *              The array at least doubles whenever it has to grow, so
+ *              pushes are amortized O(1). Pops never shrink the array
+ *              unless a spare limit is set, so by default a stack that
+ *              has reached its working size performs no further
+ *              allocation.
+ *
  *          Functions supported are as follows:
  *
  *              - stack_create
+ *              - stack_create_with_allocator
  *              - stack_destroy
  *              - stack_push
  *              - stack_pop
+ *              - stack_push_n
+ *              - stack_pop_n
+ *              - stack_peek
+ *              - stack_reserve
+ *              - stack_trim
+ *              - stack_set_spare_limit
  */
 
+#include <string.h>
+
 #include "stack.h"
 
+/*!
+ * @brief This is a static function that reallocates the array to hold
+ *          exactly a given number of elements.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[in] new_cap The new capacity. Must not be below the size.
+ *
+ * @return 0 on success, -1 on error. The array is unchanged on error.
+ */
+static int
+stack_resize (stack_t * p_stack, const size_t new_cap)
+{
+    int status = -1;
+    if (new_cap > (SIZE_MAX / sizeof(void *)))
+    {
+        goto EXIT;
+    }
+    
+    if (0 == new_cap)
+    {
+        allocator_free(p_stack->p_alloc, p_stack->pp_data,
+                       p_stack->cap * sizeof(void *));
+        p_stack->pp_data = NULL;
+        p_stack->cap = 0;
+        status = 0;
+        goto EXIT;
+    }
+    
+    void ** pp_new = allocator_realloc(p_stack->p_alloc, p_stack->pp_data,
+                                       p_stack->cap * sizeof(void *),
+                                       new_cap * sizeof(void *));
+    if (NULL == pp_new)
+    {
+        goto EXIT;
+    }
+    p_stack->pp_data = pp_new;
+    p_stack->cap = new_cap;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This is a static function that grows the array, at least
+ *          doubling it, until it holds a given number of elements.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[in] min_cap The number of elements the array must hold.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+stack_grow (stack_t * p_stack, const size_t min_cap)
+{
+    int status = -1;
+    if (min_cap <= p_stack->cap)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    size_t new_cap = p_stack->cap * 2;
+    if (new_cap < STACK_INIT_CAP)
+    {
+        new_cap = STACK_INIT_CAP;
+    }
+    if (new_cap < min_cap)
+    {
+        new_cap = min_cap;
+    }
+    
+    // Fall back to the exact size if doubling overflows.
+    status = stack_resize(p_stack, new_cap);
+    if ((-1 == status) &&
+        (new_cap != min_cap))
+    {
+        status = stack_resize(p_stack, min_cap);
+    }
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This is a static function that shrinks the array once pops have
+ *          left it well past the spare limit.
+ *
+ *          The array is shrunk only when more than twice the limit is
+ *              unused and the stack fills at most a quarter of it, and
+ *              then keeps room for the stack to double. A stack moving
+ *              back and forth across a boundary therefore does not
+ *              reallocate on every push and pop.
+ *
+ * @param[in/out] p_stack The stack context.
+ *
+ * @return No return value expected.
+ */
+static void
+stack_release (stack_t * p_stack)
+{
+    size_t spare = p_stack->cap - p_stack->size;
+    if (((spare / 2) > p_stack->spare_limit) &&
+        (p_stack->size <= (p_stack->cap / 4)))
+    {
+        stack_trim(p_stack, (p_stack->spare_limit > p_stack->size) ?
+                            p_stack->spare_limit : p_stack->size);
+    }
+}
+
 /*!
  * @brief This function instantiates a new empty stack.
  *
@@ -26,14 +154,33 @@
 stack_t *
 stack_create (void)
 {
-    stack_t * p_stack = calloc(1, sizeof(stack_t));
+    return stack_create_with_allocator(NULL);
+}
+
+/*!
+ * @brief This function instantiates a new empty stack that allocates
+ *          through a given allocator.
+ *
+ *          No array is allocated until the first element is pushed.
+ *
+ * @param[in] p_alloc The allocator for the context and its array. NULL
+ *              for the standard library.
+ *
+ * @return Pointer to new stack context. NULL on error.
+ */
+stack_t *
+stack_create_with_allocator (const allocator_t * p_alloc)
+{
+    stack_t * p_stack = allocator_calloc(p_alloc, 1, sizeof(stack_t));
     if (NULL == p_stack)
     {
         goto EXIT;
     }
-    p_stack->p_head = NULL;
-    p_stack->p_tail = NULL;
+    p_stack->pp_data = NULL;
     p_stack->size = 0;
+    p_stack->cap = 0;
+    p_stack->spare_limit = STACK_SPARE_UNLIMITED;
+    p_stack->p_alloc = p_alloc;
     
     EXIT:
         return p_stack;
@@ -54,29 +201,18 @@ stack_create (void)
 void
 stack_destroy (stack_t * p_stack)
 {
-    if ((NULL == p_stack) ||
-        (NULL == p_stack->p_head))
+    if (NULL == p_stack)
     {
         goto EXIT;
     }
     
-    // Free each node in the stack.
-    stack_node_t * p_curr = p_stack->p_head;
-    stack_node_t * p_next = NULL;
-    
-    while (NULL != p_curr)
-    {
-        p_next = p_curr->p_next;
-        free(p_curr);
-        p_curr = p_next;
-    }
+    // Free the reference array, then the context.
+    allocator_free(p_stack->p_alloc, p_stack->pp_data,
+                   p_stack->cap * sizeof(void *));
+    allocator_free(p_stack->p_alloc, p_stack, sizeof(stack_t));
+    p_stack = NULL;
     
     EXIT:
-        if (NULL != p_stack)
-        {
-            free(p_stack);
-            p_stack = NULL;
-        }
         return;
 }
 
@@ -98,27 +234,87 @@ stack_push (stack_t * p_stack, void * p_data)
         goto EXIT;
     }
     
-    // Create a new node.
-    stack_node_t * p_new = calloc(1, sizeof(stack_node_t));
-    if (NULL == p_new)
+    if ((p_stack->size == p_stack->cap) &&
+        (-1 == stack_grow(p_stack, p_stack->size + 1)))
     {
         goto EXIT;
     }
-    p_new->p_data = p_data;
-    p_new->p_next = NULL;
+    p_stack->pp_data[p_stack->size] = p_data;
+    p_stack->size++;
+    
+    status = 0;
     
-    // Push new node.
-    if (NULL == p_stack->p_head)
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function pops the last element in the stack
+ *          (The most recently pushed element).
+ *
+ * @param[in/out] p_stack The stack context.
+ *
+ * @return Pointer to the data at the top of the stack.
+ *          NULL on error or empty stack.
+ */
+void *
+stack_pop (stack_t * p_stack)
+{
+    void * p_result = NULL;
+    if ((NULL == p_stack) ||
+        (0 == p_stack->size))
     {
-        p_stack->p_head = p_new;
-        p_stack->p_tail = p_new;
+        goto EXIT;
     }
-    else
+    
+    p_stack->size--;
+    p_result = p_stack->pp_data[p_stack->size];
+    stack_release(p_stack);
+    
+    EXIT:
+        return p_result;
+}
+
+/*!
+ * @brief This function pushes several references onto the stack at once,
+ *          growing the array at most once.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[in] pp_data The references to push. None may be NULL.
+ * @param[in] count The number of references.
+ *
+ * @return 0 on success, -1 on error. Nothing is pushed on error.
+ */
+int
+stack_push_n (stack_t * p_stack, void ** pp_data, const size_t count)
+{
+    int status = -1;
+    if ((NULL == p_stack) ||
+        ((NULL == pp_data) && (0 != count)) ||
+        (count > (SIZE_MAX - p_stack->size)))
     {
-        p_new->p_next = p_stack->p_head;
-        p_stack->p_head = p_new;
+        goto EXIT;
     }
-    p_stack->size++;
+    
+    // A NULL reference could not be told apart from an empty stack when
+    // popped, so reject the whole run before changing anything.
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        if (NULL == pp_data[idx])
+        {
+            goto EXIT;
+        }
+    }
+    if (-1 == stack_grow(p_stack, p_stack->size + count))
+    {
+        goto EXIT;
+    }
+    if (0 != count)
+    {
+        memcpy(p_stack->pp_data + p_stack->size, pp_data,
+               count * sizeof(void *));
+    }
+    p_stack->size += count;
     
     status = 0;
     
@@ -127,37 +323,142 @@ stack_push (stack_t * p_stack, void * p_data)
 }
 
 /*!
- * @brief This function pops the last node in the stack
- *          (The most recently pushed node).
+ * @brief This function pops several references off the stack at once.
  *
  * @param[in/out] p_stack The stack context.
+ * @param[out] pp_data Receives the popped references.
+ * @param[in] count The number of references to pop.
+ *
+ * @return 0 on success, -1 on error or if the stack holds fewer than
+ *          count elements. Nothing is popped on error.
+ */
+int
+stack_pop_n (stack_t * p_stack, void ** pp_data, const size_t count)
+{
+    int status = -1;
+    if ((NULL == p_stack) ||
+        ((NULL == pp_data) && (0 != count)) ||
+        (count > p_stack->size))
+    {
+        goto EXIT;
+    }
+    
+    p_stack->size -= count;
+    if (0 != count)
+    {
+        memcpy(pp_data, p_stack->pp_data + p_stack->size,
+               count * sizeof(void *));
+    }
+    stack_release(p_stack);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function returns the data at the top of the stack without
+ *          popping it.
+ *
+ * @param[in] p_stack The stack context.
  *
- * @return Pointer to the data held in the first node of the stack.
+ * @return Pointer to the data at the top of the stack.
  *          NULL on error or empty stack.
  */
 void *
-stack_pop (stack_t * p_stack)
+stack_peek (const stack_t * p_stack)
 {
     void * p_result = NULL;
     if ((NULL == p_stack) ||
-        (NULL == p_stack->p_head))
+        (0 == p_stack->size))
+    {
+        goto EXIT;
+    }
+    
+    p_result = p_stack->pp_data[p_stack->size - 1];
+    
+    EXIT:
+        return p_result;
+}
+
+/*!
+ * @brief This function makes sure the stack has enough spare slots that
+ *          the next count pushes will not allocate.
+ *
+ *          The array grows geometrically, as it does for pushes.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[in] count The number of spare slots wanted.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+stack_reserve (stack_t * p_stack, const size_t count)
+{
+    int status = -1;
+    if ((NULL == p_stack) ||
+        (count > (SIZE_MAX - p_stack->size)))
+    {
+        goto EXIT;
+    }
+    
+    status = stack_grow(p_stack, p_stack->size + count);
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function shrinks the array until at most a given number of
+ *          spare slots remain.
+ *
+ *          The array is left as it is if it cannot be reallocated.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[in] keep The number of spare slots to keep.
+ *
+ * @return No return value expected.
+ */
+void
+stack_trim (stack_t * p_stack, const size_t keep)
+{
+    if ((NULL == p_stack) ||
+        ((p_stack->cap - p_stack->size) <= keep))
     {
         goto EXIT;
     }
     
-    stack_node_t * p_next = p_stack->p_head->p_next;
-    p_result = p_stack->p_head->p_data;
-    free(p_stack->p_head);
-    p_stack->p_head = p_next;
+    stack_resize(p_stack, p_stack->size + keep);
     
-    if (NULL == p_stack->p_head)
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function caps the number of spare slots the stack keeps.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[in] limit The most spare slots to keep.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+stack_set_spare_limit (stack_t * p_stack, const size_t limit)
+{
+    int status = -1;
+    if (NULL == p_stack)
     {
-        p_stack->p_tail = NULL;
+        goto EXIT;
     }
-    p_stack->size--;
+    
+    p_stack->spare_limit = limit;
+    stack_trim(p_stack, limit);
+    
+    status = 0;
     
     EXIT:
-        return p_result;
+        return status;
 }
 
-/***   end of file   ***/
+/***   end of file   ***/
\ No newline at end of file
@@ -2,50 +2,66 @@
  * @file stack.h
  *
  * @brief This file contains a generic stack implementation using
- *          a singly linked list.
+ *          a contiguous array.
  *
  *          The stack will contain references to any type of data,
  *              but will not be responsible for allocation or
  *              deallocation of referenced data.
  *
+ *          The references are stored bottom first in one array, so a push
+ *              or a pop is a single store or load and an index update.
+ *              The array at least doubles whenever it has to grow, so
+ *              pushes are amortized O(1). Pops never shrink the array
+ *              unless a spare limit is set, so by default a stack that
+ *              has reached its working size performs no further
+ *              allocation.
+ *
  *          Functions supported are as follows:
  *
  *              - stack_create
+ *              - stack_create_with_allocator
  *              - stack_destroy
  *              - stack_push
  *              - stack_pop
+ *              - stack_push_n
+ *              - stack_pop_n
+ *              - stack_peek
+ *              - stack_reserve
+ *              - stack_trim
+ *              - stack_set_spare_limit
  */
 
 #ifndef STACK_H
 #define STACK_H
 
 #include <stdlib.h>
+#include <stdint.h>
 
-/*!
- * @brief This datatype defines a node for the linked list.
- *
- * @param p_data Pointer to the referenced data.
- * @param p_next Pointer to the next node in the stack.
- */
-typedef struct _stack_node stack_node_t;
-struct _stack_node
-{
-    void * p_data;
-    stack_node_t * p_next;
-};
+#include "src/c/allocator/allocator.h"
+
+/*** Capacity of the array when the first element is pushed. ***/
+#define STACK_INIT_CAP 8
+
+/*** Spare limit under which released slots are never freed. ***/
+#define STACK_SPARE_UNLIMITED SIZE_MAX
 
 /*!
  * @brief This datatype defines a stack context.
  *
- * @param p_head The first node in the stack.
- * @param p_tail The last node in the stack.
- * @param size The number of nodes in the stack.
+ * @param pp_data The array of references, bottom of the stack first.
+ * @param size The number of elements in the stack.
+ * @param cap The number of elements the array holds.
+ * @param spare_limit The unused slots a pop keeps before shrinking.
+ * @param p_alloc The allocator for the context and its array. NULL for
+ *          the standard library.
  */
 typedef struct _stack
 {
-    stack_node_t * p_head;
-    stack_node_t * p_tail;
+    void ** pp_data;
     size_t size;
+    size_t cap;
+    size_t spare_limit;
+    const allocator_t * p_alloc;
 } stack_t;
 
 /*!
@@ -56,6 +72,18 @@ typedef struct _stack
 stack_t *
 stack_create (void);
 
+/*!
+ * @brief This function instantiates a new empty stack that allocates
+ *          through a given allocator.
+ *
+ * @param[in] p_alloc The allocator for the context and its array. NULL
+ *              for the standard library.
+ *
+ * @return Pointer to new stack context. NULL on error.
+ */
+stack_t *
+stack_create_with_allocator (const allocator_t * p_alloc);
+
 /*!
  * @brief This function destroys a stack context.
  *
@@ -83,17 +111,104 @@ int
 stack_push (stack_t * p_stack, void * p_data);
 
 /*!
- * @brief This function pops the last node in the stack
- *          (The most recently pushed node).
+ * @brief This function pops the last element in the stack
+ *          (The most recently pushed element).
  *
  * @param[in/out] p_stack The stack context.
  *
- * @return Pointer to the data held in the first node of the stack.
+ * @return Pointer to the data at the top of the stack.
  *          NULL on error or empty stack.
  */
 void *
 stack_pop (stack_t * p_stack);
 
+/*!
+ * @brief This function pushes several references onto the stack at once,
+ *          growing the array at most once.
+ *
+ *          The references are pushed in order, so the last one ends up on
+ *              top.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[in] pp_data The references to push. None may be NULL.
+ * @param[in] count The number of references.
+ *
+ * @return 0 on success, -1 on error. Nothing is pushed on error.
+ */
+int
+stack_push_n (stack_t * p_stack, void ** pp_data, const size_t count);
+
+/*!
+ * @brief This function pops several references off the stack at once.
+ *
+ *          The references are written in the order they were pushed, so
+ *              the former top of the stack is written last, and
+ *              stack_push_n of the result restores the stack.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[out] pp_data Receives the popped references.
+ * @param[in] count The number of references to pop.
+ *
+ * @return 0 on success, -1 on error or if the stack holds fewer than
+ *          count elements. Nothing is popped on error.
+ */
+int
+stack_pop_n (stack_t * p_stack, void ** pp_data, const size_t count);
+
+/*!
+ * @brief This function returns the data at the top of the stack without
+ *          popping it.
+ *
+ * @param[in] p_stack The stack context.
+ *
+ * @return Pointer to the data at the top of the stack.
+ *          NULL on error or empty stack.
+ */
+void *
+stack_peek (const stack_t * p_stack);
+
+/*!
+ * @brief This function makes sure the stack has enough spare slots that
+ *          the next count pushes will not allocate.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[in] count The number of spare slots wanted.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+stack_reserve (stack_t * p_stack, const size_t count);
+
+/*!
+ * @brief This function shrinks the array until at most a given number of
+ *          spare slots remain.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[in] keep The number of spare slots to keep.
+ *
+ * @return No return value expected.
+ */
+void
+stack_trim (stack_t * p_stack, const size_t keep);
+
+/*!
+ * @brief This function caps the number of spare slots the stack keeps.
+ *          A pop that leaves more than twice the cap unused, with the
+ *          stack filling at most a quarter of the array, shrinks it.
+ *
+ *          The shrunk array keeps room for the stack to double, so
+ *              alternating pushes and pops never reallocate. The stack
+ *              starts out with no cap (STACK_SPARE_UNLIMITED). Any spare
+ *              slots above the new cap are freed at once.
+ *
+ * @param[in/out] p_stack The stack context.
+ * @param[in] limit The most spare slots to keep.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+stack_set_spare_limit (stack_t * p_stack, const size_t limit);
+
 #endif // STACK_H
 
-/***   end of file   ***/
+/***   end of file   ***/
\ No newline at end of file
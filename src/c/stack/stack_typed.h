@@ -0,0 +1,141 @@
+/*!
+ * @file stack_typed.h
+ *
+ * @brief This file contains a macro that generates a stack specialized
+ *          for a single element type.
+ *
+ *          stack_t erases the element type behind void pointers and
+ *              out-of-line calls. A stack generated here stores its
+ *              elements directly in a typed array, and every function
+ *              is static inline, so pushing and popping compile down to
+ *              a plain store or load.
+ *
+ *          For example, STACK_DEFINE(int32_t, stack_i32) defines the type
+ *              stack_i32_t along with stack_i32_init, stack_i32_push and
+ *              so on. The context is meant to be embedded by value and
+ *              set up with the init function rather than allocated.
+ *
+ *          Functions generated are as follows:
+ *
+ *              - <name>_init
+ *              - <name>_fini
+ *              - <name>_push
+ *              - <name>_pop
+ *              - <name>_peek
+ */
+
+#ifndef STACK_TYPED_H
+#define STACK_TYPED_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*** Number of elements allocated by the first push. ***/
+#define STACK_TYPED_INIT_CAP 8
+
+/*!
+ * @brief This macro defines a stack type holding elements of type T by
+ *          value, along with its functions, all prefixed with name.
+ *
+ *          The generated functions behave as follows:
+ *
+ *              - name_init(p) sets up an empty stack.
+ *              - name_fini(p) frees the stack's array. The context may
+ *                  be initialized again afterwards.
+ *              - name_push(p, value) pushes a copy of value, doubling
+ *                  the array when full. Returns 0 on success, -1 on
+ *                  error.
+ *              - name_pop(p, p_out) pops the most recently pushed
+ *                  element into p_out, which may be NULL. Returns 0 on
+ *                  success, -1 on error or empty stack.
+ *              - name_peek(p) returns a pointer to the most recently
+ *                  pushed element. NULL on empty stack.
+ *
+ * @param T The element type.
+ * @param name The prefix for the generated type and functions.
+ */
+#define STACK_DEFINE(T, name)                                                \
+                                                                             \
+typedef struct _##name                                                       \
+{                                                                            \
+    T *    p_data;                                                           \
+    size_t size;                                                             \
+    size_t cap;                                                              \
+} name##_t;                                                                  \
+                                                                             \
+static inline void                                                           \
+name##_init (name##_t * p_stack)                                             \
+{                                                                            \
+    p_stack->p_data = NULL;                                                  \
+    p_stack->size = 0;                                                       \
+    p_stack->cap = 0;                                                        \
+}                                                                            \
+                                                                             \
+static inline void                                                           \
+name##_fini (name##_t * p_stack)                                             \
+{                                                                            \
+    free(p_stack->p_data);                                                   \
+    name##_init(p_stack);                                                    \
+}                                                                            \
+                                                                             \
+static inline int                                                            \
+name##_push (name##_t * p_stack, T value)                                    \
+{                                                                            \
+    int status = -1;                                                         \
+                                                                             \
+    /* If the stack is full, double its capacity. */                         \
+    if (p_stack->size == p_stack->cap)                                       \
+    {                                                                        \
+        size_t new_cap = (0 == p_stack->cap) ? STACK_TYPED_INIT_CAP          \
+                                             : (p_stack->cap * 2);           \
+        if (new_cap > (SIZE_MAX / sizeof(T)))                                \
+        {                                                                    \
+            goto EXIT;                                                       \
+        }                                                                    \
+        T * p_new = realloc(p_stack->p_data, new_cap * sizeof(T));           \
+        if (NULL == p_new)                                                   \
+        {                                                                    \
+            goto EXIT;                                                       \
+        }                                                                    \
+        p_stack->p_data = p_new;                                             \
+        p_stack->cap = new_cap;                                              \
+    }                                                                        \
+    p_stack->p_data[p_stack->size++] = value;                                \
+                                                                             \
+    status = 0;                                                              \
+                                                                             \
+    EXIT:                                                                    \
+        return status;                                                       \
+}                                                                            \
+                                                                             \
+static inline int                                                            \
+name##_pop (name##_t * p_stack, T * p_out)                                   \
+{                                                                            \
+    int status = -1;                                                         \
+    if (0 == p_stack->size)                                                  \
+    {                                                                        \
+        goto EXIT;                                                           \
+    }                                                                        \
+                                                                             \
+    p_stack->size--;                                                         \
+    if (NULL != p_out)                                                       \
+    {                                                                        \
+        *p_out = p_stack->p_data[p_stack->size];                             \
+    }                                                                        \
+                                                                             \
+    status = 0;                                                              \
+                                                                             \
+    EXIT:                                                                    \
+        return status;                                                       \
+}                                                                            \
+                                                                             \
+static inline T *                                                            \
+name##_peek (name##_t * p_stack)                                             \
+{                                                                            \
+    return (0 != p_stack->size) ? (p_stack->p_data + p_stack->size - 1)      \
+                                : NULL;                                      \
+}
+
+#endif // STACK_TYPED_H
+
+/***   end of file   ***/
\ No newline at end of file
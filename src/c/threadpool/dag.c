@@ -0,0 +1,363 @@
+/*!
+ * @file dag.c
+ *
+ * @brief This file contains a task dependency graph executor built on
+ *          top of the threadpool.
+ *
+ *          Functions included are as follows:
+ *
+ *              - dag_create
+ *              - dag_destroy
+ *              - dag_add_node
+ *              - dag_add_edge
+ *              - dag_run
+ */
+
+#include "dag.h"
+
+/*!
+ * @brief This is a static function that runs a node's job, then releases
+ *          each successor whose last outstanding predecessor this was.
+ *
+ *          Released successors are enqueued from inside this job, so in
+ *              stealing mode they land on the current thread's own deque
+ *              and the next one runs while its inputs are still in cache.
+ *
+ * @param[in] pb_shutdown Pointer to the threadpool's shutdown signal.
+ * @param[in/out] vp_node A void pointer to the node.
+ *
+ * @return No return value expected.
+ */
+static void
+dag_node_run (_Atomic bool * pb_shutdown, void * vp_node)
+{
+    dag_node_t * p_node = (dag_node_t *) vp_node;
+    dag_t * p_dag = p_node->p_dag;
+    
+    // Perform the job.
+    p_node->job_func(pb_shutdown, p_node->p_arg);
+    
+    // Count down each successor, enqueueing any that are now ready.
+    for (size_t idx = 0; idx < p_node->succs.size; ++idx)
+    {
+        dag_node_t * p_succ = vector_at(&(p_node->succs), idx);
+        if (1 == atomic_fetch_sub(&(p_succ->pending), 1))
+        {
+            // Should the successor fail to enqueue, run it right here
+            // rather than stall the graph.
+            if (-1 == threadpool_enq(p_dag->p_tp, dag_node_run, p_succ))
+            {
+                dag_node_run(pb_shutdown, p_succ);
+            }
+        }
+    }
+    
+    // Mark this node complete. The graph may be released as soon as the
+    // last node does so.
+    threadpool_group_done(&(p_dag->group));
+    return;
+}
+
+/*!
+ * @brief This is a static function that checks the graph for cycles by
+ *          peeling off nodes whose predecessors have all been peeled.
+ *
+ *          This leaves each node's pending count at zero.
+ *
+ * @param[in/out] p_dag The graph context.
+ * @param[out] pp_ready Scratch space for one pointer per node. On success
+ *              the nodes without predecessors are at the front.
+ * @param[out] p_num_roots Receives the number of nodes without
+ *              predecessors.
+ *
+ * @return 0 if the graph is acyclic, -1 otherwise.
+ */
+static int
+dag_check_acyclic (dag_t * p_dag,
+                   dag_node_t ** pp_ready,
+                   size_t * p_num_roots)
+{
+    int status = -1;
+    size_t num_nodes = p_dag->p_nodes->size;
+    size_t num_ready = 0;
+    
+    // Start from the nodes without predecessors.
+    for (size_t idx = 0; idx < num_nodes; ++idx)
+    {
+        dag_node_t * p_node = vector_at(p_dag->p_nodes, idx);
+        atomic_store(&(p_node->pending), p_node->num_preds);
+        if (0 == p_node->num_preds)
+        {
+            pp_ready[num_ready++] = p_node;
+        }
+    }
+    *p_num_roots = num_ready;
+    
+    // Peel each ready node, readying any successors it was the last
+    // predecessor of. Every node is peeled unless there is a cycle.
+    for (size_t head = 0; head < num_ready; ++head)
+    {
+        vector_t * p_succs = &(pp_ready[head]->succs);
+        for (size_t idx = 0; idx < p_succs->size; ++idx)
+        {
+            dag_node_t * p_succ = vector_at(p_succs, idx);
+            if (1 == atomic_fetch_sub(&(p_succ->pending), 1))
+            {
+                pp_ready[num_ready++] = p_succ;
+            }
+        }
+    }
+    
+    if (num_ready != num_nodes)
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function instantiates a new empty graph.
+ *
+ * @param[in/out] p_tp The threadpool context the graph runs on.
+ *
+ * @return Pointer to new graph context. NULL on error.
+ */
+dag_t *
+dag_create (threadpool_t * p_tp)
+{
+    int status = -1;
+    dag_t * p_dag = NULL;
+    if (NULL == p_tp)
+    {
+        goto EXIT;
+    }
+    
+    p_dag = calloc(1, sizeof(dag_t));
+    if (NULL == p_dag)
+    {
+        goto EXIT;
+    }
+    p_dag->p_tp = p_tp;
+    p_dag->p_nodes = vector_create();
+    if ((NULL == p_dag->p_nodes) ||
+        (-1 == threadpool_group_init(p_tp, &(p_dag->group))))
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        if ((-1 == status) &&
+            (NULL != p_dag))
+        {
+            dag_destroy(p_dag);
+            p_dag = NULL;
+        }
+        return p_dag;
+}
+
+/*!
+ * @brief This function destroys a graph context and all of its nodes.
+ *
+ *          The graph must not be running. Any data referenced by the
+ *              nodes' job arguments is not freed.
+ *
+ * @param[in/out] p_dag The graph context.
+ *
+ * @return No return value expected.
+ */
+void
+dag_destroy (dag_t * p_dag)
+{
+    if ((NULL == p_dag) ||
+        (NULL == p_dag->p_nodes))
+    {
+        goto EXIT;
+    }
+    
+    // Free each node along with its successor list.
+    for (size_t idx = 0; idx < p_dag->p_nodes->size; ++idx)
+    {
+        dag_node_t * p_node = vector_at(p_dag->p_nodes, idx);
+        vector_fini(&(p_node->succs));
+        free(p_node);
+    }
+    vector_destroy(p_dag->p_nodes);
+    p_dag->p_nodes = NULL;
+    
+    EXIT:
+        if (NULL != p_dag)
+        {
+            free(p_dag);
+            p_dag = NULL;
+        }
+        return;
+}
+
+/*!
+ * @brief This function adds a job to the graph as a new node with no
+ *          dependencies.
+ *
+ * @param[in/out] p_dag The graph context.
+ * @param[in] job_func The function to perform.
+ * @param[in] p_arg The arguments associated with the job.
+ *
+ * @return Pointer to the new node, owned by the graph. NULL on error.
+ */
+dag_node_t *
+dag_add_node (dag_t * p_dag, job_f job_func, void * p_arg)
+{
+    int status = -1;
+    dag_node_t * p_node = NULL;
+    if ((NULL == p_dag) ||
+        (NULL == job_func))
+    {
+        goto EXIT;
+    }
+    
+    // Create the new node.
+    p_node = calloc(1, sizeof(dag_node_t));
+    if (NULL == p_node)
+    {
+        goto EXIT;
+    }
+    p_node->job_func = job_func;
+    p_node->p_arg = p_arg;
+    p_node->p_dag = p_dag;
+    p_node->num_preds = 0;
+    atomic_init(&(p_node->pending), 0);
+    vector_init(&(p_node->succs));
+    
+    // Hand the node to the graph.
+    if (-1 == vector_push_back(p_dag->p_nodes, p_node))
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        if ((-1 == status) &&
+            (NULL != p_node))
+        {
+            vector_fini(&(p_node->succs));
+            free(p_node);
+            p_node = NULL;
+        }
+        return p_node;
+}
+
+/*!
+ * @brief This function declares that one node must complete before
+ *          another may start.
+ *
+ * @param[in/out] p_pred The node that must complete first.
+ * @param[in/out] p_succ The node that depends on it. This must belong to
+ *              the same graph.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+dag_add_edge (dag_node_t * p_pred, dag_node_t * p_succ)
+{
+    int status = -1;
+    if ((NULL == p_pred) ||
+        (NULL == p_succ) ||
+        (p_pred->p_dag != p_succ->p_dag))
+    {
+        goto EXIT;
+    }
+    
+    if (-1 == vector_push_back(&(p_pred->succs), p_succ))
+    {
+        goto EXIT;
+    }
+    p_succ->num_preds++;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function runs every job in the graph, respecting its
+ *          dependencies, and blocks until all of them have completed.
+ *
+ *          The graph may be run any number of times, but not from more
+ *              than one thread at once.
+ *
+ * @param[in/out] p_dag The graph context.
+ *
+ * @return 0 on success, -1 on error or if the graph contains a cycle.
+ *          No jobs are run if the graph contains a cycle.
+ */
+int
+dag_run (dag_t * p_dag)
+{
+    int status = -1;
+    dag_node_t ** pp_ready = NULL;
+    if ((NULL == p_dag) ||
+        (NULL == p_dag->p_nodes))
+    {
+        goto EXIT;
+    }
+    
+    size_t num_nodes = p_dag->p_nodes->size;
+    if (0 == num_nodes)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    // Refuse to run a graph that could never complete.
+    pp_ready = calloc(num_nodes, sizeof(dag_node_t *));
+    size_t num_roots = 0;
+    if ((NULL == pp_ready) ||
+        (-1 == dag_check_acyclic(p_dag, pp_ready, &num_roots)))
+    {
+        goto EXIT;
+    }
+    
+    // Arm each node's countdown of outstanding predecessors.
+    for (size_t idx = 0; idx < num_nodes; ++idx)
+    {
+        dag_node_t * p_node = vector_at(p_dag->p_nodes, idx);
+        atomic_store(&(p_node->pending), p_node->num_preds);
+    }
+    
+    // Count every node in the group, then release the roots. The rest
+    // are released by their predecessors. Should a root fail to enqueue,
+    // run it right here rather than stall the graph.
+    threadpool_group_add(&(p_dag->group), num_nodes);
+    for (size_t idx = 0; idx < num_roots; ++idx)
+    {
+        if (-1 == threadpool_enq(p_dag->p_tp, dag_node_run, pp_ready[idx]))
+        {
+            dag_node_run(&(p_dag->p_tp->b_shutdown), pp_ready[idx]);
+        }
+    }
+    
+    // Wait for the last node to complete.
+    if (-1 == threadpool_wait_all(&(p_dag->group)))
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        if (NULL != pp_ready)
+        {
+            free(pp_ready);
+            pp_ready = NULL;
+        }
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,139 @@
+/*!
+ * @file dag.h
+ *
+ * @brief This file contains a task dependency graph executor built on
+ *          top of the threadpool.
+ *
+ *          Each node of the graph is a job, and each edge declares that
+ *              one job must complete before another may start.
+ *
+ *          When the graph is run, every node without predecessors is
+ *              enqueued at once. Each node counts down its outstanding
+ *              predecessors atomically, and is enqueued by whichever
+ *              predecessor completes last, so no central lock or
+ *              scheduler is involved.
+ *
+ *          Functions included are as follows:
+ *
+ *              - dag_create
+ *              - dag_destroy
+ *              - dag_add_node
+ *              - dag_add_edge
+ *              - dag_run
+ */
+
+#ifndef DAG_H
+#define DAG_H
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "src/c/threadpool/threadpool.h"
+#include "src/c/vector/vector.h"
+
+typedef struct _dag dag_t;
+
+/*!
+ * @brief This datatype defines a node of a task dependency graph.
+ *
+ * @param job_func The job function.
+ * @param p_arg The job arguments.
+ * @param p_dag The graph the node belongs to.
+ * @param succs The nodes that depend on this node. Most nodes have only
+ *          a few, which the vector holds without allocating.
+ * @param num_preds The number of nodes this node depends on.
+ * @param pending The number of predecessors that have yet to complete
+ *          during the current run.
+ */
+typedef struct _dag_node
+{
+    job_f          job_func;
+    void *         p_arg;
+    dag_t *        p_dag;
+    vector_t       succs;
+    size_t         num_preds;
+    _Atomic size_t pending;
+} dag_node_t;
+
+/*!
+ * @brief This datatype defines a task dependency graph context.
+ *
+ * @param p_tp The threadpool context the graph runs on.
+ * @param p_nodes The nodes of the graph.
+ * @param group The task group counting nodes yet to complete during the
+ *          current run.
+ */
+struct _dag
+{
+    threadpool_t *     p_tp;
+    vector_t *         p_nodes;
+    threadpool_group_t group;
+};
+
+/*!
+ * @brief This function instantiates a new empty graph.
+ *
+ * @param[in/out] p_tp The threadpool context the graph runs on.
+ *
+ * @return Pointer to new graph context. NULL on error.
+ */
+dag_t *
+dag_create (threadpool_t * p_tp);
+
+/*!
+ * @brief This function destroys a graph context and all of its nodes.
+ *
+ *          The graph must not be running. Any data referenced by the
+ *              nodes' job arguments is not freed.
+ *
+ * @param[in/out] p_dag The graph context.
+ *
+ * @return No return value expected.
+ */
+void
+dag_destroy (dag_t * p_dag);
+
+/*!
+ * @brief This function adds a job to the graph as a new node with no
+ *          dependencies.
+ *
+ * @param[in/out] p_dag The graph context.
+ * @param[in] job_func The function to perform.
+ * @param[in] p_arg The arguments associated with the job.
+ *
+ * @return Pointer to the new node, owned by the graph. NULL on error.
+ */
+dag_node_t *
+dag_add_node (dag_t * p_dag, job_f job_func, void * p_arg);
+
+/*!
+ * @brief This function declares that one node must complete before
+ *          another may start.
+ *
+ * @param[in/out] p_pred The node that must complete first.
+ * @param[in/out] p_succ The node that depends on it. This must belong to
+ *              the same graph.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+dag_add_edge (dag_node_t * p_pred, dag_node_t * p_succ);
+
+/*!
+ * @brief This function runs every job in the graph, respecting its
+ *          dependencies, and blocks until all of them have completed.
+ *
+ *          The graph may be run any number of times, but not from more
+ *              than one thread at once.
+ *
+ * @param[in/out] p_dag The graph context.
+ *
+ * @return 0 on success, -1 on error or if the graph contains a cycle.
+ *          No jobs are run if the graph contains a cycle.
+ */
+int
+dag_run (dag_t * p_dag);
+
+#endif // DAG_H
+
+/***   end of file   ***/
\ No newline at end of file
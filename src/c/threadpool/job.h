@@ -0,0 +1,40 @@
+/*!
+ * @file job.h
+ *
+ * @brief This file contains the job datatypes shared by the threadpool
+ *          and its internal job containers.
+ */
+
+#ifndef JOB_H
+#define JOB_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/*!
+ * @brief This datatype defines a function template for a job that the
+ *          threadpool can perform.
+ *
+ * @param pb_shutdown Pointer to the parent threadpool's shutdown signal.
+ * @param p_arg The arguments to be passed to the job function.
+ *
+ * @return No return value expected.
+ */
+typedef void (*job_f)(_Atomic bool * pb_shutdown, void * p_arg);
+
+/*!
+ * @brief This datatype defines a job function packaged with its
+ *          arguments to be enqueued into a threadpool.
+ *
+ * @param job_func The job function pointer.
+ * @param p_arg The job arguments.
+ */
+typedef struct _job
+{
+    job_f job_func;
+    void * p_arg;
+} job_t;
+
+#endif // JOB_H
+
+/***   end of file   ***/
\ No newline at end of file
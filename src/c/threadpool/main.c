@@ -52,17 +52,35 @@ main ()
         return 1;
     }
     
-    // Enqueue jobs.
+    // Submit jobs as a task group.
     int nums[10] = {1,2,3,4,5,6,7,8,9,10};
+    threadpool_task_t tasks[10];
+    threadpool_group_t group;
+    if (-1 == threadpool_group_init(p_tp, &group))
+    {
+        printf("group_init\n");
+        return 1;
+    }
     for (size_t i = 0; i < 10; ++i)
     {
-        if (-1 == threadpool_enq(p_tp, (job_f) calc_double, nums + i))
+        if (-1 == threadpool_group_submit(&group, tasks + i,
+                                          (job_f) calc_double, nums + i))
         {
-            printf("enq\n");
+            printf("group_submit\n");
             return 1;
         }
     }
     
+    // Wait for every job in the group to complete.
+    if (-1 == threadpool_wait_all(&group))
+    {
+        printf("wait_all\n");
+        return 1;
+    }
+    printf("all jobs in group complete\n");
+    
+    // Enqueue jobs that only finish on shutdown.
+    
     for (size_t i = 0; i < 10; ++i)
     {
         if (-1 == threadpool_enq(p_tp, (job_f) sleep_inf, NULL))
@@ -72,6 +90,7 @@ main ()
         }
     }
     
+    // Let the jobs run for a while before shutting down.
     sleep(5);
     
     // Destroy the threadpool.
@@ -86,4 +105,4 @@ main ()
     return 0;
 }
 
-/***   end of file   ***/
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,392 @@
+/*!
+ * @file parallel.c
+ *
+ * @brief This file contains data-parallel loop primitives built on top
+ *          of the threadpool.
+ *
+ *          Functions included are as follows:
+ *
+ *              - threadpool_parallel_for
+ *              - threadpool_parallel_reduce
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "parallel.h"
+
+/*** Partial results are padded to this size so they never share a line. ***/
+#define PARALLEL_PARTIAL_ALIGN 64
+
+typedef struct _parallel parallel_t;
+
+/*!
+ * @brief This datatype defines a range of chunks handed to one job.
+ *
+ * @param p_par The parallel loop the chunks belong to.
+ * @param first The first chunk of the range.
+ * @param last One past the last chunk of the range.
+ */
+typedef struct _parallel_range
+{
+    parallel_t * p_par;
+    size_t       first;
+    size_t       last;
+} parallel_range_t;
+
+/*!
+ * @brief This datatype defines the state of one parallel loop or
+ *          reduction.
+ *
+ * @param p_tp The threadpool context.
+ * @param begin The first index of the loop.
+ * @param end One past the last index of the loop.
+ * @param grain The number of indices per chunk.
+ * @param body The loop body, or NULL for a reduction.
+ * @param reduce_body The reduction body, or NULL for a loop.
+ * @param p_ctx The context passed to the body.
+ * @param p_partials The partial result of each chunk of a reduction.
+ * @param partial_stride The distance in bytes between partial results.
+ * @param p_ranges Storage for every range that may be split off.
+ * @param num_ranges The number of ranges handed out so far.
+ * @param group The task group counting chunks yet to be processed.
+ */
+struct _parallel
+{
+    threadpool_t *     p_tp;
+    size_t             begin;
+    size_t             end;
+    size_t             grain;
+    parallel_range_f   body;
+    parallel_reduce_f  reduce_body;
+    void *             p_ctx;
+    unsigned char *    p_partials;
+    size_t             partial_stride;
+    parallel_range_t * p_ranges;
+    _Atomic size_t     num_ranges;
+    threadpool_group_t group;
+};
+
+/*!
+ * @brief This is a static function that reports whether a range should be
+ *          split for an idle thread.
+ *
+ *          A split is wanted only while more threads are asleep than there
+ *              are jobs queued for them to wake up to.
+ *
+ * @param[in] p_tp The threadpool context.
+ *
+ * @return true if a split is wanted, false otherwise.
+ */
+static bool
+parallel_wanted (threadpool_t * p_tp)
+{
+    return (atomic_load_explicit(&(p_tp->num_queued), memory_order_relaxed) <
+            atomic_load_explicit(&(p_tp->num_idle), memory_order_relaxed));
+}
+
+/*!
+ * @brief This is a static function that processes a range of chunks.
+ *
+ *          The chunks are run in order. Before each one, while a thread is
+ *              idle and nothing is queued for it, the upper half of what
+ *              is left is enqueued as a new job. A range that no thread
+ *              asks for is therefore run without splitting at all, and
+ *              one that stalls is split as soon as a thread runs dry.
+ *              Should a split fail to enqueue, the rest of the range is
+ *              simply run here.
+ *
+ * @param[in] pb_shutdown Pointer to the threadpool's shutdown signal.
+ * @param[in/out] vp_range A void pointer to the range.
+ *
+ * @return No return value expected.
+ */
+static void
+parallel_run (_Atomic bool * pb_shutdown, void * vp_range)
+{
+    (void) pb_shutdown;
+    parallel_range_t * p_range = (parallel_range_t *) vp_range;
+    parallel_t * p_par = p_range->p_par;
+    size_t first = p_range->first;
+    size_t last = p_range->last;
+    bool b_split = true;
+    
+    // The loop state may be released as soon as its last chunk is marked
+    // done, so everything needed is copied out first. It is only read
+    // directly again while this range still holds unfinished chunks.
+    threadpool_t * p_tp = p_par->p_tp;
+    size_t begin = p_par->begin;
+    size_t end = p_par->end;
+    size_t grain = p_par->grain;
+    parallel_range_f body = p_par->body;
+    parallel_reduce_f reduce_body = p_par->reduce_body;
+    void * p_ctx = p_par->p_ctx;
+    unsigned char * p_partials = p_par->p_partials;
+    size_t partial_stride = p_par->partial_stride;
+    threadpool_group_t * p_group = &(p_par->group);
+    
+    for (size_t chunk = first; chunk < last; ++chunk)
+    {
+        // Hand off upper halves while there are idle threads to take them.
+        while ((true == b_split) &&
+               ((last - chunk) > 1) &&
+               (true == parallel_wanted(p_tp)))
+        {
+            size_t mid = chunk + ((last - chunk) / 2);
+            size_t slot = atomic_fetch_add(&(p_par->num_ranges), 1);
+            parallel_range_t * p_upper = p_par->p_ranges + slot;
+            p_upper->p_par = p_par;
+            p_upper->first = mid;
+            p_upper->last = last;
+            if (-1 == threadpool_enq(p_tp, parallel_run, p_upper))
+            {
+                b_split = false;
+                break;
+            }
+            last = mid;
+        }
+        
+        // Run the chunk.
+        size_t lo = begin + (chunk * grain);
+        size_t hi = ((end - lo) > grain) ? (lo + grain) : end;
+        if (NULL != reduce_body)
+        {
+            reduce_body(lo, hi, p_ctx, p_partials + (chunk * partial_stride));
+        }
+        else
+        {
+            body(lo, hi, p_ctx);
+        }
+        threadpool_group_done(p_group);
+    }
+    return;
+}
+
+/*!
+ * @brief This is a static function that chooses the grain size of a loop
+ *          and returns the number of chunks it is cut into.
+ *
+ * @param[in/out] p_par The loop state. Its grain is filled in.
+ * @param[in] grain The requested grain size, or 0 to choose one.
+ *
+ * @return The number of chunks.
+ */
+static size_t
+parallel_chunk (parallel_t * p_par, const size_t grain)
+{
+    size_t count = p_par->end - p_par->begin;
+    p_par->grain = grain;
+    if (0 == p_par->grain)
+    {
+        p_par->grain = count / (p_par->p_tp->num_threads *
+                                PARALLEL_CHUNKS_PER_THREAD);
+        if (0 == p_par->grain)
+        {
+            p_par->grain = 1;
+        }
+    }
+    return (count / p_par->grain) + ((0 != (count % p_par->grain)) ? 1 : 0);
+}
+
+/*!
+ * @brief This is a static function that processes every chunk of a loop
+ *          and waits for them all to complete.
+ *
+ *          The calling thread processes the whole range itself until
+ *              parts of it are split off for idle threads.
+ *
+ * @param[in/out] p_par The loop state.
+ * @param[in] num_chunks The number of chunks.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+parallel_start (parallel_t * p_par, const size_t num_chunks)
+{
+    int status = -1;
+    
+    // Every split hands out a range holding at least one chunk, so there
+    // are never more ranges than chunks.
+    p_par->p_ranges = calloc(num_chunks, sizeof(parallel_range_t));
+    if ((NULL == p_par->p_ranges) ||
+        (-1 == threadpool_group_init(p_par->p_tp, &(p_par->group))))
+    {
+        goto EXIT;
+    }
+    threadpool_group_add(&(p_par->group), num_chunks);
+    
+    // Process the whole range, starting on this thread.
+    parallel_range_t * p_root = p_par->p_ranges;
+    p_root->p_par = p_par;
+    p_root->first = 0;
+    p_root->last = num_chunks;
+    atomic_init(&(p_par->num_ranges), 1);
+    parallel_run(&(p_par->p_tp->b_shutdown), p_root);
+    
+    // Wait for the chunks split off to other threads.
+    if (-1 == threadpool_wait_all(&(p_par->group)))
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        if (NULL != p_par->p_ranges)
+        {
+            free(p_par->p_ranges);
+            p_par->p_ranges = NULL;
+        }
+        return status;
+}
+
+/*!
+ * @brief This function runs a loop body over an index range in parallel,
+ *          blocking until the whole range has been processed.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] begin The first index of the range.
+ * @param[in] end One past the last index of the range.
+ * @param[in] grain The largest subrange handed to a single call of the
+ *              body. If 0, one is chosen to give each thread
+ *              PARALLEL_CHUNKS_PER_THREAD subranges.
+ * @param[in] body The loop body.
+ * @param[in/out] p_ctx The context passed to the loop body.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_parallel_for (threadpool_t * p_tp,
+                         const size_t begin,
+                         const size_t end,
+                         const size_t grain,
+                         parallel_range_f body,
+                         void * p_ctx)
+{
+    int status = -1;
+    parallel_t par = {0};
+    if ((NULL == p_tp) ||
+        (NULL == body))
+    {
+        goto EXIT;
+    }
+    
+    // There is nothing to do for an empty range.
+    if (begin >= end)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    par.p_tp = p_tp;
+    par.begin = begin;
+    par.end = end;
+    par.body = body;
+    par.reduce_body = NULL;
+    par.p_ctx = p_ctx;
+    par.p_partials = NULL;
+    par.partial_stride = 0;
+    
+    status = parallel_start(&par, parallel_chunk(&par, grain));
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function reduces an index range to a single result in
+ *          parallel, blocking until the whole range has been processed.
+ *
+ *          Every subrange is accumulated into its own copy of the initial
+ *              value, and the partial results are then combined into the
+ *              initial value in index order. The initial value must
+ *              therefore be an identity of the combination.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] begin The first index of the range.
+ * @param[in] end One past the last index of the range.
+ * @param[in] grain The largest subrange handed to a single call of the
+ *              body. If 0, one is chosen to give each thread
+ *              PARALLEL_CHUNKS_PER_THREAD subranges.
+ * @param[in] body The reduction body.
+ * @param[in] combine The function combining partial results.
+ * @param[in/out] p_ctx The context passed to the body and combination.
+ * @param[in/out] p_result The initial value. Receives the result.
+ * @param[in] result_size The size in bytes of the result.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_parallel_reduce (threadpool_t * p_tp,
+                            const size_t begin,
+                            const size_t end,
+                            const size_t grain,
+                            parallel_reduce_f body,
+                            parallel_combine_f combine,
+                            void * p_ctx,
+                            void * p_result,
+                            const size_t result_size)
+{
+    int status = -1;
+    parallel_t par = {0};
+    if ((NULL == p_tp) ||
+        (NULL == body) ||
+        (NULL == combine) ||
+        (NULL == p_result) ||
+        (0 == result_size))
+    {
+        goto EXIT;
+    }
+    
+    // There is nothing to do for an empty range.
+    if (begin >= end)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    par.p_tp = p_tp;
+    par.begin = begin;
+    par.end = end;
+    par.body = NULL;
+    par.reduce_body = body;
+    par.p_ctx = p_ctx;
+    size_t num_chunks = parallel_chunk(&par, grain);
+    
+    // Start each chunk's partial result from a copy of the initial value.
+    par.partial_stride = ((result_size + PARALLEL_PARTIAL_ALIGN - 1) /
+                          PARALLEL_PARTIAL_ALIGN) * PARALLEL_PARTIAL_ALIGN;
+    par.p_partials = calloc(num_chunks, par.partial_stride);
+    if (NULL == par.p_partials)
+    {
+        goto EXIT;
+    }
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+    {
+        memcpy(par.p_partials + (chunk * par.partial_stride), p_result,
+               result_size);
+    }
+    
+    if (-1 == parallel_start(&par, num_chunks))
+    {
+        goto EXIT;
+    }
+    
+    // Combine the partial results in index order.
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+    {
+        combine(p_ctx, p_result, par.p_partials + (chunk * par.partial_stride));
+    }
+    
+    status = 0;
+    
+    EXIT:
+        if (NULL != par.p_partials)
+        {
+            free(par.p_partials);
+            par.p_partials = NULL;
+        }
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,141 @@
+/*!
+ * @file parallel.h
+ *
+ * @brief This file contains data-parallel loop primitives built on top
+ *          of the threadpool.
+ *
+ *          An index range is cut into chunks of a grain size, and each job
+ *              runs its range of chunks in order. Splitting is driven by
+ *              demand: before each chunk, while some thread is idle and
+ *              no job is queued for it, the job enqueues the upper half
+ *              of its remaining chunks and keeps the lower half. Idle
+ *              threads therefore pick up the largest pieces first, and
+ *              when every thread is busy no jobs are created at all.
+ *
+ *          The calling thread takes part in the work and returns once
+ *              the whole range has been processed.
+ *
+ *          Functions included are as follows:
+ *
+ *              - threadpool_parallel_for
+ *              - threadpool_parallel_reduce
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdlib.h>
+
+#include "src/c/threadpool/threadpool.h"
+
+/*** Chunks per thread when the grain size is chosen automatically. ***/
+#define PARALLEL_CHUNKS_PER_THREAD 8
+
+/*!
+ * @brief This datatype defines a function template for the body of a
+ *          parallel loop.
+ *
+ * @param begin The first index of the subrange to process.
+ * @param end One past the last index of the subrange to process.
+ * @param p_ctx The context passed to the parallel loop.
+ *
+ * @return No return value expected.
+ */
+typedef void (*parallel_range_f)(size_t begin, size_t end, void * p_ctx);
+
+/*!
+ * @brief This datatype defines a function template for the body of a
+ *          parallel reduction.
+ *
+ * @param begin The first index of the subrange to process.
+ * @param end One past the last index of the subrange to process.
+ * @param p_ctx The context passed to the parallel reduction.
+ * @param p_partial The partial result to accumulate the subrange into.
+ *          This starts out as a copy of the reduction's initial value.
+ *
+ * @return No return value expected.
+ */
+typedef void (*parallel_reduce_f)(size_t begin,
+                                  size_t end,
+                                  void * p_ctx,
+                                  void * p_partial);
+
+/*!
+ * @brief This datatype defines a function template for combining two
+ *          partial results of a parallel reduction.
+ *
+ *          The combination must be associative. It need not be
+ *              commutative, since partial results are always combined
+ *              in index order.
+ *
+ * @param p_ctx The context passed to the parallel reduction.
+ * @param p_dst The partial result covering lower indices. Receives the
+ *          combined result.
+ * @param p_src The partial result covering higher indices.
+ *
+ * @return No return value expected.
+ */
+typedef void (*parallel_combine_f)(void * p_ctx,
+                                   void * p_dst,
+                                   const void * p_src);
+
+/*!
+ * @brief This function runs a loop body over an index range in parallel,
+ *          blocking until the whole range has been processed.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] begin The first index of the range.
+ * @param[in] end One past the last index of the range.
+ * @param[in] grain The largest subrange handed to a single call of the
+ *              body. If 0, one is chosen to give each thread
+ *              PARALLEL_CHUNKS_PER_THREAD subranges.
+ * @param[in] body The loop body.
+ * @param[in/out] p_ctx The context passed to the loop body.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_parallel_for (threadpool_t * p_tp,
+                         const size_t begin,
+                         const size_t end,
+                         const size_t grain,
+                         parallel_range_f body,
+                         void * p_ctx);
+
+/*!
+ * @brief This function reduces an index range to a single result in
+ *          parallel, blocking until the whole range has been processed.
+ *
+ *          Every subrange is accumulated into its own copy of the initial
+ *              value, and the partial results are then combined into the
+ *              initial value in index order. The initial value must
+ *              therefore be an identity of the combination.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] begin The first index of the range.
+ * @param[in] end One past the last index of the range.
+ * @param[in] grain The largest subrange handed to a single call of the
+ *              body. If 0, one is chosen to give each thread
+ *              PARALLEL_CHUNKS_PER_THREAD subranges.
+ * @param[in] body The reduction body.
+ * @param[in] combine The function combining partial results.
+ * @param[in/out] p_ctx The context passed to the body and combination.
+ * @param[in/out] p_result The initial value. Receives the result.
+ * @param[in] result_size The size in bytes of the result.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_parallel_reduce (threadpool_t * p_tp,
+                            const size_t begin,
+                            const size_t end,
+                            const size_t grain,
+                            parallel_reduce_f body,
+                            parallel_combine_f combine,
+                            void * p_ctx,
+                            void * p_result,
+                            const size_t result_size);
+
+#endif // PARALLEL_H
+
+/***   end of file   ***/
\ No newline at end of file
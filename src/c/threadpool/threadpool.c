@@ -5,21 +5,151 @@
  *
  *          The threadpool is designed to create a set number of threads
  *              upon instantiation, and maintains a queue of jobs
- *              that are passed off to any available threads.
+ *              that are passed off to any available threads. Jobs are
+ *              stored inline in the queue rather than allocated.
  *
  *          When the threadpool is destroyed, threads will be allowed
  *              to finish out any work on the job queue, then be
  *              joined to the main thread for destruction.
+ *
+ *          In stealing mode, each thread additionally owns a
+ *              work-stealing deque. See threadpool_steal_inactive.
  */
 
+#include <time.h>
+
 #include "threadpool.h"
 
+/*!
+ * @brief The worker context of the calling thread, or NULL if the calling
+ *          thread does not belong to any threadpool.
+ */
+static _Thread_local threadpool_worker_t * gp_self = NULL;
+
+/*!
+ * @brief This is a static function that makes room in the shared job
+ *          queue for a number of additional jobs, doubling the queue's
+ *          buffer as many times as needed.
+ *
+ *          Since the buffer is never shrunk, this only allocates when
+ *              more jobs are waiting than ever before.
+ *
+ *          The caller must hold the threadpool mutex.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] count The number of jobs to make room for.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+threadpool_queue_reserve (threadpool_t * p_tp, const size_t count)
+{
+    int status = -1;
+    
+    // If the queue is too small, move its jobs in order into a larger
+    // buffer.
+    if ((p_tp->jobs_cap - p_tp->jobs_size) < count)
+    {
+        size_t new_cap = p_tp->jobs_cap * 2;
+        while ((new_cap - p_tp->jobs_size) < count)
+        {
+            new_cap *= 2;
+        }
+        
+        job_t * p_new = allocator_calloc(p_tp->p_alloc, new_cap,
+                                         sizeof(job_t));
+        if (NULL == p_new)
+        {
+            goto EXIT;
+        }
+        for (size_t idx = 0; idx < p_tp->jobs_size; ++idx)
+        {
+            p_new[idx] = p_tp->p_jobs[(p_tp->jobs_head + idx) &
+                                      (p_tp->jobs_cap - 1)];
+        }
+        allocator_free(p_tp->p_alloc, p_tp->p_jobs,
+                       p_tp->jobs_cap * sizeof(job_t));
+        p_tp->p_jobs = p_new;
+        p_tp->jobs_cap = new_cap;
+        p_tp->jobs_head = 0;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This is a static function that appends a job to the shared job
+ *          queue, growing the queue if it is full.
+ *
+ *          The caller must hold the threadpool mutex.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] job_func The job function.
+ * @param[in] p_arg The job arguments.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+threadpool_queue_push (threadpool_t * p_tp, job_f job_func, void * p_arg)
+{
+    int status = -1;
+    if (-1 == threadpool_queue_reserve(p_tp, 1))
+    {
+        goto EXIT;
+    }
+    
+    // Store the job inline in the next free slot.
+    job_t * p_slot = p_tp->p_jobs + ((p_tp->jobs_head + p_tp->jobs_size) &
+                                     (p_tp->jobs_cap - 1));
+    p_slot->job_func = job_func;
+    p_slot->p_arg = p_arg;
+    p_tp->jobs_size++;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This is a static function that removes the oldest job from the
+ *          shared job queue.
+ *
+ *          The caller must hold the threadpool mutex.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[out] p_job Receives the job.
+ *
+ * @return 0 on success, -1 on empty queue.
+ */
+static int
+threadpool_queue_pop (threadpool_t * p_tp, job_t * p_job)
+{
+    int status = -1;
+    if (0 == p_tp->jobs_size)
+    {
+        goto EXIT;
+    }
+    
+    *p_job = p_tp->p_jobs[p_tp->jobs_head];
+    p_tp->jobs_head = (p_tp->jobs_head + 1) & (p_tp->jobs_cap - 1);
+    p_tp->jobs_size--;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
 /*!
  * @brief This is a static function that defines the behavior of
  *          an inactive thread in the threadpool.
  *
  *          The thread will wait for a job to be enqueued, pick up the job,
- *              perform the job, then release the job's memory.
+ *              then perform the job.
  *
  *          If no job is available for the thread, the thread will
  *              enter a wait state dependent on the threadpool's
@@ -29,25 +159,27 @@
  *              shutdown signal is asserted and there are no jobs
  *              remaining to pick up from the queue.
  *
- * @param[in/out] vp_tp A void pointer to the thread's parent threadpool
+ * @param[in/out] vp_worker A void pointer to the thread's worker
  *                  context. This is a void pointer to be in compliance with
  *                  the pthread_create function's specs.
  *
  * @return No return value expected.
  */
 static void *
-threadpool_inactive (void * vp_tp)
+threadpool_inactive (void * vp_worker)
 {
-    if (NULL == vp_tp)
+    if (NULL == vp_worker)
     {
         goto EXIT;
     }
     
     // Cast the void pointer to its appropriate type.
-    threadpool_t * p_tp = (threadpool_t *) vp_tp;
+    threadpool_worker_t * p_worker = (threadpool_worker_t *) vp_worker;
+    threadpool_t * p_tp = p_worker->p_tp;
+    gp_self = p_worker;
     
     // This holds the current job the thread is performing.
-    job_t * p_job = NULL;
+    job_t job = {0};
     
     // Enter main inactivity loop.
     for (;;)
@@ -56,7 +188,7 @@ threadpool_inactive (void * vp_tp)
         pthread_mutex_lock(&(p_tp->mutex));
         
         // Check if the job queue is empty.
-        if (0 == p_tp->p_queue->size)
+        if (0 == p_tp->jobs_size)
         {
             // If the shutdown signal is asserted, we can exit.
             if (true == p_tp->b_shutdown)
@@ -66,28 +198,311 @@ threadpool_inactive (void * vp_tp)
             }
             
             // Enter a wait state on the condition variable.
+            atomic_fetch_add(&(p_tp->num_idle), 1);
             pthread_cond_wait(&(p_tp->cond), &(p_tp->mutex));
+            atomic_fetch_sub(&(p_tp->num_idle), 1);
         }
         
         // Pick up a job from the job queue.
-        p_job = queue_deq(p_tp->p_queue);
+        int deq_status = threadpool_queue_pop(p_tp, &job);
         
         // Exit critical section.
         pthread_mutex_unlock(&(p_tp->mutex));
         
-        // If the job is NULL here, something went wrong in the dequeue
-        // function. Just ignore and continue.
-        if (NULL == p_job)
+        // If there was no job here, the wait was woken by the shutdown
+        // signal or spuriously. Just ignore and continue.
+        if (-1 == deq_status)
         {
             continue;
         }
+        atomic_fetch_sub(&(p_tp->num_queued), 1);
         
         // Perform the job.
-        p_job->job_func(&(p_tp->b_shutdown), p_job->p_arg);
+        job.job_func(&(p_tp->b_shutdown), job.p_arg);
+    }
+    
+    EXIT:
+        return NULL;
+}
+
+/*!
+ * @brief This is a static function that returns the next pseudo-random
+ *          number from a worker's xorshift state.
+ *
+ * @param[in/out] p_worker The worker context.
+ *
+ * @return The next pseudo-random number.
+ */
+static uint32_t
+threadpool_rand (threadpool_worker_t * p_worker)
+{
+    uint32_t x = p_worker->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    p_worker->seed = x;
+    return x;
+}
+
+/*!
+ * @brief This is a static function that releases up to a given number of
+ *          threads waiting on the threadpool's condition variable.
+ *
+ *          If at least as many threads are wanted as are waiting, they
+ *              are all released with a single broadcast.
+ *
+ *          The caller must hold the threadpool mutex.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] count The number of threads wanted.
+ *
+ * @return No return value expected.
+ */
+static void
+threadpool_signal (threadpool_t * p_tp, const size_t count)
+{
+    size_t num_idle = atomic_load(&(p_tp->num_idle));
+    if (count >= num_idle)
+    {
+        if (0 != num_idle)
+        {
+            pthread_cond_broadcast(&(p_tp->cond));
+        }
+    }
+    else
+    {
+        for (size_t idx = 0; idx < count; ++idx)
+        {
+            pthread_cond_signal(&(p_tp->cond));
+        }
+    }
+    return;
+}
+
+/*!
+ * @brief This is a static function that wakes up to a given number of
+ *          sleeping workers in stealing mode, if there are any.
+ *
+ *          The caller must already have counted its new jobs in
+ *              num_queued. Since a worker counts itself in num_idle
+ *              before checking num_queued, at least one of the two
+ *              sides is guaranteed to see the other.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] count The number of workers wanted.
+ *
+ * @return No return value expected.
+ */
+static void
+threadpool_wake (threadpool_t * p_tp, const size_t count)
+{
+    if (0 != atomic_load(&(p_tp->num_idle)))
+    {
+        pthread_mutex_lock(&(p_tp->mutex));
+        threadpool_signal(p_tp, count);
+        pthread_mutex_unlock(&(p_tp->mutex));
+    }
+    return;
+}
+
+/*!
+ * @brief This is a static function that looks for a job for a worker in
+ *          stealing mode without taking the threadpool mutex.
+ *
+ *          The worker's own deque is checked first, newest job first.
+ *              Failing that, every other worker's deque is tried once,
+ *              oldest job first, starting from a random victim.
+ *
+ * @param[in/out] p_worker The worker context.
+ * @param[out] p_job Receives the job.
+ *
+ * @return 0 on success, -1 if no job was found.
+ */
+static int
+threadpool_find_job (threadpool_worker_t * p_worker, job_t * p_job)
+{
+    int status = -1;
+    threadpool_t * p_tp = p_worker->p_tp;
+    
+    // Check the worker's own deque.
+    if (0 == wsdeque_pop(p_worker->p_deque, p_job))
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    // Try to steal from each other worker, starting at a random victim.
+    size_t num_threads = p_tp->num_threads;
+    size_t start = threadpool_rand(p_worker) % num_threads;
+    for (size_t idx = 0; idx < num_threads; ++idx)
+    {
+        threadpool_worker_t * p_victim = p_tp->p_workers +
+                                         ((start + idx) % num_threads);
+        if ((p_victim != p_worker) &&
+            (0 == wsdeque_steal(p_victim->p_deque, p_job)))
+        {
+            status = 0;
+            goto EXIT;
+        }
+    }
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This is a static function that runs at most one queued job on
+ *          behalf of a worker that is waiting for other jobs to finish.
+ *
+ *          Running queued jobs instead of blocking keeps a worker that
+ *              waits from inside a job from starving the threadpool of
+ *              threads, which could otherwise deadlock.
+ *
+ * @param[in/out] p_worker The worker context.
+ *
+ * @return 0 if a job was run, -1 otherwise.
+ */
+static int
+threadpool_help (threadpool_worker_t * p_worker)
+{
+    int status = -1;
+    threadpool_t * p_tp = p_worker->p_tp;
+    job_t job = {0};
+    
+    // Look in the deques first, then in the shared job queue.
+    if ((THREADPOOL_MODE_STEALING == p_tp->mode) &&
+        (0 == threadpool_find_job(p_worker, &job)))
+    {
+        status = 0;
+    }
+    else if (0 != atomic_load(&(p_tp->num_queued)))
+    {
+        pthread_mutex_lock(&(p_tp->mutex));
+        status = threadpool_queue_pop(p_tp, &job);
+        pthread_mutex_unlock(&(p_tp->mutex));
+    }
+    
+    if (0 == status)
+    {
+        atomic_fetch_sub(&(p_tp->num_queued), 1);
+        job.job_func(&(p_tp->b_shutdown), job.p_arg);
+    }
+    
+    return status;
+}
+
+/*!
+ * @brief This is a static function that defines the behavior of
+ *          an inactive thread in a stealing mode threadpool.
+ *
+ *          The thread runs jobs from its own deque, then from other
+ *              workers' deques, then from the shared job queue. When
+ *              it takes jobs from the shared queue it moves a batch of
+ *              them onto its own deque so that other idle workers can
+ *              steal them without taking the mutex.
+ *
+ *          If no job is available anywhere, the thread will enter a
+ *              wait state dependent on the threadpool's condition
+ *              variable.
+ *
+ *          The thread will exit this function when the threadpool's
+ *              shutdown signal is asserted and no jobs remain queued
+ *              anywhere in the threadpool.
+ *
+ * @param[in/out] vp_worker A void pointer to the thread's worker
+ *                  context. This is a void pointer to be in compliance with
+ *                  the pthread_create function's specs.
+ *
+ * @return No return value expected.
+ */
+static void *
+threadpool_steal_inactive (void * vp_worker)
+{
+    if (NULL == vp_worker)
+    {
+        goto EXIT;
+    }
+    
+    // Cast the void pointer to its appropriate type.
+    threadpool_worker_t * p_worker = (threadpool_worker_t *) vp_worker;
+    threadpool_t * p_tp = p_worker->p_tp;
+    gp_self = p_worker;
+    
+    // This holds the current job the thread is performing.
+    job_t job = {0};
+    
+    // Enter main inactivity loop.
+    for (;;)
+    {
+        // Look for a job without taking the mutex.
+        if (0 == threadpool_find_job(p_worker, &job))
+        {
+            atomic_fetch_sub(&(p_tp->num_queued), 1);
+            job.job_func(&(p_tp->b_shutdown), job.p_arg);
+            continue;
+        }
         
-        // Free the job and set to NULL.
-        free(p_job);
-        p_job = NULL;
+        // Enter critical section.
+        pthread_mutex_lock(&(p_tp->mutex));
+        
+        // Pick up a job from the shared job queue, moving a share of
+        // any remaining jobs onto this worker's deque.
+        if (0 == threadpool_queue_pop(p_tp, &job))
+        {
+            size_t batch = p_tp->jobs_size / p_tp->num_threads;
+            if (batch > THREADPOOL_INJECT_BATCH)
+            {
+                batch = THREADPOOL_INJECT_BATCH;
+            }
+            for (size_t idx = 0; idx < batch; ++idx)
+            {
+                job_t * p_moved = p_tp->p_jobs + p_tp->jobs_head;
+                if (-1 == wsdeque_push(p_worker->p_deque,
+                                       p_moved->job_func, p_moved->p_arg))
+                {
+                    batch = idx;
+                    break;
+                }
+                p_tp->jobs_head = (p_tp->jobs_head + 1) &
+                                  (p_tp->jobs_cap - 1);
+                p_tp->jobs_size--;
+            }
+            
+            // Exit critical section.
+            pthread_mutex_unlock(&(p_tp->mutex));
+            
+            // Let another sleeping worker come steal the batch.
+            if (0 != batch)
+            {
+                threadpool_wake(p_tp, 1);
+            }
+            
+            atomic_fetch_sub(&(p_tp->num_queued), 1);
+            job.job_func(&(p_tp->b_shutdown), job.p_arg);
+            continue;
+        }
+        
+        // If the shutdown signal is asserted and no jobs remain
+        // anywhere, we can exit.
+        if ((true == p_tp->b_shutdown) &&
+            (0 == atomic_load(&(p_tp->num_queued))))
+        {
+            pthread_mutex_unlock(&(p_tp->mutex));
+            goto EXIT;
+        }
+        
+        // Enter a wait state on the condition variable, unless a job
+        // was pushed onto some deque since we last looked.
+        atomic_fetch_add(&(p_tp->num_idle), 1);
+        if ((0 == atomic_load(&(p_tp->num_queued))) &&
+            (false == p_tp->b_shutdown))
+        {
+            pthread_cond_wait(&(p_tp->cond), &(p_tp->mutex));
+        }
+        atomic_fetch_sub(&(p_tp->num_idle), 1);
+        
+        // Exit critical section.
+        pthread_mutex_unlock(&(p_tp->mutex));
     }
     
     EXIT:
@@ -95,57 +510,426 @@ threadpool_inactive (void * vp_tp)
 }
 
 /*!
- * @brief This function instantiates a new threadpool context.
+ * @brief This is a static function that enqueues a batch of jobs on the
+ *          threadpool, taking the threadpool mutex at most once.
+ *
+ *          In stealing mode, when called from one of the threadpool's own
+ *              threads, jobs are pushed onto that thread's deque. Any
+ *              jobs its deque cannot take go to the shared queue.
+ *
+ *          Exactly as many sleeping threads are woken as there are new
+ *              jobs for them, up to the number of sleeping threads.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] p_funcs The array of job functions, or NULL to use job_func
+ *              for every job.
+ * @param[in] job_func The job function shared by every job. Ignored if
+ *              p_funcs is not NULL.
+ * @param[in] pp_args The array of job arguments, or NULL to pass NULL
+ *              to every job.
+ * @param[in] count The number of jobs in the batch.
+ *
+ * @return 0 on success, -1 on error. On error, no jobs from the batch
+ *          were placed on the shared queue, though in stealing mode some
+ *          may already have been pushed onto the calling thread's deque.
+ */
+static int
+threadpool_enq_many (threadpool_t * p_tp,
+                     job_f * p_funcs,
+                     job_f job_func,
+                     void ** pp_args,
+                     const size_t count)
+{
+    int status = -1;
+    if (NULL == p_tp)
+    {
+        goto EXIT;
+    }
+    
+    // Validate every job up front, so the batch is not left half
+    // enqueued because of a bad entry.
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        if (NULL == ((NULL != p_funcs) ? p_funcs[idx] : job_func))
+        {
+            goto EXIT;
+        }
+    }
+    
+    // In stealing mode, push onto the calling worker's own deque for as
+    // long as the deque can grow.
+    size_t num_pushed = 0;
+    if ((THREADPOOL_MODE_STEALING == p_tp->mode) &&
+        (NULL != gp_self) &&
+        (p_tp == gp_self->p_tp))
+    {
+        for (; num_pushed < count; ++num_pushed)
+        {
+            if (-1 == wsdeque_push(gp_self->p_deque,
+                    (NULL != p_funcs) ? p_funcs[num_pushed] : job_func,
+                    (NULL != pp_args) ? pp_args[num_pushed] : NULL))
+            {
+                break;
+            }
+        }
+        
+        if (0 != num_pushed)
+        {
+            atomic_fetch_add(&(p_tp->num_queued), num_pushed);
+            threadpool_wake(p_tp, num_pushed);
+        }
+    }
+    
+    // Place the remaining jobs on the shared queue.
+    if (num_pushed < count)
+    {
+        size_t num_shared = count - num_pushed;
+        
+        // Enter critical section.
+        pthread_mutex_lock(&(p_tp->mutex));
+        
+        // Make room for every job before enqueueing any of them.
+        if (-1 == threadpool_queue_reserve(p_tp, num_shared))
+        {
+            pthread_mutex_unlock(&(p_tp->mutex));
+            goto EXIT;
+        }
+        for (size_t idx = num_pushed; idx < count; ++idx)
+        {
+            threadpool_queue_push(p_tp,
+                (NULL != p_funcs) ? p_funcs[idx] : job_func,
+                (NULL != pp_args) ? pp_args[idx] : NULL);
+        }
+        atomic_fetch_add(&(p_tp->num_queued), num_shared);
+        
+        // Release one waiting thread per job.
+        threadpool_signal(p_tp, num_shared);
+        
+        // Exit critical section.
+        pthread_mutex_unlock(&(p_tp->mutex));
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This is a static function that releases every thread waiting
+ *          for a task or group to complete, if there are any.
+ *
+ *          The caller must already have published the completion. Since
+ *              a waiter counts itself in num_waiters before checking for
+ *              completion, at least one of the two sides is guaranteed
+ *              to see the other.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ *
+ * @return No return value expected.
+ */
+static void
+threadpool_notify (threadpool_t * p_tp)
+{
+    if (0 != atomic_load(&(p_tp->num_waiters)))
+    {
+        pthread_mutex_lock(&(p_tp->done_mutex));
+        pthread_cond_broadcast(&(p_tp->done_cond));
+        pthread_mutex_unlock(&(p_tp->done_mutex));
+    }
+    return;
+}
+
+/*!
+ * @brief This is a static function that blocks until a pending counter
+ *          reaches zero.
+ *
+ *          A thread outside the threadpool sleeps on the threadpool's
+ *              completion condition variable. One of the threadpool's
+ *              own threads instead runs queued jobs while it waits, and
+ *              only naps briefly when there are none.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] p_pending The counter to wait on.
+ *
+ * @return No return value expected.
+ */
+static void
+threadpool_wait_pending (threadpool_t * p_tp, _Atomic size_t * p_pending)
+{
+    threadpool_worker_t * p_self = gp_self;
+    bool b_helper = ((NULL != p_self) && (p_tp == p_self->p_tp));
+    
+    while (0 != atomic_load(p_pending))
+    {
+        // Run someone else's job rather than sitting idle.
+        if ((true == b_helper) &&
+            (0 == threadpool_help(p_self)))
+        {
+            continue;
+        }
+        
+        // Enter critical section.
+        pthread_mutex_lock(&(p_tp->done_mutex));
+        atomic_fetch_add(&(p_tp->num_waiters), 1);
+        
+        if (0 != atomic_load(p_pending))
+        {
+            if (true == b_helper)
+            {
+                // Nap, so that newly queued jobs are picked up.
+                struct timespec deadline = {0};
+                clock_gettime(CLOCK_REALTIME, &deadline);
+                deadline.tv_nsec += THREADPOOL_HELP_NAP_NS;
+                if (deadline.tv_nsec >= 1000000000L)
+                {
+                    deadline.tv_sec++;
+                    deadline.tv_nsec -= 1000000000L;
+                }
+                pthread_cond_timedwait(&(p_tp->done_cond),
+                                       &(p_tp->done_mutex), &deadline);
+            }
+            else
+            {
+                pthread_cond_wait(&(p_tp->done_cond), &(p_tp->done_mutex));
+            }
+        }
+        
+        // Exit critical section.
+        atomic_fetch_sub(&(p_tp->num_waiters), 1);
+        pthread_mutex_unlock(&(p_tp->done_mutex));
+    }
+    return;
+}
+
+/*!
+ * @brief This is a static function that runs a submitted task's job and
+ *          then publishes its completion.
+ *
+ *          The task and group are not touched once their completion is
+ *              published, since a waiter may release them at once.
+ *
+ * @param[in] pb_shutdown Pointer to the threadpool's shutdown signal.
+ * @param[in/out] vp_task A void pointer to the task.
+ *
+ * @return No return value expected.
+ */
+static void
+threadpool_task_run (_Atomic bool * pb_shutdown, void * vp_task)
+{
+    threadpool_task_t * p_task = (threadpool_task_t *) vp_task;
+    threadpool_t * p_tp = p_task->p_tp;
+    threadpool_group_t * p_group = p_task->p_group;
+    
+    // Perform the job.
+    p_task->job_func(pb_shutdown, p_task->p_arg);
+    
+    // Publish completion of the task, then of the group.
+    atomic_store(&(p_task->pending), 0);
+    if (NULL != p_group)
+    {
+        atomic_fetch_sub(&(p_group->pending), 1);
+    }
+    threadpool_notify(p_tp);
+    return;
+}
+
+/*!
+ * @brief This is a static function that fills in a task and enqueues it.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in/out] p_group The task's group, or NULL.
+ * @param[out] p_task The task.
+ * @param[in] job_func The function to perform.
+ * @param[in] p_arg The arguments associated with the job.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+threadpool_task_submit (threadpool_t * p_tp,
+                        threadpool_group_t * p_group,
+                        threadpool_task_t * p_task,
+                        job_f job_func,
+                        void * p_arg)
+{
+    int status = -1;
+    if ((NULL == p_tp) ||
+        (NULL == p_task) ||
+        (NULL == job_func))
+    {
+        goto EXIT;
+    }
+    p_task->job_func = job_func;
+    p_task->p_arg = p_arg;
+    p_task->p_tp = p_tp;
+    p_task->p_group = p_group;
+    atomic_store(&(p_task->pending), 1);
+    
+    // Count the task in its group before it can possibly finish.
+    if (NULL != p_group)
+    {
+        atomic_fetch_add(&(p_group->pending), 1);
+    }
+    
+    if (-1 == threadpool_enq(p_tp, threadpool_task_run, p_task))
+    {
+        atomic_store(&(p_task->pending), 0);
+        if (NULL != p_group)
+        {
+            atomic_fetch_sub(&(p_group->pending), 1);
+            threadpool_notify(p_tp);
+        }
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function instantiates a new threadpool context.
+ *
+ * @param[in] num_threads The number of threads in the job queue.
+ *              This cannot be changed after instantiation.
+ *              This number must be non-zero, or error will be returned.
+ *
+ * @return Pointer to new threadpool context. NULL on error.
+ */
+threadpool_t *
+threadpool_create (const size_t num_threads)
+{
+    return threadpool_create_mode(num_threads, THREADPOOL_MODE_SHARED);
+}
+
+/*!
+ * @brief This function instantiates a new threadpool context using the
+ *          given job distribution mode.
  *
  * @param[in] num_threads The number of threads in the job queue.
  *              This cannot be changed after instantiation.
  *              This number must be non-zero, or error will be returned.
+ * @param[in] mode The job distribution mode.
  *
  * @return Pointer to new threadpool context. NULL on error.
  */
 threadpool_t *
-threadpool_create (const size_t num_threads)
+threadpool_create_mode (const size_t num_threads,
+                        const threadpool_mode_t mode)
+{
+    return threadpool_create_with_allocator(num_threads, mode, NULL);
+}
+
+/*!
+ * @brief This function instantiates a new threadpool context using the
+ *          given job distribution mode that allocates through a given
+ *          allocator.
+ *
+ * @param[in] num_threads The number of threads in the job queue.
+ *              This cannot be changed after instantiation.
+ *              This number must be non-zero, or error will be returned.
+ * @param[in] mode The job distribution mode.
+ * @param[in] p_alloc The allocator for the context, thread and worker
+ *              arrays and job queue. NULL for the standard library.
+ *
+ * @return Pointer to new threadpool context. NULL on error.
+ */
+threadpool_t *
+threadpool_create_with_allocator (const size_t num_threads,
+                                  const threadpool_mode_t mode,
+                                  const allocator_t * p_alloc)
 {
     int status = -1;
-    threadpool_t * p_tp = calloc(1, sizeof(threadpool_t));
-    if ((NULL == p_tp) ||
-        (0 == num_threads))
+    threadpool_t * p_tp = NULL;
+    if ((0 == num_threads) ||
+        ((THREADPOOL_MODE_SHARED != mode) &&
+         (THREADPOOL_MODE_STEALING != mode)))
+    {
+        goto EXIT;
+    }
+    
+    p_tp = allocator_calloc(p_alloc, 1, sizeof(threadpool_t));
+    if (NULL == p_tp)
     {
         goto EXIT;
     }
     p_tp->p_threads = NULL;
     p_tp->num_threads = num_threads;
+    p_tp->num_started = 0;
+    p_tp->mode = mode;
+    p_tp->p_workers = NULL;
     p_tp->b_shutdown = false;
-    p_tp->p_queue = NULL;
+    atomic_init(&(p_tp->num_queued), 0);
+    atomic_init(&(p_tp->num_idle), 0);
+    atomic_init(&(p_tp->num_waiters), 0);
+    p_tp->p_jobs = NULL;
+    p_tp->jobs_cap = THREADPOOL_QUEUE_CAP;
+    p_tp->jobs_head = 0;
+    p_tp->jobs_size = 0;
+    p_tp->p_alloc = p_alloc;
     
-    // Initialize the mutex and condition variable.
+    // Initialize the mutexes and condition variables.
     if ((0 != pthread_mutex_init(&(p_tp->mutex), NULL)) ||
-        (0 != pthread_cond_init(&(p_tp->cond), NULL)))
+        (0 != pthread_cond_init(&(p_tp->cond), NULL)) ||
+        (0 != pthread_mutex_init(&(p_tp->done_mutex), NULL)) ||
+        (0 != pthread_cond_init(&(p_tp->done_cond), NULL)))
     {
         goto EXIT;
     }
     
     // Create the job queue.
-    p_tp->p_queue = queue_create();
-    if (NULL == p_tp->p_queue)
+    p_tp->p_jobs = allocator_calloc(p_alloc, p_tp->jobs_cap, sizeof(job_t));
+    if (NULL == p_tp->p_jobs)
     {
         goto EXIT;
     }
     
-    // Allocate space for the inidividual threads.
-    p_tp->p_threads = calloc(num_threads, sizeof(pthread_t));
-    if (NULL == p_tp->p_threads)
+    // Allocate space for the inidividual threads and their contexts.
+    p_tp->p_threads = allocator_calloc(p_alloc, num_threads,
+                                       sizeof(pthread_t));
+    p_tp->p_workers = allocator_calloc(p_alloc, num_threads,
+                                       sizeof(threadpool_worker_t));
+    if ((NULL == p_tp->p_threads) ||
+        (NULL == p_tp->p_workers))
     {
         goto EXIT;
     }
     
+    // Initialize every worker context before any thread starts, since
+    // threads in stealing mode look at each other's deques.
+    for (size_t tid = 0; tid < num_threads; ++tid)
+    {
+        threadpool_worker_t * p_worker = p_tp->p_workers + tid;
+        p_worker->p_tp = p_tp;
+        p_worker->p_deque = NULL;
+        p_worker->id = tid;
+        p_worker->seed = (uint32_t) (tid * 2654435761u) | 1;
+        
+        if (THREADPOOL_MODE_STEALING == mode)
+        {
+            p_worker->p_deque = wsdeque_create(THREADPOOL_DEQUE_CAP);
+            if (NULL == p_worker->p_deque)
+            {
+                goto EXIT;
+            }
+        }
+    }
+    
     // Initialize the threads into the inactive function.
+    void * (*inactive_func)(void *) = threadpool_inactive;
+    if (THREADPOOL_MODE_STEALING == mode)
+    {
+        inactive_func = threadpool_steal_inactive;
+    }
     for (size_t tid = 0; tid < num_threads; ++tid)
     {
-        if (0 != pthread_create(p_tp->p_threads + tid, NULL, threadpool_inactive, p_tp))
+        if (0 != pthread_create(p_tp->p_threads + tid, NULL, inactive_func,
+                                p_tp->p_workers + tid))
         {
             goto EXIT;
         }
+        p_tp->num_started++;
     }
     
     status = 0;
@@ -180,18 +964,23 @@ threadpool_destroy (threadpool_t * p_tp)
         goto EXIT;
     }
     
-    // Assert the threadpool's shutdown signal.
+    // Assert the threadpool's shutdown signal. This is done inside the
+    // critical section so no thread can miss the broadcast between
+    // checking the signal and entering its wait state.
+    pthread_mutex_lock(&(p_tp->mutex));
     p_tp->b_shutdown = true;
     
     // Send a broadcast signal on the threadpool's condition variable
     // to release any waiting threads.
     if (0 != pthread_cond_broadcast(&(p_tp->cond)))
     {
+        pthread_mutex_unlock(&(p_tp->mutex));
         goto EXIT;
     }
+    pthread_mutex_unlock(&(p_tp->mutex));
     
     // Join all individual threads.
-    for (size_t tid = 0; tid < p_tp->num_threads; ++tid)
+    for (size_t tid = 0; tid < p_tp->num_started; ++tid)
     {
         if (0 != pthread_join(p_tp->p_threads[tid], NULL))
         {
@@ -200,16 +989,32 @@ threadpool_destroy (threadpool_t * p_tp)
     }
     
     // Free the array containing the threads.
-    free(p_tp->p_threads);
+    allocator_free(p_tp->p_alloc, p_tp->p_threads,
+                   p_tp->num_threads * sizeof(pthread_t));
     p_tp->p_threads = NULL;
     
+    // Free the worker contexts and their deques.
+    if (NULL != p_tp->p_workers)
+    {
+        for (size_t tid = 0; tid < p_tp->num_threads; ++tid)
+        {
+            wsdeque_destroy(p_tp->p_workers[tid].p_deque);
+        }
+        allocator_free(p_tp->p_alloc, p_tp->p_workers,
+                       p_tp->num_threads * sizeof(threadpool_worker_t));
+        p_tp->p_workers = NULL;
+    }
+    
     // Destroy the job queue.
-    queue_destroy(p_tp->p_queue);
-    p_tp->p_queue = NULL;
+    allocator_free(p_tp->p_alloc, p_tp->p_jobs,
+                   p_tp->jobs_cap * sizeof(job_t));
+    p_tp->p_jobs = NULL;
     
-    // Destroy the mutex and condition variables.
+    // Destroy the mutexes and condition variables.
     if ((0 != pthread_mutex_destroy(&(p_tp->mutex))) ||
-        (0 != pthread_cond_destroy(&(p_tp->cond))))
+        (0 != pthread_cond_destroy(&(p_tp->cond))) ||
+        (0 != pthread_mutex_destroy(&(p_tp->done_mutex))) ||
+        (0 != pthread_cond_destroy(&(p_tp->done_cond))))
     {
         goto EXIT;
     }
@@ -219,7 +1024,7 @@ threadpool_destroy (threadpool_t * p_tp)
     EXIT:
         if (NULL != p_tp)
         {
-            free(p_tp);
+            allocator_free(p_tp->p_alloc, p_tp, sizeof(threadpool_t));
             p_tp = NULL;
         }
         return status;
@@ -228,6 +1033,14 @@ threadpool_destroy (threadpool_t * p_tp)
 /*!
  * @brief This function enqueues a job on the threadpool.
  *
+ *          The job is stored inline in the threadpool's job queue, so
+ *              no memory is allocated once the queue has grown to fit
+ *              the workload.
+ *
+ *          In stealing mode, a job enqueued from one of the threadpool's
+ *              own threads is pushed onto that thread's deque without
+ *              taking the threadpool mutex.
+ *
  * @param[in/out] p_tp The threadpool context.
  * @param[in] job_func The function to perform.
  * @param[in] p_arg The arguments associated with the job.
@@ -239,30 +1052,34 @@ threadpool_enq (threadpool_t * p_tp, job_f job_func, void * p_arg)
 {
     int status = -1;
     if ((NULL == p_tp) ||
-        (NULL == p_tp->p_queue) ||
         (NULL == job_func))
     {
         goto EXIT;
     }
     
-    // Create the new job context.
-    job_t * p_new = calloc(1, sizeof(job_t));
-    if (NULL == p_new)
+    // In stealing mode, push onto the calling worker's own deque.
+    // Should the deque fail to grow, fall back to the shared queue.
+    if ((THREADPOOL_MODE_STEALING == p_tp->mode) &&
+        (NULL != gp_self) &&
+        (p_tp == gp_self->p_tp) &&
+        (0 == wsdeque_push(gp_self->p_deque, job_func, p_arg)))
     {
+        atomic_fetch_add(&(p_tp->num_queued), 1);
+        threadpool_wake(p_tp, 1);
+        status = 0;
         goto EXIT;
     }
-    p_new->job_func = job_func;
-    p_new->p_arg = p_arg;
     
     // Enter critical section.
     pthread_mutex_lock(&(p_tp->mutex));
     
     // Enqueue the job.
-    if (-1 == queue_enq(p_tp->p_queue, p_new))
+    if (-1 == threadpool_queue_push(p_tp, job_func, p_arg))
     {
         pthread_mutex_unlock(&(p_tp->mutex));
         goto EXIT;
     }
+    atomic_fetch_add(&(p_tp->num_queued), 1);
     
     // Exit critical section.
     pthread_mutex_unlock(&(p_tp->mutex));
@@ -277,13 +1094,327 @@ threadpool_enq (threadpool_t * p_tp, job_f job_func, void * p_arg)
     status = 0;
     
     EXIT:
-        if ((-1 == status) &&
-            (NULL != p_new))
-        {
-            free(p_new);
-            p_new = NULL;
-        }
         return status;
 }
 
-/***   end of file   ***/
+
+/*!
+ * @brief This function enqueues a batch of jobs on the threadpool.
+ *
+ *          The whole batch is enqueued under a single acquisition of the
+ *              threadpool mutex, and exactly as many waiting threads
+ *              are released as are needed to run it.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] p_funcs The array of job functions. None may be NULL.
+ * @param[in] pp_args The array of job arguments, or NULL to pass NULL
+ *              to every job.
+ * @param[in] count The number of jobs in the batch.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_enq_batch (threadpool_t * p_tp,
+                      job_f * p_funcs,
+                      void ** pp_args,
+                      const size_t count)
+{
+    int status = -1;
+    if ((NULL == p_tp) ||
+        ((NULL == p_funcs) && (0 != count)))
+    {
+        goto EXIT;
+    }
+    
+    status = threadpool_enq_many(p_tp, p_funcs, NULL, pp_args, count);
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function enqueues a batch of jobs on the threadpool that
+ *          all run the same function with different arguments.
+ *
+ *          The whole batch is enqueued under a single acquisition of the
+ *              threadpool mutex, and exactly as many waiting threads
+ *              are released as are needed to run it.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] job_func The function every job performs.
+ * @param[in] pp_args The array of job arguments, or NULL to pass NULL
+ *              to every job.
+ * @param[in] count The number of jobs in the batch.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_enq_batch_args (threadpool_t * p_tp,
+                           job_f job_func,
+                           void ** pp_args,
+                           const size_t count)
+{
+    int status = -1;
+    if ((NULL == p_tp) ||
+        (NULL == job_func))
+    {
+        goto EXIT;
+    }
+    
+    status = threadpool_enq_many(p_tp, NULL, job_func, pp_args, count);
+    
+    EXIT:
+        return status;
+}
+
+
+/*!
+ * @brief This function submits a job to the threadpool along with a
+ *          completion handle that can be waited on.
+ *
+ *          The task is owned by the caller and must stay valid until
+ *              the job completes. No memory is allocated, and no mutex
+ *              or condition variable is created, per task.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[out] p_task The task handle.
+ * @param[in] job_func The function to perform.
+ * @param[in] p_arg The arguments associated with the job.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_submit (threadpool_t * p_tp,
+                   threadpool_task_t * p_task,
+                   job_f job_func,
+                   void * p_arg)
+{
+    return threadpool_task_submit(p_tp, NULL, p_task, job_func, p_arg);
+}
+
+/*!
+ * @brief This function blocks until a submitted task's job has completed.
+ *
+ *          If called from one of the threadpool's own threads, that
+ *              thread runs other queued jobs while it waits.
+ *
+ * @param[in/out] p_task The task handle.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_wait (threadpool_task_t * p_task)
+{
+    int status = -1;
+    if ((NULL == p_task) ||
+        (NULL == p_task->p_tp))
+    {
+        goto EXIT;
+    }
+    
+    threadpool_wait_pending(p_task->p_tp, &(p_task->pending));
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function checks, without blocking, whether a submitted
+ *          task's job has completed.
+ *
+ * @param[in] p_task The task handle.
+ *
+ * @return true if the job has completed, false otherwise or on error.
+ */
+bool
+threadpool_try_wait (threadpool_task_t * p_task)
+{
+    bool b_done = false;
+    if (NULL == p_task)
+    {
+        goto EXIT;
+    }
+    
+    b_done = (0 == atomic_load(&(p_task->pending)));
+    
+    EXIT:
+        return b_done;
+}
+
+/*!
+ * @brief This function initializes an empty task group.
+ *
+ *          A task group counts outstanding work so that it can all be
+ *              waited on at once. A group may be reused once it has been
+ *              waited on.
+ *
+ * @param[in/out] p_tp The threadpool context the group's jobs run on.
+ * @param[out] p_group The task group.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_group_init (threadpool_t * p_tp, threadpool_group_t * p_group)
+{
+    int status = -1;
+    if ((NULL == p_tp) ||
+        (NULL == p_group))
+    {
+        goto EXIT;
+    }
+    p_group->p_tp = p_tp;
+    atomic_init(&(p_group->pending), 0);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function submits a job to the threadpool as a member of a
+ *          task group.
+ *
+ * @param[in/out] p_group The task group.
+ * @param[out] p_task The task handle. This must stay valid until the job
+ *              completes.
+ * @param[in] job_func The function to perform.
+ * @param[in] p_arg The arguments associated with the job.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_group_submit (threadpool_group_t * p_group,
+                         threadpool_task_t * p_task,
+                         job_f job_func,
+                         void * p_arg)
+{
+    int status = -1;
+    if (NULL == p_group)
+    {
+        goto EXIT;
+    }
+    
+    status = threadpool_task_submit(p_group->p_tp, p_group, p_task,
+                                    job_func, p_arg);
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function adds outstanding work to a task group without
+ *          submitting a task.
+ *
+ *          Each unit added must later be marked complete with
+ *              threadpool_group_done, typically from inside a job
+ *              enqueued with threadpool_enq.
+ *
+ * @param[in/out] p_group The task group.
+ * @param[in] count The number of units of work to add.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_group_add (threadpool_group_t * p_group, const size_t count)
+{
+    int status = -1;
+    if (NULL == p_group)
+    {
+        goto EXIT;
+    }
+    
+    atomic_fetch_add(&(p_group->pending), count);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function marks one unit of work added with
+ *          threadpool_group_add as complete.
+ *
+ * @param[in/out] p_group The task group.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_group_done (threadpool_group_t * p_group)
+{
+    int status = -1;
+    if (NULL == p_group)
+    {
+        goto EXIT;
+    }
+    
+    // The group may be released as soon as it is seen complete, so the
+    // threadpool is looked up first.
+    threadpool_t * p_tp = p_group->p_tp;
+    if (1 == atomic_fetch_sub(&(p_group->pending), 1))
+    {
+        threadpool_notify(p_tp);
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function blocks until every job in a task group has
+ *          completed.
+ *
+ *          If called from one of the threadpool's own threads, that
+ *              thread runs other queued jobs while it waits.
+ *
+ * @param[in/out] p_group The task group.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_wait_all (threadpool_group_t * p_group)
+{
+    int status = -1;
+    if ((NULL == p_group) ||
+        (NULL == p_group->p_tp))
+    {
+        goto EXIT;
+    }
+    
+    threadpool_wait_pending(p_group->p_tp, &(p_group->pending));
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function checks, without blocking, whether every job in a
+ *          task group has completed.
+ *
+ * @param[in] p_group The task group.
+ *
+ * @return true if every job has completed, false otherwise or on error.
+ */
+bool
+threadpool_try_wait_all (threadpool_group_t * p_group)
+{
+    bool b_done = false;
+    if (NULL == p_group)
+    {
+        goto EXIT;
+    }
+    
+    b_done = (0 == atomic_load(&(p_group->pending)));
+    
+    EXIT:
+        return b_done;
+}
+
+/***   end of file   ***/
\ No newline at end of file
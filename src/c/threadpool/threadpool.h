@@ -5,7 +5,8 @@
  *
  *          The threadpool is designed to create a set number of threads
  *              upon instantiation, and maintains a queue of jobs
- *              that are passed off to any available threads.
+ *              that are passed off to any available threads. Jobs are
+ *              stored inline in the queue rather than allocated.
  *
  *          When the threadpool is destroyed, threads will be allowed
  *              to finish out any work on the job queue, then be
@@ -14,63 +15,164 @@
  *          Functions included are as follows:
  *
  *              - threadpool_create
+ *              - threadpool_create_mode
+ *              - threadpool_create_with_allocator
  *              - threadpool_destroy
  *              - threadpool_enq
+ *              - threadpool_enq_batch
+ *              - threadpool_enq_batch_args
+ *              - threadpool_submit
+ *              - threadpool_wait
+ *              - threadpool_try_wait
+ *              - threadpool_group_init
+ *              - threadpool_group_submit
+ *              - threadpool_group_add
+ *              - threadpool_group_done
+ *              - threadpool_wait_all
+ *              - threadpool_try_wait_all
  */
 
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdbool.h>
 
-#include "src/c/queue/queue.h"
+#include "src/c/allocator/allocator.h"
+#include "src/c/threadpool/job.h"
+#include "src/c/threadpool/wsdeque.h"
+
+/*** Initial number of job slots in the shared job queue. Power of two. ***/
+#define THREADPOOL_QUEUE_CAP 1024
+
+/*** How long a worker waiting on a task naps when it has nothing to run. ***/
+#define THREADPOOL_HELP_NAP_NS 1000000L
+
+/*** Initial number of job slots in each worker's work-stealing deque. ***/
+#define THREADPOOL_DEQUE_CAP 256
+
+/*** Most jobs a stealing worker moves from the shared queue at once. ***/
+#define THREADPOOL_INJECT_BATCH 32
+
+/*!
+ * @brief This datatype defines how a threadpool distributes jobs.
+ *
+ * @param THREADPOOL_MODE_SHARED All workers take jobs from one shared
+ *          queue guarded by the threadpool mutex.
+ * @param THREADPOOL_MODE_STEALING Each worker owns a work-stealing deque.
+ *          Jobs enqueued from a worker go to its own deque, and idle
+ *          workers steal from randomly chosen victims. Jobs enqueued
+ *          from outside the threadpool go to the shared queue.
+ */
+typedef enum _threadpool_mode
+{
+    THREADPOOL_MODE_SHARED = 0,
+    THREADPOOL_MODE_STEALING,
+} threadpool_mode_t;
+
+typedef struct _threadpool threadpool_t;
+
+/*!
+ * @brief This datatype defines the per-thread context of a worker.
+ *
+ * @param p_tp The parent threadpool context.
+ * @param p_deque The worker's deque. NULL in shared mode.
+ * @param id The worker's index in the threadpool.
+ * @param seed The worker's random state for choosing steal victims.
+ */
+typedef struct _threadpool_worker
+{
+    threadpool_t * p_tp;
+    wsdeque_t *    p_deque;
+    size_t         id;
+    uint32_t       seed;
+} threadpool_worker_t;
 
 /*!
  * @brief This datatype defines a threadpool context.
  *
  * @param p_threads The array containing the individual threads.
  * @param num_threads The number of threads in the threadpool.
+ * @param num_started The number of threads successfully started.
+ * @param mode The job distribution mode.
+ * @param p_workers The array containing the per-thread worker contexts.
  * @param b_shutdown The threadpool's shutdown signal.
+ * @param num_queued The number of jobs waiting in any queue or deque.
+ * @param num_idle The number of workers waiting on the condition
+ *          variable.
+ * @param num_waiters The number of threads waiting on the completion
+ *          condition variable.
  * @param mutex The threadpool mutex.
  * @param cond The threadpool condition variable.
- * @param p_queue The threadpool job queue.
+ * @param done_mutex The mutex guarding the completion condition variable.
+ * @param done_cond The condition variable signalled when a task or task
+ *          group completes while a thread is waiting on one.
+ * @param p_jobs The threadpool job queue, a circular buffer of jobs.
+ * @param jobs_cap The number of slots in the job queue. Power of two.
+ * @param jobs_head The slot holding the oldest job in the job queue.
+ * @param jobs_size The number of jobs in the job queue.
+ * @param p_alloc The allocator for the context, thread and worker arrays
+ *          and job queue. NULL for the standard library.
  */
-typedef struct _threadpool
+struct _threadpool
 {
-    pthread_t *     p_threads;
-    size_t          num_threads;
-    _Atomic bool    b_shutdown;
-    pthread_mutex_t mutex;
-    pthread_cond_t  cond;
-    queue_t *       p_queue;
-} threadpool_t;
+    pthread_t *           p_threads;
+    size_t                num_threads;
+    size_t                num_started;
+    threadpool_mode_t     mode;
+    threadpool_worker_t * p_workers;
+    _Atomic bool          b_shutdown;
+    _Atomic size_t        num_queued;
+    _Atomic size_t        num_idle;
+    _Atomic size_t        num_waiters;
+    pthread_mutex_t       mutex;
+    pthread_cond_t        cond;
+    pthread_mutex_t       done_mutex;
+    pthread_cond_t        done_cond;
+    job_t *               p_jobs;
+    size_t                jobs_cap;
+    size_t                jobs_head;
+    size_t                jobs_size;
+    const allocator_t *   p_alloc;
+};
 
 /*!
- * @brief This datatype defines a function template for a job that the
- *          threadpool can perform.
- *
- * @param pb_shutdown Pointer to the parent threadpool's shutdown signal.
- * @param p_arg The arguments to be passed to the job function.
+ * @brief This datatype defines a task group, a barrier that counts
+ *          outstanding work on a threadpool.
  *
- * @return No return value expected.
+ * @param p_tp The threadpool context the group's jobs run on.
+ * @param pending The number of jobs in the group still to complete.
  */
-typedef void (*job_f)(_Atomic bool * pb_shutdown, void * p_arg);
+typedef struct _threadpool_group
+{
+    threadpool_t * p_tp;
+    _Atomic size_t pending;
+} threadpool_group_t;
 
 /*!
- * @brief This datatype defines a job function packaged with its
- *          arguments to be enqueued into a threadpool.
+ * @brief This datatype defines a task, a completion handle for a job
+ *          submitted to a threadpool.
+ *
+ *          Tasks are owned by the caller, who may keep them anywhere
+ *              (including on the stack) as long as they outlive the job.
  *
- * @param job_func The job function pointer.
+ * @param job_func The job function.
  * @param p_arg The job arguments.
+ * @param p_tp The threadpool context the job runs on.
+ * @param p_group The task group the job belongs to, or NULL.
+ * @param pending 1 until the job has completed, then 0.
  */
-typedef struct _job
+typedef struct _threadpool_task
 {
-    job_f job_func;
-    void * p_arg;
-} job_t;
+    job_f                job_func;
+    void *               p_arg;
+    threadpool_t *       p_tp;
+    threadpool_group_t * p_group;
+    _Atomic size_t       pending;
+} threadpool_task_t;
 
 /*!
  * @brief This function instantiates a new threadpool context.
@@ -84,6 +186,44 @@ typedef struct _job
 threadpool_t *
 threadpool_create (const size_t num_threads);
 
+/*!
+ * @brief This function instantiates a new threadpool context using the
+ *          given job distribution mode.
+ *
+ * @param[in] num_threads The number of threads in the job queue.
+ *              This cannot be changed after instantiation.
+ *              This number must be non-zero, or error will be returned.
+ * @param[in] mode The job distribution mode.
+ *
+ * @return Pointer to new threadpool context. NULL on error.
+ */
+threadpool_t *
+threadpool_create_mode (const size_t num_threads,
+                        const threadpool_mode_t mode);
+
+/*!
+ * @brief This function instantiates a new threadpool context using the
+ *          given job distribution mode that allocates through a given
+ *          allocator.
+ *
+ *          The allocator is only called with the threadpool's lock held
+ *              or while no other thread uses the threadpool, so it need
+ *              not be thread-safe on its own account.
+ *
+ * @param[in] num_threads The number of threads in the job queue.
+ *              This cannot be changed after instantiation.
+ *              This number must be non-zero, or error will be returned.
+ * @param[in] mode The job distribution mode.
+ * @param[in] p_alloc The allocator for the context, thread and worker
+ *              arrays and job queue. NULL for the standard library.
+ *
+ * @return Pointer to new threadpool context. NULL on error.
+ */
+threadpool_t *
+threadpool_create_with_allocator (const size_t num_threads,
+                                  const threadpool_mode_t mode,
+                                  const allocator_t * p_alloc);
+
 /*!
  * @brief This function destroys a threadpool context.
  *
@@ -110,6 +250,181 @@ threadpool_destroy (threadpool_t * p_tp);
 int
 threadpool_enq (threadpool_t * p_tp, job_f job_func, void * p_arg);
 
+
+/*!
+ * @brief This function enqueues a batch of jobs on the threadpool.
+ *
+ *          The whole batch is enqueued under a single acquisition of the
+ *              threadpool mutex, and exactly as many waiting threads
+ *              are released as are needed to run it.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] p_funcs The array of job functions. None may be NULL.
+ * @param[in] pp_args The array of job arguments, or NULL to pass NULL
+ *              to every job.
+ * @param[in] count The number of jobs in the batch.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_enq_batch (threadpool_t * p_tp,
+                      job_f * p_funcs,
+                      void ** pp_args,
+                      const size_t count);
+
+/*!
+ * @brief This function enqueues a batch of jobs on the threadpool that
+ *          all run the same function with different arguments.
+ *
+ *          The whole batch is enqueued under a single acquisition of the
+ *              threadpool mutex, and exactly as many waiting threads
+ *              are released as are needed to run it.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] job_func The function every job performs.
+ * @param[in] pp_args The array of job arguments, or NULL to pass NULL
+ *              to every job.
+ * @param[in] count The number of jobs in the batch.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_enq_batch_args (threadpool_t * p_tp,
+                           job_f job_func,
+                           void ** pp_args,
+                           const size_t count);
+
+
+/*!
+ * @brief This function submits a job to the threadpool along with a
+ *          completion handle that can be waited on.
+ *
+ *          The task is owned by the caller and must stay valid until
+ *              the job completes. No memory is allocated, and no mutex
+ *              or condition variable is created, per task.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[out] p_task The task handle.
+ * @param[in] job_func The function to perform.
+ * @param[in] p_arg The arguments associated with the job.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_submit (threadpool_t * p_tp,
+                   threadpool_task_t * p_task,
+                   job_f job_func,
+                   void * p_arg);
+
+/*!
+ * @brief This function blocks until a submitted task's job has completed.
+ *
+ *          If called from one of the threadpool's own threads, that
+ *              thread runs other queued jobs while it waits.
+ *
+ * @param[in/out] p_task The task handle.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_wait (threadpool_task_t * p_task);
+
+/*!
+ * @brief This function checks, without blocking, whether a submitted
+ *          task's job has completed.
+ *
+ * @param[in] p_task The task handle.
+ *
+ * @return true if the job has completed, false otherwise or on error.
+ */
+bool
+threadpool_try_wait (threadpool_task_t * p_task);
+
+/*!
+ * @brief This function initializes an empty task group.
+ *
+ *          A task group counts outstanding work so that it can all be
+ *              waited on at once. A group may be reused once it has been
+ *              waited on.
+ *
+ * @param[in/out] p_tp The threadpool context the group's jobs run on.
+ * @param[out] p_group The task group.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_group_init (threadpool_t * p_tp, threadpool_group_t * p_group);
+
+/*!
+ * @brief This function submits a job to the threadpool as a member of a
+ *          task group.
+ *
+ * @param[in/out] p_group The task group.
+ * @param[out] p_task The task handle. This must stay valid until the job
+ *              completes.
+ * @param[in] job_func The function to perform.
+ * @param[in] p_arg The arguments associated with the job.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_group_submit (threadpool_group_t * p_group,
+                         threadpool_task_t * p_task,
+                         job_f job_func,
+                         void * p_arg);
+
+/*!
+ * @brief This function adds outstanding work to a task group without
+ *          submitting a task.
+ *
+ *          Each unit added must later be marked complete with
+ *              threadpool_group_done, typically from inside a job
+ *              enqueued with threadpool_enq.
+ *
+ * @param[in/out] p_group The task group.
+ * @param[in] count The number of units of work to add.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_group_add (threadpool_group_t * p_group, const size_t count);
+
+/*!
+ * @brief This function marks one unit of work added with
+ *          threadpool_group_add as complete.
+ *
+ * @param[in/out] p_group The task group.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_group_done (threadpool_group_t * p_group);
+
+/*!
+ * @brief This function blocks until every job in a task group has
+ *          completed.
+ *
+ *          If called from one of the threadpool's own threads, that
+ *              thread runs other queued jobs while it waits.
+ *
+ * @param[in/out] p_group The task group.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+threadpool_wait_all (threadpool_group_t * p_group);
+
+/*!
+ * @brief This function checks, without blocking, whether every job in a
+ *          task group has completed.
+ *
+ * @param[in] p_group The task group.
+ *
+ * @return true if every job has completed, false otherwise or on error.
+ */
+bool
+threadpool_try_wait_all (threadpool_group_t * p_group);
+
 #endif // THREADPOOL_H
 
-/***   end of file   ***/
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,372 @@
+/*!
+ * @file wsdeque.c
+ *
+ * @brief This file contains a Chase-Lev work-stealing deque of jobs.
+ *
+ *          The memory orderings follow "Correct and Efficient
+ *              Work-Stealing for Weak Memory Models" (Le et al., 2013),
+ *              except that a push publishes with a release store rather
+ *              than a release fence, which is equivalent here and is
+ *              understood by thread sanitizers.
+ *
+ *          Functions included are as follows:
+ *
+ *              - wsdeque_create
+ *              - wsdeque_destroy
+ *              - wsdeque_push
+ *              - wsdeque_pop
+ *              - wsdeque_steal
+ *              - wsdeque_size
+ */
+
+#include "wsdeque.h"
+
+/*!
+ * @brief This is a static function that allocates a new circular buffer.
+ *
+ * @param[in] cap The number of slots. Must be a power of two.
+ *
+ * @return Pointer to the new buffer. NULL on error.
+ */
+static wsdeque_buf_t *
+wsdeque_buf_create (size_t cap)
+{
+    wsdeque_buf_t * p_buf = calloc(1, sizeof(wsdeque_buf_t) +
+                                      (cap * sizeof(wsdeque_cell_t)));
+    if (NULL == p_buf)
+    {
+        goto EXIT;
+    }
+    p_buf->mask = (int64_t) cap - 1;
+    p_buf->p_prev = NULL;
+    
+    EXIT:
+        return p_buf;
+}
+
+/*!
+ * @brief This is a static function that replaces the deque's buffer with
+ *          one of twice the size, copying the live jobs across.
+ *
+ *          The old buffer is chained onto the new one rather than freed,
+ *              since a thief may still be reading a slot from it.
+ *
+ * @param[in/out] p_deque The deque context.
+ * @param[in] top The current top index.
+ * @param[in] bottom The current bottom index.
+ *
+ * @return Pointer to the new buffer. NULL on error.
+ */
+static wsdeque_buf_t *
+wsdeque_grow (wsdeque_t * p_deque, int64_t top, int64_t bottom)
+{
+    wsdeque_buf_t * p_old = atomic_load_explicit(&(p_deque->p_buf),
+                                                 memory_order_relaxed);
+    wsdeque_buf_t * p_new = wsdeque_buf_create((size_t) (p_old->mask + 1) * 2);
+    if (NULL == p_new)
+    {
+        goto EXIT;
+    }
+    
+    // Copy the live jobs, keeping each at the same logical index.
+    for (int64_t idx = top; idx < bottom; ++idx)
+    {
+        wsdeque_cell_t * p_src = p_old->cells + (idx & p_old->mask);
+        wsdeque_cell_t * p_dst = p_new->cells + (idx & p_new->mask);
+        atomic_store_explicit(&(p_dst->job_func),
+            atomic_load_explicit(&(p_src->job_func), memory_order_relaxed),
+            memory_order_relaxed);
+        atomic_store_explicit(&(p_dst->p_arg),
+            atomic_load_explicit(&(p_src->p_arg), memory_order_relaxed),
+            memory_order_relaxed);
+    }
+    
+    // Publish the new buffer, retiring the old one.
+    p_new->p_prev = p_old;
+    atomic_store_explicit(&(p_deque->p_buf), p_new, memory_order_release);
+    
+    EXIT:
+        return p_new;
+}
+
+/*!
+ * @brief This function instantiates a new empty deque.
+ *
+ * @param[in] cap The initial number of slots. This is rounded up to a
+ *              power of two.
+ *
+ * @return Pointer to new deque context. NULL on error.
+ */
+wsdeque_t *
+wsdeque_create (size_t cap)
+{
+    int status = -1;
+    wsdeque_t * p_deque = calloc(1, sizeof(wsdeque_t));
+    if (NULL == p_deque)
+    {
+        goto EXIT;
+    }
+    atomic_init(&(p_deque->top), 0);
+    atomic_init(&(p_deque->bottom), 0);
+    atomic_init(&(p_deque->p_buf), NULL);
+    
+    // Round the capacity up to a power of two.
+    size_t pow2 = 2;
+    while (pow2 < cap)
+    {
+        pow2 <<= 1;
+    }
+    
+    wsdeque_buf_t * p_buf = wsdeque_buf_create(pow2);
+    if (NULL == p_buf)
+    {
+        goto EXIT;
+    }
+    atomic_store(&(p_deque->p_buf), p_buf);
+    
+    status = 0;
+    
+    EXIT:
+        if ((-1 == status) &&
+            (NULL != p_deque))
+        {
+            wsdeque_destroy(p_deque);
+            p_deque = NULL;
+        }
+        return p_deque;
+}
+
+/*!
+ * @brief This function destroys a deque context along with any
+ *          retired buffers.
+ *
+ *          No other thread may access the deque during or after
+ *              this call.
+ *
+ * @param[in/out] p_deque The deque context.
+ *
+ * @return No return value expected.
+ */
+void
+wsdeque_destroy (wsdeque_t * p_deque)
+{
+    if (NULL == p_deque)
+    {
+        goto EXIT;
+    }
+    
+    // Free the current buffer and every buffer it has retired.
+    wsdeque_buf_t * p_curr = atomic_load(&(p_deque->p_buf));
+    wsdeque_buf_t * p_prev = NULL;
+    
+    while (NULL != p_curr)
+    {
+        p_prev = p_curr->p_prev;
+        free(p_curr);
+        p_curr = p_prev;
+    }
+    
+    free(p_deque);
+    p_deque = NULL;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function pushes a job onto the bottom of the deque.
+ *
+ *          This may only be called by the deque's owner.
+ *
+ * @param[in/out] p_deque The deque context.
+ * @param[in] job_func The job function.
+ * @param[in] p_arg The job arguments.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+wsdeque_push (wsdeque_t * p_deque, job_f job_func, void * p_arg)
+{
+    int status = -1;
+    if ((NULL == p_deque) ||
+        (NULL == job_func))
+    {
+        goto EXIT;
+    }
+    
+    int64_t bottom = atomic_load_explicit(&(p_deque->bottom),
+                                          memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&(p_deque->top),
+                                       memory_order_acquire);
+    wsdeque_buf_t * p_buf = atomic_load_explicit(&(p_deque->p_buf),
+                                                 memory_order_relaxed);
+    
+    // If the buffer is full, grow it.
+    if ((bottom - top) > p_buf->mask)
+    {
+        p_buf = wsdeque_grow(p_deque, top, bottom);
+        if (NULL == p_buf)
+        {
+            goto EXIT;
+        }
+    }
+    
+    // Store the job, then publish it by advancing the bottom index.
+    wsdeque_cell_t * p_cell = p_buf->cells + (bottom & p_buf->mask);
+    atomic_store_explicit(&(p_cell->job_func), job_func, memory_order_relaxed);
+    atomic_store_explicit(&(p_cell->p_arg), p_arg, memory_order_relaxed);
+    atomic_store_explicit(&(p_deque->bottom), bottom + 1,
+                          memory_order_release);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function pops the most recently pushed job from the
+ *          bottom of the deque.
+ *
+ *          This may only be called by the deque's owner.
+ *
+ * @param[in/out] p_deque The deque context.
+ * @param[out] p_job Receives the popped job.
+ *
+ * @return 0 on success, -1 on error or empty deque.
+ */
+int
+wsdeque_pop (wsdeque_t * p_deque, job_t * p_job)
+{
+    int status = -1;
+    if ((NULL == p_deque) ||
+        (NULL == p_job))
+    {
+        goto EXIT;
+    }
+    
+    // Reserve the bottom slot before looking at the top index, so that
+    // a racing thief either sees the reservation or loses to us.
+    int64_t bottom = atomic_load_explicit(&(p_deque->bottom),
+                                          memory_order_relaxed) - 1;
+    wsdeque_buf_t * p_buf = atomic_load_explicit(&(p_deque->p_buf),
+                                                 memory_order_relaxed);
+    atomic_store_explicit(&(p_deque->bottom), bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&(p_deque->top), memory_order_relaxed);
+    
+    // The deque was empty. Undo the reservation.
+    if (top > bottom)
+    {
+        atomic_store_explicit(&(p_deque->bottom), bottom + 1,
+                              memory_order_relaxed);
+        goto EXIT;
+    }
+    
+    wsdeque_cell_t * p_cell = p_buf->cells + (bottom & p_buf->mask);
+    p_job->job_func = atomic_load_explicit(&(p_cell->job_func),
+                                           memory_order_relaxed);
+    p_job->p_arg = atomic_load_explicit(&(p_cell->p_arg),
+                                        memory_order_relaxed);
+    status = 0;
+    
+    // If this was the last job, race any thieves for it.
+    if (top == bottom)
+    {
+        if (false == atomic_compare_exchange_strong_explicit(
+                        &(p_deque->top), &top, top + 1,
+                        memory_order_seq_cst, memory_order_relaxed))
+        {
+            status = -1;
+        }
+        atomic_store_explicit(&(p_deque->bottom), bottom + 1,
+                              memory_order_relaxed);
+    }
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function steals the oldest job from the top of the deque.
+ *
+ *          This may be called by any thread.
+ *
+ * @param[in/out] p_deque The deque context.
+ * @param[out] p_job Receives the stolen job.
+ *
+ * @return 0 on success, -1 on error, empty deque or lost race.
+ */
+int
+wsdeque_steal (wsdeque_t * p_deque, job_t * p_job)
+{
+    int status = -1;
+    if ((NULL == p_deque) ||
+        (NULL == p_job))
+    {
+        goto EXIT;
+    }
+    
+    int64_t top = atomic_load_explicit(&(p_deque->top), memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&(p_deque->bottom),
+                                          memory_order_acquire);
+    if (top >= bottom)
+    {
+        goto EXIT;
+    }
+    
+    // Read the job before claiming it. If the claim fails, the owner or
+    // another thief took it and what we read is discarded.
+    wsdeque_buf_t * p_buf = atomic_load_explicit(&(p_deque->p_buf),
+                                                 memory_order_acquire);
+    wsdeque_cell_t * p_cell = p_buf->cells + (top & p_buf->mask);
+    job_t job;
+    job.job_func = atomic_load_explicit(&(p_cell->job_func),
+                                        memory_order_relaxed);
+    job.p_arg = atomic_load_explicit(&(p_cell->p_arg), memory_order_relaxed);
+    
+    if (false == atomic_compare_exchange_strong_explicit(
+                    &(p_deque->top), &top, top + 1,
+                    memory_order_seq_cst, memory_order_relaxed))
+    {
+        goto EXIT;
+    }
+    *p_job = job;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function returns an estimate of the number of jobs in the
+ *          deque. The result may be stale by the time it is used.
+ *
+ * @param[in] p_deque The deque context.
+ *
+ * @return The estimated number of jobs.
+ */
+size_t
+wsdeque_size (wsdeque_t * p_deque)
+{
+    size_t size = 0;
+    if (NULL == p_deque)
+    {
+        goto EXIT;
+    }
+    
+    int64_t bottom = atomic_load_explicit(&(p_deque->bottom),
+                                          memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&(p_deque->top), memory_order_relaxed);
+    if (bottom > top)
+    {
+        size = (size_t) (bottom - top);
+    }
+    
+    EXIT:
+        return size;
+}
+
+/***   end of file   ***/
\ No newline at end of file
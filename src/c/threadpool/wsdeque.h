@@ -0,0 +1,164 @@
+/*!
+ * @file wsdeque.h
+ *
+ * @brief This file contains a Chase-Lev work-stealing deque of jobs.
+ *
+ *          The deque is owned by a single thread, which pushes and pops
+ *              jobs at the bottom without taking any lock. Any other
+ *              thread may steal jobs from the top, racing only on a
+ *              single compare-and-swap.
+ *
+ *          Jobs are stored inline in a circular buffer that doubles
+ *              in size when full. Retired buffers are kept until the
+ *              deque is destroyed, since a thief may still be reading
+ *              from them.
+ *
+ *          Functions included are as follows:
+ *
+ *              - wsdeque_create
+ *              - wsdeque_destroy
+ *              - wsdeque_push
+ *              - wsdeque_pop
+ *              - wsdeque_steal
+ *              - wsdeque_size
+ */
+
+#ifndef WSDEQUE_H
+#define WSDEQUE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "src/c/cache_line/cache_line.h"
+#include "src/c/threadpool/job.h"
+
+/*!
+ * @brief This datatype defines a single slot of a deque buffer.
+ *
+ *          The fields are atomic since a thief may read a slot while
+ *              the owner is overwriting it. Such a thief will always
+ *              lose its compare-and-swap and discard what it read.
+ *
+ * @param job_func The job function pointer.
+ * @param p_arg The job arguments.
+ */
+typedef struct _wsdeque_cell
+{
+    _Atomic(job_f)  job_func;
+    _Atomic(void *) p_arg;
+} wsdeque_cell_t;
+
+/*!
+ * @brief This datatype defines a circular buffer of deque slots.
+ *
+ * @param mask The number of slots minus one. The slot count is always
+ *          a power of two.
+ * @param p_prev The previously used (retired) buffer, if any.
+ * @param cells The slots.
+ */
+typedef struct _wsdeque_buf wsdeque_buf_t;
+struct _wsdeque_buf
+{
+    int64_t         mask;
+    wsdeque_buf_t * p_prev;
+    wsdeque_cell_t  cells[];
+};
+
+/*!
+ * @brief This datatype defines a work-stealing deque context.
+ *
+ * @param top The index thieves steal from.
+ * @param bottom The index the owner pushes to and pops from.
+ * @param p_buf The current circular buffer.
+ */
+typedef struct _wsdeque
+{
+    _Atomic int64_t          top;
+    char                     pad_top[CACHE_LINE_SIZE - sizeof(int64_t)];
+    _Atomic int64_t          bottom;
+    _Atomic(wsdeque_buf_t *) p_buf;
+    char                     pad_bottom[CACHE_LINE_SIZE - sizeof(int64_t)
+                                        - sizeof(wsdeque_buf_t *)];
+} wsdeque_t;
+
+/*!
+ * @brief This function instantiates a new empty deque.
+ *
+ * @param[in] cap The initial number of slots. This is rounded up to a
+ *              power of two.
+ *
+ * @return Pointer to new deque context. NULL on error.
+ */
+wsdeque_t *
+wsdeque_create (size_t cap);
+
+/*!
+ * @brief This function destroys a deque context along with any
+ *          retired buffers.
+ *
+ *          No other thread may access the deque during or after
+ *              this call.
+ *
+ * @param[in/out] p_deque The deque context.
+ *
+ * @return No return value expected.
+ */
+void
+wsdeque_destroy (wsdeque_t * p_deque);
+
+/*!
+ * @brief This function pushes a job onto the bottom of the deque.
+ *
+ *          This may only be called by the deque's owner.
+ *
+ * @param[in/out] p_deque The deque context.
+ * @param[in] job_func The job function.
+ * @param[in] p_arg The job arguments.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+wsdeque_push (wsdeque_t * p_deque, job_f job_func, void * p_arg);
+
+/*!
+ * @brief This function pops the most recently pushed job from the
+ *          bottom of the deque.
+ *
+ *          This may only be called by the deque's owner.
+ *
+ * @param[in/out] p_deque The deque context.
+ * @param[out] p_job Receives the popped job.
+ *
+ * @return 0 on success, -1 on error or empty deque.
+ */
+int
+wsdeque_pop (wsdeque_t * p_deque, job_t * p_job);
+
+/*!
+ * @brief This function steals the oldest job from the top of the deque.
+ *
+ *          This may be called by any thread.
+ *
+ * @param[in/out] p_deque The deque context.
+ * @param[out] p_job Receives the stolen job.
+ *
+ * @return 0 on success, -1 on error, empty deque or lost race.
+ */
+int
+wsdeque_steal (wsdeque_t * p_deque, job_t * p_job);
+
+/*!
+ * @brief This function returns an estimate of the number of jobs in the
+ *          deque. The result may be stale by the time it is used.
+ *
+ * @param[in] p_deque The deque context.
+ *
+ * @return The estimated number of jobs.
+ */
+size_t
+wsdeque_size (wsdeque_t * p_deque);
+
+#endif // WSDEQUE_H
+
+/***   end of file   ***/
\ No newline at end of file
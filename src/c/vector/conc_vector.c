@@ -0,0 +1,343 @@
+/*!
+ * @file conc_vector.c
+ *
+ * @brief This file contains a grow-only vector that any number of
+ *          threads may append to at once without locking.
+ *
+ *          Functions included are as follows:
+ *
+ *              - conc_vector_create()
+ *              - conc_vector_destroy()
+ *              - conc_vector_reserve()
+ *              - conc_vector_push_back()
+ *              - conc_vector_at()
+ *              - conc_vector_size()
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include "conc_vector.h"
+
+/*!
+ * @brief This is a static function that returns the number of elements
+ *          a block holds.
+ *
+ * @param[in] block The index of the block.
+ *
+ * @return The number of elements.
+ */
+static inline size_t
+conc_vector_block_cap (const size_t block)
+{
+    return CONC_VECTOR_FIRST_CAP << block;
+}
+
+/*!
+ * @brief This is a static function that finds the block holding an index
+ *          and the index's offset within it.
+ *
+ * @param[in] idx The index.
+ * @param[out] p_offset Receives the offset of the index in its block.
+ *
+ * @return The index of the block.
+ */
+static inline size_t
+conc_vector_locate (const size_t idx, size_t * p_offset)
+{
+    unsigned long long slot = (idx >> CONC_VECTOR_FIRST_SHIFT) + 1;
+    size_t block = ((sizeof(slot) * 8) - 1) - __builtin_clzll(slot);
+    *p_offset = (idx + CONC_VECTOR_FIRST_CAP) - conc_vector_block_cap(block);
+    return block;
+}
+
+/*!
+ * @brief This is a static function that returns the publication flags of
+ *          a block, which follow its elements.
+ *
+ * @param[in] p_vector The concurrent vector context.
+ * @param[in] p_block The block.
+ * @param[in] block The index of the block.
+ *
+ * @return Pointer to the block's flags.
+ */
+static inline atomic_uchar *
+conc_vector_flags (conc_vector_t * p_vector,
+                   unsigned char * p_block,
+                   const size_t block)
+{
+    return (atomic_uchar *) (p_block + (conc_vector_block_cap(block) *
+                                        p_vector->elem_size));
+}
+
+/*!
+ * @brief This is a static function that returns a block, installing it
+ *          first if no thread has yet.
+ *
+ *          Threads that race to install the same block each allocate one,
+ *              and all but the winner of the compare-and-swap free
+ *              theirs again.
+ *
+ * @param[in/out] p_vector The concurrent vector context.
+ * @param[in] block The index of the block.
+ *
+ * @return Pointer to the block. NULL on error or block out of range.
+ */
+static unsigned char *
+conc_vector_block (conc_vector_t * p_vector, const size_t block)
+{
+    unsigned char * p_block = NULL;
+    if (block >= CONC_VECTOR_MAX_BLOCKS)
+    {
+        goto EXIT;
+    }
+    
+    p_block = atomic_load_explicit(&(p_vector->pp_blocks[block]),
+                                   memory_order_acquire);
+    if (NULL != p_block)
+    {
+        goto EXIT;
+    }
+    
+    // The flags start out zeroed, marking every element unpublished.
+    size_t block_cap = conc_vector_block_cap(block);
+    if (block_cap > (SIZE_MAX / (p_vector->elem_size + 1)))
+    {
+        goto EXIT;
+    }
+    unsigned char * p_new = calloc(block_cap, p_vector->elem_size + 1);
+    if (NULL == p_new)
+    {
+        goto EXIT;
+    }
+    if (atomic_compare_exchange_strong_explicit(
+            &(p_vector->pp_blocks[block]), &p_block, p_new,
+            memory_order_acq_rel, memory_order_acquire))
+    {
+        p_block = p_new;
+    }
+    else
+    {
+        free(p_new);
+    }
+    
+    EXIT:
+        return p_block;
+}
+
+/*!
+ * @brief This function instantiates a new concurrent vector context.
+ *
+ * @param[in] elem_size The size in bytes of a single element.
+ *
+ * @return Pointer to new concurrent vector context. NULL on error.
+ */
+conc_vector_t *
+conc_vector_create (const size_t elem_size)
+{
+    conc_vector_t * p_vector = NULL;
+    if (0 == elem_size)
+    {
+        goto EXIT;
+    }
+    
+    p_vector = calloc(1, sizeof(conc_vector_t));
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    p_vector->elem_size = elem_size;
+    for (size_t block = 0; block < CONC_VECTOR_MAX_BLOCKS; ++block)
+    {
+        atomic_init(&(p_vector->pp_blocks[block]), NULL);
+    }
+    atomic_init(&(p_vector->size), 0);
+    
+    EXIT:
+        return p_vector;
+}
+
+/*!
+ * @brief This function destroys a concurrent vector context along with
+ *          the elements it holds.
+ *
+ * @param[in/out] p_vector The concurrent vector context.
+ *
+ * @return No return value expected.
+ */
+void
+conc_vector_destroy (conc_vector_t * p_vector)
+{
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    for (size_t block = 0; block < CONC_VECTOR_MAX_BLOCKS; ++block)
+    {
+        free(atomic_load_explicit(&(p_vector->pp_blocks[block]),
+                                  memory_order_relaxed));
+    }
+    free(p_vector);
+    p_vector = NULL;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function allocates the blocks for the first indices of the
+ *          vector ahead of time.
+ *
+ * @param[in/out] p_vector The concurrent vector context.
+ * @param[in] count The number of indices to allocate blocks for.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+conc_vector_reserve (conc_vector_t * p_vector, const size_t count)
+{
+    int status = -1;
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    if (0 == count)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    size_t offset = 0;
+    size_t last = conc_vector_locate(count - 1, &offset);
+    for (size_t block = 0; block <= last; ++block)
+    {
+        if (NULL == conc_vector_block(p_vector, block))
+        {
+            goto EXIT;
+        }
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function copies an element onto the back of the vector.
+ *
+ *          The index is claimed before anything else, so a thread that
+ *              stalls mid-append only delays the publication of its own
+ *              element.
+ *
+ * @param[in/out] p_vector The concurrent vector context.
+ * @param[in] p_elem The element to copy in.
+ * @param[out] p_idx Receives the index of the element. May be NULL.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+conc_vector_push_back (conc_vector_t * p_vector,
+                       const void * p_elem,
+                       size_t * p_idx)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == p_elem))
+    {
+        goto EXIT;
+    }
+    
+    size_t idx = atomic_fetch_add_explicit(&(p_vector->size), 1,
+                                           memory_order_relaxed);
+    size_t offset = 0;
+    size_t block = conc_vector_locate(idx, &offset);
+    unsigned char * p_block = conc_vector_block(p_vector, block);
+    if (NULL == p_block)
+    {
+        goto EXIT;
+    }
+    
+    // Publish the element only once it has been copied in whole.
+    memcpy(p_block + (offset * p_vector->elem_size), p_elem,
+           p_vector->elem_size);
+    atomic_store_explicit(conc_vector_flags(p_vector, p_block, block) +
+                          offset, 1, memory_order_release);
+    if (NULL != p_idx)
+    {
+        *p_idx = idx;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function returns a pointer to a published element.
+ *
+ * @param[in] p_vector The concurrent vector context.
+ * @param[in] idx The index of the element.
+ *
+ * @return Pointer to the element. NULL on error, index out of range or
+ *          element not published yet.
+ */
+void *
+conc_vector_at (conc_vector_t * p_vector, const size_t idx)
+{
+    void * p_elem = NULL;
+    if ((NULL == p_vector) ||
+        (idx >= atomic_load_explicit(&(p_vector->size),
+                                     memory_order_relaxed)))
+    {
+        goto EXIT;
+    }
+    
+    size_t offset = 0;
+    size_t block = conc_vector_locate(idx, &offset);
+    if (block >= CONC_VECTOR_MAX_BLOCKS)
+    {
+        goto EXIT;
+    }
+    unsigned char * p_block = atomic_load_explicit(
+                                  &(p_vector->pp_blocks[block]),
+                                  memory_order_acquire);
+    if ((NULL == p_block) ||
+        (0 == atomic_load_explicit(conc_vector_flags(p_vector, p_block,
+                                                     block) + offset,
+                                   memory_order_acquire)))
+    {
+        goto EXIT;
+    }
+    
+    p_elem = p_block + (offset * p_vector->elem_size);
+    
+    EXIT:
+        return p_elem;
+}
+
+/*!
+ * @brief This function returns the number of indices claimed so far.
+ *
+ * @param[in] p_vector The concurrent vector context.
+ *
+ * @return The number of indices claimed. 0 on error.
+ */
+size_t
+conc_vector_size (conc_vector_t * p_vector)
+{
+    size_t size = 0;
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    size = atomic_load_explicit(&(p_vector->size), memory_order_acquire);
+    
+    EXIT:
+        return size;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,163 @@
+/*!
+ * @file conc_vector.h
+ *
+ * @brief This file contains a grow-only vector that any number of
+ *          threads may append to at once without locking.
+ *
+ *          Elements are copied by value into blocks whose sizes double,
+ *              as in seg_vector_t, so growing never moves an element. An
+ *              append claims the next index with a single atomic
+ *              fetch-and-add, installs the block for that index with a
+ *              compare-and-swap if no other thread has yet, copies the
+ *              element in and then publishes it through a per-element
+ *              flag. Appending threads therefore never wait on one
+ *              another.
+ *
+ *          conc_vector_at may be called concurrently with appends. It
+ *              returns NULL for an element whose index has been claimed
+ *              but which has not been published yet. Once every append
+ *              has returned, for example after waiting on the jobs that
+ *              made them, the index of every successful append is
+ *              published. An append that fails after claiming its index,
+ *              because its block could not be allocated, leaves that
+ *              index unpublished for good, so conc_vector_size is only
+ *              the number of published elements if no append failed.
+ *
+ *          Elements are never removed. The order of elements appended
+ *              from different threads is unspecified.
+ *
+ *          Functions included are as follows:
+ *
+ *              - conc_vector_create()
+ *              - conc_vector_destroy()
+ *              - conc_vector_reserve()
+ *              - conc_vector_push_back()
+ *              - conc_vector_at()
+ *              - conc_vector_size()
+ */
+
+#ifndef CONC_VECTOR_H
+#define CONC_VECTOR_H
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "src/c/cache_line/cache_line.h"
+
+/*** Base two logarithm of the number of elements in the first block. ***/
+#define CONC_VECTOR_FIRST_SHIFT 6
+
+/*** Number of elements in the first block. ***/
+#define CONC_VECTOR_FIRST_CAP ((size_t) 1 << CONC_VECTOR_FIRST_SHIFT)
+
+/*** Number of directory entries, enough to index any size_t. ***/
+#define CONC_VECTOR_MAX_BLOCKS ((sizeof(size_t) * 8) - \
+                                CONC_VECTOR_FIRST_SHIFT)
+
+/*!
+ * @brief This datatype defines a concurrent vector context.
+ *
+ *          The index counter sits on a cache line of its own, so the
+ *              appends hammering it do not slow down readers of the
+ *              block directory.
+ *
+ * @param elem_size The size in bytes of a single element.
+ * @param pp_blocks The directory of blocks. An entry is NULL until some
+ *          thread first needs its block.
+ * @param size The number of indices claimed so far.
+ */
+typedef struct _conc_vector
+{
+    size_t                   elem_size;
+    _Atomic(unsigned char *) pp_blocks[CONC_VECTOR_MAX_BLOCKS];
+    char                     pad_blocks[CACHE_LINE_SIZE -
+                                        (((CONC_VECTOR_MAX_BLOCKS + 1) *
+                                          sizeof(size_t)) %
+                                         CACHE_LINE_SIZE)];
+    _Atomic size_t           size;
+    char                     pad_size[CACHE_LINE_SIZE -
+                                      sizeof(size_t)];
+} conc_vector_t;
+
+/*!
+ * @brief This function instantiates a new concurrent vector context.
+ *
+ * @param[in] elem_size The size in bytes of a single element.
+ *
+ * @return Pointer to new concurrent vector context. NULL on error.
+ */
+conc_vector_t *
+conc_vector_create (const size_t elem_size);
+
+/*!
+ * @brief This function destroys a concurrent vector context along with
+ *          the elements it holds.
+ *
+ *          No other thread may access the vector during or after this
+ *              call.
+ *
+ * @param[in/out] p_vector The concurrent vector context.
+ *
+ * @return No return value expected.
+ */
+void
+conc_vector_destroy (conc_vector_t * p_vector);
+
+/*!
+ * @brief This function allocates the blocks for the first indices of the
+ *          vector ahead of time, so appends to them never allocate.
+ *
+ *          This may be called concurrently with appends.
+ *
+ * @param[in/out] p_vector The concurrent vector context.
+ * @param[in] count The number of indices to allocate blocks for.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+conc_vector_reserve (conc_vector_t * p_vector, const size_t count);
+
+/*!
+ * @brief This function copies an element onto the back of the vector.
+ *          It is safe to call from any number of threads at once.
+ *
+ * @param[in/out] p_vector The concurrent vector context.
+ * @param[in] p_elem The element to copy in.
+ * @param[out] p_idx Receives the index of the element. May be NULL.
+ *
+ * @return 0 on success, -1 on error. An index claimed by a failed append
+ *          is never published.
+ */
+int
+conc_vector_push_back (conc_vector_t * p_vector,
+                       const void * p_elem,
+                       size_t * p_idx);
+
+/*!
+ * @brief This function returns a pointer to a published element. It is
+ *          safe to call while other threads append.
+ *
+ * @param[in] p_vector The concurrent vector context.
+ * @param[in] idx The index of the element.
+ *
+ * @return Pointer to the element, which stays valid until the vector is
+ *          destroyed. NULL on error, index out of range or element not
+ *          published yet.
+ */
+void *
+conc_vector_at (conc_vector_t * p_vector, const size_t idx);
+
+/*!
+ * @brief This function returns the number of indices claimed so far,
+ *          including those of elements that are still being appended.
+ *
+ * @param[in] p_vector The concurrent vector context.
+ *
+ * @return The number of indices claimed. 0 on error.
+ */
+size_t
+conc_vector_size (conc_vector_t * p_vector);
+
+#endif // CONC_VECTOR_H
+
+/***   end of file   ***/
\ No newline at end of file
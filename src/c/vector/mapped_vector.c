@@ -0,0 +1,412 @@
+/*!
+ * @file mapped_vector.c
+ *
+ * @brief This file contains a value vector whose elements live in a
+ *          memory-mapped file.
+ *
+ *          Functions included are as follows:
+ *
+ *              - mapped_vector_open()
+ *              - mapped_vector_close()
+ *              - mapped_vector_reserve()
+ *              - mapped_vector_push_back()
+ *              - mapped_vector_pop_back()
+ *              - mapped_vector_at()
+ *              - mapped_vector_sync()
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "mapped_vector.h"
+
+/*!
+ * @brief This is a static function that maps the first bytes of the
+ *          vector's file, replacing any previous mapping.
+ *
+ *          The new mapping is made before the old one is removed, so the
+ *              vector is untouched on error.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ * @param[in] map_size The number of bytes to map.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+mapped_vector_map (mapped_vector_t * p_vector, const size_t map_size)
+{
+    int status = -1;
+    int prot = PROT_READ;
+    if (p_vector->b_writable)
+    {
+        prot |= PROT_WRITE;
+    }
+    void * p_map = mmap(NULL, map_size, prot, MAP_SHARED, p_vector->fd, 0);
+    if (MAP_FAILED == p_map)
+    {
+        goto EXIT;
+    }
+    
+    if (NULL != p_vector->p_header)
+    {
+        munmap(p_vector->p_header, p_vector->map_size);
+    }
+    p_vector->p_header = p_map;
+    p_vector->p_data = (unsigned char *) p_map +
+                       VALUE_VECTOR_FILE_HEADER_SIZE;
+    p_vector->map_size = map_size;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This is a static function that makes sure the vector has space
+ *          for at least one more element.
+ *
+ *          The capacity is at least doubled when it has to grow.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+mapped_vector_grow (mapped_vector_t * p_vector)
+{
+    int status = -1;
+    if (p_vector->size < p_vector->cap)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    size_t amt = p_vector->cap;
+    if (amt < (MAPPED_VECTOR_INIT_BYTES / p_vector->elem_size))
+    {
+        amt = MAPPED_VECTOR_INIT_BYTES / p_vector->elem_size;
+    }
+    if (0 == amt)
+    {
+        amt = 1;
+    }
+    status = mapped_vector_reserve(p_vector, amt);
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function opens a mapped vector, creating its file if it
+ *          is opened for writing and does not exist yet.
+ *
+ *          Opening an existing file writable clears its snapshot
+ *              checksum, since the elements may change from then on.
+ *
+ * @param[in] p_path The path of the file.
+ * @param[in] elem_size The size in bytes of a single element. Zero to
+ *              accept the size recorded in an existing file.
+ * @param[in] b_writable Whether to open the file for writing.
+ *
+ * @return Pointer to new mapped vector context. NULL on error, malformed
+ *          file or element size mismatch.
+ */
+mapped_vector_t *
+mapped_vector_open (const char * p_path,
+                    const size_t elem_size,
+                    const bool b_writable)
+{
+    int status = -1;
+    mapped_vector_t * p_vector = NULL;
+    if (NULL == p_path)
+    {
+        goto EXIT;
+    }
+    
+    p_vector = calloc(1, sizeof(mapped_vector_t));
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    p_vector->b_writable = b_writable;
+    p_vector->fd = open(p_path,
+                        b_writable ? (O_RDWR | O_CREAT | O_CLOEXEC) :
+                                     (O_RDONLY | O_CLOEXEC),
+                        0644);
+    if (-1 == p_vector->fd)
+    {
+        goto EXIT;
+    }
+    struct stat st;
+    if (0 != fstat(p_vector->fd, &st))
+    {
+        goto EXIT;
+    }
+    
+    // A new file starts out as a bare header.
+    bool b_new = (0 == st.st_size);
+    if (b_new)
+    {
+        if ((!b_writable) ||
+            (0 == elem_size) ||
+            (0 != ftruncate(p_vector->fd, VALUE_VECTOR_FILE_HEADER_SIZE)))
+        {
+            goto EXIT;
+        }
+        st.st_size = VALUE_VECTOR_FILE_HEADER_SIZE;
+    }
+    if ((st.st_size < VALUE_VECTOR_FILE_HEADER_SIZE) ||
+        (-1 == mapped_vector_map(p_vector, (size_t) st.st_size)))
+    {
+        goto EXIT;
+    }
+    if (b_new)
+    {
+        value_vector_file_init_header(p_vector->p_header, elem_size);
+    }
+    
+    value_vector_file_header_t * p_header = p_vector->p_header;
+    if ((-1 == value_vector_file_check_header(p_header,
+                                              (uint64_t) st.st_size)) ||
+        ((0 != elem_size) &&
+         (elem_size != p_header->elem_size)))
+    {
+        goto EXIT;
+    }
+    p_vector->elem_size = p_header->elem_size;
+    p_vector->size = p_header->size;
+    p_vector->cap = (p_vector->map_size - VALUE_VECTOR_FILE_HEADER_SIZE) /
+                    p_vector->elem_size;
+    if ((b_writable) &&
+        (0 != (p_header->flags & VALUE_VECTOR_FILE_CHECKSUMMED)))
+    {
+        p_header->flags &= ~VALUE_VECTOR_FILE_CHECKSUMMED;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        if ((-1 == status) &&
+            (NULL != p_vector))
+        {
+            if (NULL != p_vector->p_header)
+            {
+                munmap(p_vector->p_header, p_vector->map_size);
+            }
+            if (-1 != p_vector->fd)
+            {
+                close(p_vector->fd);
+            }
+            free(p_vector);
+            p_vector = NULL;
+        }
+        return p_vector;
+}
+
+/*!
+ * @brief This function checkpoints a writable vector, then unmaps and
+ *          closes it.
+ *
+ *          The file keeps its spare capacity, so a reopened vector can
+ *              keep growing without extending the file at once.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ *
+ * @return 0 on success, -1 if the checkpoint failed. The vector is
+ *          closed either way.
+ */
+int
+mapped_vector_close (mapped_vector_t * p_vector)
+{
+    int status = -1;
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    if (p_vector->b_writable)
+    {
+        status = mapped_vector_sync(p_vector);
+    }
+    munmap(p_vector->p_header, p_vector->map_size);
+    if (0 != close(p_vector->fd))
+    {
+        status = -1;
+    }
+    free(p_vector);
+    p_vector = NULL;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function extends the file by space for a specified number
+ *          of additional elements.
+ *
+ *          The file is extended with ftruncate, which leaves the new
+ *              space as a hole until it is written, and then mapped
+ *              again at its new size.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ * @param[in] amt The number of elements to make space for.
+ *
+ * @return 0 on success, -1 on error or read-only vector.
+ */
+int
+mapped_vector_reserve (mapped_vector_t * p_vector, const size_t amt)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (!p_vector->b_writable) ||
+        (amt > (((SIZE_MAX - VALUE_VECTOR_FILE_HEADER_SIZE) /
+                 p_vector->elem_size) - p_vector->cap)))
+    {
+        goto EXIT;
+    }
+    
+    size_t map_size = VALUE_VECTOR_FILE_HEADER_SIZE +
+                      ((p_vector->cap + amt) * p_vector->elem_size);
+    if ((0 != ftruncate(p_vector->fd, (off_t) map_size)) ||
+        (-1 == mapped_vector_map(p_vector, map_size)))
+    {
+        goto EXIT;
+    }
+    p_vector->cap += amt;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function copies an element onto the back of the vector.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ * @param[in] p_elem The element to copy in.
+ *
+ * @return 0 on success, -1 on error or read-only vector.
+ */
+int
+mapped_vector_push_back (mapped_vector_t * p_vector, const void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == p_elem) ||
+        (!p_vector->b_writable))
+    {
+        goto EXIT;
+    }
+    
+    if (-1 == mapped_vector_grow(p_vector))
+    {
+        goto EXIT;
+    }
+    memcpy(p_vector->p_data + (p_vector->size * p_vector->elem_size),
+           p_elem, p_vector->elem_size);
+    p_vector->size++;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function removes the last element from the vector.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ * @param[out] p_elem Receives a copy of the removed element. May be NULL
+ *              to discard it.
+ *
+ * @return 0 on success, -1 on error, empty or read-only vector.
+ */
+int
+mapped_vector_pop_back (mapped_vector_t * p_vector, void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (!p_vector->b_writable) ||
+        (0 == p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    p_vector->size--;
+    if (NULL != p_elem)
+    {
+        memcpy(p_elem,
+               p_vector->p_data + (p_vector->size * p_vector->elem_size),
+               p_vector->elem_size);
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function returns a pointer to the element at a specified
+ *          index in the vector.
+ *
+ * @param[in] p_vector The mapped vector context.
+ * @param[in] idx The index of the element.
+ *
+ * @return Pointer to the element in the mapping. NULL on error or index
+ *          out of range.
+ */
+void *
+mapped_vector_at (mapped_vector_t * p_vector, const size_t idx)
+{
+    void * p_elem = NULL;
+    if ((NULL == p_vector) ||
+        (idx >= p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    p_elem = p_vector->p_data + (idx * p_vector->elem_size);
+    
+    EXIT:
+        return p_elem;
+}
+
+/*!
+ * @brief This function checkpoints the vector, recording its element
+ *          count in the file and flushing the mapping to disk.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ *
+ * @return 0 on success, -1 on error or read-only vector.
+ */
+int
+mapped_vector_sync (mapped_vector_t * p_vector)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (!p_vector->b_writable))
+    {
+        goto EXIT;
+    }
+    
+    p_vector->p_header->size = p_vector->size;
+    if (0 != msync(p_vector->p_header, p_vector->map_size, MS_SYNC))
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,163 @@
+/*!
+ * @file mapped_vector.h
+ *
+ * @brief This file contains a value vector whose elements live in a
+ *          memory-mapped file.
+ *
+ *          The file uses the layout of value_vector_file.h, so the
+ *              elements are used in place and reopening a vector only
+ *              maps the file. Pages are read in as they are touched
+ *              instead of the whole vector being rebuilt. The vector may
+ *              be larger than physical memory, and value_vector_save
+ *              snapshots may be opened the same way.
+ *
+ *          The file grows geometrically by extending it and mapping it
+ *              again, so pointers returned by mapped_vector_at are
+ *              invalidated by any call that adds elements.
+ *
+ *          The element count in the file is only updated when the vector
+ *              is checkpointed with mapped_vector_sync or closed. If the
+ *              process dies in between, reopening the file yields the
+ *              vector as of the last checkpoint.
+ *
+ *          Functions included are as follows:
+ *
+ *              - mapped_vector_open()
+ *              - mapped_vector_close()
+ *              - mapped_vector_reserve()
+ *              - mapped_vector_push_back()
+ *              - mapped_vector_pop_back()
+ *              - mapped_vector_at()
+ *              - mapped_vector_sync()
+ */
+
+#ifndef MAPPED_VECTOR_H
+#define MAPPED_VECTOR_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "src/c/vector/value_vector_file.h"
+
+/*** Bytes of elements allocated by the first automatic growth. ***/
+#define MAPPED_VECTOR_INIT_BYTES (64 * 1024)
+
+/*!
+ * @brief This datatype defines a mapped vector context.
+ *
+ * @param p_data The mapped elements.
+ * @param elem_size The size in bytes of a single element.
+ * @param size The number of elements in the vector.
+ * @param cap The number of elements the file has space for.
+ * @param p_header The mapped file header.
+ * @param map_size The size in bytes of the mapping and the file.
+ * @param fd The file descriptor of the backing file.
+ * @param b_writable Whether the file was opened for writing.
+ */
+typedef struct _mapped_vector
+{
+    unsigned char *              p_data;
+    size_t                       elem_size;
+    size_t                       size;
+    size_t                       cap;
+    value_vector_file_header_t * p_header;
+    size_t                       map_size;
+    int                          fd;
+    bool                         b_writable;
+} mapped_vector_t;
+
+/*!
+ * @brief This function opens a mapped vector, creating its file if it
+ *          is opened for writing and does not exist yet.
+ *
+ *          The checksum of a snapshot is not verified, as that would read
+ *              the whole file. Use value_vector_load for a verified copy.
+ *
+ * @param[in] p_path The path of the file.
+ * @param[in] elem_size The size in bytes of a single element. Zero to
+ *              accept the size recorded in an existing file.
+ * @param[in] b_writable Whether to open the file for writing.
+ *
+ * @return Pointer to new mapped vector context. NULL on error, malformed
+ *          file or element size mismatch.
+ */
+mapped_vector_t *
+mapped_vector_open (const char * p_path,
+                    const size_t elem_size,
+                    const bool b_writable);
+
+/*!
+ * @brief This function checkpoints a writable vector, then unmaps and
+ *          closes it.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ *
+ * @return 0 on success, -1 if the checkpoint failed. The vector is
+ *          closed either way.
+ */
+int
+mapped_vector_close (mapped_vector_t * p_vector);
+
+/*!
+ * @brief This function extends the file by space for a specified number
+ *          of additional elements.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ * @param[in] amt The number of elements to make space for.
+ *
+ * @return 0 on success, -1 on error or read-only vector.
+ */
+int
+mapped_vector_reserve (mapped_vector_t * p_vector, const size_t amt);
+
+/*!
+ * @brief This function copies an element onto the back of the vector.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ * @param[in] p_elem The element to copy in.
+ *
+ * @return 0 on success, -1 on error or read-only vector.
+ */
+int
+mapped_vector_push_back (mapped_vector_t * p_vector, const void * p_elem);
+
+/*!
+ * @brief This function removes the last element from the vector.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ * @param[out] p_elem Receives a copy of the removed element. May be NULL
+ *              to discard it.
+ *
+ * @return 0 on success, -1 on error, empty or read-only vector.
+ */
+int
+mapped_vector_pop_back (mapped_vector_t * p_vector, void * p_elem);
+
+/*!
+ * @brief This function returns a pointer to the element at a specified
+ *          index in the vector.
+ *
+ * @param[in] p_vector The mapped vector context.
+ * @param[in] idx The index of the element.
+ *
+ * @return Pointer to the element in the mapping. It may only be written
+ *          if the vector is writable. NULL on error or index out of
+ *          range.
+ */
+void *
+mapped_vector_at (mapped_vector_t * p_vector, const size_t idx);
+
+/*!
+ * @brief This function checkpoints the vector, recording its element
+ *          count in the file and flushing the mapping to disk.
+ *
+ * @param[in/out] p_vector The mapped vector context.
+ *
+ * @return 0 on success, -1 on error or read-only vector.
+ */
+int
+mapped_vector_sync (mapped_vector_t * p_vector);
+
+#endif // MAPPED_VECTOR_H
+
+/***   end of file   ***/
\ No newline at end of file
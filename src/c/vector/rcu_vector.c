@@ -0,0 +1,403 @@
+/*!
+ * @file rcu_vector.c
+ *
+ * @brief This file contains a read-mostly vector that readers access
+ *          through snapshots without taking a lock.
+ *
+ *          Functions included are as follows:
+ *
+ *              - rcu_vector_create()
+ *              - rcu_vector_destroy()
+ *              - rcu_vector_register()
+ *              - rcu_vector_unregister()
+ *              - rcu_vector_read_lock()
+ *              - rcu_vector_read_unlock()
+ *              - rcu_vector_update()
+ *              - rcu_vector_publish()
+ *              - rcu_vector_synchronize()
+ */
+
+#include <stdbool.h>
+#include <sched.h>
+
+#include "rcu_vector.h"
+
+/*!
+ * @brief This is a static function that finds the oldest epoch recorded
+ *          by a reader inside its read-side section.
+ *
+ * @param[in] p_rcu The read-mostly vector context.
+ *
+ * @return The oldest epoch. UINT64_MAX if no reader is inside.
+ */
+static uint64_t
+rcu_vector_min_epoch (rcu_vector_t * p_rcu)
+{
+    uint64_t min = UINT64_MAX;
+    for (size_t idx = 0; idx < RCU_VECTOR_MAX_READERS; ++idx)
+    {
+        uint64_t epoch = atomic_load(&(p_rcu->readers[idx].epoch));
+        if ((RCU_VECTOR_QUIESCENT != epoch) &&
+            (epoch < min))
+        {
+            min = epoch;
+        }
+    }
+    return min;
+}
+
+/*!
+ * @brief This is a static function that frees the retired versions no
+ *          reader can still see. The caller holds the mutex.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ *
+ * @return No return value expected.
+ */
+static void
+rcu_vector_reclaim (rcu_vector_t * p_rcu)
+{
+    uint64_t min = rcu_vector_min_epoch(p_rcu);
+    rcu_vector_retired_t ** pp_link = &(p_rcu->p_retired);
+    while (NULL != *pp_link)
+    {
+        rcu_vector_retired_t * p_retired = *pp_link;
+        if (p_retired->epoch > min)
+        {
+            pp_link = &(p_retired->p_next);
+            continue;
+        }
+        *pp_link = p_retired->p_next;
+        vector_destroy(p_retired->p_vector);
+        free(p_retired);
+    }
+}
+
+/*!
+ * @brief This is a static function that publishes a new version and
+ *          retires the old one. The caller holds the mutex.
+ *
+ *          The epoch is advanced after the exchange, so a reader that
+ *              records the new epoch is certain to load the new version.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ * @param[in/out] p_vector The new version.
+ *
+ * @return 0 on success, -1 on error. Nothing is published on error.
+ */
+static int
+rcu_vector_publish_locked (rcu_vector_t * p_rcu, vector_t * p_vector)
+{
+    int status = -1;
+    rcu_vector_retired_t * p_retired = malloc(sizeof(rcu_vector_retired_t));
+    if (NULL == p_retired)
+    {
+        goto EXIT;
+    }
+    
+    p_retired->p_vector = atomic_exchange(&(p_rcu->p_current), p_vector);
+    p_retired->epoch = atomic_fetch_add(&(p_rcu->epoch), 1) + 1;
+    p_retired->p_next = p_rcu->p_retired;
+    p_rcu->p_retired = p_retired;
+    rcu_vector_reclaim(p_rcu);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function instantiates a new empty read-mostly vector.
+ *
+ * @return Pointer to new read-mostly vector context. NULL on error.
+ */
+rcu_vector_t *
+rcu_vector_create (void)
+{
+    rcu_vector_t * p_rcu = calloc(1, sizeof(rcu_vector_t));
+    if (NULL == p_rcu)
+    {
+        goto EXIT;
+    }
+    
+    vector_t * p_vector = vector_create();
+    if (NULL == p_vector)
+    {
+        free(p_rcu);
+        p_rcu = NULL;
+        goto EXIT;
+    }
+    if (0 != pthread_mutex_init(&(p_rcu->mutex), NULL))
+    {
+        vector_destroy(p_vector);
+        free(p_rcu);
+        p_rcu = NULL;
+        goto EXIT;
+    }
+    for (size_t idx = 0; idx < RCU_VECTOR_MAX_READERS; ++idx)
+    {
+        atomic_init(&(p_rcu->readers[idx].epoch), RCU_VECTOR_QUIESCENT);
+        atomic_init(&(p_rcu->readers[idx].b_used), false);
+    }
+    atomic_init(&(p_rcu->p_current), p_vector);
+    atomic_init(&(p_rcu->epoch), RCU_VECTOR_QUIESCENT + 1);
+    p_rcu->p_retired = NULL;
+    
+    EXIT:
+        return p_rcu;
+}
+
+/*!
+ * @brief This function destroys a read-mostly vector context along with
+ *          every version of the vector.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ *
+ * @return No return value expected.
+ */
+void
+rcu_vector_destroy (rcu_vector_t * p_rcu)
+{
+    if (NULL == p_rcu)
+    {
+        goto EXIT;
+    }
+    
+    while (NULL != p_rcu->p_retired)
+    {
+        rcu_vector_retired_t * p_next = p_rcu->p_retired->p_next;
+        vector_destroy(p_rcu->p_retired->p_vector);
+        free(p_rcu->p_retired);
+        p_rcu->p_retired = p_next;
+    }
+    vector_destroy(atomic_load(&(p_rcu->p_current)));
+    pthread_mutex_destroy(&(p_rcu->mutex));
+    free(p_rcu);
+    p_rcu = NULL;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function claims a reader slot for the calling thread.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ *
+ * @return Pointer to the reader slot. NULL on error or if every slot is
+ *          taken.
+ */
+rcu_vector_reader_t *
+rcu_vector_register (rcu_vector_t * p_rcu)
+{
+    rcu_vector_reader_t * p_reader = NULL;
+    if (NULL == p_rcu)
+    {
+        goto EXIT;
+    }
+    
+    for (size_t idx = 0; idx < RCU_VECTOR_MAX_READERS; ++idx)
+    {
+        bool b_used = false;
+        if (atomic_compare_exchange_strong(&(p_rcu->readers[idx].b_used),
+                                           &b_used, true))
+        {
+            p_reader = &(p_rcu->readers[idx]);
+            break;
+        }
+    }
+    
+    EXIT:
+        return p_reader;
+}
+
+/*!
+ * @brief This function releases a reader slot.
+ *
+ * @param[in/out] p_reader The reader slot.
+ *
+ * @return No return value expected.
+ */
+void
+rcu_vector_unregister (rcu_vector_reader_t * p_reader)
+{
+    if (NULL == p_reader)
+    {
+        goto EXIT;
+    }
+    
+    atomic_store_explicit(&(p_reader->epoch), RCU_VECTOR_QUIESCENT,
+                          memory_order_release);
+    atomic_store_explicit(&(p_reader->b_used), false, memory_order_release);
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function enters a read-side section and returns the current
+ *          version of the vector.
+ *
+ *          The epoch is recorded before the version is loaded, with a
+ *              full fence in between. A writer that misses the recorded
+ *              epoch must therefore have published before the load, so
+ *              the reader sees the new version and the old one is safe
+ *              to free. An out of date epoch only delays reclamation.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ * @param[in/out] p_reader The calling thread's reader slot.
+ *
+ * @return Pointer to the current version. NULL on error.
+ */
+const vector_t *
+rcu_vector_read_lock (rcu_vector_t * p_rcu, rcu_vector_reader_t * p_reader)
+{
+    const vector_t * p_vector = NULL;
+    if ((NULL == p_rcu) ||
+        (NULL == p_reader))
+    {
+        goto EXIT;
+    }
+    
+    atomic_store(&(p_reader->epoch),
+                 atomic_load_explicit(&(p_rcu->epoch),
+                                      memory_order_acquire));
+    p_vector = atomic_load(&(p_rcu->p_current));
+    
+    EXIT:
+        return p_vector;
+}
+
+/*!
+ * @brief This function leaves a read-side section.
+ *
+ * @param[in/out] p_reader The calling thread's reader slot.
+ *
+ * @return No return value expected.
+ */
+void
+rcu_vector_read_unlock (rcu_vector_reader_t * p_reader)
+{
+    if (NULL == p_reader)
+    {
+        goto EXIT;
+    }
+    
+    atomic_store_explicit(&(p_reader->epoch), RCU_VECTOR_QUIESCENT,
+                          memory_order_release);
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function changes the vector by copying the current version,
+ *          applying a function to the copy and publishing it.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ * @param[in] update_func The function changing the copy.
+ * @param[in/out] p_arg The argument passed to update_func.
+ *
+ * @return 0 on success, -1 on error or if update_func discarded the copy.
+ */
+int
+rcu_vector_update (rcu_vector_t * p_rcu,
+                   rcu_vector_update_f update_func,
+                   void * p_arg)
+{
+    int status = -1;
+    vector_t * p_copy = NULL;
+    if ((NULL == p_rcu) ||
+        (NULL == update_func))
+    {
+        goto EXIT;
+    }
+    
+    pthread_mutex_lock(&(p_rcu->mutex));
+    vector_t * p_current = atomic_load_explicit(&(p_rcu->p_current),
+                                                memory_order_relaxed);
+    p_copy = vector_create();
+    if ((NULL != p_copy) &&
+        ((0 == p_current->size) ||
+         (0 == vector_append_n(p_copy, p_current->pp_data,
+                               p_current->size))) &&
+        (0 == update_func(p_copy, p_arg)) &&
+        (0 == rcu_vector_publish_locked(p_rcu, p_copy)))
+    {
+        p_copy = NULL;
+        status = 0;
+    }
+    pthread_mutex_unlock(&(p_rcu->mutex));
+    
+    EXIT:
+        vector_destroy(p_copy);
+        return status;
+}
+
+/*!
+ * @brief This function replaces the vector with a new version.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ * @param[in/out] p_vector The new version.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+rcu_vector_publish (rcu_vector_t * p_rcu, vector_t * p_vector)
+{
+    int status = -1;
+    if ((NULL == p_rcu) ||
+        (NULL == p_vector))
+    {
+        goto EXIT;
+    }
+    
+    pthread_mutex_lock(&(p_rcu->mutex));
+    status = rcu_vector_publish_locked(p_rcu, p_vector);
+    pthread_mutex_unlock(&(p_rcu->mutex));
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function waits until no reader can still see a version
+ *          replaced before the call, then frees those versions.
+ *
+ *          Every version retired so far was retired at or before the
+ *              current epoch, so it is enough to wait until no reader
+ *              records an older one. The wait reads only the reader
+ *              slots, so the mutex is not held while waiting and writers
+ *              are never stalled behind a slow reader.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+rcu_vector_synchronize (rcu_vector_t * p_rcu)
+{
+    int status = -1;
+    if (NULL == p_rcu)
+    {
+        goto EXIT;
+    }
+    
+    uint64_t epoch = atomic_load(&(p_rcu->epoch));
+    while (rcu_vector_min_epoch(p_rcu) < epoch)
+    {
+        sched_yield();
+    }
+    
+    pthread_mutex_lock(&(p_rcu->mutex));
+    rcu_vector_reclaim(p_rcu);
+    pthread_mutex_unlock(&(p_rcu->mutex));
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,237 @@
+/*!
+ * @file rcu_vector.h
+ *
+ * @brief This file contains a read-mostly vector that readers access
+ *          through snapshots without taking a lock.
+ *
+ *          The vector is held as an immutable vector_t. A writer copies
+ *              it, changes the copy and publishes the copy with a single
+ *              atomic exchange, so a reader always sees either the old
+ *              or the new version in full. Readers only write to a slot
+ *              of their own, so reads scale across cores.
+ *
+ *          Replaced versions are reclaimed by epoch. A reader entering
+ *              its read-side section records the current epoch in its
+ *              slot, and a writer advances the epoch after publishing.
+ *              A replaced version is freed once no reader still records
+ *              an epoch from before it was replaced. Writers reclaim
+ *              what they can on every update without waiting, and
+ *              rcu_vector_synchronize waits until everything retired
+ *              before it was called has been freed.
+ *
+ *          Like vector_t, the vector holds references. Data referenced
+ *              only by a replaced version must not be freed by the
+ *              client until rcu_vector_synchronize has returned.
+ *
+ *          Functions included are as follows:
+ *
+ *              - rcu_vector_create()
+ *              - rcu_vector_destroy()
+ *              - rcu_vector_register()
+ *              - rcu_vector_unregister()
+ *              - rcu_vector_read_lock()
+ *              - rcu_vector_read_unlock()
+ *              - rcu_vector_update()
+ *              - rcu_vector_publish()
+ *              - rcu_vector_synchronize()
+ */
+
+#ifndef RCU_VECTOR_H
+#define RCU_VECTOR_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "src/c/cache_line/cache_line.h"
+#include "src/c/vector/vector.h"
+
+/*** Number of threads that may be registered as readers at once. ***/
+#define RCU_VECTOR_MAX_READERS 128
+
+/*** Epoch recorded by a reader outside its read-side section. ***/
+#define RCU_VECTOR_QUIESCENT 0
+
+/*!
+ * @brief This datatype defines a function template for changing a copy
+ *          of the vector during an update.
+ *
+ * @param p_vector The private copy to change.
+ * @param p_arg The argument passed to rcu_vector_update.
+ *
+ * @return 0 to publish the copy, -1 to discard it.
+ */
+typedef int (*rcu_vector_update_f)(vector_t * p_vector, void * p_arg);
+
+/*!
+ * @brief This datatype defines a reader slot. Each slot has a cache line
+ *          of its own.
+ *
+ * @param epoch The epoch the reader entered its read-side section in, or
+ *          RCU_VECTOR_QUIESCENT.
+ * @param b_used Whether a thread has registered the slot.
+ */
+typedef struct _rcu_vector_reader
+{
+    _Atomic uint64_t epoch;
+    atomic_bool      b_used;
+    char             pad[CACHE_LINE_SIZE - sizeof(uint64_t) -
+                         sizeof(atomic_bool)];
+} rcu_vector_reader_t;
+
+/*!
+ * @brief This datatype defines a version of the vector waiting to be
+ *          freed.
+ *
+ * @param p_vector The replaced version.
+ * @param epoch The epoch readers must have reached before it is freed.
+ * @param p_next The next retired version.
+ */
+typedef struct _rcu_vector_retired
+{
+    vector_t *                   p_vector;
+    uint64_t                     epoch;
+    struct _rcu_vector_retired * p_next;
+} rcu_vector_retired_t;
+
+/*!
+ * @brief This datatype defines a read-mostly vector context.
+ *
+ * @param readers The reader slots.
+ * @param p_current The current version.
+ * @param epoch The current epoch.
+ * @param mutex The lock serialising writers.
+ * @param p_retired The replaced versions not yet freed. Guarded by mutex.
+ */
+typedef struct _rcu_vector
+{
+    rcu_vector_reader_t    readers[RCU_VECTOR_MAX_READERS];
+    _Atomic(vector_t *)    p_current;
+    _Atomic uint64_t       epoch;
+    pthread_mutex_t        mutex;
+    rcu_vector_retired_t * p_retired;
+} rcu_vector_t;
+
+/*!
+ * @brief This function instantiates a new empty read-mostly vector.
+ *
+ * @return Pointer to new read-mostly vector context. NULL on error.
+ */
+rcu_vector_t *
+rcu_vector_create (void);
+
+/*!
+ * @brief This function destroys a read-mostly vector context along with
+ *          every version of the vector.
+ *
+ *          No other thread may access the vector during or after this
+ *              call. Data referenced by the vector is not freed.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ *
+ * @return No return value expected.
+ */
+void
+rcu_vector_destroy (rcu_vector_t * p_rcu);
+
+/*!
+ * @brief This function claims a reader slot for the calling thread.
+ *
+ *          A thread registers once and reuses its slot for every read.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ *
+ * @return Pointer to the reader slot. NULL on error or if every slot is
+ *          taken.
+ */
+rcu_vector_reader_t *
+rcu_vector_register (rcu_vector_t * p_rcu);
+
+/*!
+ * @brief This function releases a reader slot.
+ *
+ * @param[in/out] p_reader The reader slot. It must be outside its
+ *              read-side section.
+ *
+ * @return No return value expected.
+ */
+void
+rcu_vector_unregister (rcu_vector_reader_t * p_reader);
+
+/*!
+ * @brief This function enters a read-side section and returns the current
+ *          version of the vector.
+ *
+ *          The version stays valid, and unchanged, until the matching
+ *              rcu_vector_read_unlock. It is returned const, since other
+ *              readers share it, and is read with the const accessors
+ *              such as vector_at and vector_find or through pp_data.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ * @param[in/out] p_reader The calling thread's reader slot.
+ *
+ * @return Pointer to the current version. NULL on error.
+ */
+const vector_t *
+rcu_vector_read_lock (rcu_vector_t * p_rcu, rcu_vector_reader_t * p_reader);
+
+/*!
+ * @brief This function leaves a read-side section.
+ *
+ * @param[in/out] p_reader The calling thread's reader slot.
+ *
+ * @return No return value expected.
+ */
+void
+rcu_vector_read_unlock (rcu_vector_reader_t * p_reader);
+
+/*!
+ * @brief This function changes the vector by copying the current version,
+ *          applying a function to the copy and publishing it.
+ *
+ *          Writers are serialised, so concurrent updates are never lost.
+ *              The function must not enter a read-side section on the
+ *              same vector.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ * @param[in] update_func The function changing the copy.
+ * @param[in/out] p_arg The argument passed to update_func.
+ *
+ * @return 0 on success, -1 on error or if update_func discarded the copy.
+ */
+int
+rcu_vector_update (rcu_vector_t * p_rcu,
+                   rcu_vector_update_f update_func,
+                   void * p_arg);
+
+/*!
+ * @brief This function replaces the vector with a new version.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ * @param[in/out] p_vector The new version, created with vector_create. The
+ *              read-mostly vector takes ownership of it on success.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+rcu_vector_publish (rcu_vector_t * p_rcu, vector_t * p_vector);
+
+/*!
+ * @brief This function waits until no reader can still see a version
+ *          replaced before the call, then frees those versions.
+ *
+ *          Writers are not held off while waiting. Versions they replace
+ *              in the meantime may be left for a later call. It must not
+ *              be called from within a read-side section.
+ *
+ * @param[in/out] p_rcu The read-mostly vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+rcu_vector_synchronize (rcu_vector_t * p_rcu);
+
+#endif // RCU_VECTOR_H
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,339 @@
+/*!
+ * @file seg_vector.c
+ *
+ * @brief This file contains a segmented vector that stores elements by
+ *          value and never moves them once added.
+ *
+ *          Functions included are as follows:
+ *
+ *              - seg_vector_create()
+ *              - seg_vector_create_with_allocator()
+ *              - seg_vector_destroy()
+ *              - seg_vector_reserve()
+ *              - seg_vector_push_back()
+ *              - seg_vector_pop_back()
+ *              - seg_vector_at()
+ *              - seg_vector_shrink_to_fit()
+ */
+
+#include <string.h>
+
+#include "seg_vector.h"
+
+/*!
+ * @brief This is a static function that returns the number of elements
+ *          a block holds.
+ *
+ * @param[in] block The index of the block.
+ *
+ * @return The number of elements.
+ */
+static inline size_t
+seg_vector_block_cap (const size_t block)
+{
+    return SEG_VECTOR_FIRST_CAP << block;
+}
+
+/*!
+ * @brief This is a static function that returns the address of the
+ *          element at an index.
+ *
+ *          Blocks 0 to k - 1 hold SEG_VECTOR_FIRST_CAP * (2^k - 1)
+ *              elements between them, so adding SEG_VECTOR_FIRST_CAP to
+ *              an index and dividing by it yields a number whose highest
+ *              set bit is the index's block.
+ *
+ * @param[in] p_vector The segmented vector context.
+ * @param[in] idx The index of the element. Less than the capacity.
+ *
+ * @return Pointer to the element.
+ */
+static inline unsigned char *
+seg_vector_locate (seg_vector_t * p_vector, const size_t idx)
+{
+    unsigned long long slot = (idx >> SEG_VECTOR_FIRST_SHIFT) + 1;
+    size_t block = ((sizeof(slot) * 8) - 1) - __builtin_clzll(slot);
+    size_t offset = (idx + SEG_VECTOR_FIRST_CAP) -
+                    seg_vector_block_cap(block);
+    return p_vector->pp_blocks[block] + (offset * p_vector->elem_size);
+}
+
+/*!
+ * @brief This is a static function that frees the blocks past a given
+ *          number.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ * @param[in] num_blocks The number of blocks to keep.
+ *
+ * @return No return value expected.
+ */
+static void
+seg_vector_release (seg_vector_t * p_vector, const size_t num_blocks)
+{
+    while (p_vector->num_blocks > num_blocks)
+    {
+        size_t block = p_vector->num_blocks - 1;
+        size_t block_cap = seg_vector_block_cap(block);
+        allocator_free(p_vector->p_alloc, p_vector->pp_blocks[block],
+                       block_cap * p_vector->elem_size);
+        p_vector->pp_blocks[block] = NULL;
+        p_vector->num_blocks--;
+        p_vector->cap -= block_cap;
+    }
+}
+
+/*!
+ * @brief This function instantiates a new segmented vector context.
+ *
+ * @param[in] elem_size The size in bytes of a single element.
+ *
+ * @return Pointer to new segmented vector context. NULL on error.
+ */
+seg_vector_t *
+seg_vector_create (const size_t elem_size)
+{
+    return seg_vector_create_with_allocator(elem_size, NULL);
+}
+
+/*!
+ * @brief This function instantiates a new segmented vector context that
+ *          allocates through a given allocator.
+ *
+ * @param[in] elem_size The size in bytes of a single element.
+ * @param[in] p_alloc The allocator for the context and its blocks. NULL
+ *              for the standard library.
+ *
+ * @return Pointer to new segmented vector context. NULL on error.
+ */
+seg_vector_t *
+seg_vector_create_with_allocator (const size_t elem_size,
+                                  const allocator_t * p_alloc)
+{
+    seg_vector_t * p_vector = NULL;
+    if (0 == elem_size)
+    {
+        goto EXIT;
+    }
+    
+    p_vector = allocator_calloc(p_alloc, 1, sizeof(seg_vector_t));
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    p_vector->elem_size = elem_size;
+    p_vector->size = 0;
+    p_vector->cap = 0;
+    p_vector->num_blocks = 0;
+    p_vector->p_alloc = p_alloc;
+    
+    EXIT:
+        return p_vector;
+}
+
+/*!
+ * @brief This function destroys a segmented vector context along with the
+ *          elements it holds.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ *
+ * @return No return value expected.
+ */
+void
+seg_vector_destroy (seg_vector_t * p_vector)
+{
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    seg_vector_release(p_vector, 0);
+    allocator_free(p_vector->p_alloc, p_vector, sizeof(seg_vector_t));
+    p_vector = NULL;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function allocates blocks until the vector has space for
+ *          a specified number of additional elements.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ * @param[in] amt The number of elements to make space for.
+ *
+ * @return 0 on success, -1 on error. The vector is unchanged on error.
+ */
+int
+seg_vector_reserve (seg_vector_t * p_vector, const size_t amt)
+{
+    int status = -1;
+    size_t num_blocks = 0;
+    if ((NULL == p_vector) ||
+        (amt > (SIZE_MAX - p_vector->size)))
+    {
+        goto EXIT;
+    }
+    
+    num_blocks = p_vector->num_blocks;
+    while ((p_vector->cap - p_vector->size) < amt)
+    {
+        size_t block = p_vector->num_blocks;
+        if (block >= SEG_VECTOR_MAX_BLOCKS)
+        {
+            goto EXIT;
+        }
+        size_t block_cap = seg_vector_block_cap(block);
+        if (block_cap > (SIZE_MAX / p_vector->elem_size))
+        {
+            goto EXIT;
+        }
+        unsigned char * p_block = allocator_alloc(p_vector->p_alloc,
+                                                  block_cap *
+                                                  p_vector->elem_size);
+        if (NULL == p_block)
+        {
+            goto EXIT;
+        }
+        p_vector->pp_blocks[block] = p_block;
+        p_vector->num_blocks++;
+        p_vector->cap += block_cap;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        // Release the blocks a failed reservation allocated.
+        if ((-1 == status) &&
+            (NULL != p_vector))
+        {
+            seg_vector_release(p_vector, num_blocks);
+        }
+        return status;
+}
+
+/*!
+ * @brief This function copies an element onto the back of the vector.
+ *
+ *          When the vector is full, exactly one block is allocated. No
+ *              existing element is copied.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ * @param[in] p_elem The element to copy in.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+seg_vector_push_back (seg_vector_t * p_vector, const void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == p_elem))
+    {
+        goto EXIT;
+    }
+    
+    if ((p_vector->size == p_vector->cap) &&
+        (-1 == seg_vector_reserve(p_vector, 1)))
+    {
+        goto EXIT;
+    }
+    memcpy(seg_vector_locate(p_vector, p_vector->size), p_elem,
+           p_vector->elem_size);
+    p_vector->size++;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function removes the last element from the vector.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ * @param[out] p_elem Receives a copy of the removed element. May be NULL
+ *              to discard it.
+ *
+ * @return 0 on success, -1 on error or empty vector.
+ */
+int
+seg_vector_pop_back (seg_vector_t * p_vector, void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (0 == p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    p_vector->size--;
+    if (NULL != p_elem)
+    {
+        memcpy(p_elem, seg_vector_locate(p_vector, p_vector->size),
+               p_vector->elem_size);
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function returns a pointer to the element at a specified
+ *          index in the vector.
+ *
+ * @param[in] p_vector The segmented vector context.
+ * @param[in] idx The index of the element.
+ *
+ * @return Pointer to the element. NULL on error or index out of range.
+ */
+void *
+seg_vector_at (seg_vector_t * p_vector, const size_t idx)
+{
+    void * p_elem = NULL;
+    if ((NULL == p_vector) ||
+        (idx >= p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    p_elem = seg_vector_locate(p_vector, idx);
+    
+    EXIT:
+        return p_elem;
+}
+
+/*!
+ * @brief This function frees the blocks that hold no elements.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+seg_vector_shrink_to_fit (seg_vector_t * p_vector)
+{
+    int status = -1;
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    // Keep the fewest blocks that hold every element.
+    size_t num_blocks = 0;
+    size_t cap = 0;
+    while (cap < p_vector->size)
+    {
+        cap += seg_vector_block_cap(num_blocks);
+        num_blocks++;
+    }
+    seg_vector_release(p_vector, num_blocks);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
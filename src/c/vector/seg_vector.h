@@ -0,0 +1,170 @@
+/*!
+ * @file seg_vector.h
+ *
+ * @brief This file contains a segmented vector that stores elements by
+ *          value and never moves them once added.
+ *
+ *          Elements are stored in blocks whose sizes double from one
+ *              block to the next, starting at SEG_VECTOR_FIRST_CAP. A
+ *              fixed directory inside the context points at the blocks.
+ *              Growing the vector allocates one new block and copies
+ *              nothing, so the cost of an append is bounded, and a
+ *              pointer to an element stays valid until that element is
+ *              removed or the vector is destroyed.
+ *
+ *          Block k holds SEG_VECTOR_FIRST_CAP << k elements, so the block
+ *              and offset of an index follow from its highest set bit,
+ *              and seg_vector_at is O(1).
+ *
+ *          Functions included are as follows:
+ *
+ *              - seg_vector_create()
+ *              - seg_vector_create_with_allocator()
+ *              - seg_vector_destroy()
+ *              - seg_vector_reserve()
+ *              - seg_vector_push_back()
+ *              - seg_vector_pop_back()
+ *              - seg_vector_at()
+ *              - seg_vector_shrink_to_fit()
+ */
+
+#ifndef SEG_VECTOR_H
+#define SEG_VECTOR_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "src/c/allocator/allocator.h"
+
+/*** Base two logarithm of the number of elements in the first block. ***/
+#define SEG_VECTOR_FIRST_SHIFT 4
+
+/*** Number of elements in the first block. ***/
+#define SEG_VECTOR_FIRST_CAP ((size_t) 1 << SEG_VECTOR_FIRST_SHIFT)
+
+/*** Number of directory entries, enough to index any size_t. ***/
+#define SEG_VECTOR_MAX_BLOCKS ((sizeof(size_t) * 8) - SEG_VECTOR_FIRST_SHIFT)
+
+/*!
+ * @brief This datatype defines a segmented vector context.
+ *
+ * @param pp_blocks The directory of blocks. Only the first num_blocks
+ *          entries are allocated.
+ * @param elem_size The size in bytes of a single element.
+ * @param size The number of elements in the vector.
+ * @param cap The number of elements the allocated blocks hold.
+ * @param num_blocks The number of allocated blocks.
+ * @param p_alloc The allocator for the context and its blocks. NULL for
+ *          the standard library.
+ */
+typedef struct _seg_vector
+{
+    unsigned char *     pp_blocks[SEG_VECTOR_MAX_BLOCKS];
+    size_t              elem_size;
+    size_t              size;
+    size_t              cap;
+    size_t              num_blocks;
+    const allocator_t * p_alloc;
+} seg_vector_t;
+
+/*!
+ * @brief This function instantiates a new segmented vector context.
+ *
+ *          No block is allocated until the first element is added.
+ *
+ * @param[in] elem_size The size in bytes of a single element.
+ *
+ * @return Pointer to new segmented vector context. NULL on error.
+ */
+seg_vector_t *
+seg_vector_create (const size_t elem_size);
+
+/*!
+ * @brief This function instantiates a new segmented vector context that
+ *          allocates through a given allocator.
+ *
+ * @param[in] elem_size The size in bytes of a single element.
+ * @param[in] p_alloc The allocator for the context and its blocks. NULL
+ *              for the standard library.
+ *
+ * @return Pointer to new segmented vector context. NULL on error.
+ */
+seg_vector_t *
+seg_vector_create_with_allocator (const size_t elem_size,
+                                  const allocator_t * p_alloc);
+
+/*!
+ * @brief This function destroys a segmented vector context along with the
+ *          elements it holds.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ *
+ * @return No return value expected.
+ */
+void
+seg_vector_destroy (seg_vector_t * p_vector);
+
+/*!
+ * @brief This function allocates blocks until the vector has space for
+ *          a specified number of additional elements.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ * @param[in] amt The number of elements to make space for.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+seg_vector_reserve (seg_vector_t * p_vector, const size_t amt);
+
+/*!
+ * @brief This function copies an element onto the back of the vector.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ * @param[in] p_elem The element to copy in.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+seg_vector_push_back (seg_vector_t * p_vector, const void * p_elem);
+
+/*!
+ * @brief This function removes the last element from the vector.
+ *
+ *          The block it occupied is kept for reuse.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ * @param[out] p_elem Receives a copy of the removed element. May be NULL
+ *              to discard it.
+ *
+ * @return 0 on success, -1 on error or empty vector.
+ */
+int
+seg_vector_pop_back (seg_vector_t * p_vector, void * p_elem);
+
+/*!
+ * @brief This function returns a pointer to the element at a specified
+ *          index in the vector.
+ *
+ * @param[in] p_vector The segmented vector context.
+ * @param[in] idx The index of the element.
+ *
+ * @return Pointer to the element, which may be read or written in place
+ *          and stays valid while the element is in the vector. NULL on
+ *          error or index out of range.
+ */
+void *
+seg_vector_at (seg_vector_t * p_vector, const size_t idx);
+
+/*!
+ * @brief This function frees the blocks that hold no elements.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+seg_vector_shrink_to_fit (seg_vector_t * p_vector);
+
+#endif // SEG_VECTOR_H
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,352 @@
+/*!
+ * @file value_vector.c
+ *
+ * @brief This file contains a generic vector implementation that stores
+ *          elements by value.
+ *
+ *          Functions included are as follows:
+ *
+ *              - value_vector_create()
+ *              - value_vector_create_with_allocator()
+ *              - value_vector_destroy()
+ *              - value_vector_reserve()
+ *              - value_vector_push_back()
+ *              - value_vector_pop_back()
+ *              - value_vector_at()
+ *              - value_vector_insert()
+ *              - value_vector_erase()
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include "value_vector.h"
+
+/*!
+ * @brief This is a static function that makes sure the vector has space
+ *          for at least one more element.
+ *
+ *          The capacity is at least doubled when it has to grow.
+ *
+ * @param[in/out] p_vector The value vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+value_vector_grow (value_vector_t * p_vector)
+{
+    int status = -1;
+    if (p_vector->size < p_vector->cap)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    size_t amt = p_vector->cap;
+    if (amt < VALUE_VECTOR_INIT_CAP)
+    {
+        amt = VALUE_VECTOR_INIT_CAP;
+    }
+    status = value_vector_reserve(p_vector, amt);
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function instantiates a new value vector context.
+ *
+ * @param[in] elem_size The size in bytes of a single element.
+ *
+ * @return Pointer to new value vector context. NULL on error.
+ */
+value_vector_t *
+value_vector_create (const size_t elem_size)
+{
+    return value_vector_create_with_allocator(elem_size, NULL);
+}
+
+/*!
+ * @brief This function instantiates a new value vector context that
+ *          allocates through a given allocator.
+ *
+ * @param[in] elem_size The size in bytes of a single element.
+ * @param[in] p_alloc The allocator for the context and its array. NULL
+ *              for the standard library.
+ *
+ * @return Pointer to new value vector context. NULL on error.
+ */
+value_vector_t *
+value_vector_create_with_allocator (const size_t elem_size,
+                                    const allocator_t * p_alloc)
+{
+    value_vector_t * p_vector = NULL;
+    if (0 == elem_size)
+    {
+        goto EXIT;
+    }
+    
+    p_vector = allocator_calloc(p_alloc, 1, sizeof(value_vector_t));
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    p_vector->p_data = NULL;
+    p_vector->elem_size = elem_size;
+    p_vector->size = 0;
+    p_vector->cap = 0;
+    p_vector->p_alloc = p_alloc;
+    
+    EXIT:
+        return p_vector;
+}
+
+/*!
+ * @brief This function destroys a value vector context along with the
+ *          elements it holds.
+ *
+ * @param[in/out] p_vector The value vector context.
+ *
+ * @return No return value expected.
+ */
+void
+value_vector_destroy (value_vector_t * p_vector)
+{
+    if ((NULL == p_vector) ||
+        (NULL == p_vector->p_data))
+    {
+        goto EXIT;
+    }
+    
+    // Free the element array.
+    allocator_free(p_vector->p_alloc, p_vector->p_data,
+                   p_vector->cap * p_vector->elem_size);
+    p_vector->p_data = NULL;
+    
+    EXIT:
+        if (NULL != p_vector)
+        {
+            allocator_free(p_vector->p_alloc, p_vector,
+                           sizeof(value_vector_t));
+            p_vector = NULL;
+        }
+        return;
+}
+
+/*!
+ * @brief This function allocates space for a specified number of
+ *          additional elements in the vector.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[in] amt The number of elements to allocate space for.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_reserve (value_vector_t * p_vector, const size_t amt)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (amt > ((SIZE_MAX / p_vector->elem_size) - p_vector->cap)))
+    {
+        goto EXIT;
+    }
+    
+    // Perform a reallocation of the element array. On failure the
+    // original array is left intact.
+    size_t old_size = p_vector->cap * p_vector->elem_size;
+    size_t new_size = (p_vector->cap + amt) * p_vector->elem_size;
+    unsigned char * p_new = allocator_realloc(p_vector->p_alloc,
+                                              p_vector->p_data,
+                                              old_size, new_size);
+    if (NULL == p_new)
+    {
+        goto EXIT;
+    }
+    p_vector->p_data = p_new;
+    p_vector->cap += amt;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function copies an element onto the back of the vector.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[in] p_elem The element to copy in.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_push_back (value_vector_t * p_vector, const void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == p_elem))
+    {
+        goto EXIT;
+    }
+    
+    // If the vector is full, allocate more space.
+    if (-1 == value_vector_grow(p_vector))
+    {
+        goto EXIT;
+    }
+    
+    // Append the new element.
+    memcpy(p_vector->p_data + (p_vector->size * p_vector->elem_size),
+           p_elem, p_vector->elem_size);
+    p_vector->size++;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function removes the last element from the vector.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[out] p_elem Receives a copy of the removed element. May be NULL
+ *              to discard it.
+ *
+ * @return 0 on success, -1 on error or empty vector.
+ */
+int
+value_vector_pop_back (value_vector_t * p_vector, void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (0 == p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    p_vector->size--;
+    if (NULL != p_elem)
+    {
+        memcpy(p_elem,
+               p_vector->p_data + (p_vector->size * p_vector->elem_size),
+               p_vector->elem_size);
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function returns a pointer to the element at a specified
+ *          index in the vector.
+ *
+ * @param[in] p_vector The value vector context.
+ * @param[in] idx The index of the element.
+ *
+ * @return Pointer to the element, which may be read or written in
+ *          place. NULL on error or index out of range.
+ */
+void *
+value_vector_at (value_vector_t * p_vector, const size_t idx)
+{
+    void * p_result = NULL;
+    if ((NULL == p_vector) ||
+        (idx >= p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    p_result = p_vector->p_data + (idx * p_vector->elem_size);
+    
+    EXIT:
+        return p_result;
+}
+
+/*!
+ * @brief This function copies an element into the vector before a
+ *          specified index.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[in] idx The index to insert at. Equal to the size to append.
+ * @param[in] p_elem The element to copy in.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_insert (value_vector_t * p_vector,
+                     const size_t idx,
+                     const void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == p_elem) ||
+        (idx > p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    // If the vector is full, allocate more space.
+    if (-1 == value_vector_grow(p_vector))
+    {
+        goto EXIT;
+    }
+    
+    // Shift the trailing elements back one position and copy the new
+    // element into the gap.
+    unsigned char * p_slot = p_vector->p_data + (idx * p_vector->elem_size);
+    memmove(p_slot + p_vector->elem_size, p_slot,
+            (p_vector->size - idx) * p_vector->elem_size);
+    memcpy(p_slot, p_elem, p_vector->elem_size);
+    p_vector->size++;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function removes the element at a specified index from the
+ *          vector.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[in] idx The index of the element to remove.
+ * @param[out] p_elem Receives a copy of the removed element. May be NULL
+ *              to discard it.
+ *
+ * @return 0 on success, -1 on error or index out of range.
+ */
+int
+value_vector_erase (value_vector_t * p_vector,
+                    const size_t idx,
+                    void * p_elem)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (idx >= p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    unsigned char * p_slot = p_vector->p_data + (idx * p_vector->elem_size);
+    if (NULL != p_elem)
+    {
+        memcpy(p_elem, p_slot, p_vector->elem_size);
+    }
+    
+    // Shift the trailing elements forward one position.
+    memmove(p_slot, p_slot + p_vector->elem_size,
+            (p_vector->size - idx - 1) * p_vector->elem_size);
+    p_vector->size--;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,315 @@
+/*!
+ * @file value_vector.h
+ *
+ * @brief This file contains a generic vector implementation that stores
+ *          elements by value.
+ *
+ *          Unlike vector_t, which holds references to data stored
+ *              elsewhere, the value vector copies each element into
+ *              one contiguous array. The size of an element is fixed
+ *              when the vector is created. Small structs and numbers
+ *              therefore need no allocation of their own, and a scan
+ *              over the vector reads memory sequentially.
+ *
+ *          Reallocations of memory occur automatically when the
+ *              number of elements in the vector exceed the allocated
+ *              space. The capacity grows geometrically, so appending
+ *              is amortized O(1).
+ *
+ *          Pointers returned by value_vector_at are invalidated by any
+ *              call that adds elements to the vector.
+ *
+ *          Functions included are as follows:
+ *
+ *              - value_vector_create()
+ *              - value_vector_create_with_allocator()
+ *              - value_vector_destroy()
+ *              - value_vector_reserve()
+ *              - value_vector_push_back()
+ *              - value_vector_pop_back()
+ *              - value_vector_at()
+ *              - value_vector_insert()
+ *              - value_vector_erase()
+ *              - value_vector_sum_i32()
+ *              - value_vector_min_max_i32()
+ *              - value_vector_sum_f64()
+ *              - value_vector_min_max_f64()
+ *              - value_vector_radix_sort()
+ *              - value_vector_save()
+ *              - value_vector_load()
+ */
+
+#ifndef VALUE_VECTOR_H
+#define VALUE_VECTOR_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "src/c/allocator/allocator.h"
+
+/*** Number of elements allocated by the first automatic growth. ***/
+#define VALUE_VECTOR_INIT_CAP 8
+
+/*!
+ * @brief This datatype defines a value vector context.
+ *
+ * @param p_data The array containing the elements.
+ * @param elem_size The size in bytes of a single element.
+ * @param size The number of elements in the vector.
+ * @param cap The number of elements the vector has allocated space for.
+ * @param p_alloc The allocator for the context and its array. NULL for
+ *          the standard library.
+ */
+typedef struct _value_vector
+{
+    unsigned char * p_data;
+    size_t elem_size;
+    size_t size;
+    size_t cap;
+    const allocator_t * p_alloc;
+} value_vector_t;
+
+/*!
+ * @brief This function instantiates a new value vector context.
+ *
+ * @param[in] elem_size The size in bytes of a single element.
+ *
+ * @return Pointer to new value vector context. NULL on error.
+ */
+value_vector_t *
+value_vector_create (const size_t elem_size);
+
+/*!
+ * @brief This function instantiates a new value vector context that
+ *          allocates through a given allocator.
+ *
+ * @param[in] elem_size The size in bytes of a single element.
+ * @param[in] p_alloc The allocator for the context and its array. NULL
+ *              for the standard library.
+ *
+ * @return Pointer to new value vector context. NULL on error.
+ */
+value_vector_t *
+value_vector_create_with_allocator (const size_t elem_size,
+                                    const allocator_t * p_alloc);
+
+/*!
+ * @brief This function destroys a value vector context along with the
+ *          elements it holds.
+ *
+ * @param[in/out] p_vector The value vector context.
+ *
+ * @return No return value expected.
+ */
+void
+value_vector_destroy (value_vector_t * p_vector);
+
+/*!
+ * @brief This function allocates space for a specified number of
+ *          additional elements in the vector.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[in] amt The number of elements to allocate space for.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_reserve (value_vector_t * p_vector, const size_t amt);
+
+/*!
+ * @brief This function copies an element onto the back of the vector.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[in] p_elem The element to copy in.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_push_back (value_vector_t * p_vector, const void * p_elem);
+
+/*!
+ * @brief This function removes the last element from the vector.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[out] p_elem Receives a copy of the removed element. May be NULL
+ *              to discard it.
+ *
+ * @return 0 on success, -1 on error or empty vector.
+ */
+int
+value_vector_pop_back (value_vector_t * p_vector, void * p_elem);
+
+/*!
+ * @brief This function returns a pointer to the element at a specified
+ *          index in the vector.
+ *
+ * @param[in] p_vector The value vector context.
+ * @param[in] idx The index of the element.
+ *
+ * @return Pointer to the element, which may be read or written in
+ *          place. NULL on error or index out of range.
+ */
+void *
+value_vector_at (value_vector_t * p_vector, const size_t idx);
+
+/*!
+ * @brief This function copies an element into the vector before a
+ *          specified index.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[in] idx The index to insert at. Equal to the size to append.
+ * @param[in] p_elem The element to copy in.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_insert (value_vector_t * p_vector,
+                     const size_t idx,
+                     const void * p_elem);
+
+/*!
+ * @brief This function removes the element at a specified index from the
+ *          vector.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[in] idx The index of the element to remove.
+ * @param[out] p_elem Receives a copy of the removed element. May be NULL
+ *              to discard it.
+ *
+ * @return 0 on success, -1 on error or index out of range.
+ */
+int
+value_vector_erase (value_vector_t * p_vector,
+                    const size_t idx,
+                    void * p_elem);
+
+/*!
+ * @brief This function sums the elements of a vector of int32_t.
+ *
+ *          This and the other aggregates below process several elements
+ *              per instruction on x86-64, picking AVX2 or SSE2 at runtime.
+ *
+ * @param[in] p_vector The value vector context. Its element size must be
+ *              sizeof(int32_t).
+ * @param[out] p_sum Receives the sum. 0 for an empty vector.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_sum_i32 (const value_vector_t * p_vector, int64_t * p_sum);
+
+/*!
+ * @brief This function finds the smallest and largest elements of a
+ *          vector of int32_t.
+ *
+ * @param[in] p_vector The value vector context. Its element size must be
+ *              sizeof(int32_t).
+ * @param[out] p_min Receives the smallest element.
+ * @param[out] p_max Receives the largest element.
+ *
+ * @return 0 on success, -1 on error or empty vector.
+ */
+int
+value_vector_min_max_i32 (const value_vector_t * p_vector,
+                          int32_t * p_min,
+                          int32_t * p_max);
+
+/*!
+ * @brief This function sums the elements of a vector of double.
+ *
+ *          The elements are added in an unspecified order, so the result
+ *              may differ from a left-to-right sum by rounding.
+ *
+ * @param[in] p_vector The value vector context. Its element size must be
+ *              sizeof(double).
+ * @param[out] p_sum Receives the sum. 0 for an empty vector.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_sum_f64 (const value_vector_t * p_vector, double * p_sum);
+
+/*!
+ * @brief This function finds the smallest and largest elements of a
+ *          vector of double.
+ *
+ *          The result is unspecified if the vector holds a NaN.
+ *
+ * @param[in] p_vector The value vector context. Its element size must be
+ *              sizeof(double).
+ * @param[out] p_min Receives the smallest element.
+ * @param[out] p_max Receives the largest element.
+ *
+ * @return 0 on success, -1 on error or empty vector.
+ */
+int
+value_vector_min_max_f64 (const value_vector_t * p_vector,
+                          double * p_min,
+                          double * p_max);
+
+/*!
+ * @brief This function sorts the vector into ascending order of an
+ *          integer key stored in each element.
+ *
+ *          The sort is a stable byte-wise radix sort. It runs in O(n) time
+ *              for a fixed key size and needs a scratch array as large as
+ *              the vector.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[in] key_offset The offset in bytes of the key in an element,
+ *              for example offsetof() a struct member.
+ * @param[in] key_size The size in bytes of the key. 1, 2, 4 or 8.
+ * @param[in] b_signed Whether the key is a signed integer.
+ *
+ * @return 0 on success, -1 on error. The vector is unchanged on error.
+ */
+int
+value_vector_radix_sort (value_vector_t * p_vector,
+                         const size_t key_offset,
+                         const size_t key_size,
+                         const bool b_signed);
+
+/*!
+ * @brief This function writes a snapshot of the vector to a file,
+ *          replacing any existing contents.
+ *
+ *          The file holds a header, described in value_vector_file.h,
+ *              followed by the elements exactly as they sit in memory,
+ *              so it is only portable between machines of the same byte
+ *              order and struct layout.
+ *
+ *          The snapshot is written to a temporary file in the same
+ *              directory, flushed with fsync and renamed over the target.
+ *              A crash or error part way through leaves any previous
+ *              snapshot intact.
+ *
+ *          A new file is created with mode 0644 less the umask. A file
+ *              that is replaced keeps its permissions.
+ *
+ * @param[in] p_vector The value vector context.
+ * @param[in] p_path The path of the file.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_save (const value_vector_t * p_vector, const char * p_path);
+
+/*!
+ * @brief This function reads a vector from a snapshot or mapped vector
+ *          file into memory.
+ *
+ *          The elements are read into the new vector's array in one
+ *              piece. A snapshot's checksum is verified.
+ *
+ * @param[in] p_path The path of the file.
+ *
+ * @return Pointer to new value vector context holding the file's
+ *          elements. NULL on error, malformed file or checksum mismatch.
+ */
+value_vector_t *
+value_vector_load (const char * p_path);
+
+#endif // VALUE_VECTOR_H
+
+/***   end of file   ***/
\ No newline at end of file
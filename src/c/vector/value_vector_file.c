@@ -0,0 +1,549 @@
+/*!
+ * @file value_vector_file.c
+ *
+ * @brief This file contains binary snapshots of value vectors.
+ *
+ *          A snapshot is written as the header and the element array
+ *              exactly as they sit in memory, so saving and loading are
+ *              one write and one read each, with no per-element parsing.
+ *              A snapshot may also be opened in place with
+ *              mapped_vector_open, which maps it without copying.
+ *
+ *          Functions included are as follows:
+ *
+ *              - value_vector_file_checksum()
+ *              - value_vector_file_init_header()
+ *              - value_vector_file_check_header()
+ *              - value_vector_save()
+ *              - value_vector_load()
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "value_vector.h"
+#include "value_vector_file.h"
+
+/*** Odd multiplier used to mix the checksum lanes. ***/
+#define VALUE_VECTOR_FILE_PRIME 0x9E3779B97F4A7C15ULL
+
+/*** Number of independent checksum lanes. ***/
+#define VALUE_VECTOR_FILE_LANES 4
+
+/*** Format of a temporary path: target, process id and counter. ***/
+#define VALUE_VECTOR_FILE_TMP_FORMAT "%s.tmp.%ld.%lu"
+
+/*** Room for the temporary suffix beyond the path, with the terminator. ***/
+#define VALUE_VECTOR_FILE_TMP_EXTRA 48
+
+/*** Number of temporary names tried before a save gives up. ***/
+#define VALUE_VECTOR_FILE_TMP_TRIES 100
+
+/*** Permissions of a newly created snapshot, before the umask. ***/
+#define VALUE_VECTOR_FILE_MODE 0644
+
+/*** Counter making temporary names unique within the process. ***/
+static _Atomic unsigned long g_tmp_counter = 0;
+
+/*!
+ * @brief This is a static function that mixes a word into a checksum
+ *          lane.
+ *
+ * @param[in] lane The lane.
+ * @param[in] word The word.
+ *
+ * @return The new value of the lane.
+ */
+static inline uint64_t
+value_vector_file_mix (uint64_t lane, const uint64_t word)
+{
+    lane ^= word;
+    lane *= VALUE_VECTOR_FILE_PRIME;
+    lane ^= lane >> 32;
+    return lane;
+}
+
+/*!
+ * @brief This is a static function that writes a whole buffer to a file
+ *          at a given offset, retrying short writes.
+ *
+ * @param[in] fd The file descriptor.
+ * @param[in] p_buf The buffer.
+ * @param[in] len The size in bytes of the buffer.
+ * @param[in] offset The offset in the file to write at.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+value_vector_file_write (const int fd,
+                         const void * p_buf,
+                         size_t len,
+                         off_t offset)
+{
+    int status = -1;
+    const unsigned char * p_bytes = p_buf;
+    while (len > 0)
+    {
+        ssize_t done = pwrite(fd, p_bytes, len, offset);
+        if (done < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            goto EXIT;
+        }
+        p_bytes += done;
+        len -= (size_t) done;
+        offset += done;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This is a static function that fills a whole buffer from a file
+ *          at a given offset, retrying short reads.
+ *
+ * @param[in] fd The file descriptor.
+ * @param[out] p_buf The buffer.
+ * @param[in] len The size in bytes of the buffer.
+ * @param[in] offset The offset in the file to read from.
+ *
+ * @return 0 on success, -1 on error or end of file.
+ */
+static int
+value_vector_file_read (const int fd, void * p_buf, size_t len, off_t offset)
+{
+    int status = -1;
+    unsigned char * p_bytes = p_buf;
+    while (len > 0)
+    {
+        ssize_t done = pread(fd, p_bytes, len, offset);
+        if (done <= 0)
+        {
+            if ((done < 0) &&
+                (EINTR == errno))
+            {
+                continue;
+            }
+            goto EXIT;
+        }
+        p_bytes += done;
+        len -= (size_t) done;
+        offset += done;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This is a static function that creates the temporary file a
+ *          snapshot is written to, next to its target.
+ *
+ *          The file is created with VALUE_VECTOR_FILE_MODE, so the umask
+ *              applies as it would to any new file. When the snapshot
+ *              replaces an existing file, that file's permissions are
+ *              carried over instead.
+ *
+ * @param[in] p_path The path of the target.
+ * @param[out] pp_tmp Receives the path of the temporary file, to be freed
+ *              by the caller. NULL on error.
+ *
+ * @return The open file descriptor. -1 on error.
+ */
+static int
+value_vector_file_create_tmp (const char * p_path, char ** pp_tmp)
+{
+    int fd = -1;
+    size_t tmp_size = strlen(p_path) + VALUE_VECTOR_FILE_TMP_EXTRA;
+    char * p_tmp = malloc(tmp_size);
+    if (NULL == p_tmp)
+    {
+        goto EXIT;
+    }
+    
+    // Names are unique within the process, and O_EXCL skips any left
+    // behind by another process.
+    for (int tries = 0; (-1 == fd) && (tries < VALUE_VECTOR_FILE_TMP_TRIES);
+         ++tries)
+    {
+        snprintf(p_tmp, tmp_size, VALUE_VECTOR_FILE_TMP_FORMAT, p_path,
+                 (long) getpid(), atomic_fetch_add(&g_tmp_counter, 1));
+        fd = open(p_tmp, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                  VALUE_VECTOR_FILE_MODE);
+        if ((-1 == fd) &&
+            (EEXIST != errno))
+        {
+            break;
+        }
+    }
+    if (-1 == fd)
+    {
+        goto EXIT;
+    }
+    
+    struct stat st;
+    if ((0 == stat(p_path, &st)) &&
+        (0 != fchmod(fd, st.st_mode & 07777)))
+    {
+        close(fd);
+        unlink(p_tmp);
+        fd = -1;
+    }
+    
+    EXIT:
+        if (-1 == fd)
+        {
+            free(p_tmp);
+            p_tmp = NULL;
+        }
+        *pp_tmp = p_tmp;
+        return fd;
+}
+
+/*!
+ * @brief This is a static function that flushes the directory holding a
+ *          file to disk, so that a rename into it survives a crash.
+ *
+ * @param[in] p_path The path of the file.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+value_vector_file_sync_dir (const char * p_path)
+{
+    int status = -1;
+    int fd = -1;
+    char * p_dir = NULL;
+    
+    // The directory is everything up to the last slash, or "." if there
+    // is none.
+    const char * p_slash = strrchr(p_path, '/');
+    size_t dir_len = (NULL == p_slash) ? 0 : (size_t) (p_slash - p_path);
+    p_dir = malloc(dir_len + 2);
+    if (NULL == p_dir)
+    {
+        goto EXIT;
+    }
+    if (NULL == p_slash)
+    {
+        memcpy(p_dir, ".", 2);
+    }
+    else
+    {
+        memcpy(p_dir, p_path, dir_len);
+        p_dir[dir_len] = '\0';
+        if (0 == dir_len)
+        {
+            memcpy(p_dir, "/", 2);
+        }
+    }
+    
+    fd = open(p_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if ((-1 == fd) ||
+        (0 != fsync(fd)))
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        if (-1 != fd)
+        {
+            close(fd);
+        }
+        free(p_dir);
+        return status;
+}
+
+/*!
+ * @brief This function computes the checksum of an element block.
+ *
+ * @param[in] p_data The element block.
+ * @param[in] len The size in bytes of the block.
+ *
+ * @return The checksum.
+ */
+uint64_t
+value_vector_file_checksum (const void * p_data, const size_t len)
+{
+    const unsigned char * p_bytes = p_data;
+    uint64_t lanes[VALUE_VECTOR_FILE_LANES];
+    for (size_t lane = 0; lane < VALUE_VECTOR_FILE_LANES; ++lane)
+    {
+        lanes[lane] = VALUE_VECTOR_FILE_PRIME + lane;
+    }
+    
+    // Feed whole words round-robin into the lanes, so the multiplies of
+    // neighbouring words do not wait on each other.
+    size_t idx = 0;
+    uint64_t word = 0;
+    for (; (len - idx) >= (VALUE_VECTOR_FILE_LANES * sizeof(word));
+         idx += VALUE_VECTOR_FILE_LANES * sizeof(word))
+    {
+        for (size_t lane = 0; lane < VALUE_VECTOR_FILE_LANES; ++lane)
+        {
+            memcpy(&word, p_bytes + idx + (lane * sizeof(word)),
+                   sizeof(word));
+            lanes[lane] = value_vector_file_mix(lanes[lane], word);
+        }
+    }
+    for (; (len - idx) >= sizeof(word); idx += sizeof(word))
+    {
+        memcpy(&word, p_bytes + idx, sizeof(word));
+        lanes[0] = value_vector_file_mix(lanes[0], word);
+    }
+    if (idx < len)
+    {
+        word = 0;
+        memcpy(&word, p_bytes + idx, len - idx);
+        lanes[1] = value_vector_file_mix(lanes[1], word);
+    }
+    
+    uint64_t checksum = len;
+    for (size_t lane = 0; lane < VALUE_VECTOR_FILE_LANES; ++lane)
+    {
+        checksum = value_vector_file_mix(checksum, lanes[lane]);
+    }
+    return checksum;
+}
+
+/*!
+ * @brief This function fills in the header of a file holding no elements.
+ *
+ * @param[out] p_header The header.
+ * @param[in] elem_size The size in bytes of a single element.
+ *
+ * @return No return value expected.
+ */
+void
+value_vector_file_init_header (value_vector_file_header_t * p_header,
+                               const size_t elem_size)
+{
+    if (NULL == p_header)
+    {
+        goto EXIT;
+    }
+    
+    memset(p_header, 0, sizeof(*p_header));
+    memcpy(p_header->magic, VALUE_VECTOR_FILE_MAGIC,
+           sizeof(VALUE_VECTOR_FILE_MAGIC));
+    p_header->version = VALUE_VECTOR_FILE_VERSION;
+    p_header->header_size = VALUE_VECTOR_FILE_HEADER_SIZE;
+    p_header->elem_size = elem_size;
+    p_header->byte_order = VALUE_VECTOR_FILE_BYTE_ORDER;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function checks that a header is well formed and that its
+ *          elements fit in a file of a given size.
+ *
+ * @param[in] p_header The header.
+ * @param[in] file_size The size in bytes of the whole file.
+ *
+ * @return 0 if the header is valid, -1 otherwise.
+ */
+int
+value_vector_file_check_header (const value_vector_file_header_t * p_header,
+                                const uint64_t file_size)
+{
+    int status = -1;
+    if ((NULL == p_header) ||
+        (file_size < VALUE_VECTOR_FILE_HEADER_SIZE) ||
+        (0 != memcmp(p_header->magic, VALUE_VECTOR_FILE_MAGIC,
+                     sizeof(VALUE_VECTOR_FILE_MAGIC))) ||
+        (VALUE_VECTOR_FILE_VERSION != p_header->version) ||
+        (VALUE_VECTOR_FILE_HEADER_SIZE != p_header->header_size) ||
+        (VALUE_VECTOR_FILE_BYTE_ORDER != p_header->byte_order) ||
+        (0 == p_header->elem_size))
+    {
+        goto EXIT;
+    }
+    
+    // The counted elements must lie within the file.
+    uint64_t block = file_size - VALUE_VECTOR_FILE_HEADER_SIZE;
+    if (p_header->size > (block / p_header->elem_size))
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function writes a snapshot of the vector to a file,
+ *          replacing any existing contents.
+ *
+ *          The snapshot is written to a temporary file in the same
+ *              directory, flushed with fsync and renamed over the target,
+ *              so the target always holds either the old or the new
+ *              snapshot in full.
+ *
+ * @param[in] p_vector The value vector context.
+ * @param[in] p_path The path of the file.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_save (const value_vector_t * p_vector, const char * p_path)
+{
+    int status = -1;
+    int fd = -1;
+    char * p_tmp = NULL;
+    bool b_created = false;
+    if ((NULL == p_vector) ||
+        (NULL == p_path))
+    {
+        goto EXIT;
+    }
+    
+    size_t bytes = p_vector->size * p_vector->elem_size;
+    value_vector_file_header_t header;
+    value_vector_file_init_header(&header, p_vector->elem_size);
+    header.size = p_vector->size;
+    header.checksum = value_vector_file_checksum(p_vector->p_data, bytes);
+    header.flags = VALUE_VECTOR_FILE_CHECKSUMMED;
+    
+    // Write to a temporary file next to the target and rename it over the
+    // target only once it is on disk. A crash or error part way through
+    // leaves the previous snapshot intact.
+    fd = value_vector_file_create_tmp(p_path, &p_tmp);
+    if (-1 == fd)
+    {
+        goto EXIT;
+    }
+    b_created = true;
+    if ((-1 == value_vector_file_write(fd, &header, sizeof(header), 0)) ||
+        (-1 == value_vector_file_write(fd, p_vector->p_data, bytes,
+                                       VALUE_VECTOR_FILE_HEADER_SIZE)) ||
+        (0 != fsync(fd)))
+    {
+        goto EXIT;
+    }
+    
+    // Delayed write errors are reported by close.
+    int fd_closed = fd;
+    fd = -1;
+    if ((0 != close(fd_closed)) ||
+        (0 != rename(p_tmp, p_path)))
+    {
+        goto EXIT;
+    }
+    b_created = false;
+    
+    // The new snapshot is in place. Flushing the directory makes the
+    // rename itself durable.
+    if (-1 == value_vector_file_sync_dir(p_path))
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        if (-1 != fd)
+        {
+            close(fd);
+        }
+        if (true == b_created)
+        {
+            unlink(p_tmp);
+        }
+        free(p_tmp);
+        return status;
+}
+
+/*!
+ * @brief This function reads a vector from a snapshot or mapped vector
+ *          file into memory.
+ *
+ * @param[in] p_path The path of the file.
+ *
+ * @return Pointer to new value vector context holding the file's
+ *          elements. NULL on error, malformed file or checksum mismatch.
+ */
+value_vector_t *
+value_vector_load (const char * p_path)
+{
+    int status = -1;
+    value_vector_t * p_vector = NULL;
+    int fd = -1;
+    if (NULL == p_path)
+    {
+        goto EXIT;
+    }
+    
+    fd = open(p_path, O_RDONLY | O_CLOEXEC);
+    if (-1 == fd)
+    {
+        goto EXIT;
+    }
+    struct stat st;
+    value_vector_file_header_t header;
+    if ((0 != fstat(fd, &st)) ||
+        (-1 == value_vector_file_read(fd, &header, sizeof(header), 0)) ||
+        (-1 == value_vector_file_check_header(&header,
+                                              (uint64_t) st.st_size)))
+    {
+        goto EXIT;
+    }
+    
+    // Read the element block straight into the vector's array.
+    p_vector = value_vector_create(header.elem_size);
+    if ((NULL == p_vector) ||
+        ((header.size > 0) &&
+         (-1 == value_vector_reserve(p_vector, header.size))))
+    {
+        goto EXIT;
+    }
+    size_t bytes = header.size * header.elem_size;
+    if (-1 == value_vector_file_read(fd, p_vector->p_data, bytes,
+                                     VALUE_VECTOR_FILE_HEADER_SIZE))
+    {
+        goto EXIT;
+    }
+    if ((0 != (header.flags & VALUE_VECTOR_FILE_CHECKSUMMED)) &&
+        (header.checksum != value_vector_file_checksum(p_vector->p_data,
+                                                       bytes)))
+    {
+        goto EXIT;
+    }
+    p_vector->size = header.size;
+    
+    status = 0;
+    
+    EXIT:
+        if (-1 != fd)
+        {
+            close(fd);
+        }
+        if (-1 == status)
+        {
+            value_vector_destroy(p_vector);
+            p_vector = NULL;
+        }
+        return p_vector;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,118 @@
+/*!
+ * @file value_vector_file.h
+ *
+ * @brief This file contains the binary file format shared by value vector
+ *          snapshots and memory-mapped vectors.
+ *
+ *          A file is a 64-byte header followed directly by the raw
+ *              element block, so the elements start at an offset aligned
+ *              for any element type and the file can be mapped and used
+ *              in place. The header records the element size and count
+ *              and, for snapshots, a checksum of the element block.
+ *              Anything in the file past the counted elements is spare
+ *              capacity.
+ *
+ *          Files are written in the byte order of the machine that wrote
+ *              them, and one with another byte order is rejected.
+ *
+ *          Functions included are as follows:
+ *
+ *              - value_vector_file_checksum()
+ *              - value_vector_file_init_header()
+ *              - value_vector_file_check_header()
+ */
+
+#ifndef VALUE_VECTOR_FILE_H
+#define VALUE_VECTOR_FILE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*** Magic bytes opening every file. ***/
+#define VALUE_VECTOR_FILE_MAGIC "VALVECT"
+
+/*** Version of the file format. ***/
+#define VALUE_VECTOR_FILE_VERSION 1
+
+/*** Size in bytes of the header, and offset of the element block. ***/
+#define VALUE_VECTOR_FILE_HEADER_SIZE 64
+
+/*** Value read back as written only in the writer's byte order. ***/
+#define VALUE_VECTOR_FILE_BYTE_ORDER 0x01020304
+
+/*** Header flag set when the checksum covers the element block. ***/
+#define VALUE_VECTOR_FILE_CHECKSUMMED 0x1
+
+/*!
+ * @brief This datatype defines the header of a value vector file.
+ *
+ * @param magic VALUE_VECTOR_FILE_MAGIC, NUL terminated.
+ * @param version VALUE_VECTOR_FILE_VERSION.
+ * @param header_size VALUE_VECTOR_FILE_HEADER_SIZE.
+ * @param elem_size The size in bytes of a single element.
+ * @param size The number of elements in the file.
+ * @param checksum The checksum of the element block, if flagged.
+ * @param flags A combination of the VALUE_VECTOR_FILE_* flags.
+ * @param byte_order VALUE_VECTOR_FILE_BYTE_ORDER.
+ * @param reserved Zero.
+ */
+typedef struct _value_vector_file_header
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t elem_size;
+    uint64_t size;
+    uint64_t checksum;
+    uint32_t flags;
+    uint32_t byte_order;
+    uint8_t  reserved[16];
+} value_vector_file_header_t;
+
+_Static_assert(VALUE_VECTOR_FILE_HEADER_SIZE ==
+               sizeof(value_vector_file_header_t),
+               "value vector file header must be 64 bytes");
+
+/*!
+ * @brief This function computes the checksum of an element block.
+ *
+ *          The checksum is a fast non-cryptographic hash that reads eight
+ *              bytes at a time in four independent lanes. It catches
+ *              truncated and corrupted files, not deliberate tampering.
+ *
+ * @param[in] p_data The element block.
+ * @param[in] len The size in bytes of the block.
+ *
+ * @return The checksum.
+ */
+uint64_t
+value_vector_file_checksum (const void * p_data, const size_t len);
+
+/*!
+ * @brief This function fills in the header of a file holding no elements.
+ *
+ * @param[out] p_header The header.
+ * @param[in] elem_size The size in bytes of a single element.
+ *
+ * @return No return value expected.
+ */
+void
+value_vector_file_init_header (value_vector_file_header_t * p_header,
+                               const size_t elem_size);
+
+/*!
+ * @brief This function checks that a header is well formed and that its
+ *          elements fit in a file of a given size.
+ *
+ * @param[in] p_header The header.
+ * @param[in] file_size The size in bytes of the whole file.
+ *
+ * @return 0 if the header is valid, -1 otherwise.
+ */
+int
+value_vector_file_check_header (const value_vector_file_header_t * p_header,
+                                const uint64_t file_size);
+
+#endif // VALUE_VECTOR_FILE_H
+
+/***   end of file   ***/
\ No newline at end of file
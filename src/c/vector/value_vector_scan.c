@@ -0,0 +1,577 @@
+/*!
+ * @file value_vector_scan.c
+ *
+ * @brief This file contains numeric aggregates over value vectors of
+ *          int32_t or double elements.
+ *
+ *          On x86-64 the aggregates process several elements per
+ *              instruction, using AVX2 when the processor supports it
+ *              and SSE2 otherwise. The choice is made at runtime, so a
+ *              single build runs everywhere. Other targets use plain
+ *              scalar loops.
+ *
+ *          Functions included are as follows:
+ *
+ *              - value_vector_sum_i32()
+ *              - value_vector_min_max_i32()
+ *              - value_vector_sum_f64()
+ *              - value_vector_min_max_f64()
+ */
+
+#include <stdint.h>
+
+#include "value_vector.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define VALUE_VECTOR_SCAN_X86_64 1
+#else
+#define VALUE_VECTOR_SCAN_X86_64 0
+#endif
+
+/*!
+ * @brief This is a static function that sums an int32_t array one
+ *          element at a time.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ *
+ * @return The sum.
+ */
+static int64_t
+value_vector_sum_i32_scalar (const int32_t * p_data, const size_t count)
+{
+    int64_t sum = 0;
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        sum += p_data[idx];
+    }
+    return sum;
+}
+
+/*!
+ * @brief This is a static function that folds an int32_t array into a
+ *          running minimum and maximum one element at a time.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in/out] p_min The running minimum.
+ * @param[in/out] p_max The running maximum.
+ *
+ * @return No return value expected.
+ */
+static void
+value_vector_min_max_i32_scalar (const int32_t * p_data,
+                                 const size_t count,
+                                 int32_t * p_min,
+                                 int32_t * p_max)
+{
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        if (p_data[idx] < *p_min)
+        {
+            *p_min = p_data[idx];
+        }
+        if (p_data[idx] > *p_max)
+        {
+            *p_max = p_data[idx];
+        }
+    }
+}
+
+/*!
+ * @brief This is a static function that sums a double array one element
+ *          at a time.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ *
+ * @return The sum.
+ */
+static double
+value_vector_sum_f64_scalar (const double * p_data, const size_t count)
+{
+    double sum = 0.0;
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        sum += p_data[idx];
+    }
+    return sum;
+}
+
+/*!
+ * @brief This is a static function that folds a double array into a
+ *          running minimum and maximum one element at a time.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in/out] p_min The running minimum.
+ * @param[in/out] p_max The running maximum.
+ *
+ * @return No return value expected.
+ */
+static void
+value_vector_min_max_f64_scalar (const double * p_data,
+                                 const size_t count,
+                                 double * p_min,
+                                 double * p_max)
+{
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        if (p_data[idx] < *p_min)
+        {
+            *p_min = p_data[idx];
+        }
+        if (p_data[idx] > *p_max)
+        {
+            *p_max = p_data[idx];
+        }
+    }
+}
+
+#if VALUE_VECTOR_SCAN_X86_64
+
+/*!
+ * @brief This is a static function that sums an int32_t array four
+ *          elements at a time with SSE2.
+ *
+ *          Each element is sign extended to 64 bits before it is added,
+ *              so the sum does not overflow 32 bits.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ *
+ * @return The sum.
+ */
+static int64_t
+value_vector_sum_i32_sse2 (const int32_t * p_data, const size_t count)
+{
+    __m128i acc_lo = _mm_setzero_si128();
+    __m128i acc_hi = _mm_setzero_si128();
+    size_t idx = 0;
+    for (; (idx + 4) <= count; idx += 4)
+    {
+        __m128i lanes = _mm_loadu_si128((const __m128i *) (p_data + idx));
+        __m128i sign = _mm_srai_epi32(lanes, 31);
+        acc_lo = _mm_add_epi64(acc_lo, _mm_unpacklo_epi32(lanes, sign));
+        acc_hi = _mm_add_epi64(acc_hi, _mm_unpackhi_epi32(lanes, sign));
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i *) lanes, _mm_add_epi64(acc_lo, acc_hi));
+    return lanes[0] + lanes[1] +
+           value_vector_sum_i32_scalar(p_data + idx, count - idx);
+}
+
+/*!
+ * @brief This is a static function that folds an int32_t array into a
+ *          running minimum and maximum four elements at a time with SSE2.
+ *
+ *          SSE2 has no 32-bit min or max, so each is a compare followed
+ *              by a bitwise select.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in/out] p_min The running minimum.
+ * @param[in/out] p_max The running maximum.
+ *
+ * @return No return value expected.
+ */
+static void
+value_vector_min_max_i32_sse2 (const int32_t * p_data,
+                               const size_t count,
+                               int32_t * p_min,
+                               int32_t * p_max)
+{
+    __m128i lo = _mm_set1_epi32(*p_min);
+    __m128i hi = _mm_set1_epi32(*p_max);
+    size_t idx = 0;
+    for (; (idx + 4) <= count; idx += 4)
+    {
+        __m128i lanes = _mm_loadu_si128((const __m128i *) (p_data + idx));
+        __m128i less = _mm_cmplt_epi32(lanes, lo);
+        __m128i more = _mm_cmpgt_epi32(lanes, hi);
+        lo = _mm_or_si128(_mm_and_si128(less, lanes),
+                          _mm_andnot_si128(less, lo));
+        hi = _mm_or_si128(_mm_and_si128(more, lanes),
+                          _mm_andnot_si128(more, hi));
+    }
+    int32_t lows[4];
+    int32_t highs[4];
+    _mm_storeu_si128((__m128i *) lows, lo);
+    _mm_storeu_si128((__m128i *) highs, hi);
+    value_vector_min_max_i32_scalar(lows, 4, p_min, p_max);
+    value_vector_min_max_i32_scalar(highs, 4, p_min, p_max);
+    value_vector_min_max_i32_scalar(p_data + idx, count - idx, p_min, p_max);
+}
+
+/*!
+ * @brief This is a static function that sums a double array four
+ *          elements at a time with SSE2.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ *
+ * @return The sum.
+ */
+static double
+value_vector_sum_f64_sse2 (const double * p_data, const size_t count)
+{
+    __m128d acc_lo = _mm_setzero_pd();
+    __m128d acc_hi = _mm_setzero_pd();
+    size_t idx = 0;
+    for (; (idx + 4) <= count; idx += 4)
+    {
+        acc_lo = _mm_add_pd(acc_lo, _mm_loadu_pd(p_data + idx));
+        acc_hi = _mm_add_pd(acc_hi, _mm_loadu_pd(p_data + idx + 2));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(acc_lo, acc_hi));
+    return lanes[0] + lanes[1] +
+           value_vector_sum_f64_scalar(p_data + idx, count - idx);
+}
+
+/*!
+ * @brief This is a static function that folds a double array into a
+ *          running minimum and maximum two elements at a time with SSE2.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in/out] p_min The running minimum.
+ * @param[in/out] p_max The running maximum.
+ *
+ * @return No return value expected.
+ */
+static void
+value_vector_min_max_f64_sse2 (const double * p_data,
+                               const size_t count,
+                               double * p_min,
+                               double * p_max)
+{
+    __m128d lo = _mm_set1_pd(*p_min);
+    __m128d hi = _mm_set1_pd(*p_max);
+    size_t idx = 0;
+    for (; (idx + 2) <= count; idx += 2)
+    {
+        __m128d lanes = _mm_loadu_pd(p_data + idx);
+        lo = _mm_min_pd(lo, lanes);
+        hi = _mm_max_pd(hi, lanes);
+    }
+    double lows[2];
+    double highs[2];
+    _mm_storeu_pd(lows, lo);
+    _mm_storeu_pd(highs, hi);
+    value_vector_min_max_f64_scalar(lows, 2, p_min, p_max);
+    value_vector_min_max_f64_scalar(highs, 2, p_min, p_max);
+    value_vector_min_max_f64_scalar(p_data + idx, count - idx, p_min, p_max);
+}
+
+/*!
+ * @brief This is a static function that sums an int32_t array eight
+ *          elements at a time with AVX2.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ *
+ * @return The sum.
+ */
+__attribute__((target("avx2")))
+static int64_t
+value_vector_sum_i32_avx2 (const int32_t * p_data, const size_t count)
+{
+    __m256i acc_lo = _mm256_setzero_si256();
+    __m256i acc_hi = _mm256_setzero_si256();
+    size_t idx = 0;
+    for (; (idx + 8) <= count; idx += 8)
+    {
+        __m128i lo = _mm_loadu_si128((const __m128i *) (p_data + idx));
+        __m128i hi = _mm_loadu_si128((const __m128i *) (p_data + idx + 4));
+        acc_lo = _mm256_add_epi64(acc_lo, _mm256_cvtepi32_epi64(lo));
+        acc_hi = _mm256_add_epi64(acc_hi, _mm256_cvtepi32_epi64(hi));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i *) lanes, _mm256_add_epi64(acc_lo, acc_hi));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+           value_vector_sum_i32_scalar(p_data + idx, count - idx);
+}
+
+/*!
+ * @brief This is a static function that folds an int32_t array into a
+ *          running minimum and maximum eight elements at a time with AVX2.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in/out] p_min The running minimum.
+ * @param[in/out] p_max The running maximum.
+ *
+ * @return No return value expected.
+ */
+__attribute__((target("avx2")))
+static void
+value_vector_min_max_i32_avx2 (const int32_t * p_data,
+                               const size_t count,
+                               int32_t * p_min,
+                               int32_t * p_max)
+{
+    __m256i lo = _mm256_set1_epi32(*p_min);
+    __m256i hi = _mm256_set1_epi32(*p_max);
+    size_t idx = 0;
+    for (; (idx + 8) <= count; idx += 8)
+    {
+        __m256i lanes = _mm256_loadu_si256((const __m256i *) (p_data + idx));
+        lo = _mm256_min_epi32(lo, lanes);
+        hi = _mm256_max_epi32(hi, lanes);
+    }
+    int32_t lows[8];
+    int32_t highs[8];
+    _mm256_storeu_si256((__m256i *) lows, lo);
+    _mm256_storeu_si256((__m256i *) highs, hi);
+    value_vector_min_max_i32_scalar(lows, 8, p_min, p_max);
+    value_vector_min_max_i32_scalar(highs, 8, p_min, p_max);
+    value_vector_min_max_i32_scalar(p_data + idx, count - idx, p_min, p_max);
+}
+
+/*!
+ * @brief This is a static function that sums a double array eight
+ *          elements at a time with AVX2.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ *
+ * @return The sum.
+ */
+__attribute__((target("avx2")))
+static double
+value_vector_sum_f64_avx2 (const double * p_data, const size_t count)
+{
+    __m256d acc_lo = _mm256_setzero_pd();
+    __m256d acc_hi = _mm256_setzero_pd();
+    size_t idx = 0;
+    for (; (idx + 8) <= count; idx += 8)
+    {
+        acc_lo = _mm256_add_pd(acc_lo, _mm256_loadu_pd(p_data + idx));
+        acc_hi = _mm256_add_pd(acc_hi, _mm256_loadu_pd(p_data + idx + 4));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc_lo, acc_hi));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+           value_vector_sum_f64_scalar(p_data + idx, count - idx);
+}
+
+/*!
+ * @brief This is a static function that folds a double array into a
+ *          running minimum and maximum four elements at a time with AVX2.
+ *
+ * @param[in] p_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in/out] p_min The running minimum.
+ * @param[in/out] p_max The running maximum.
+ *
+ * @return No return value expected.
+ */
+__attribute__((target("avx2")))
+static void
+value_vector_min_max_f64_avx2 (const double * p_data,
+                               const size_t count,
+                               double * p_min,
+                               double * p_max)
+{
+    __m256d lo = _mm256_set1_pd(*p_min);
+    __m256d hi = _mm256_set1_pd(*p_max);
+    size_t idx = 0;
+    for (; (idx + 4) <= count; idx += 4)
+    {
+        __m256d lanes = _mm256_loadu_pd(p_data + idx);
+        lo = _mm256_min_pd(lo, lanes);
+        hi = _mm256_max_pd(hi, lanes);
+    }
+    double lows[4];
+    double highs[4];
+    _mm256_storeu_pd(lows, lo);
+    _mm256_storeu_pd(highs, hi);
+    value_vector_min_max_f64_scalar(lows, 4, p_min, p_max);
+    value_vector_min_max_f64_scalar(highs, 4, p_min, p_max);
+    value_vector_min_max_f64_scalar(p_data + idx, count - idx, p_min, p_max);
+}
+
+#endif // VALUE_VECTOR_SCAN_X86_64
+
+/*!
+ * @brief This function sums the elements of a vector of int32_t.
+ *
+ * @param[in] p_vector The value vector context.
+ * @param[out] p_sum Receives the sum. 0 for an empty vector.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_sum_i32 (const value_vector_t * p_vector, int64_t * p_sum)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == p_sum) ||
+        (sizeof(int32_t) != p_vector->elem_size))
+    {
+        goto EXIT;
+    }
+    
+    const int32_t * p_data = (const int32_t *) p_vector->p_data;
+#if VALUE_VECTOR_SCAN_X86_64
+    if (__builtin_cpu_supports("avx2"))
+    {
+        *p_sum = value_vector_sum_i32_avx2(p_data, p_vector->size);
+    }
+    else
+    {
+        *p_sum = value_vector_sum_i32_sse2(p_data, p_vector->size);
+    }
+#else
+    *p_sum = value_vector_sum_i32_scalar(p_data, p_vector->size);
+#endif
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function finds the smallest and largest elements of a
+ *          vector of int32_t.
+ *
+ * @param[in] p_vector The value vector context.
+ * @param[out] p_min Receives the smallest element.
+ * @param[out] p_max Receives the largest element.
+ *
+ * @return 0 on success, -1 on error or empty vector.
+ */
+int
+value_vector_min_max_i32 (const value_vector_t * p_vector,
+                          int32_t * p_min,
+                          int32_t * p_max)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == p_min) ||
+        (NULL == p_max) ||
+        (sizeof(int32_t) != p_vector->elem_size) ||
+        (0 == p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    // Seed both bounds with the first element.
+    const int32_t * p_data = (const int32_t *) p_vector->p_data;
+    *p_min = p_data[0];
+    *p_max = p_data[0];
+#if VALUE_VECTOR_SCAN_X86_64
+    if (__builtin_cpu_supports("avx2"))
+    {
+        value_vector_min_max_i32_avx2(p_data, p_vector->size, p_min, p_max);
+    }
+    else
+    {
+        value_vector_min_max_i32_sse2(p_data, p_vector->size, p_min, p_max);
+    }
+#else
+    value_vector_min_max_i32_scalar(p_data, p_vector->size, p_min, p_max);
+#endif
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function sums the elements of a vector of double.
+ *
+ *          The elements are added in an unspecified order, so the result
+ *              may differ from a left-to-right sum by rounding.
+ *
+ * @param[in] p_vector The value vector context.
+ * @param[out] p_sum Receives the sum. 0 for an empty vector.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+value_vector_sum_f64 (const value_vector_t * p_vector, double * p_sum)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == p_sum) ||
+        (sizeof(double) != p_vector->elem_size))
+    {
+        goto EXIT;
+    }
+    
+    const double * p_data = (const double *) p_vector->p_data;
+#if VALUE_VECTOR_SCAN_X86_64
+    if (__builtin_cpu_supports("avx2"))
+    {
+        *p_sum = value_vector_sum_f64_avx2(p_data, p_vector->size);
+    }
+    else
+    {
+        *p_sum = value_vector_sum_f64_sse2(p_data, p_vector->size);
+    }
+#else
+    *p_sum = value_vector_sum_f64_scalar(p_data, p_vector->size);
+#endif
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function finds the smallest and largest elements of a
+ *          vector of double.
+ *
+ *          The result is unspecified if the vector holds a NaN.
+ *
+ * @param[in] p_vector The value vector context.
+ * @param[out] p_min Receives the smallest element.
+ * @param[out] p_max Receives the largest element.
+ *
+ * @return 0 on success, -1 on error or empty vector.
+ */
+int
+value_vector_min_max_f64 (const value_vector_t * p_vector,
+                          double * p_min,
+                          double * p_max)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == p_min) ||
+        (NULL == p_max) ||
+        (sizeof(double) != p_vector->elem_size) ||
+        (0 == p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    // Seed both bounds with the first element.
+    const double * p_data = (const double *) p_vector->p_data;
+    *p_min = p_data[0];
+    *p_max = p_data[0];
+#if VALUE_VECTOR_SCAN_X86_64
+    if (__builtin_cpu_supports("avx2"))
+    {
+        value_vector_min_max_f64_avx2(p_data, p_vector->size, p_min, p_max);
+    }
+    else
+    {
+        value_vector_min_max_f64_sse2(p_data, p_vector->size, p_min, p_max);
+    }
+#else
+    value_vector_min_max_f64_scalar(p_data, p_vector->size, p_min, p_max);
+#endif
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
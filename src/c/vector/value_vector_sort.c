@@ -0,0 +1,198 @@
+/*!
+ * @file value_vector_sort.c
+ *
+ * @brief This file contains a radix sort for value vectors whose
+ *          elements carry an integer key.
+ *
+ *          The sort is a least significant digit radix sort with one byte
+ *              per pass. The counts for every pass are gathered in a
+ *              single read of the vector, and a pass in which every key
+ *              shares the same byte is skipped. The sort is stable and
+ *              runs in O(n) time for a fixed key size.
+ *
+ *          Functions included are as follows:
+ *
+ *              - value_vector_radix_sort()
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include "value_vector.h"
+
+/*** Number of buckets per pass, one for each value of a byte. ***/
+#define VALUE_VECTOR_RADIX 256
+
+/*!
+ * @brief This is a static function that reads the key of an element as
+ *          an unsigned integer that orders the same way as the key.
+ *
+ *          A signed key has its sign bit flipped, which moves negative
+ *              keys below non-negative ones.
+ *
+ * @param[in] p_elem The element.
+ * @param[in] key_offset The offset in bytes of the key in the element.
+ * @param[in] key_size The size in bytes of the key. 1, 2, 4 or 8.
+ * @param[in] b_signed Whether the key is a signed integer.
+ *
+ * @return The key.
+ */
+static uint64_t
+value_vector_radix_key (const unsigned char * p_elem,
+                        const size_t key_offset,
+                        const size_t key_size,
+                        const bool b_signed)
+{
+    uint64_t key = 0;
+    switch (key_size)
+    {
+        case sizeof(uint8_t):
+        {
+            uint8_t value = 0;
+            memcpy(&value, p_elem + key_offset, sizeof(value));
+            key = value;
+            break;
+        }
+        case sizeof(uint16_t):
+        {
+            uint16_t value = 0;
+            memcpy(&value, p_elem + key_offset, sizeof(value));
+            key = value;
+            break;
+        }
+        case sizeof(uint32_t):
+        {
+            uint32_t value = 0;
+            memcpy(&value, p_elem + key_offset, sizeof(value));
+            key = value;
+            break;
+        }
+        default:
+        {
+            memcpy(&key, p_elem + key_offset, sizeof(key));
+            break;
+        }
+    }
+    if (b_signed)
+    {
+        key ^= (uint64_t) 1 << ((key_size * 8) - 1);
+    }
+    return key;
+}
+
+/*!
+ * @brief This function sorts the vector into ascending order of an
+ *          integer key stored in each element.
+ *
+ * @param[in/out] p_vector The value vector context.
+ * @param[in] key_offset The offset in bytes of the key in an element.
+ * @param[in] key_size The size in bytes of the key. 1, 2, 4 or 8.
+ * @param[in] b_signed Whether the key is a signed integer.
+ *
+ * @return 0 on success, -1 on error. The vector is unchanged on error.
+ */
+int
+value_vector_radix_sort (value_vector_t * p_vector,
+                         const size_t key_offset,
+                         const size_t key_size,
+                         const bool b_signed)
+{
+    int status = -1;
+    size_t * p_counts = NULL;
+    unsigned char * p_scratch = NULL;
+    if ((NULL == p_vector) ||
+        ((sizeof(uint8_t) != key_size) &&
+         (sizeof(uint16_t) != key_size) &&
+         (sizeof(uint32_t) != key_size) &&
+         (sizeof(uint64_t) != key_size)) ||
+        (key_offset > p_vector->elem_size) ||
+        (key_size > (p_vector->elem_size - key_offset)))
+    {
+        goto EXIT;
+    }
+    if (p_vector->size < 2)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    // The scratch array matches the vector's capacity and comes from the
+    // vector's allocator, so the two may simply trade places after an odd
+    // number of passes.
+    const size_t elem_size = p_vector->elem_size;
+    p_counts = calloc(key_size * VALUE_VECTOR_RADIX, sizeof(size_t));
+    p_scratch = allocator_alloc(p_vector->p_alloc, p_vector->cap * elem_size);
+    if ((NULL == p_counts) ||
+        (NULL == p_scratch))
+    {
+        goto EXIT;
+    }
+    
+    // Count the bytes of every key for all passes at once.
+    for (size_t idx = 0; idx < p_vector->size; ++idx)
+    {
+        uint64_t key = value_vector_radix_key(p_vector->p_data +
+                                              (idx * elem_size),
+                                              key_offset, key_size,
+                                              b_signed);
+        for (size_t pass = 0; pass < key_size; ++pass)
+        {
+            p_counts[(pass * VALUE_VECTOR_RADIX) +
+                     ((key >> (pass * 8)) & 0xFF)]++;
+        }
+    }
+    
+    unsigned char * p_src = p_vector->p_data;
+    unsigned char * p_dst = p_scratch;
+    for (size_t pass = 0; pass < key_size; ++pass)
+    {
+        size_t * p_pass = p_counts + (pass * VALUE_VECTOR_RADIX);
+        
+        // Skip the pass if every key has the same byte here.
+        uint64_t first = value_vector_radix_key(p_src, key_offset,
+                                                key_size, b_signed);
+        if (p_pass[(first >> (pass * 8)) & 0xFF] == p_vector->size)
+        {
+            continue;
+        }
+        
+        // Turn the counts into the starting offset of each bucket.
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < VALUE_VECTOR_RADIX; ++bucket)
+        {
+            size_t count = p_pass[bucket];
+            p_pass[bucket] = offset;
+            offset += count;
+        }
+        
+        for (size_t idx = 0; idx < p_vector->size; ++idx)
+        {
+            const unsigned char * p_elem = p_src + (idx * elem_size);
+            uint64_t key = value_vector_radix_key(p_elem, key_offset,
+                                                  key_size, b_signed);
+            size_t pos = p_pass[(key >> (pass * 8)) & 0xFF]++;
+            memcpy(p_dst + (pos * elem_size), p_elem, elem_size);
+        }
+        
+        unsigned char * p_tmp = p_src;
+        p_src = p_dst;
+        p_dst = p_tmp;
+    }
+    
+    // Keep whichever array ended up holding the sorted elements.
+    p_vector->p_data = p_src;
+    p_scratch = p_dst;
+    
+    status = 0;
+    
+    EXIT:
+        free(p_counts);
+        if (NULL != p_vector)
+        {
+            allocator_free(p_vector->p_alloc, p_scratch,
+                           p_vector->cap * p_vector->elem_size);
+        }
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -8,22 +8,165 @@
  *
  *          Reallocations of memory occur automatically when the
  *              number of elements in the vector exceed the allocated
- *              space.
+ *              space. The capacity grows geometrically, so appending
+ *              is amortized O(1).
+ *
+ *          Elements need not start at the beginning of the allocated
+ *              array. Removing from the front just moves the start
+ *              forward, and adding to the front uses the free space in
+ *              front of the start, so both ends support amortized O(1)
+ *              insertion and removal.
+ *
+ *          The first VECTOR_INLINE_CAP references are stored inside the
+ *              vector context, so small vectors need no array of their
+ *              own.
  *
  *          Functions included are as follows:
  *
  *              - vector_create()
+ *              - vector_create_with_allocator()
  *              - vector_destroy()
+ *              - vector_init()
+ *              - vector_init_with_allocator()
+ *              - vector_fini()
  *              - vector_reserve()
  *              - vector_push_back()
  *              - vector_push_front()
  *              - vector_pop_back()
  *              - vector_pop_front()
  *              - vector_at()
+ *              - vector_append_n()
+ *              - vector_insert_range()
+ *              - vector_erase_range()
+ *              - vector_shrink_to_fit()
  */
 
+#include <string.h>
+#include <stdint.h>
+
 #include "vector.h"
 
+/*!
+ * @brief This is a static function that moves the elements down to the
+ *          start of the allocated array, turning the free slots in front
+ *          of them into free slots behind them.
+ *
+ * @param[in/out] p_vector The vector context.
+ *
+ * @return No return value expected.
+ */
+static void
+vector_slide (vector_t * p_vector)
+{
+    if (0 == p_vector->front)
+    {
+        goto EXIT;
+    }
+    
+    memmove(p_vector->pp_base, p_vector->pp_data,
+            p_vector->size * sizeof(void *));
+    p_vector->cap += p_vector->front;
+    p_vector->front = 0;
+    p_vector->pp_data = p_vector->pp_base;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This is a static function that makes sure there is a free slot
+ *          in front of the first element.
+ *
+ *          The free space opened up is at least as large as the vector,
+ *              so a series of prepends moves the elements only O(log n)
+ *              times.
+ *
+ * @param[in/out] p_vector The vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+vector_grow_front (vector_t * p_vector)
+{
+    int status = -1;
+    if (0 != p_vector->front)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    size_t room = p_vector->size;
+    if (room < VECTOR_INIT_CAP)
+    {
+        room = VECTOR_INIT_CAP;
+    }
+    
+    // Allocate the extra space behind the elements, then move them up
+    // past it.
+    if (-1 == vector_reserve(p_vector, room))
+    {
+        goto EXIT;
+    }
+    memmove(p_vector->pp_base + room, p_vector->pp_base,
+            p_vector->size * sizeof(void *));
+    p_vector->front = room;
+    p_vector->pp_data = p_vector->pp_base + room;
+    p_vector->cap -= room;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This is a static function that makes sure the vector has space
+ *          for at least a given number of elements.
+ *
+ *          The capacity is at least doubled when it has to grow, so a
+ *              series of appends reallocates only O(log n) times.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] min_cap The number of elements needed.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+vector_grow (vector_t * p_vector, const size_t min_cap)
+{
+    int status = -1;
+    if (min_cap <= p_vector->cap)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    // Reclaim the space left in front by pops from the front, as long as
+    // that is at least as much as is in use. Otherwise grow the array.
+    if ((p_vector->front >= p_vector->size) &&
+        (min_cap <= (p_vector->cap + p_vector->front)))
+    {
+        vector_slide(p_vector);
+        status = 0;
+        goto EXIT;
+    }
+    
+    size_t new_cap = p_vector->cap * 2;
+    if (new_cap < VECTOR_INIT_CAP)
+    {
+        new_cap = VECTOR_INIT_CAP;
+    }
+    if (new_cap < min_cap)
+    {
+        new_cap = min_cap;
+    }
+    
+    status = vector_reserve(p_vector, new_cap - p_vector->cap);
+    
+    EXIT:
+        return status;
+}
+
 /*!
  * @brief This function instantiates a new vector context.
  *
@@ -32,14 +175,27 @@
 vector_t *
 vector_create (void)
 {
-    vector_t * p_vector = calloc(1, sizeof(vector_t));
+    return vector_create_with_allocator(NULL);
+}
+
+/*!
+ * @brief This function instantiates a new vector context that allocates
+ *          through a given allocator.
+ *
+ * @param[in] p_alloc The allocator for the context and its array. NULL
+ *              for the standard library.
+ *
+ * @return Pointer to new vector context. NULL on error.
+ */
+vector_t *
+vector_create_with_allocator (const allocator_t * p_alloc)
+{
+    vector_t * p_vector = allocator_calloc(p_alloc, 1, sizeof(vector_t));
     if (NULL == p_vector)
     {
         goto EXIT;
     }
-    p_vector->pp_data = NULL;
-    p_vector->size = 0;
-    p_vector->cap = 0;
+    vector_init_with_allocator(p_vector, p_alloc);
     
     EXIT:
         return p_vector;
@@ -61,22 +217,93 @@ vector_create (void)
 void
 vector_destroy (vector_t * p_vector)
 {
-    if ((NULL == p_vector) ||
-        (NULL == p_vector->pp_data))
+    if (NULL == p_vector)
     {
         goto EXIT;
     }
     
-    // Free the data reference array.
-    free(p_vector->pp_data);
-    p_vector->pp_data = NULL;
+    // Free the data reference array, then the context.
+    const allocator_t * p_alloc = p_vector->p_alloc;
+    vector_fini(p_vector);
+    allocator_free(p_alloc, p_vector, sizeof(vector_t));
+    p_vector = NULL;
+    
+    EXIT:
+        return;
+}
+
+/*!
+ * @brief This function sets up an empty vector in caller-provided
+ *          storage, such as a local variable or a struct member.
+ *
+ * @param[out] p_vector The vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+vector_init (vector_t * p_vector)
+{
+    return vector_init_with_allocator(p_vector, NULL);
+}
+
+/*!
+ * @brief This function sets up an empty vector in caller-provided storage
+ *          that allocates its array through a given allocator.
+ *
+ * @param[out] p_vector The vector context.
+ * @param[in] p_alloc The allocator for the array. NULL for the standard
+ *              library.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+vector_init_with_allocator (vector_t * p_vector, const allocator_t * p_alloc)
+{
+    int status = -1;
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    // Start out on the inline references.
+    p_vector->pp_base = p_vector->p_inline;
+    p_vector->pp_data = p_vector->p_inline;
+    p_vector->size = 0;
+    p_vector->cap = VECTOR_INLINE_CAP;
+    p_vector->front = 0;
+    p_vector->p_alloc = p_alloc;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function releases any memory held by a vector set up with
+ *          vector_init, leaving it empty. The context itself is not freed,
+ *          and the vector keeps its allocator.
+ *
+ * @param[in/out] p_vector The vector context.
+ *
+ * @return No return value expected.
+ */
+void
+vector_fini (vector_t * p_vector)
+{
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    if (p_vector->pp_base != p_vector->p_inline)
+    {
+        allocator_free(p_vector->p_alloc, p_vector->pp_base,
+                       (p_vector->front + p_vector->cap) * sizeof(void *));
+    }
+    vector_init_with_allocator(p_vector, p_vector->p_alloc);
     
     EXIT:
-        if (NULL != p_vector)
-        {
-            free(p_vector);
-            p_vector = NULL;
-        }
         return;
 }
 
@@ -98,14 +325,37 @@ vector_reserve (vector_t * p_vector, const size_t amt)
         goto EXIT;
     }
     
-    // Perform a reallocation of the vector's data array.
-    size_t new_size = (p_vector->cap + amt) * sizeof(void *);
-    p_vector->pp_data = realloc(p_vector->pp_data, new_size);
+    size_t alloc = p_vector->front + p_vector->cap;
+    if (amt > ((SIZE_MAX / sizeof(void *)) - alloc))
+    {
+        goto EXIT;
+    }
+    
+    // Perform a reallocation of the vector's data array. On failure the
+    // original array is left intact. Inline references are copied out to
+    // the first allocated array.
+    size_t new_size = (alloc + amt) * sizeof(void *);
+    void ** pp_new = NULL;
+    if (p_vector->pp_base == p_vector->p_inline)
+    {
+        pp_new = allocator_alloc(p_vector->p_alloc, new_size);
+        if (NULL != pp_new)
+        {
+            memcpy(pp_new, p_vector->p_inline, alloc * sizeof(void *));
+        }
+    }
+    else
+    {
+        pp_new = allocator_realloc(p_vector->p_alloc, p_vector->pp_base,
+                                   alloc * sizeof(void *), new_size);
+    }
     
-    if (NULL == p_vector->pp_data)
+    if (NULL == pp_new)
     {
         goto EXIT;
     }
+    p_vector->pp_base = pp_new;
+    p_vector->pp_data = pp_new + p_vector->front;
     
     // Adjust the vector's capacity parameter.
     p_vector->cap += amt;
@@ -135,8 +385,7 @@ vector_push_back (vector_t * p_vector, void * p_data)
     }
     
     // If the vector is full, allocate more space.
-    if ((p_vector->size >= p_vector->cap) &&
-        (-1 == vector_reserve(p_vector, 1)))
+    if (-1 == vector_grow(p_vector, p_vector->size + 1))
     {
         goto EXIT;
     }
@@ -171,18 +420,16 @@ vector_push_front (vector_t * p_vector, void * p_data)
         goto EXIT;
     }
     
-    // If the vector is full, allocate more space.
-    if ((p_vector->size >= p_vector->cap) &&
-        (-1 == vector_reserve(p_vector, 1)))
+    // If there is no space in front of the first element, make some.
+    if (-1 == vector_grow_front(p_vector))
     {
         goto EXIT;
     }
     
-    // Shift all elements of the vector back one position.
-    for (size_t idx = p_vector->size; idx > 0; --idx)
-    {
-        p_vector->pp_data[idx] = p_vector->pp_data[idx-1];
-    }
+    // Move the start of the vector back one position.
+    p_vector->front--;
+    p_vector->pp_data--;
+    p_vector->cap++;
     
     // Prepend the new data.
     p_vector->pp_data[0] = p_data;
@@ -210,7 +457,6 @@ vector_pop_back (vector_t * p_vector)
 {
     void * p_result = NULL;
     if ((NULL == p_vector) ||
-        (NULL == p_vector->pp_data) ||
         (0 == p_vector->size))
     {
         goto EXIT;
@@ -241,7 +487,6 @@ vector_pop_front (vector_t * p_vector)
 {
     void * p_result = NULL;
     if ((NULL == p_vector) ||
-        (NULL == p_vector->pp_data) ||
         (0 == p_vector->size))
     {
         goto EXIT;
@@ -250,16 +495,20 @@ vector_pop_front (vector_t * p_vector)
     // Save the reference to the data of the last element in the vector.
     p_result = p_vector->pp_data[0];
     
-    // Shift all elements of the vector forward one position.
-    for (size_t idx = 0; idx < p_vector->size - 1; ++idx)
+    // Remove the element by moving the start of the vector forward one
+    // position. No elements are shifted.
+    p_vector->front++;
+    p_vector->pp_data++;
+    p_vector->cap--;
+    p_vector->size--;
+    
+    // Once empty, the space in front can be reclaimed without moving
+    // anything.
+    if (0 == p_vector->size)
     {
-        p_vector->pp_data[idx] = p_vector->pp_data[idx + 1];
+        vector_slide(p_vector);
     }
     
-    // Remove the element by simply decrementing the size. No
-    // reallocations need occur.
-    p_vector->size--;
-    
     EXIT:
         return p_result;
 }
@@ -268,18 +517,17 @@ vector_pop_front (vector_t * p_vector)
  * @brief This function returns the data reference at a specified
  *          index in the vector.
  *
- * @param[in/out] p_vector The vector context.
+ * @param[in] p_vector The vector context.
  * @param[in] idx The index of the reference to return.
  *
  * @return Pointer to the referenced data of the element at the specified
  *          index. NULL on error or index out of range.
  */
 void *
-vector_at (vector_t * p_vector, const size_t idx)
+vector_at (const vector_t * p_vector, const size_t idx)
 {
     void * p_result = NULL;
     if ((NULL == p_vector) ||
-        (NULL == p_vector->pp_data) ||
         (idx >= p_vector->size))
     {
         goto EXIT;
@@ -292,4 +540,182 @@ vector_at (vector_t * p_vector, const size_t idx)
         return p_result;
 }
 
-/***   end of file   ***/
+/*!
+ * @brief This function appends an array of elements to the back of the
+ *          vector.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] pp_data The data references to append, in order. None may
+ *              be NULL.
+ * @param[in] count The number of references in pp_data.
+ *
+ * @return 0 on success, -1 on error. The vector is unchanged on error.
+ */
+int
+vector_append_n (vector_t * p_vector, void ** pp_data, const size_t count)
+{
+    int status = -1;
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    status = vector_insert_range(p_vector, p_vector->size, pp_data, count);
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function inserts an array of elements into the vector
+ *          before a specified index.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] idx The index to insert at. Equal to the size to append.
+ * @param[in] pp_data The data references to insert, in order. None may
+ *              be NULL.
+ * @param[in] count The number of references in pp_data.
+ *
+ * @return 0 on success, -1 on error. The vector is unchanged on error.
+ */
+int
+vector_insert_range (vector_t * p_vector,
+                     const size_t idx,
+                     void ** pp_data,
+                     const size_t count)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == pp_data) ||
+        (idx > p_vector->size) ||
+        (count > (SIZE_MAX / sizeof(void *)) - p_vector->size))
+    {
+        goto EXIT;
+    }
+    
+    // Like vector_push_back, refuse NULL references.
+    for (size_t src = 0; src < count; ++src)
+    {
+        if (NULL == pp_data[src])
+        {
+            goto EXIT;
+        }
+    }
+    
+    // Make room once for the whole run.
+    if (-1 == vector_grow(p_vector, p_vector->size + count))
+    {
+        goto EXIT;
+    }
+    
+    // Open a gap at the index and copy the new elements into it.
+    memmove(p_vector->pp_data + idx + count, p_vector->pp_data + idx,
+            (p_vector->size - idx) * sizeof(void *));
+    memcpy(p_vector->pp_data + idx, pp_data, count * sizeof(void *));
+    p_vector->size += count;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function removes a run of consecutive elements from the
+ *          vector.
+ *
+ *          Any data referenced by the removed elements will NOT be freed.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] idx The index of the first element to remove.
+ * @param[in] count The number of elements to remove.
+ *
+ * @return 0 on success, -1 on error or range out of bounds.
+ */
+int
+vector_erase_range (vector_t * p_vector,
+                    const size_t idx,
+                    const size_t count)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (idx > p_vector->size) ||
+        (count > (p_vector->size - idx)))
+    {
+        goto EXIT;
+    }
+    
+    // Close the gap with a single move of the trailing elements.
+    memmove(p_vector->pp_data + idx, p_vector->pp_data + idx + count,
+            (p_vector->size - idx - count) * sizeof(void *));
+    p_vector->size -= count;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function releases any allocated space beyond the elements
+ *          currently in the vector.
+ *
+ * @param[in/out] p_vector The vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+vector_shrink_to_fit (vector_t * p_vector)
+{
+    int status = -1;
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    // Drop the space in front of the elements. The inline references
+    // have nothing more to give up.
+    vector_slide(p_vector);
+    if (p_vector->pp_base == p_vector->p_inline)
+    {
+        status = 0;
+        goto EXIT;
+    }
+    
+    // A vector that fits inline gives up its array entirely.
+    if (p_vector->size <= VECTOR_INLINE_CAP)
+    {
+        void ** pp_old = p_vector->pp_base;
+        memcpy(p_vector->p_inline, pp_old, p_vector->size * sizeof(void *));
+        p_vector->pp_base = p_vector->p_inline;
+        p_vector->pp_data = p_vector->p_inline;
+        allocator_free(p_vector->p_alloc, pp_old,
+                       p_vector->cap * sizeof(void *));
+        p_vector->cap = VECTOR_INLINE_CAP;
+        status = 0;
+        goto EXIT;
+    }
+    
+    // Drop the space behind the elements.
+    if (p_vector->size < p_vector->cap)
+    {
+        void ** pp_new = allocator_realloc(p_vector->p_alloc,
+                                           p_vector->pp_base,
+                                           p_vector->cap * sizeof(void *),
+                                           p_vector->size * sizeof(void *));
+        if (NULL == pp_new)
+        {
+            goto EXIT;
+        }
+        p_vector->pp_base = pp_new;
+        p_vector->pp_data = pp_new;
+        p_vector->cap = p_vector->size;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -8,18 +8,46 @@
  *
  *          Reallocations of memory occur automatically when the
  *              number of elements in the vector exceed the allocated
- *              space.
+ *              space. The capacity grows geometrically, so appending
+ *              is amortized O(1).
+ *
+ *          Elements need not start at the beginning of the allocated
+ *              array. Removing from the front just moves the start
+ *              forward, and adding to the front uses the free space in
+ *              front of the start, so both ends support amortized O(1)
+ *              insertion and removal.
+ *
+ *          The first VECTOR_INLINE_CAP references are stored inside the
+ *              vector context itself, and an array is only allocated
+ *              once they overflow. A vector set up with vector_init in
+ *              caller-provided storage therefore never allocates while
+ *              it stays small. No vector context, however it was set
+ *              up, may be copied or moved by value, since its data may
+ *              point into itself.
  *
  *          Functions included are as follows:
  *
  *              - vector_create()
+ *              - vector_create_with_allocator()
  *              - vector_destroy()
+ *              - vector_init()
+ *              - vector_init_with_allocator()
+ *              - vector_fini()
  *              - vector_reserve()
  *              - vector_push_back()
  *              - vector_push_front()
  *              - vector_pop_back()
  *              - vector_pop_front()
  *              - vector_at()
+ *              - vector_append_n()
+ *              - vector_insert_range()
+ *              - vector_erase_range()
+ *              - vector_shrink_to_fit()
+ *              - vector_find()
+ *              - vector_count_eq()
+ *              - vector_filter_into()
+ *              - vector_sort()
+ *              - vector_sort_range()
  */
 
 #ifndef VECTOR_H
@@ -27,18 +55,58 @@
 
 #include <stdlib.h>
 
+#include "src/c/allocator/allocator.h"
+
+/*** Number of elements allocated by the first automatic growth. ***/
+#define VECTOR_INIT_CAP 8
+
+/*** Number of references stored inside the vector context. ***/
+#define VECTOR_INLINE_CAP 8
+
+/*!
+ * @brief This datatype defines a function template for comparing two
+ *          references held in a vector.
+ *
+ * @param p_lhs The first reference.
+ * @param p_rhs The second reference.
+ *
+ * @return Negative if p_lhs orders before p_rhs, positive if after, and
+ *          0 if they are equivalent.
+ */
+typedef int (*vector_cmp_f)(const void * p_lhs, const void * p_rhs);
+
 /*!
  * @brief This datatype defines a vector context.
  *
- * @param pp_data The array containing the data references.
+ *          While the elements fit in p_inline, pp_data and pp_base point
+ *              into the context itself. A vector_t must therefore never
+ *              be copied or moved by value, for example by assignment or
+ *              memcpy: the copy would still point at the original's
+ *              inline storage, and changes through either one would
+ *              corrupt both. Pass it by pointer, and use vector_init in
+ *              the final location of an embedded vector.
+ *
+ * @param pp_data The array containing the data references. This points
+ *          at the first element, front slots into the allocated array.
  * @param size The number of elements in the vector.
- * @param cap The number of elements the vector has allocated space for.
+ * @param cap The number of elements the vector has allocated space for,
+ *          counting from pp_data.
+ * @param pp_base The allocated array, or p_inline while the elements
+ *          fit there.
+ * @param front The number of free slots in front of the first element.
+ * @param p_inline The references stored inside the context.
+ * @param p_alloc The allocator for the context and its array. NULL for
+ *          the standard library.
  */
 typedef struct _vector
 {
     void ** pp_data;
     size_t size;
     size_t cap;
+    void ** pp_base;
+    size_t front;
+    void * p_inline[VECTOR_INLINE_CAP];
+    const allocator_t * p_alloc;
 } vector_t;
 
 /*!
@@ -49,6 +117,18 @@ typedef struct _vector
 vector_t *
 vector_create (void);
 
+/*!
+ * @brief This function instantiates a new vector context that allocates
+ *          through a given allocator.
+ *
+ * @param[in] p_alloc The allocator for the context and its array. NULL
+ *              for the standard library.
+ *
+ * @return Pointer to new vector context. NULL on error.
+ */
+vector_t *
+vector_create_with_allocator (const allocator_t * p_alloc);
+
 /*!
  * @brief This function destroys a vector context.
  *
@@ -59,6 +139,45 @@ vector_create (void);
 void
 vector_destroy (vector_t * p_vector);
 
+/*!
+ * @brief This function sets up an empty vector in caller-provided
+ *          storage, such as a local variable or a struct member.
+ *
+ *          No memory is allocated until the vector holds more than
+ *              VECTOR_INLINE_CAP references.
+ *
+ * @param[out] p_vector The vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+vector_init (vector_t * p_vector);
+
+/*!
+ * @brief This function sets up an empty vector in caller-provided storage
+ *          that allocates its array through a given allocator.
+ *
+ * @param[out] p_vector The vector context.
+ * @param[in] p_alloc The allocator for the array. NULL for the standard
+ *              library.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+vector_init_with_allocator (vector_t * p_vector, const allocator_t * p_alloc);
+
+/*!
+ * @brief This function releases any memory held by a vector set up with
+ *          vector_init, leaving it empty. The context itself is not freed,
+ *          and the vector keeps its allocator.
+ *
+ * @param[in/out] p_vector The vector context.
+ *
+ * @return No return value expected.
+ */
+void
+vector_fini (vector_t * p_vector);
+
 /*!
  * @brief This function allocates space for a specified number of elements
  *          in the vector.
@@ -121,15 +240,154 @@ vector_pop_front (vector_t * p_vector);
  * @brief This function returns the data reference at a specified
  *          index in the vector.
  *
- * @param[in/out] p_vector The vector context.
+ * @param[in] p_vector The vector context.
  * @param[in] idx The index of the reference to return.
  *
  * @return Pointer to the referenced data of the element at the specified
  *          index. NULL on error or index out of range.
  */
 void *
-vector_at (vector_t * p_vector, const size_t idx);
+vector_at (const vector_t * p_vector, const size_t idx);
+
+/*!
+ * @brief This function appends an array of elements to the back of the
+ *          vector.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] pp_data The data references to append, in order. None may
+ *              be NULL.
+ * @param[in] count The number of references in pp_data.
+ *
+ * @return 0 on success, -1 on error. The vector is unchanged on error.
+ */
+int
+vector_append_n (vector_t * p_vector, void ** pp_data, const size_t count);
+
+/*!
+ * @brief This function inserts an array of elements into the vector
+ *          before a specified index.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] idx The index to insert at. Equal to the size to append.
+ * @param[in] pp_data The data references to insert, in order. None may
+ *              be NULL.
+ * @param[in] count The number of references in pp_data.
+ *
+ * @return 0 on success, -1 on error. The vector is unchanged on error.
+ */
+int
+vector_insert_range (vector_t * p_vector,
+                     const size_t idx,
+                     void ** pp_data,
+                     const size_t count);
+
+/*!
+ * @brief This function removes a run of consecutive elements from the
+ *          vector.
+ *
+ *          Any data referenced by the removed elements will NOT be freed.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] idx The index of the first element to remove.
+ * @param[in] count The number of elements to remove.
+ *
+ * @return 0 on success, -1 on error or range out of bounds.
+ */
+int
+vector_erase_range (vector_t * p_vector,
+                    const size_t idx,
+                    const size_t count);
+
+/*!
+ * @brief This function releases any allocated space beyond the elements
+ *          currently in the vector.
+ *
+ * @param[in/out] p_vector The vector context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+vector_shrink_to_fit (vector_t * p_vector);
+
+/*!
+ * @brief This function finds the first element of the vector that holds
+ *          a given reference.
+ *
+ *          This and the other scans below compare several references per
+ *              instruction on x86-64, picking AVX2 or SSE2 at runtime.
+ *
+ * @param[in] p_vector The vector context.
+ * @param[in] p_data The reference to find.
+ * @param[out] p_idx Receives the index of the first match.
+ *
+ * @return 0 on success, -1 on error or no match.
+ */
+int
+vector_find (const vector_t * p_vector, void * p_data, size_t * p_idx);
+
+/*!
+ * @brief This function counts the elements of the vector that hold a
+ *          given reference.
+ *
+ * @param[in] p_vector The vector context.
+ * @param[in] p_data The reference to count.
+ *
+ * @return The number of matches. 0 on error.
+ */
+size_t
+vector_count_eq (const vector_t * p_vector, void * p_data);
+
+/*!
+ * @brief This function appends every element of one vector that does not
+ *          hold a given reference to the back of another vector.
+ *
+ * @param[in] p_src The vector to filter.
+ * @param[in/out] p_dst The vector to append to. Must not be p_src.
+ * @param[in] p_data The reference to filter out.
+ *
+ * @return 0 on success, -1 on error. p_dst is unchanged on error.
+ */
+int
+vector_filter_into (const vector_t * p_src,
+                    vector_t * p_dst,
+                    void * p_data);
+
+/*!
+ * @brief This function sorts the vector into ascending order.
+ *
+ *          The sort is an introsort, so it runs in O(n log n) time even
+ *              in the worst case and needs no extra memory. It is not
+ *              stable.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] cmp The comparison function. It is passed the references
+ *              themselves, not pointers to them as with qsort.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+vector_sort (vector_t * p_vector, vector_cmp_f cmp);
+
+/*!
+ * @brief This function sorts a range of elements of the vector into
+ *          ascending order, leaving the rest untouched.
+ *
+ *          Disjoint ranges of one vector may be sorted from different
+ *              threads at the same time.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] idx The index of the first element to sort.
+ * @param[in] count The number of elements to sort.
+ * @param[in] cmp The comparison function.
+ *
+ * @return 0 on success, -1 on error or range out of bounds.
+ */
+int
+vector_sort_range (vector_t * p_vector,
+                   const size_t idx,
+                   const size_t count,
+                   vector_cmp_f cmp);
 
 #endif // VECTOR_H
 
-/***   end of file   ***/
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,283 @@
+/*!
+ * @file vector_parallel_sort.c
+ *
+ * @brief This file contains a parallel sort for vectors that runs on a
+ *          threadpool.
+ *
+ *          Functions included are as follows:
+ *
+ *              - vector_sort_parallel()
+ */
+
+#include <string.h>
+#include <stdbool.h>
+
+#include "vector_parallel_sort.h"
+#include "src/c/threadpool/parallel.h"
+
+/*!
+ * @brief This datatype defines the state of one parallel sort.
+ *
+ * @param p_vector The vector being sorted.
+ * @param cmp The comparison function.
+ * @param width The length of the sorted runs at the start of the current
+ *          round. The last run may be shorter.
+ * @param pieces The number of pieces each merge of the current round is
+ *          split into.
+ * @param pp_src The array holding the sorted runs.
+ * @param pp_dst The array the merged runs are written to.
+ */
+typedef struct _vector_parallel_sort
+{
+    vector_t *   p_vector;
+    vector_cmp_f cmp;
+    size_t       width;
+    size_t       pieces;
+    void **      pp_src;
+    void **      pp_dst;
+} vector_parallel_sort_t;
+
+/*!
+ * @brief This is a static function that sorts a range of runs.
+ *
+ * @param[in] begin The first run to sort.
+ * @param[in] end One past the last run to sort.
+ * @param[in/out] vp_sort A void pointer to the sort state.
+ *
+ * @return No return value expected.
+ */
+static void
+vector_parallel_sort_runs (size_t begin, size_t end, void * vp_sort)
+{
+    vector_parallel_sort_t * p_sort = vp_sort;
+    size_t size = p_sort->p_vector->size;
+    for (size_t run = begin; run < end; ++run)
+    {
+        size_t first = run * p_sort->width;
+        if (first >= size)
+        {
+            break;
+        }
+        size_t count = size - first;
+        if (count > p_sort->width)
+        {
+            count = p_sort->width;
+        }
+        vector_sort_range(p_sort->p_vector, first, count, p_sort->cmp);
+    }
+}
+
+/*!
+ * @brief This is a static function that finds how many elements of the
+ *          first run are among the first elements of the merged output.
+ *
+ *          Equivalent elements are taken from the first run first, which
+ *              keeps the merge stable.
+ *
+ * @param[in] pp_lhs The first sorted run.
+ * @param[in] lhs_count The number of elements in the first run.
+ * @param[in] pp_rhs The second sorted run.
+ * @param[in] rhs_count The number of elements in the second run.
+ * @param[in] out The number of leading output elements.
+ * @param[in] cmp The comparison function.
+ *
+ * @return The number of those elements taken from the first run.
+ */
+static size_t
+vector_parallel_sort_split (void ** pp_lhs,
+                            const size_t lhs_count,
+                            void ** pp_rhs,
+                            const size_t rhs_count,
+                            const size_t out,
+                            vector_cmp_f cmp)
+{
+    size_t lo = (out > rhs_count) ? (out - rhs_count) : 0;
+    size_t hi = (out < lhs_count) ? out : lhs_count;
+    while (lo < hi)
+    {
+        // If pp_lhs[mid] goes before pp_rhs[out - mid - 1], more than mid
+        // elements come from the first run.
+        size_t mid = lo + ((hi - lo) / 2);
+        if (cmp(pp_lhs[mid], pp_rhs[out - mid - 1]) <= 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*!
+ * @brief This is a static function that runs a range of merge pieces of
+ *          the current round.
+ *
+ *          Piece p of merge m writes the p-th slice of the output of
+ *              merging runs 2m and 2m + 1.
+ *
+ * @param[in] begin The first piece to run.
+ * @param[in] end One past the last piece to run.
+ * @param[in/out] vp_sort A void pointer to the sort state.
+ *
+ * @return No return value expected.
+ */
+static void
+vector_parallel_sort_merge (size_t begin, size_t end, void * vp_sort)
+{
+    vector_parallel_sort_t * p_sort = vp_sort;
+    size_t size = p_sort->p_vector->size;
+    for (size_t piece = begin; piece < end; ++piece)
+    {
+        size_t merge = piece / p_sort->pieces;
+        size_t slice = piece % p_sort->pieces;
+        
+        // Locate the pair of runs and this piece's slice of their output.
+        size_t first = merge * 2 * p_sort->width;
+        size_t lhs_count = size - first;
+        if (lhs_count > p_sort->width)
+        {
+            lhs_count = p_sort->width;
+        }
+        size_t rhs_count = size - first - lhs_count;
+        if (rhs_count > p_sort->width)
+        {
+            rhs_count = p_sort->width;
+        }
+        void ** pp_lhs = p_sort->pp_src + first;
+        void ** pp_rhs = pp_lhs + lhs_count;
+        size_t total = lhs_count + rhs_count;
+        size_t out_begin = (total * slice) / p_sort->pieces;
+        size_t out_end = (total * (slice + 1)) / p_sort->pieces;
+        
+        size_t lhs = vector_parallel_sort_split(pp_lhs, lhs_count,
+                                                pp_rhs, rhs_count,
+                                                out_begin, p_sort->cmp);
+        size_t lhs_end = vector_parallel_sort_split(pp_lhs, lhs_count,
+                                                    pp_rhs, rhs_count,
+                                                    out_end, p_sort->cmp);
+        size_t rhs = out_begin - lhs;
+        size_t rhs_end = out_end - lhs_end;
+        
+        // Merge the slice, taking from the first run on ties.
+        void ** pp_out = p_sort->pp_dst + first + out_begin;
+        while ((lhs < lhs_end) &&
+               (rhs < rhs_end))
+        {
+            if (p_sort->cmp(pp_rhs[rhs], pp_lhs[lhs]) < 0)
+            {
+                *pp_out++ = pp_rhs[rhs++];
+            }
+            else
+            {
+                *pp_out++ = pp_lhs[lhs++];
+            }
+        }
+        memcpy(pp_out, pp_lhs + lhs, (lhs_end - lhs) * sizeof(void *));
+        pp_out += lhs_end - lhs;
+        memcpy(pp_out, pp_rhs + rhs, (rhs_end - rhs) * sizeof(void *));
+    }
+}
+
+/*!
+ * @brief This function sorts the vector into ascending order using the
+ *          threads of a threadpool, blocking until it is sorted.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] cmp The comparison function.
+ * @param[in/out] p_tp The threadpool context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+vector_sort_parallel (vector_t * p_vector,
+                      vector_cmp_f cmp,
+                      threadpool_t * p_tp)
+{
+    int status = -1;
+    void ** pp_scratch = NULL;
+    if ((NULL == p_vector) ||
+        (NULL == cmp) ||
+        (NULL == p_tp))
+    {
+        goto EXIT;
+    }
+    
+    // Small vectors are not worth handing out.
+    size_t size = p_vector->size;
+    if ((size < VECTOR_PARALLEL_SORT_MIN) ||
+        (p_tp->num_threads < 2))
+    {
+        status = vector_sort(p_vector, cmp);
+        goto EXIT;
+    }
+    
+    pp_scratch = malloc(size * sizeof(void *));
+    if (NULL == pp_scratch)
+    {
+        goto EXIT;
+    }
+    
+    // Sort one run per thread, rounded up to a power of two so the runs
+    // pair off evenly in every merge round.
+    size_t runs = 2;
+    while (runs < p_tp->num_threads)
+    {
+        runs *= 2;
+    }
+    vector_parallel_sort_t sort = {
+        .p_vector = p_vector,
+        .cmp = cmp,
+        .width = (size + runs - 1) / runs,
+        .pieces = 1,
+        .pp_src = p_vector->pp_data,
+        .pp_dst = pp_scratch,
+    };
+    if (-1 == threadpool_parallel_for(p_tp, 0, runs, 1,
+                                      vector_parallel_sort_runs, &sort))
+    {
+        goto EXIT;
+    }
+    
+    // Merge pairs of runs until a single run covers the vector. Each round
+    // is cut into enough pieces to occupy every thread.
+    bool b_failed = false;
+    while (sort.width < size)
+    {
+        size_t merges = (size + (2 * sort.width) - 1) / (2 * sort.width);
+        sort.pieces = ((p_tp->num_threads * VECTOR_PARALLEL_SORT_PIECES) +
+                       merges - 1) / merges;
+        if (-1 == threadpool_parallel_for(p_tp, 0, merges * sort.pieces, 1,
+                                          vector_parallel_sort_merge, &sort))
+        {
+            b_failed = true;
+            break;
+        }
+        
+        void ** pp_tmp = sort.pp_src;
+        sort.pp_src = sort.pp_dst;
+        sort.pp_dst = pp_tmp;
+        sort.width *= 2;
+    }
+    
+    // Copy the result back if the last round left it in the scratch array.
+    // This is done after a failed round too, so the vector never loses
+    // elements.
+    if (sort.pp_src != p_vector->pp_data)
+    {
+        memcpy(p_vector->pp_data, sort.pp_src, size * sizeof(void *));
+    }
+    if (b_failed)
+    {
+        goto EXIT;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        free(pp_scratch);
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,58 @@
+/*!
+ * @file vector_parallel_sort.h
+ *
+ * @brief This file contains a parallel sort for vectors that runs on a
+ *          threadpool.
+ *
+ *          The vector is cut into one run per thread, rounded up to a
+ *              power of two, and the runs are sorted concurrently with
+ *              vector_sort_range. Pairs of sorted runs are then merged
+ *              into a scratch array, round after round, until one run
+ *              remains. Every merge is itself split into pieces of equal
+ *              output length by a binary search along the merge path, so
+ *              all threads stay busy in the last rounds too.
+ *
+ *          The merges are stable, but the run sorts are not, so the
+ *              overall sort is not stable.
+ *
+ *          Functions included are as follows:
+ *
+ *              - vector_sort_parallel()
+ */
+
+#ifndef VECTOR_PARALLEL_SORT_H
+#define VECTOR_PARALLEL_SORT_H
+
+#include <stdlib.h>
+
+#include "src/c/vector/vector.h"
+#include "src/c/threadpool/threadpool.h"
+
+/*** Vectors smaller than this are sorted on the calling thread. ***/
+#define VECTOR_PARALLEL_SORT_MIN 4096
+
+/*** Merge pieces per thread in each merge round. ***/
+#define VECTOR_PARALLEL_SORT_PIECES 4
+
+/*!
+ * @brief This function sorts the vector into ascending order using the
+ *          threads of a threadpool, blocking until it is sorted.
+ *
+ *          The calling thread takes part in the work. A scratch array as
+ *              large as the vector is allocated for the merges.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] cmp The comparison function. It is called from several
+ *              threads at once.
+ * @param[in/out] p_tp The threadpool context.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+vector_sort_parallel (vector_t * p_vector,
+                      vector_cmp_f cmp,
+                      threadpool_t * p_tp);
+
+#endif // VECTOR_PARALLEL_SORT_H
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,358 @@
+/*!
+ * @file vector_scan.c
+ *
+ * @brief This file contains linear scans over the references held in a
+ *          vector.
+ *
+ *          On x86-64 the scans compare several references per
+ *              instruction, using AVX2 when the processor supports it
+ *              and SSE2 otherwise. The choice is made at runtime, so a
+ *              single build runs everywhere. Other targets use plain
+ *              scalar loops.
+ *
+ *          Functions included are as follows:
+ *
+ *              - vector_find()
+ *              - vector_count_eq()
+ *              - vector_filter_into()
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include "vector.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define VECTOR_SCAN_X86_64 1
+#else
+#define VECTOR_SCAN_X86_64 0
+#endif
+
+/*!
+ * @brief This is a static function that finds the first occurrence of a
+ *          reference in an array, one element at a time.
+ *
+ * @param[in] pp_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in] p_data The reference to find.
+ *
+ * @return The index of the first match, or count if there is none.
+ */
+static size_t
+vector_find_scalar (void ** pp_data, const size_t count, void * p_data)
+{
+    size_t idx = 0;
+    while ((idx < count) &&
+           (pp_data[idx] != p_data))
+    {
+        ++idx;
+    }
+    return idx;
+}
+
+/*!
+ * @brief This is a static function that counts the occurrences of a
+ *          reference in an array, one element at a time.
+ *
+ * @param[in] pp_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in] p_data The reference to count.
+ *
+ * @return The number of matches.
+ */
+static size_t
+vector_count_scalar (void ** pp_data, const size_t count, void * p_data)
+{
+    size_t matches = 0;
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        matches += (pp_data[idx] == p_data) ? 1 : 0;
+    }
+    return matches;
+}
+
+#if VECTOR_SCAN_X86_64
+
+/*!
+ * @brief This is a static function that finds the first occurrence of a
+ *          reference in an array, two elements at a time with SSE2.
+ *
+ *          SSE2 has no 64-bit equality compare, so the 32-bit halves are
+ *              compared and a lane matches only if both halves do.
+ *
+ * @param[in] pp_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in] p_data The reference to find.
+ *
+ * @return The index of the first match, or count if there is none.
+ */
+static size_t
+vector_find_sse2 (void ** pp_data, const size_t count, void * p_data)
+{
+    __m128i needle = _mm_set1_epi64x((long long) (uintptr_t) p_data);
+    size_t idx = 0;
+    for (; (idx + 2) <= count; idx += 2)
+    {
+        __m128i lanes = _mm_loadu_si128((const __m128i *) (pp_data + idx));
+        __m128i halves = _mm_cmpeq_epi32(lanes, needle);
+        __m128i swapped = _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128i both = _mm_and_si128(halves, swapped);
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(both));
+        if (0 != mask)
+        {
+            return idx + (size_t) __builtin_ctz((unsigned int) mask);
+        }
+    }
+    return idx + vector_find_scalar(pp_data + idx, count - idx, p_data);
+}
+
+/*!
+ * @brief This is a static function that counts the occurrences of a
+ *          reference in an array, two elements at a time with SSE2.
+ *
+ * @param[in] pp_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in] p_data The reference to count.
+ *
+ * @return The number of matches.
+ */
+static size_t
+vector_count_sse2 (void ** pp_data, const size_t count, void * p_data)
+{
+    __m128i needle = _mm_set1_epi64x((long long) (uintptr_t) p_data);
+    __m128i acc = _mm_setzero_si128();
+    size_t idx = 0;
+    for (; (idx + 2) <= count; idx += 2)
+    {
+        __m128i lanes = _mm_loadu_si128((const __m128i *) (pp_data + idx));
+        __m128i halves = _mm_cmpeq_epi32(lanes, needle);
+        __m128i swapped = _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128i both = _mm_and_si128(halves, swapped);
+        
+        // A matching lane is all ones, so subtracting it counts one.
+        acc = _mm_sub_epi64(acc, both);
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *) lanes, acc);
+    return (size_t) (lanes[0] + lanes[1]) +
+           vector_count_scalar(pp_data + idx, count - idx, p_data);
+}
+
+/*!
+ * @brief This is a static function that finds the first occurrence of a
+ *          reference in an array, eight elements at a time with AVX2.
+ *
+ * @param[in] pp_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in] p_data The reference to find.
+ *
+ * @return The index of the first match, or count if there is none.
+ */
+__attribute__((target("avx2")))
+static size_t
+vector_find_avx2 (void ** pp_data, const size_t count, void * p_data)
+{
+    __m256i needle = _mm256_set1_epi64x((long long) (uintptr_t) p_data);
+    size_t idx = 0;
+    for (; (idx + 8) <= count; idx += 8)
+    {
+        __m256i lo = _mm256_cmpeq_epi64(
+            _mm256_loadu_si256((const __m256i *) (pp_data + idx)), needle);
+        __m256i hi = _mm256_cmpeq_epi64(
+            _mm256_loadu_si256((const __m256i *) (pp_data + idx + 4)),
+            needle);
+        
+        // Check both halves with one branch, then find which one hit.
+        if (0 == _mm256_testz_si256(_mm256_or_si256(lo, hi),
+                                    _mm256_or_si256(lo, hi)))
+        {
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(lo)) |
+                       (_mm256_movemask_pd(_mm256_castsi256_pd(hi)) << 4);
+            return idx + (size_t) __builtin_ctz((unsigned int) mask);
+        }
+    }
+    return idx + vector_find_scalar(pp_data + idx, count - idx, p_data);
+}
+
+/*!
+ * @brief This is a static function that counts the occurrences of a
+ *          reference in an array, eight elements at a time with AVX2.
+ *
+ * @param[in] pp_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in] p_data The reference to count.
+ *
+ * @return The number of matches.
+ */
+__attribute__((target("avx2")))
+static size_t
+vector_count_avx2 (void ** pp_data, const size_t count, void * p_data)
+{
+    __m256i needle = _mm256_set1_epi64x((long long) (uintptr_t) p_data);
+    __m256i acc_lo = _mm256_setzero_si256();
+    __m256i acc_hi = _mm256_setzero_si256();
+    size_t idx = 0;
+    for (; (idx + 8) <= count; idx += 8)
+    {
+        acc_lo = _mm256_sub_epi64(acc_lo, _mm256_cmpeq_epi64(
+            _mm256_loadu_si256((const __m256i *) (pp_data + idx)), needle));
+        acc_hi = _mm256_sub_epi64(acc_hi, _mm256_cmpeq_epi64(
+            _mm256_loadu_si256((const __m256i *) (pp_data + idx + 4)),
+            needle));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *) lanes, _mm256_add_epi64(acc_lo, acc_hi));
+    return (size_t) (lanes[0] + lanes[1] + lanes[2] + lanes[3]) +
+           vector_count_scalar(pp_data + idx, count - idx, p_data);
+}
+
+#endif // VECTOR_SCAN_X86_64
+
+/*!
+ * @brief This is a static function that finds the first occurrence of a
+ *          reference in an array with the best kernel for this processor.
+ *
+ * @param[in] pp_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in] p_data The reference to find.
+ *
+ * @return The index of the first match, or count if there is none.
+ */
+static size_t
+vector_find_any (void ** pp_data, const size_t count, void * p_data)
+{
+#if VECTOR_SCAN_X86_64
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return vector_find_avx2(pp_data, count, p_data);
+    }
+    return vector_find_sse2(pp_data, count, p_data);
+#else
+    return vector_find_scalar(pp_data, count, p_data);
+#endif
+}
+
+/*!
+ * @brief This function finds the first element of the vector that holds
+ *          a given reference.
+ *
+ * @param[in] p_vector The vector context.
+ * @param[in] p_data The reference to find.
+ * @param[out] p_idx Receives the index of the first match.
+ *
+ * @return 0 on success, -1 on error or no match.
+ */
+int
+vector_find (const vector_t * p_vector, void * p_data, size_t * p_idx)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == p_idx))
+    {
+        goto EXIT;
+    }
+    
+    size_t idx = vector_find_any(p_vector->pp_data, p_vector->size, p_data);
+    if (idx == p_vector->size)
+    {
+        goto EXIT;
+    }
+    *p_idx = idx;
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function counts the elements of the vector that hold a
+ *          given reference.
+ *
+ * @param[in] p_vector The vector context.
+ * @param[in] p_data The reference to count.
+ *
+ * @return The number of matches. 0 on error.
+ */
+size_t
+vector_count_eq (const vector_t * p_vector, void * p_data)
+{
+    size_t matches = 0;
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+
+#if VECTOR_SCAN_X86_64
+    if (__builtin_cpu_supports("avx2"))
+    {
+        matches = vector_count_avx2(p_vector->pp_data, p_vector->size,
+                                    p_data);
+    }
+    else
+    {
+        matches = vector_count_sse2(p_vector->pp_data, p_vector->size,
+                                    p_data);
+    }
+#else
+    matches = vector_count_scalar(p_vector->pp_data, p_vector->size, p_data);
+#endif
+    
+    EXIT:
+        return matches;
+}
+
+/*!
+ * @brief This function appends every element of one vector that does not
+ *          hold a given reference to the back of another vector.
+ *
+ *          The elements in between matches are found with the same scan
+ *              as vector_find and copied across in bulk.
+ *
+ * @param[in] p_src The vector to filter.
+ * @param[in/out] p_dst The vector to append to. Must not be p_src.
+ * @param[in] p_data The reference to filter out.
+ *
+ * @return 0 on success, -1 on error. p_dst is unchanged on error.
+ */
+int
+vector_filter_into (const vector_t * p_src,
+                    vector_t * p_dst,
+                    void * p_data)
+{
+    int status = -1;
+    if ((NULL == p_src) ||
+        (NULL == p_dst) ||
+        (p_src == p_dst))
+    {
+        goto EXIT;
+    }
+    
+    // Make room for the worst case, where nothing is filtered out.
+    size_t spare = p_dst->cap - p_dst->size;
+    if ((spare < p_src->size) &&
+        (-1 == vector_reserve(p_dst, p_src->size - spare)))
+    {
+        goto EXIT;
+    }
+    
+    // Copy each run of elements up to the next match.
+    size_t idx = 0;
+    while (idx < p_src->size)
+    {
+        size_t run = vector_find_any(p_src->pp_data + idx,
+                                     p_src->size - idx, p_data);
+        memcpy(p_dst->pp_data + p_dst->size, p_src->pp_data + idx,
+               run * sizeof(void *));
+        p_dst->size += run;
+        idx += run + 1;
+    }
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
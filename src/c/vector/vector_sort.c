@@ -0,0 +1,280 @@
+/*!
+ * @file vector_sort.c
+ *
+ * @brief This file contains an in-place introsort over the references
+ *          held in a vector.
+ *
+ *          The sort is a quicksort with median-of-three pivots that falls
+ *              back to heapsort once the recursion gets deeper than twice
+ *              the logarithm of the range, so it is O(n log n) in the
+ *              worst case. Small ranges are finished with insertion sort.
+ *              The sort is not stable.
+ *
+ *          Functions included are as follows:
+ *
+ *              - vector_sort()
+ *              - vector_sort_range()
+ */
+
+#include "vector.h"
+
+/*** Ranges at or below this size are finished with insertion sort. ***/
+#define VECTOR_SORT_INSERTION_MAX 16
+
+/*!
+ * @brief This is a static function that swaps two references.
+ *
+ * @param[in/out] pp_lhs The first reference.
+ * @param[in/out] pp_rhs The second reference.
+ *
+ * @return No return value expected.
+ */
+static inline void
+vector_sort_swap (void ** pp_lhs, void ** pp_rhs)
+{
+    void * p_tmp = *pp_lhs;
+    *pp_lhs = *pp_rhs;
+    *pp_rhs = p_tmp;
+}
+
+/*!
+ * @brief This is a static function that sorts an array with insertion
+ *          sort.
+ *
+ * @param[in/out] pp_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in] cmp The comparison function.
+ *
+ * @return No return value expected.
+ */
+static void
+vector_insertion_sort (void ** pp_data, const size_t count, vector_cmp_f cmp)
+{
+    for (size_t idx = 1; idx < count; ++idx)
+    {
+        void * p_data = pp_data[idx];
+        size_t pos = idx;
+        while ((pos > 0) &&
+               (cmp(p_data, pp_data[pos - 1]) < 0))
+        {
+            pp_data[pos] = pp_data[pos - 1];
+            pos--;
+        }
+        pp_data[pos] = p_data;
+    }
+}
+
+/*!
+ * @brief This is a static function that moves an element down a max
+ *          heap until neither of its children is larger.
+ *
+ * @param[in/out] pp_data The heap.
+ * @param[in] root The index of the element to move.
+ * @param[in] count The number of elements in the heap.
+ * @param[in] cmp The comparison function.
+ *
+ * @return No return value expected.
+ */
+static void
+vector_sift_down (void ** pp_data,
+                  size_t root,
+                  const size_t count,
+                  vector_cmp_f cmp)
+{
+    size_t child = (2 * root) + 1;
+    while (child < count)
+    {
+        // Pick the larger child.
+        if (((child + 1) < count) &&
+            (cmp(pp_data[child], pp_data[child + 1]) < 0))
+        {
+            child++;
+        }
+        if (cmp(pp_data[root], pp_data[child]) >= 0)
+        {
+            break;
+        }
+        vector_sort_swap(pp_data + root, pp_data + child);
+        root = child;
+        child = (2 * root) + 1;
+    }
+}
+
+/*!
+ * @brief This is a static function that sorts an array with heapsort.
+ *
+ * @param[in/out] pp_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in] cmp The comparison function.
+ *
+ * @return No return value expected.
+ */
+static void
+vector_heap_sort (void ** pp_data, const size_t count, vector_cmp_f cmp)
+{
+    for (size_t idx = count / 2; idx > 0; --idx)
+    {
+        vector_sift_down(pp_data, idx - 1, count, cmp);
+    }
+    for (size_t end = count; end > 1; --end)
+    {
+        vector_sort_swap(pp_data, pp_data + end - 1);
+        vector_sift_down(pp_data, 0, end - 1, cmp);
+    }
+}
+
+/*!
+ * @brief This is a static function that sorts an array with introsort.
+ *
+ *          The recursion goes into the smaller partition and loops on the
+ *              larger one, so the stack depth stays logarithmic.
+ *
+ * @param[in/out] pp_data The array.
+ * @param[in] count The number of elements in the array.
+ * @param[in] depth The number of partitioning levels left before
+ *              switching to heapsort.
+ * @param[in] cmp The comparison function.
+ *
+ * @return No return value expected.
+ */
+static void
+vector_introsort (void ** pp_data,
+                  size_t count,
+                  size_t depth,
+                  vector_cmp_f cmp)
+{
+    while (count > VECTOR_SORT_INSERTION_MAX)
+    {
+        if (0 == depth)
+        {
+            vector_heap_sort(pp_data, count, cmp);
+            return;
+        }
+        depth--;
+        
+        // Order the first, middle and last elements, then park the median
+        // just before the last one as the pivot.
+        size_t mid = count / 2;
+        size_t last = count - 1;
+        if (cmp(pp_data[mid], pp_data[0]) < 0)
+        {
+            vector_sort_swap(pp_data + mid, pp_data);
+        }
+        if (cmp(pp_data[last], pp_data[mid]) < 0)
+        {
+            vector_sort_swap(pp_data + last, pp_data + mid);
+            if (cmp(pp_data[mid], pp_data[0]) < 0)
+            {
+                vector_sort_swap(pp_data + mid, pp_data);
+            }
+        }
+        vector_sort_swap(pp_data + mid, pp_data + last - 1);
+        void * p_pivot = pp_data[last - 1];
+        
+        // Partition the elements between the sentinels at either end.
+        size_t lo = 0;
+        size_t hi = last - 1;
+        for (;;)
+        {
+            do
+            {
+                lo++;
+            } while (cmp(pp_data[lo], p_pivot) < 0);
+            do
+            {
+                hi--;
+            } while (cmp(p_pivot, pp_data[hi]) < 0);
+            if (lo >= hi)
+            {
+                break;
+            }
+            vector_sort_swap(pp_data + lo, pp_data + hi);
+        }
+        vector_sort_swap(pp_data + lo, pp_data + last - 1);
+        
+        // Elements [0, lo) are no greater than the pivot at lo, and
+        // elements (lo, count) are no less.
+        size_t left = lo;
+        size_t right = count - lo - 1;
+        if (left < right)
+        {
+            vector_introsort(pp_data, left, depth, cmp);
+            pp_data += lo + 1;
+            count = right;
+        }
+        else
+        {
+            vector_introsort(pp_data + lo + 1, right, depth, cmp);
+            count = left;
+        }
+    }
+    vector_insertion_sort(pp_data, count, cmp);
+}
+
+/*!
+ * @brief This function sorts the vector into ascending order.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] cmp The comparison function.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int
+vector_sort (vector_t * p_vector, vector_cmp_f cmp)
+{
+    int status = -1;
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    status = vector_sort_range(p_vector, 0, p_vector->size, cmp);
+    
+    EXIT:
+        return status;
+}
+
+/*!
+ * @brief This function sorts a range of elements of the vector into
+ *          ascending order, leaving the rest untouched.
+ *
+ *          Disjoint ranges of one vector may be sorted from different
+ *              threads at the same time.
+ *
+ * @param[in/out] p_vector The vector context.
+ * @param[in] idx The index of the first element to sort.
+ * @param[in] count The number of elements to sort.
+ * @param[in] cmp The comparison function.
+ *
+ * @return 0 on success, -1 on error or range out of bounds.
+ */
+int
+vector_sort_range (vector_t * p_vector,
+                   const size_t idx,
+                   const size_t count,
+                   vector_cmp_f cmp)
+{
+    int status = -1;
+    if ((NULL == p_vector) ||
+        (NULL == cmp) ||
+        (idx > p_vector->size) ||
+        (count > (p_vector->size - idx)))
+    {
+        goto EXIT;
+    }
+    
+    // Allow twice the depth of a perfectly balanced partitioning.
+    size_t depth = 0;
+    for (size_t remaining = count; remaining > 1; remaining /= 2)
+    {
+        depth += 2;
+    }
+    vector_introsort(p_vector->pp_data + idx, count, depth, cmp);
+    
+    status = 0;
+    
+    EXIT:
+        return status;
+}
+
+/***   end of file   ***/
\ No newline at end of file
@@ -0,0 +1,161 @@
+/*!
+ * @file vector_typed.h
+ *
+ * @brief This file contains a macro that generates a vector specialized
+ *          for a single element type.
+ *
+ *          vector_t erases the element type behind void pointers and
+ *              out-of-line calls. A vector generated here stores its
+ *              elements directly in a typed array, and every function
+ *              is static inline, so element access compiles down to a
+ *              plain load or store that the compiler may vectorize.
+ *
+ *          For example, VECTOR_DEFINE(int32_t, vec_i32) defines the type
+ *              vec_i32_t along with vec_i32_init, vec_i32_push_back and
+ *              so on. The context is meant to be embedded by value and
+ *              set up with the init function rather than allocated.
+ *
+ *          Functions generated are as follows:
+ *
+ *              - <name>_init()
+ *              - <name>_fini()
+ *              - <name>_reserve()
+ *              - <name>_push_back()
+ *              - <name>_pop_back()
+ *              - <name>_at()
+ */
+
+#ifndef VECTOR_TYPED_H
+#define VECTOR_TYPED_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*** Number of elements allocated by the first automatic growth. ***/
+#define VECTOR_TYPED_INIT_CAP 8
+
+/*!
+ * @brief This macro defines a vector type holding elements of type T by
+ *          value, along with its functions, all prefixed with name.
+ *
+ *          The generated functions behave as follows:
+ *
+ *              - name_init(p) sets up an empty vector.
+ *              - name_fini(p) frees the vector's array. The context may
+ *                  be initialized again afterwards.
+ *              - name_reserve(p, amt) allocates space for amt more
+ *                  elements. Returns 0 on success, -1 on error.
+ *              - name_push_back(p, value) appends a copy of value,
+ *                  growing the capacity geometrically. Returns 0 on
+ *                  success, -1 on error.
+ *              - name_pop_back(p, p_out) removes the last element into
+ *                  p_out, which may be NULL. Returns 0 on success, -1 on
+ *                  error or empty vector.
+ *              - name_at(p, idx) returns a pointer to the element at idx.
+ *                  NULL on error or index out of range.
+ *
+ *          The size and data fields may also be used directly, for
+ *              example to loop over p->p_data[0 .. p->size).
+ *
+ * @param T The element type.
+ * @param name The prefix for the generated type and functions.
+ */
+#define VECTOR_DEFINE(T, name)                                               \
+                                                                             \
+typedef struct _##name                                                       \
+{                                                                            \
+    T *    p_data;                                                           \
+    size_t size;                                                             \
+    size_t cap;                                                              \
+} name##_t;                                                                  \
+                                                                             \
+static inline void                                                           \
+name##_init (name##_t * p_vector)                                            \
+{                                                                            \
+    p_vector->p_data = NULL;                                                 \
+    p_vector->size = 0;                                                      \
+    p_vector->cap = 0;                                                       \
+}                                                                            \
+                                                                             \
+static inline void                                                           \
+name##_fini (name##_t * p_vector)                                            \
+{                                                                            \
+    free(p_vector->p_data);                                                  \
+    name##_init(p_vector);                                                   \
+}                                                                            \
+                                                                             \
+static inline int                                                            \
+name##_reserve (name##_t * p_vector, const size_t amt)                       \
+{                                                                            \
+    int status = -1;                                                         \
+    if (amt > ((SIZE_MAX / sizeof(T)) - p_vector->cap))                      \
+    {                                                                        \
+        goto EXIT;                                                           \
+    }                                                                        \
+                                                                             \
+    T * p_new = realloc(p_vector->p_data,                                    \
+                        (p_vector->cap + amt) * sizeof(T));                  \
+    if (NULL == p_new)                                                       \
+    {                                                                        \
+        goto EXIT;                                                           \
+    }                                                                        \
+    p_vector->p_data = p_new;                                                \
+    p_vector->cap += amt;                                                    \
+                                                                             \
+    status = 0;                                                              \
+                                                                             \
+    EXIT:                                                                    \
+        return status;                                                       \
+}                                                                            \
+                                                                             \
+static inline int                                                            \
+name##_push_back (name##_t * p_vector, T value)                              \
+{                                                                            \
+    int status = -1;                                                         \
+                                                                             \
+    /* If the vector is full, at least double its capacity. */               \
+    if ((p_vector->size == p_vector->cap) &&                                 \
+        (-1 == name##_reserve(p_vector,                                      \
+                              (0 == p_vector->cap) ? VECTOR_TYPED_INIT_CAP   \
+                                                   : p_vector->cap)))        \
+    {                                                                        \
+        goto EXIT;                                                           \
+    }                                                                        \
+    p_vector->p_data[p_vector->size++] = value;                              \
+                                                                             \
+    status = 0;                                                              \
+                                                                             \
+    EXIT:                                                                    \
+        return status;                                                       \
+}                                                                            \
+                                                                             \
+static inline int                                                            \
+name##_pop_back (name##_t * p_vector, T * p_out)                             \
+{                                                                            \
+    int status = -1;                                                         \
+    if (0 == p_vector->size)                                                 \
+    {                                                                        \
+        goto EXIT;                                                           \
+    }                                                                        \
+                                                                             \
+    p_vector->size--;                                                        \
+    if (NULL != p_out)                                                       \
+    {                                                                        \
+        *p_out = p_vector->p_data[p_vector->size];                           \
+    }                                                                        \
+                                                                             \
+    status = 0;                                                              \
+                                                                             \
+    EXIT:                                                                    \
+        return status;                                                       \
+}                                                                            \
+                                                                             \
+static inline T *                                                            \
+name##_at (name##_t * p_vector, const size_t idx)                            \
+{                                                                            \
+    return (idx < p_vector->size) ? (p_vector->p_data + idx) : NULL;         \
+}
+
+#endif // VECTOR_TYPED_H
+
+/***   end of file   ***/
\ No newline at end of file
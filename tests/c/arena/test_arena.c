@@ -0,0 +1,401 @@
+/*!
+ * @file tests/c/arena/test_arena.c
+ *
+ * @brief This file tests the arena allocator.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/arena/arena.h"
+
+/*** Chunk size of the test arenas, small enough to fill quickly. ***/
+#define TEST_ARENA_CHUNK 256
+
+/*** Size of a block that leaves no room for a second one in a chunk. ***/
+#define TEST_ARENA_BLOCK 200
+
+/*** Alignment larger than ARENA_DEFAULT_ALIGN and the chunk size. ***/
+#define TEST_ARENA_BIG_ALIGN 4096
+
+/*** Alignment larger than ARENA_DEFAULT_ALIGN that fits in a chunk. ***/
+#define TEST_ARENA_SMALL_ALIGN 64
+
+/*!
+ * @brief This is a static function that counts the chunks of an arena.
+ *
+ * @param[in] p_arena The arena context.
+ *
+ * @return The number of chunks.
+ */
+static size_t
+test_arena_chunks (const arena_t * p_arena)
+{
+    size_t count = 0;
+    for (const arena_chunk_t * p_chunk = p_arena->p_first;
+         NULL != p_chunk;
+         p_chunk = p_chunk->p_next)
+    {
+        ++count;
+    }
+    return count;
+}
+
+/*!
+ * @brief This is a static function that tells whether a block is aligned.
+ *
+ * @param[in] p_block The block.
+ * @param[in] align The alignment. A power of two.
+ *
+ * @return C_TRUE if it is, C_FALSE otherwise.
+ */
+static C_BOOL
+test_arena_aligned (const void * p_block, const size_t align)
+{
+    return (NULL != p_block) &&
+           (0 == ((uintptr_t) p_block & (align - 1)));
+}
+
+/*!
+ * @brief This is a static function that checks plain allocation and the
+ *          rejection of bad arguments.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_arena_alloc (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    arena_t * p_arena = arena_create(TEST_ARENA_CHUNK);
+    b_pass &= C_ASSERT(NULL != p_arena);
+    if (NULL == p_arena)
+    {
+        goto EXIT;
+    }
+    
+    unsigned char * p_a = arena_alloc(p_arena, 3);
+    unsigned char * p_b = arena_alloc(p_arena, 5);
+    b_pass &= C_ASSERT(test_arena_aligned(p_a, ARENA_DEFAULT_ALIGN));
+    b_pass &= C_ASSERT(test_arena_aligned(p_b, ARENA_DEFAULT_ALIGN));
+    b_pass &= C_ASSERT((NULL != p_a) &&
+                       (p_b >= (p_a + 3)));
+    
+    unsigned char * p_zero = arena_calloc(p_arena, 10, 4);
+    b_pass &= C_ASSERT(NULL != p_zero);
+    for (size_t idx = 0; (NULL != p_zero) && (idx < 40); ++idx)
+    {
+        b_pass &= C_ASSERT(0 == p_zero[idx]);
+    }
+    
+    b_pass &= C_ASSERT(NULL == arena_calloc(p_arena, SIZE_MAX / 2, 4));
+    b_pass &= C_ASSERT(NULL == arena_alloc_aligned(p_arena, 8, 0));
+    b_pass &= C_ASSERT(NULL == arena_alloc_aligned(p_arena, 8, 24));
+    b_pass &= C_ASSERT(NULL == arena_alloc(p_arena, SIZE_MAX));
+    b_pass &= C_ASSERT(NULL == arena_alloc(NULL, 8));
+    
+    // A block larger than a chunk gets a chunk of its own.
+    unsigned char * p_big = arena_alloc(p_arena, 4 * TEST_ARENA_CHUNK);
+    b_pass &= C_ASSERT(NULL != p_big);
+    if (NULL != p_big)
+    {
+        memset(p_big, 0xA5, 4 * TEST_ARENA_CHUNK);
+    }
+    b_pass &= C_ASSERT(2 == test_arena_chunks(p_arena));
+    arena_destroy(p_arena);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks arena_rewind accepts
+ *          markers at or before the current position and refuses those
+ *          after it.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_arena_rewind (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    arena_t * p_arena = arena_create(TEST_ARENA_CHUNK);
+    b_pass &= C_ASSERT(NULL != p_arena);
+    if (NULL == p_arena)
+    {
+        goto EXIT;
+    }
+    
+    arena_mark_t start = arena_mark(p_arena);
+    b_pass &= C_ASSERT(NULL != arena_alloc(p_arena, 16));
+    arena_mark_t first = arena_mark(p_arena);
+    b_pass &= C_ASSERT(NULL != arena_alloc(p_arena, 16));
+    arena_mark_t second = arena_mark(p_arena);
+    
+    // Within one chunk, a marker past the used bytes is refused.
+    b_pass &= C_ASSERT(0 == arena_rewind(p_arena, first));
+    b_pass &= C_ASSERT(first.used == p_arena->used);
+    b_pass &= C_ASSERT(-1 == arena_rewind(p_arena, second));
+    b_pass &= C_ASSERT(first.used == p_arena->used);
+    
+    // Move to a second chunk and take a marker there.
+    b_pass &= C_ASSERT(NULL != arena_alloc(p_arena, TEST_ARENA_BLOCK));
+    b_pass &= C_ASSERT(NULL != arena_alloc(p_arena, TEST_ARENA_BLOCK));
+    b_pass &= C_ASSERT(p_arena->p_first != p_arena->p_curr);
+    arena_mark_t later = arena_mark(p_arena);
+    b_pass &= C_ASSERT(0 == arena_rewind(p_arena, later));
+    
+    // Back in the first chunk, the second chunk's marker is after the
+    // current chunk and must be refused, however few bytes it counts.
+    b_pass &= C_ASSERT(0 == arena_rewind(p_arena, start));
+    b_pass &= C_ASSERT((p_arena->p_first == p_arena->p_curr) &&
+                       (0 == p_arena->used));
+    b_pass &= C_ASSERT(-1 == arena_rewind(p_arena, later));
+    b_pass &= C_ASSERT((p_arena->p_first == p_arena->p_curr) &&
+                       (0 == p_arena->used));
+    later.used = 0;
+    b_pass &= C_ASSERT(-1 == arena_rewind(p_arena, later));
+    
+    arena_mark_t none = arena_mark(NULL);
+    b_pass &= C_ASSERT(NULL == none.p_chunk);
+    b_pass &= C_ASSERT(-1 == arena_rewind(p_arena, none));
+    b_pass &= C_ASSERT(-1 == arena_rewind(NULL, start));
+    arena_destroy(p_arena);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks a reset arena reuses its
+ *          chunks instead of allocating new ones.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_arena_reset (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    void * p_blocks[3] = { NULL };
+    arena_t * p_arena = arena_create(TEST_ARENA_CHUNK);
+    b_pass &= C_ASSERT(NULL != p_arena);
+    if (NULL == p_arena)
+    {
+        goto EXIT;
+    }
+    
+    for (size_t idx = 0; idx < 3; ++idx)
+    {
+        p_blocks[idx] = arena_alloc(p_arena, TEST_ARENA_BLOCK);
+        b_pass &= C_ASSERT(NULL != p_blocks[idx]);
+    }
+    b_pass &= C_ASSERT(3 == test_arena_chunks(p_arena));
+    
+    // Two passes over the same chunks hand out the same blocks.
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        b_pass &= C_ASSERT(0 == arena_reset(p_arena));
+        b_pass &= C_ASSERT((p_arena->p_first == p_arena->p_curr) &&
+                           (0 == p_arena->used));
+        for (size_t idx = 0; idx < 3; ++idx)
+        {
+            b_pass &= C_ASSERT(p_blocks[idx] ==
+                               arena_alloc(p_arena, TEST_ARENA_BLOCK));
+        }
+        b_pass &= C_ASSERT(3 == test_arena_chunks(p_arena));
+    }
+    
+    // A block too large for the next kept chunk gets a new chunk linked
+    // in ahead of it, and the kept chunk is still used afterwards.
+    b_pass &= C_ASSERT(0 == arena_reset(p_arena));
+    b_pass &= C_ASSERT(p_blocks[0] == arena_alloc(p_arena, TEST_ARENA_BLOCK));
+    b_pass &= C_ASSERT(NULL != arena_alloc(p_arena, 2 * TEST_ARENA_CHUNK));
+    b_pass &= C_ASSERT(4 == test_arena_chunks(p_arena));
+    b_pass &= C_ASSERT(p_blocks[1] == arena_alloc(p_arena, TEST_ARENA_BLOCK));
+    b_pass &= C_ASSERT(4 == test_arena_chunks(p_arena));
+    b_pass &= C_ASSERT(-1 == arena_reset(NULL));
+    arena_destroy(p_arena);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks blocks aligned beyond
+ *          ARENA_DEFAULT_ALIGN, in the current chunk and in a new one.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_arena_aligned_alloc (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    arena_t * p_arena = arena_create(TEST_ARENA_CHUNK);
+    b_pass &= C_ASSERT(NULL != p_arena);
+    if (NULL == p_arena)
+    {
+        goto EXIT;
+    }
+    
+    b_pass &= C_ASSERT(NULL != arena_alloc(p_arena, 1));
+    unsigned char * p_small = arena_alloc_aligned(p_arena, 32,
+                                                  TEST_ARENA_SMALL_ALIGN);
+    b_pass &= C_ASSERT(test_arena_aligned(p_small, TEST_ARENA_SMALL_ALIGN));
+    b_pass &= C_ASSERT(1 == test_arena_chunks(p_arena));
+    
+    // The alignment is larger than a chunk, so the block needs its own.
+    for (size_t idx = 0; idx < 3; ++idx)
+    {
+        unsigned char * p_big = arena_alloc_aligned(p_arena, 100,
+                                                    TEST_ARENA_BIG_ALIGN);
+        b_pass &= C_ASSERT(test_arena_aligned(p_big, TEST_ARENA_BIG_ALIGN));
+        if (NULL != p_big)
+        {
+            memset(p_big, 0x5A, 100);
+        }
+    }
+    
+    // The rest of the last chunk still serves default-aligned blocks.
+    b_pass &= C_ASSERT(test_arena_aligned(arena_alloc(p_arena, 8),
+                                          ARENA_DEFAULT_ALIGN));
+    arena_destroy(p_arena);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks the arena allocator
+ *          resizes and frees its most recent block in place, and moves
+ *          any other block.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_arena_allocator (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    allocator_t alloc;
+    arena_t * p_arena = arena_create(TEST_ARENA_CHUNK);
+    b_pass &= C_ASSERT(NULL != p_arena);
+    if (NULL == p_arena)
+    {
+        goto EXIT;
+    }
+    b_pass &= C_ASSERT(-1 == arena_allocator(NULL, &alloc));
+    b_pass &= C_ASSERT(-1 == arena_allocator(p_arena, NULL));
+    b_pass &= C_ASSERT(0 == arena_allocator(p_arena, &alloc));
+    
+    unsigned char * p_block = allocator_alloc(&alloc, 16);
+    b_pass &= C_ASSERT(NULL != p_block);
+    if (NULL == p_block)
+    {
+        goto DESTROY;
+    }
+    memset(p_block, 7, 16);
+    size_t start = p_arena->used - 16;
+    
+    // The most recent block grows and shrinks where it is.
+    unsigned char * p_grown = allocator_realloc(&alloc, p_block, 16, 64);
+    b_pass &= C_ASSERT(p_block == p_grown);
+    b_pass &= C_ASSERT((start + 64) == p_arena->used);
+    p_grown = allocator_realloc(&alloc, p_block, 64, 32);
+    b_pass &= C_ASSERT(p_block == p_grown);
+    b_pass &= C_ASSERT((start + 32) == p_arena->used);
+    
+    // Growing past the chunk moves the block and keeps its contents.
+    p_grown = allocator_realloc(&alloc, p_block, 32, TEST_ARENA_CHUNK + 1);
+    b_pass &= C_ASSERT((NULL != p_grown) &&
+                       (p_block != p_grown));
+    for (size_t idx = 0; (NULL != p_grown) && (idx < 16); ++idx)
+    {
+        b_pass &= C_ASSERT(7 == p_grown[idx]);
+    }
+    p_block = p_grown;
+    
+    // A block that is no longer the most recent one is moved.
+    unsigned char * p_other = allocator_alloc(&alloc, 8);
+    b_pass &= C_ASSERT(NULL != p_other);
+    p_grown = allocator_realloc(&alloc, p_block, TEST_ARENA_CHUNK + 1,
+                                TEST_ARENA_CHUNK + 8);
+    b_pass &= C_ASSERT((NULL != p_grown) &&
+                       (p_block != p_grown));
+    for (size_t idx = 0; (NULL != p_grown) && (idx < 16); ++idx)
+    {
+        b_pass &= C_ASSERT(7 == p_grown[idx]);
+    }
+    
+    // Freeing gives back the most recent block only.
+    size_t used = p_arena->used;
+    allocator_free(&alloc, p_other, 8);
+    b_pass &= C_ASSERT(used == p_arena->used);
+    allocator_free(&alloc, p_grown, TEST_ARENA_CHUNK + 8);
+    b_pass &= C_ASSERT((used - (TEST_ARENA_CHUNK + 8)) == p_arena->used);
+    
+    DESTROY:
+        arena_destroy(p_arena);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function run by a thread that checks it gets
+ *          an arena of its own.
+ *
+ * @param[in] vp_main A void pointer to the main thread's arena.
+ *
+ * @return A non-NULL pointer on success, NULL on failure.
+ */
+static void *
+test_arena_thread (void * vp_main)
+{
+    arena_t * p_arena = arena_thread_local();
+    void * p_result = NULL;
+    if ((NULL != p_arena) &&
+        (p_arena != vp_main) &&
+        (p_arena == arena_thread_local()) &&
+        (NULL != arena_alloc(p_arena, 64)))
+    {
+        p_result = p_arena;
+    }
+    return p_result;
+}
+
+/*!
+ * @brief This is a static function that checks each thread has its own
+ *          thread-local arena.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_arena_thread_local (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    pthread_t thread;
+    void * p_result = NULL;
+    arena_t * p_main = arena_thread_local();
+    b_pass &= C_ASSERT(NULL != p_main);
+    b_pass &= C_ASSERT(p_main == arena_thread_local());
+    b_pass &= C_ASSERT(0 == pthread_create(&thread, NULL, test_arena_thread,
+                                           p_main));
+    b_pass &= C_ASSERT(0 == pthread_join(thread, &p_result));
+    b_pass &= C_ASSERT(NULL != p_result);
+    arena_thread_local_destroy();
+    arena_thread_local_destroy();
+    return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= test_arena_alloc();
+    b_pass &= test_arena_rewind();
+    b_pass &= test_arena_reset();
+    b_pass &= test_arena_aligned_alloc();
+    b_pass &= test_arena_allocator();
+    b_pass &= test_arena_thread_local();
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
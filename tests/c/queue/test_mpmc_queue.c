@@ -0,0 +1,229 @@
+/*!
+ * @file tests/c/queue/test_mpmc_queue.c
+ *
+ * @brief This file tests the bounded multi-producer multi-consumer queue.
+ */
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/queue/mpmc_queue.h"
+
+/*** Number of producer threads in the stress test. ***/
+#define TEST_MPMC_PRODUCERS 4
+
+/*** Number of consumer threads in the stress test. ***/
+#define TEST_MPMC_CONSUMERS 4
+
+/*** Number of elements each producer enqueues. ***/
+#define TEST_MPMC_ITEMS 20000
+
+/*!
+ * @brief This datatype defines an element passed through the queue in
+ *          the stress test.
+ *
+ * @param producer The index of the producer that enqueued it.
+ * @param seq Its position in that producer's sequence, from 1.
+ */
+typedef struct _test_mpmc_item
+{
+    uint64_t producer;
+    uint64_t seq;
+} test_mpmc_item_t;
+
+/*!
+ * @brief This datatype defines one thread in the stress test.
+ *
+ * @param p_queue The queue under test.
+ * @param idx The thread's index among producers or consumers.
+ * @param sum The sum of the sequence numbers the thread dequeued.
+ * @param b_ordered Whether every producer's elements were dequeued in
+ *          order, as seen by this thread.
+ */
+typedef struct _test_mpmc_thread
+{
+    mpmc_queue_t * p_queue;
+    uint64_t       idx;
+    uint64_t       sum;
+    C_BOOL         b_ordered;
+} test_mpmc_thread_t;
+
+/*!
+ * @brief This is a static function run by each producer thread.
+ *
+ * @param[in/out] p_arg The thread's state.
+ *
+ * @return Always NULL.
+ */
+static void *
+test_mpmc_producer (void * p_arg)
+{
+    test_mpmc_thread_t * p_thread = p_arg;
+    for (uint64_t seq = 1; seq <= TEST_MPMC_ITEMS; ++seq)
+    {
+        test_mpmc_item_t item = { p_thread->idx, seq };
+        if (0 != mpmc_queue_enq(p_thread->p_queue, &item))
+        {
+            p_thread->b_ordered = C_FALSE;
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * @brief This is a static function run by each consumer thread. It
+ *          dequeues its share of the elements and checks that each
+ *          producer's elements arrive in order.
+ *
+ * @param[in/out] p_arg The thread's state.
+ *
+ * @return Always NULL.
+ */
+static void *
+test_mpmc_consumer (void * p_arg)
+{
+    test_mpmc_thread_t * p_thread = p_arg;
+    uint64_t last[TEST_MPMC_PRODUCERS] = { 0 };
+    size_t share = (TEST_MPMC_PRODUCERS * TEST_MPMC_ITEMS) /
+                   TEST_MPMC_CONSUMERS;
+    for (size_t count = 0; count < share; ++count)
+    {
+        test_mpmc_item_t item;
+        if ((0 != mpmc_queue_deq(p_thread->p_queue, &item)) ||
+            (item.producer >= TEST_MPMC_PRODUCERS) ||
+            (item.seq <= last[item.producer]))
+        {
+            p_thread->b_ordered = C_FALSE;
+            continue;
+        }
+        last[item.producer] = item.seq;
+        p_thread->sum += item.seq;
+    }
+    return NULL;
+}
+
+/*!
+ * @brief This is a static function that checks the queue's behaviour on
+ *          a single thread.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_mpmc_single (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    uint64_t value = 0;
+    b_pass &= C_ASSERT(NULL == mpmc_queue_create(0, sizeof(uint64_t)));
+    b_pass &= C_ASSERT(NULL == mpmc_queue_create(4, 0));
+    b_pass &= C_ASSERT(NULL == mpmc_queue_create(SIZE_MAX, 1));
+    
+    // A capacity of three rounds up to four.
+    mpmc_queue_t * p_queue = mpmc_queue_create(3, sizeof(uint64_t));
+    b_pass &= C_ASSERT(NULL != p_queue);
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    b_pass &= C_ASSERT(-1 == mpmc_queue_try_deq(p_queue, &value));
+    for (uint64_t idx = 1; idx <= 4; ++idx)
+    {
+        b_pass &= C_ASSERT(0 == mpmc_queue_try_enq(p_queue, &idx));
+    }
+    value = 5;
+    b_pass &= C_ASSERT(-1 == mpmc_queue_try_enq(p_queue, &value));
+    b_pass &= C_ASSERT(4 == mpmc_queue_size(p_queue));
+    
+    // Wrap around the ring a few times, checking the elements stay FIFO.
+    for (uint64_t idx = 1; idx <= 20; ++idx)
+    {
+        b_pass &= C_ASSERT(0 == mpmc_queue_deq(p_queue, &value));
+        b_pass &= C_ASSERT(idx == value);
+        value = idx + 4;
+        b_pass &= C_ASSERT(0 == mpmc_queue_enq(p_queue, &value));
+    }
+    for (uint64_t idx = 21; idx <= 24; ++idx)
+    {
+        b_pass &= C_ASSERT(0 == mpmc_queue_try_deq(p_queue, &value));
+        b_pass &= C_ASSERT(idx == value);
+    }
+    b_pass &= C_ASSERT(0 == mpmc_queue_size(p_queue));
+    b_pass &= C_ASSERT(-1 == mpmc_queue_try_deq(p_queue, &value));
+    
+    mpmc_queue_destroy(p_queue);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks that, with several
+ *          producers and consumers sharing a small queue, every element
+ *          is dequeued exactly once and in order per producer.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_mpmc_stress (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    pthread_t producers[TEST_MPMC_PRODUCERS];
+    pthread_t consumers[TEST_MPMC_CONSUMERS];
+    test_mpmc_thread_t producer_state[TEST_MPMC_PRODUCERS];
+    test_mpmc_thread_t consumer_state[TEST_MPMC_CONSUMERS];
+    mpmc_queue_t * p_queue = mpmc_queue_create(64, sizeof(test_mpmc_item_t));
+    b_pass &= C_ASSERT(NULL != p_queue);
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    for (size_t idx = 0; idx < TEST_MPMC_CONSUMERS; ++idx)
+    {
+        consumer_state[idx] = (test_mpmc_thread_t) { p_queue, idx, 0,
+                                                     C_TRUE };
+        pthread_create(&(consumers[idx]), NULL, test_mpmc_consumer,
+                       &(consumer_state[idx]));
+    }
+    for (size_t idx = 0; idx < TEST_MPMC_PRODUCERS; ++idx)
+    {
+        producer_state[idx] = (test_mpmc_thread_t) { p_queue, idx, 0,
+                                                     C_TRUE };
+        pthread_create(&(producers[idx]), NULL, test_mpmc_producer,
+                       &(producer_state[idx]));
+    }
+    
+    uint64_t sum = 0;
+    for (size_t idx = 0; idx < TEST_MPMC_PRODUCERS; ++idx)
+    {
+        pthread_join(producers[idx], NULL);
+        b_pass &= C_ASSERT(producer_state[idx].b_ordered);
+    }
+    for (size_t idx = 0; idx < TEST_MPMC_CONSUMERS; ++idx)
+    {
+        pthread_join(consumers[idx], NULL);
+        b_pass &= C_ASSERT(consumer_state[idx].b_ordered);
+        sum += consumer_state[idx].sum;
+    }
+    
+    // Each producer's sequence numbers sum to n(n + 1) / 2.
+    b_pass &= C_ASSERT((TEST_MPMC_PRODUCERS * (uint64_t) TEST_MPMC_ITEMS *
+                        (TEST_MPMC_ITEMS + 1) / 2) == sum);
+    b_pass &= C_ASSERT(0 == mpmc_queue_size(p_queue));
+    
+    mpmc_queue_destroy(p_queue);
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= test_mpmc_single();
+    b_pass &= test_mpmc_stress();
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
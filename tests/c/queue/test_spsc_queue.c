@@ -0,0 +1,189 @@
+/*!
+ * @file tests/c/queue/test_spsc_queue.c
+ *
+ * @brief This file tests the bounded single-producer single-consumer
+ *          queue.
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/queue/spsc_queue.h"
+
+/*** Number of references the producer pushes in the stress test. ***/
+#define TEST_SPSC_ITEMS 200000
+
+/*** Largest batch pushed or popped at once in the stress test. ***/
+#define TEST_SPSC_BATCH 8
+
+/*!
+ * @brief This is a static function run by the producer thread. It
+ *          alternates between single and batched pushes, yielding
+ *          the processor whenever the queue is full.
+ *
+ * @param[in/out] p_arg The queue under test.
+ *
+ * @return Always NULL.
+ */
+static void *
+test_spsc_producer (void * p_arg)
+{
+    spsc_queue_t * p_queue = p_arg;
+    void * batch[TEST_SPSC_BATCH];
+    uintptr_t next = 1;
+    while (TEST_SPSC_ITEMS >= next)
+    {
+        if (0 == (next % 2))
+        {
+            if (0 == spsc_queue_push(p_queue, (void *) next))
+            {
+                ++next;
+            }
+            else
+            {
+                sched_yield();
+            }
+            continue;
+        }
+        
+        size_t count = 0;
+        while ((TEST_SPSC_BATCH > count) &&
+               (TEST_SPSC_ITEMS >= (next + count)))
+        {
+            batch[count] = (void *) (next + count);
+            ++count;
+        }
+        count = spsc_queue_push_n(p_queue, batch, count);
+        if (0 == count)
+        {
+            sched_yield();
+        }
+        next += count;
+    }
+    return NULL;
+}
+
+/*!
+ * @brief This is a static function that checks the queue's behaviour on
+ *          a single thread.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_spsc_single (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    void * p_data = NULL;
+    void * batch[6] = { (void *) 5, (void *) 6, (void *) 7,
+                        (void *) 8, (void *) 9, (void *) 10 };
+    b_pass &= C_ASSERT(NULL == spsc_queue_create(0));
+    b_pass &= C_ASSERT(NULL == spsc_queue_create(SIZE_MAX));
+    
+    // A capacity of three rounds up to four.
+    spsc_queue_t * p_queue = spsc_queue_create(3);
+    b_pass &= C_ASSERT(NULL != p_queue);
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    b_pass &= C_ASSERT(-1 == spsc_queue_pop(p_queue, &p_data));
+    b_pass &= C_ASSERT(0 == spsc_queue_pop_n(p_queue, batch, 6));
+    for (uintptr_t idx = 1; idx <= 4; ++idx)
+    {
+        b_pass &= C_ASSERT(0 == spsc_queue_push(p_queue, (void *) idx));
+    }
+    b_pass &= C_ASSERT(-1 == spsc_queue_push(p_queue, (void *) 5));
+    b_pass &= C_ASSERT(0 == spsc_queue_push_n(p_queue, batch, 6));
+    b_pass &= C_ASSERT(4 == spsc_queue_size(p_queue));
+    
+    b_pass &= C_ASSERT(0 == spsc_queue_pop(p_queue, &p_data));
+    b_pass &= C_ASSERT((void *) 1 == p_data);
+    b_pass &= C_ASSERT(0 == spsc_queue_pop(p_queue, &p_data));
+    b_pass &= C_ASSERT((void *) 2 == p_data);
+    
+    // Only as many references as there is room for are pushed, and the
+    // batch wraps around the end of the ring.
+    b_pass &= C_ASSERT(2 == spsc_queue_push_n(p_queue, batch, 6));
+    b_pass &= C_ASSERT(4 == spsc_queue_pop_n(p_queue, batch, 6));
+    b_pass &= C_ASSERT((void *) 3 == batch[0]);
+    b_pass &= C_ASSERT((void *) 4 == batch[1]);
+    b_pass &= C_ASSERT((void *) 5 == batch[2]);
+    b_pass &= C_ASSERT((void *) 6 == batch[3]);
+    b_pass &= C_ASSERT(0 == spsc_queue_size(p_queue));
+    b_pass &= C_ASSERT(-1 == spsc_queue_pop(p_queue, &p_data));
+    
+    spsc_queue_destroy(p_queue);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks that every reference
+ *          pushed by one thread is popped by another exactly once and
+ *          in order, through a small queue that is often full.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_spsc_stress (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    C_BOOL b_ordered = C_TRUE;
+    pthread_t producer;
+    void * batch[TEST_SPSC_BATCH];
+    spsc_queue_t * p_queue = spsc_queue_create(16);
+    b_pass &= C_ASSERT(NULL != p_queue);
+    if (NULL == p_queue)
+    {
+        goto EXIT;
+    }
+    
+    pthread_create(&producer, NULL, test_spsc_producer, p_queue);
+    
+    // The consumer alternates between single and batched pops too, and
+    // yields the processor whenever the queue is empty.
+    uintptr_t expected = 1;
+    while (TEST_SPSC_ITEMS >= expected)
+    {
+        size_t count = 0;
+        if (0 == (expected % 2))
+        {
+            count = spsc_queue_pop_n(p_queue, batch, TEST_SPSC_BATCH);
+        }
+        else if (0 == spsc_queue_pop(p_queue, &(batch[0])))
+        {
+            count = 1;
+        }
+        if (0 == count)
+        {
+            sched_yield();
+        }
+        for (size_t idx = 0; idx < count; ++idx)
+        {
+            b_ordered &= ((void *) expected == batch[idx]);
+            ++expected;
+        }
+    }
+    
+    pthread_join(producer, NULL);
+    b_pass &= C_ASSERT(b_ordered);
+    b_pass &= C_ASSERT(0 == spsc_queue_size(p_queue));
+    
+    spsc_queue_destroy(p_queue);
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= test_spsc_single();
+    b_pass &= test_spsc_stress();
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,248 @@
+/*!
+ * @file tests/c/stack/test_lfstack.c
+ *
+ * @brief This file tests the lock-free stack.
+ */
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/stack/lfstack.h"
+
+/*** Number of threads in the stress test. ***/
+#define TEST_LFSTACK_THREADS 4
+
+/*** Number of references each thread pushes. ***/
+#define TEST_LFSTACK_ITEMS 20000
+
+/*** Number of pushes a thread makes between calls to pop_all. ***/
+#define TEST_LFSTACK_POP_ALL_EVERY 64
+
+/*** Total number of references pushed in the stress test. ***/
+#define TEST_LFSTACK_TOTAL (TEST_LFSTACK_THREADS * TEST_LFSTACK_ITEMS)
+
+/*!
+ * @brief This datatype defines the state shared by the stress test.
+ *
+ * @param p_stack The stack under test.
+ * @param failures The number of failed pushes.
+ * @param seen How many times each reference has been removed.
+ */
+typedef struct _test_lfstack_shared
+{
+    lfstack_t *    p_stack;
+    _Atomic size_t failures;
+    _Atomic int    seen[TEST_LFSTACK_TOTAL];
+} test_lfstack_shared_t;
+
+/*!
+ * @brief This datatype defines one thread in the stress test.
+ *
+ * @param p_shared The shared state.
+ * @param first The first reference the thread pushes.
+ */
+typedef struct _test_lfstack_thread
+{
+    test_lfstack_shared_t * p_shared;
+    uintptr_t               first;
+} test_lfstack_thread_t;
+
+/*!
+ * @brief This is a static function that records a reference removed
+ *          from the stack in the stress test.
+ *
+ * @param[in] p_data The reference, counted from 1.
+ * @param[in/out] p_arg The shared state.
+ *
+ * @return No return value expected.
+ */
+static void
+test_lfstack_take (void * p_data, void * p_arg)
+{
+    test_lfstack_shared_t * p_shared = p_arg;
+    uintptr_t value = (uintptr_t) p_data;
+    if ((0 != value) &&
+        (TEST_LFSTACK_TOTAL >= value))
+    {
+        atomic_fetch_add(&(p_shared->seen[value - 1]), 1);
+    }
+}
+
+/*!
+ * @brief This is a static function that records the order in which
+ *          pop_all visits references in the single-thread test.
+ *
+ * @param[in] p_data The reference.
+ * @param[in/out] p_arg The next slot of the array receiving it.
+ *
+ * @return No return value expected.
+ */
+static void
+test_lfstack_record (void * p_data, void * p_arg)
+{
+    void *** ppp_next = p_arg;
+    **ppp_next = p_data;
+    ++(*ppp_next);
+}
+
+/*!
+ * @brief This is a static function run by each stress test thread. It
+ *          pushes its references, popping one after each push and every
+ *          so often emptying the whole stack.
+ *
+ * @param[in/out] p_arg The thread's state.
+ *
+ * @return Always NULL.
+ */
+static void *
+test_lfstack_worker (void * p_arg)
+{
+    test_lfstack_thread_t * p_thread = p_arg;
+    test_lfstack_shared_t * p_shared = p_thread->p_shared;
+    for (uintptr_t idx = 0; idx < TEST_LFSTACK_ITEMS; ++idx)
+    {
+        if (0 != lfstack_push(p_shared->p_stack,
+                              (void *) (p_thread->first + idx)))
+        {
+            atomic_fetch_add(&(p_shared->failures), 1);
+        }
+        
+        if (0 == (idx % TEST_LFSTACK_POP_ALL_EVERY))
+        {
+            lfstack_pop_all(p_shared->p_stack, test_lfstack_take, p_shared);
+        }
+        else if (0 != (idx % 3))
+        {
+            test_lfstack_take(lfstack_pop(p_shared->p_stack), p_shared);
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * @brief This is a static function that checks the stack's behaviour on
+ *          a single thread.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_lfstack_single (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    void * visited[10] = { NULL };
+    void ** pp_next = visited;
+    lfstack_t * p_stack = lfstack_create();
+    b_pass &= C_ASSERT(NULL != p_stack);
+    if (NULL == p_stack)
+    {
+        goto EXIT;
+    }
+    
+    b_pass &= C_ASSERT(NULL == lfstack_pop(p_stack));
+    b_pass &= C_ASSERT(0 == lfstack_pop_all(p_stack, NULL, NULL));
+    b_pass &= C_ASSERT(-1 == lfstack_push(p_stack, NULL));
+    b_pass &= C_ASSERT(-1 == lfstack_push(NULL, (void *) 1));
+    
+    for (uintptr_t value = 1; value <= 100; ++value)
+    {
+        b_pass &= C_ASSERT(0 == lfstack_push(p_stack, (void *) value));
+    }
+    for (uintptr_t value = 100; value >= 1; --value)
+    {
+        b_pass &= C_ASSERT((void *) value == lfstack_pop(p_stack));
+    }
+    b_pass &= C_ASSERT(NULL == lfstack_pop(p_stack));
+    
+    // pop_all hands over everything, most recent first, in one go.
+    b_pass &= C_ASSERT(0 == lfstack_reserve(p_stack, 50));
+    for (uintptr_t value = 1; value <= 10; ++value)
+    {
+        b_pass &= C_ASSERT(0 == lfstack_push(p_stack, (void *) value));
+    }
+    b_pass &= C_ASSERT(10 == lfstack_pop_all(p_stack, test_lfstack_record,
+                                             &pp_next));
+    for (uintptr_t idx = 0; idx < 10; ++idx)
+    {
+        b_pass &= C_ASSERT((void *) (10 - idx) == visited[idx]);
+    }
+    b_pass &= C_ASSERT(NULL == lfstack_pop(p_stack));
+    
+    b_pass &= C_ASSERT(0 == lfstack_push(p_stack, (void *) 1));
+    b_pass &= C_ASSERT(1 == lfstack_pop_all(p_stack, NULL, NULL));
+    b_pass &= C_ASSERT(0 == lfstack_pop_all(p_stack, NULL, NULL));
+    
+    lfstack_destroy(p_stack);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks that, with several
+ *          threads pushing, popping and emptying the stack at once,
+ *          every reference is removed exactly once.
+ *
+ *          Popped nodes are recycled straight away, so this also
+ *              exercises the tag that guards against the ABA problem.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_lfstack_stress (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    pthread_t threads[TEST_LFSTACK_THREADS];
+    test_lfstack_thread_t state[TEST_LFSTACK_THREADS];
+    test_lfstack_shared_t * p_shared = calloc(1,
+                                              sizeof(test_lfstack_shared_t));
+    b_pass &= C_ASSERT(NULL != p_shared);
+    if (NULL == p_shared)
+    {
+        goto EXIT;
+    }
+    p_shared->p_stack = lfstack_create();
+    b_pass &= C_ASSERT(NULL != p_shared->p_stack);
+    if (NULL == p_shared->p_stack)
+    {
+        free(p_shared);
+        goto EXIT;
+    }
+    
+    for (size_t idx = 0; idx < TEST_LFSTACK_THREADS; ++idx)
+    {
+        state[idx].p_shared = p_shared;
+        state[idx].first = (idx * TEST_LFSTACK_ITEMS) + 1;
+        pthread_create(&(threads[idx]), NULL, test_lfstack_worker,
+                       &(state[idx]));
+    }
+    for (size_t idx = 0; idx < TEST_LFSTACK_THREADS; ++idx)
+    {
+        pthread_join(threads[idx], NULL);
+    }
+    lfstack_pop_all(p_shared->p_stack, test_lfstack_take, p_shared);
+    
+    b_pass &= C_ASSERT(0 == atomic_load(&(p_shared->failures)));
+    C_BOOL b_once = C_TRUE;
+    for (size_t idx = 0; idx < TEST_LFSTACK_TOTAL; ++idx)
+    {
+        b_once &= (1 == atomic_load(&(p_shared->seen[idx])));
+    }
+    b_pass &= C_ASSERT(b_once);
+    
+    lfstack_destroy(p_shared->p_stack);
+    free(p_shared);
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= test_lfstack_single();
+    b_pass &= test_lfstack_stress();
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
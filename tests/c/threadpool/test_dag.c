@@ -0,0 +1,390 @@
+/*!
+ * @file tests/c/threadpool/test_dag.c
+ *
+ * @brief This file tests the task dependency graph executor.
+ */
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/allocator/allocator.h"
+#include "src/c/threadpool/dag.h"
+
+/*** Number of threads in the multi-threaded pools. ***/
+#define TEST_DAG_THREADS 4
+
+/*** Number of nodes in the chain graph. ***/
+#define TEST_DAG_CHAIN 100
+
+/*** Number of middle nodes in the fan-out graph, more than the queue. ***/
+#define TEST_DAG_FAN (THREADPOOL_QUEUE_CAP + 100)
+
+/*** Largest number of nodes in any test graph. ***/
+#define TEST_DAG_MAX_NODES (TEST_DAG_FAN + 2)
+
+/*** Largest number of edges in any test graph. ***/
+#define TEST_DAG_MAX_EDGES (2 * TEST_DAG_FAN)
+
+typedef struct _test_dag_graph test_dag_graph_t;
+
+/*!
+ * @brief This datatype defines the argument of one node's job.
+ *
+ * @param p_graph The graph under test.
+ * @param id The node's index.
+ */
+typedef struct _test_dag_arg
+{
+    test_dag_graph_t * p_graph;
+    size_t             id;
+} test_dag_arg_t;
+
+/*!
+ * @brief This datatype defines a graph under test along with a record of
+ *          how its nodes ran.
+ *
+ * @param p_dag The graph context.
+ * @param num_nodes The number of nodes.
+ * @param num_edges The number of edges.
+ * @param edges Each edge as a pair of node indices, predecessor first.
+ * @param seq The number of node jobs started so far.
+ * @param runs How many times each node's job ran.
+ * @param stamps The value of seq when each node's job last started.
+ * @param args The argument of each node's job.
+ */
+struct _test_dag_graph
+{
+    dag_t *        p_dag;
+    size_t         num_nodes;
+    size_t         num_edges;
+    size_t         edges[TEST_DAG_MAX_EDGES][2];
+    _Atomic size_t seq;
+    _Atomic size_t runs[TEST_DAG_MAX_NODES];
+    _Atomic size_t stamps[TEST_DAG_MAX_NODES];
+    test_dag_arg_t args[TEST_DAG_MAX_NODES];
+};
+
+/*!
+ * @brief This is a static function run as every node's job. It records
+ *          that the node ran and when it started.
+ *
+ * @param[in] pb_shutdown Unused.
+ * @param[in/out] p_arg The node's argument.
+ *
+ * @return No return value expected.
+ */
+static void
+test_dag_job (_Atomic bool * pb_shutdown, void * p_arg)
+{
+    (void) pb_shutdown;
+    test_dag_arg_t * p_node = p_arg;
+    test_dag_graph_t * p_graph = p_node->p_graph;
+    atomic_store(&(p_graph->stamps[p_node->id]),
+                 atomic_fetch_add(&(p_graph->seq), 1) + 1);
+    atomic_fetch_add(&(p_graph->runs[p_node->id]), 1);
+}
+
+/*!
+ * @brief This is a static function used as an allocator that fails once
+ *          its flag is set.
+ *
+ * @param[in] p_ctx The flag.
+ * @param[in] size The size in bytes of the block.
+ *
+ * @return Pointer to the block. NULL once the flag is set.
+ */
+static void *
+test_dag_alloc (void * p_ctx, size_t size)
+{
+    return atomic_load((_Atomic bool *) p_ctx) ? NULL : malloc(size);
+}
+
+/*!
+ * @brief This is a static function used as the failing allocator's free.
+ *
+ * @param[in] p_ctx Unused.
+ * @param[in/out] p_ptr The block.
+ * @param[in] size Unused.
+ *
+ * @return No return value expected.
+ */
+static void
+test_dag_free (void * p_ctx, void * p_ptr, size_t size)
+{
+    (void) p_ctx;
+    (void) size;
+    free(p_ptr);
+}
+
+/*!
+ * @brief This is a static function that builds a graph of unconnected
+ *          nodes.
+ *
+ * @param[in/out] p_tp The threadpool the graph runs on.
+ * @param[in] num_nodes The number of nodes.
+ *
+ * @return Pointer to the new graph. NULL on error.
+ */
+static test_dag_graph_t *
+test_dag_graph_create (threadpool_t * p_tp, const size_t num_nodes)
+{
+    test_dag_graph_t * p_graph = calloc(1, sizeof(test_dag_graph_t));
+    if (NULL == p_graph)
+    {
+        goto EXIT;
+    }
+    
+    p_graph->p_dag = dag_create(p_tp);
+    p_graph->num_nodes = num_nodes;
+    for (size_t idx = 0; (NULL != p_graph->p_dag) && (idx < num_nodes);
+         ++idx)
+    {
+        p_graph->args[idx].p_graph = p_graph;
+        p_graph->args[idx].id = idx;
+        if (NULL == dag_add_node(p_graph->p_dag, test_dag_job,
+                                 &(p_graph->args[idx])))
+        {
+            dag_destroy(p_graph->p_dag);
+            p_graph->p_dag = NULL;
+        }
+    }
+    if (NULL == p_graph->p_dag)
+    {
+        free(p_graph);
+        p_graph = NULL;
+    }
+    
+    EXIT:
+        return p_graph;
+}
+
+/*!
+ * @brief This is a static function that destroys a graph under test.
+ *
+ * @param[in/out] p_graph The graph.
+ *
+ * @return No return value expected.
+ */
+static void
+test_dag_graph_destroy (test_dag_graph_t * p_graph)
+{
+    if (NULL != p_graph)
+    {
+        dag_destroy(p_graph->p_dag);
+        free(p_graph);
+    }
+}
+
+/*!
+ * @brief This is a static function that adds an edge to a graph under
+ *          test and records it.
+ *
+ * @param[in/out] p_graph The graph.
+ * @param[in] pred The index of the node that must complete first.
+ * @param[in] succ The index of the node that depends on it.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_dag_graph_edge (test_dag_graph_t * p_graph,
+                     const size_t pred,
+                     const size_t succ)
+{
+    dag_node_t * p_pred = vector_at(p_graph->p_dag->p_nodes, pred);
+    dag_node_t * p_succ = vector_at(p_graph->p_dag->p_nodes, succ);
+    p_graph->edges[p_graph->num_edges][0] = pred;
+    p_graph->edges[p_graph->num_edges][1] = succ;
+    p_graph->num_edges++;
+    return (0 == dag_add_edge(p_pred, p_succ));
+}
+
+/*!
+ * @brief This is a static function that checks how the nodes of a graph
+ *          under test ran.
+ *
+ * @param[in] p_graph The graph.
+ * @param[in] runs The number of times every node should have run.
+ *
+ * @return C_TRUE if every node ran that many times and, when it ran at
+ *          all, started after each of its predecessors. C_FALSE
+ *          otherwise.
+ */
+static C_BOOL
+test_dag_graph_check (test_dag_graph_t * p_graph, const size_t runs)
+{
+    C_BOOL b_pass = C_TRUE;
+    for (size_t idx = 0; idx < p_graph->num_nodes; ++idx)
+    {
+        b_pass &= (runs == atomic_load(&(p_graph->runs[idx])));
+    }
+    for (size_t idx = 0; (0 != runs) && (idx < p_graph->num_edges); ++idx)
+    {
+        size_t pred = p_graph->edges[idx][0];
+        size_t succ = p_graph->edges[idx][1];
+        b_pass &= (atomic_load(&(p_graph->stamps[pred])) <
+                   atomic_load(&(p_graph->stamps[succ])));
+    }
+    return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks a diamond, run twice so
+ *          the countdowns must be rearmed, and a chain.
+ *
+ * @param[in] mode The job distribution mode.
+ * @param[in] num_threads The number of threads in the threadpool.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_dag_acyclic (const threadpool_mode_t mode, const size_t num_threads)
+{
+    C_BOOL b_pass = C_TRUE;
+    threadpool_t * p_tp = threadpool_create_mode(num_threads, mode);
+    b_pass &= C_ASSERT(NULL != p_tp);
+    if (NULL == p_tp)
+    {
+        goto EXIT;
+    }
+    
+    // A runs first, then B and C in either order, then D.
+    test_dag_graph_t * p_diamond = test_dag_graph_create(p_tp, 4);
+    b_pass &= C_ASSERT(NULL != p_diamond);
+    if (NULL != p_diamond)
+    {
+        b_pass &= C_ASSERT(test_dag_graph_edge(p_diamond, 0, 1));
+        b_pass &= C_ASSERT(test_dag_graph_edge(p_diamond, 0, 2));
+        b_pass &= C_ASSERT(test_dag_graph_edge(p_diamond, 1, 3));
+        b_pass &= C_ASSERT(test_dag_graph_edge(p_diamond, 2, 3));
+        b_pass &= C_ASSERT(0 == dag_run(p_diamond->p_dag));
+        b_pass &= C_ASSERT(test_dag_graph_check(p_diamond, 1));
+        b_pass &= C_ASSERT(0 == dag_run(p_diamond->p_dag));
+        b_pass &= C_ASSERT(test_dag_graph_check(p_diamond, 2));
+        test_dag_graph_destroy(p_diamond);
+    }
+    
+    // Each node of the chain depends on the one before. The edges are
+    // added back to front, so node order does not imply run order.
+    test_dag_graph_t * p_chain = test_dag_graph_create(p_tp, TEST_DAG_CHAIN);
+    b_pass &= C_ASSERT(NULL != p_chain);
+    if (NULL != p_chain)
+    {
+        for (size_t idx = TEST_DAG_CHAIN - 1; idx > 0; --idx)
+        {
+            b_pass &= C_ASSERT(test_dag_graph_edge(p_chain, idx, idx - 1));
+        }
+        b_pass &= C_ASSERT(0 == dag_run(p_chain->p_dag));
+        b_pass &= C_ASSERT(test_dag_graph_check(p_chain, 1));
+        test_dag_graph_destroy(p_chain);
+    }
+    
+    b_pass &= C_ASSERT(0 == threadpool_destroy(p_tp));
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks a graph containing a
+ *          cycle is refused without running any node, including a node
+ *          outside the cycle.
+ *
+ * @param[in] mode The job distribution mode.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_dag_cycle (const threadpool_mode_t mode)
+{
+    C_BOOL b_pass = C_TRUE;
+    threadpool_t * p_tp = threadpool_create_mode(TEST_DAG_THREADS, mode);
+    test_dag_graph_t * p_graph = test_dag_graph_create(p_tp, 4);
+    b_pass &= C_ASSERT(NULL != p_graph);
+    if (NULL == p_graph)
+    {
+        threadpool_destroy(p_tp);
+        goto EXIT;
+    }
+    
+    b_pass &= C_ASSERT(test_dag_graph_edge(p_graph, 0, 1));
+    b_pass &= C_ASSERT(test_dag_graph_edge(p_graph, 1, 2));
+    b_pass &= C_ASSERT(test_dag_graph_edge(p_graph, 2, 0));
+    b_pass &= C_ASSERT(-1 == dag_run(p_graph->p_dag));
+    b_pass &= C_ASSERT(test_dag_graph_check(p_graph, 0));
+    
+    test_dag_graph_destroy(p_graph);
+    b_pass &= C_ASSERT(0 == threadpool_destroy(p_tp));
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks the nodes a predecessor
+ *          fails to enqueue are run inline.
+ *
+ *          A single source releases more nodes than the shared queue
+ *              holds, on a one-thread pool whose allocator fails, so the
+ *              queue fills and cannot grow. The overflow must run on the
+ *              releasing thread, and a single sink joins everything.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_dag_inline (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    _Atomic bool b_fail = false;
+    allocator_t alloc = {
+        .alloc_func = test_dag_alloc,
+        .realloc_func = NULL,
+        .free_func = test_dag_free,
+        .p_ctx = &b_fail,
+    };
+    threadpool_t * p_tp = threadpool_create_with_allocator(
+                                1, THREADPOOL_MODE_SHARED, &alloc);
+    test_dag_graph_t * p_graph = test_dag_graph_create(p_tp,
+                                                       TEST_DAG_FAN + 2);
+    b_pass &= C_ASSERT(NULL != p_graph);
+    if (NULL == p_graph)
+    {
+        threadpool_destroy(p_tp);
+        goto EXIT;
+    }
+    
+    for (size_t idx = 1; idx <= TEST_DAG_FAN; ++idx)
+    {
+        b_pass &= C_ASSERT(test_dag_graph_edge(p_graph, 0, idx));
+        b_pass &= C_ASSERT(test_dag_graph_edge(p_graph, idx,
+                                               TEST_DAG_FAN + 1));
+    }
+    
+    atomic_store(&b_fail, true);
+    b_pass &= C_ASSERT(0 == dag_run(p_graph->p_dag));
+    b_pass &= C_ASSERT(test_dag_graph_check(p_graph, 1));
+    b_pass &= C_ASSERT(THREADPOOL_QUEUE_CAP == p_tp->jobs_cap);
+    atomic_store(&b_fail, false);
+    
+    test_dag_graph_destroy(p_graph);
+    b_pass &= C_ASSERT(0 == threadpool_destroy(p_tp));
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= C_ASSERT(NULL == dag_create(NULL));
+    b_pass &= C_ASSERT(-1 == dag_run(NULL));
+    b_pass &= test_dag_acyclic(THREADPOOL_MODE_SHARED, 1);
+    b_pass &= test_dag_acyclic(THREADPOOL_MODE_SHARED, TEST_DAG_THREADS);
+    b_pass &= test_dag_acyclic(THREADPOOL_MODE_STEALING, 1);
+    b_pass &= test_dag_acyclic(THREADPOOL_MODE_STEALING, TEST_DAG_THREADS);
+    b_pass &= test_dag_cycle(THREADPOOL_MODE_SHARED);
+    b_pass &= test_dag_cycle(THREADPOOL_MODE_STEALING);
+    b_pass &= test_dag_inline();
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,273 @@
+/*!
+ * @file tests/c/threadpool/test_parallel.c
+ *
+ * @brief This file tests the parallel loop and reduction primitives.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/threadpool/parallel.h"
+
+/*** Number of threads in the multi-threaded pools. ***/
+#define TEST_PARALLEL_THREADS 4
+
+/*** One past the largest index any test range reaches. ***/
+#define TEST_PARALLEL_MAX_END 20000
+
+/*** Multiplier of the order-sensitive hash the reductions compute. ***/
+#define TEST_PARALLEL_HASH_BASE 1000003u
+
+/*!
+ * @brief This datatype defines a range the tests run over.
+ *
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param grain The grain size passed, 0 to choose one automatically.
+ */
+typedef struct _test_parallel_range
+{
+    size_t begin;
+    size_t end;
+    size_t grain;
+} test_parallel_range_t;
+
+/*!
+ * @brief This datatype defines the context of a parallel loop test.
+ *
+ * @param grain The grain size passed, or 0.
+ * @param bad_calls The number of body calls given an empty or oversized
+ *          subrange.
+ * @param visits How many times each index was visited.
+ */
+typedef struct _test_parallel_ctx
+{
+    size_t         grain;
+    _Atomic size_t bad_calls;
+    _Atomic int    visits[TEST_PARALLEL_MAX_END];
+} test_parallel_ctx_t;
+
+/*!
+ * @brief This datatype defines a partial result of the test reduction.
+ *
+ *          The hash folds indices in order as h = h * B + i, so it
+ *              differs if any index is missed, repeated or combined out
+ *              of order. scale is B raised to the number of indices.
+ *
+ * @param hash The hash of the indices covered.
+ * @param scale The multiplier that shifts a hash past this partial.
+ * @param sum The sum of the indices covered.
+ */
+typedef struct _test_parallel_partial
+{
+    uint64_t hash;
+    uint64_t scale;
+    uint64_t sum;
+} test_parallel_partial_t;
+
+/*!
+ * @brief This is a static function used as a parallel loop body. It
+ *          counts a visit to every index of its subrange.
+ *
+ * @param[in] begin The first index of the subrange.
+ * @param[in] end One past the last index of the subrange.
+ * @param[in/out] p_ctx The loop test context.
+ *
+ * @return No return value expected.
+ */
+static void
+test_parallel_visit (size_t begin, size_t end, void * p_ctx)
+{
+    test_parallel_ctx_t * p_test = p_ctx;
+    if ((begin >= end) ||
+        ((0 != p_test->grain) &&
+         ((end - begin) > p_test->grain)))
+    {
+        atomic_fetch_add(&(p_test->bad_calls), 1);
+    }
+    for (size_t idx = begin; (idx < end) && (idx < TEST_PARALLEL_MAX_END);
+         ++idx)
+    {
+        atomic_fetch_add(&(p_test->visits[idx]), 1);
+    }
+}
+
+/*!
+ * @brief This is a static function used as a reduction body. It folds
+ *          every index of its subrange into a partial result.
+ *
+ * @param[in] begin The first index of the subrange.
+ * @param[in] end One past the last index of the subrange.
+ * @param[in] p_ctx Unused.
+ * @param[in/out] p_partial The partial result.
+ *
+ * @return No return value expected.
+ */
+static void
+test_parallel_fold (size_t begin, size_t end, void * p_ctx, void * p_partial)
+{
+    (void) p_ctx;
+    test_parallel_partial_t * p_result = p_partial;
+    for (size_t idx = begin; idx < end; ++idx)
+    {
+        p_result->hash = (p_result->hash * TEST_PARALLEL_HASH_BASE) + idx;
+        p_result->scale *= TEST_PARALLEL_HASH_BASE;
+        p_result->sum += idx;
+    }
+}
+
+/*!
+ * @brief This is a static function that combines two partial results of
+ *          the test reduction. It is associative but not commutative.
+ *
+ * @param[in] p_ctx Unused.
+ * @param[in/out] p_dst The partial result covering lower indices.
+ * @param[in] p_src The partial result covering higher indices.
+ *
+ * @return No return value expected.
+ */
+static void
+test_parallel_combine (void * p_ctx, void * p_dst, const void * p_src)
+{
+    (void) p_ctx;
+    test_parallel_partial_t * p_lower = p_dst;
+    const test_parallel_partial_t * p_upper = p_src;
+    p_lower->hash = (p_lower->hash * p_upper->scale) + p_upper->hash;
+    p_lower->scale *= p_upper->scale;
+    p_lower->sum += p_upper->sum;
+}
+
+/*!
+ * @brief This is a static function that checks a parallel loop visits
+ *          every index of a range exactly once, and nothing outside it.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] range The range.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_parallel_for_range (threadpool_t * p_tp,
+                         const test_parallel_range_t range)
+{
+    C_BOOL b_pass = C_TRUE;
+    test_parallel_ctx_t * p_test = calloc(1, sizeof(test_parallel_ctx_t));
+    b_pass &= C_ASSERT(NULL != p_test);
+    if (NULL == p_test)
+    {
+        goto EXIT;
+    }
+    
+    p_test->grain = range.grain;
+    b_pass &= C_ASSERT(0 == threadpool_parallel_for(p_tp, range.begin,
+                                                    range.end, range.grain,
+                                                    test_parallel_visit,
+                                                    p_test));
+    b_pass &= C_ASSERT(0 == atomic_load(&(p_test->bad_calls)));
+    C_BOOL b_once = C_TRUE;
+    for (size_t idx = 0; idx < TEST_PARALLEL_MAX_END; ++idx)
+    {
+        int expected = ((idx >= range.begin) && (idx < range.end)) ? 1 : 0;
+        b_once &= (expected == atomic_load(&(p_test->visits[idx])));
+    }
+    b_pass &= C_ASSERT(b_once);
+    free(p_test);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks a parallel reduction
+ *          over a range matches a serial fold of it.
+ *
+ * @param[in/out] p_tp The threadpool context.
+ * @param[in] range The range.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_parallel_reduce_range (threadpool_t * p_tp,
+                            const test_parallel_range_t range)
+{
+    C_BOOL b_pass = C_TRUE;
+    test_parallel_partial_t expected = { 0, 1, 0 };
+    test_parallel_partial_t result = { 0, 1, 0 };
+    if (range.begin < range.end)
+    {
+        test_parallel_fold(range.begin, range.end, NULL, &expected);
+    }
+    b_pass &= C_ASSERT(0 == threadpool_parallel_reduce(
+                                p_tp, range.begin, range.end, range.grain,
+                                test_parallel_fold, test_parallel_combine,
+                                NULL, &result, sizeof(result)));
+    b_pass &= C_ASSERT(expected.hash == result.hash);
+    b_pass &= C_ASSERT(expected.scale == result.scale);
+    b_pass &= C_ASSERT(expected.sum == result.sum);
+    return b_pass;
+}
+
+/*!
+ * @brief This is a static function that runs the loop and reduction
+ *          checks over every test range on one threadpool.
+ *
+ *          The ranges start away from zero, include grains that do not
+ *              divide them evenly, a grain larger than the range, an
+ *              automatic grain and empty ranges.
+ *
+ * @param[in] mode The job distribution mode.
+ * @param[in] num_threads The number of threads in the threadpool.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_parallel_pool (const threadpool_mode_t mode, const size_t num_threads)
+{
+    C_BOOL b_pass = C_TRUE;
+    const test_parallel_range_t ranges[] = {
+        { 13, 10013, 7 },
+        { 13, 10013, 0 },
+        { 1000, 19999, 64 },
+        { 5, 6, 1 },
+        { 100, 103, 64 },
+        { 0, 1000, 1000 },
+        { 0, 0, 1 },
+        { 37, 37, 0 },
+        { 50, 10, 1 },
+    };
+    threadpool_t * p_tp = threadpool_create_mode(num_threads, mode);
+    b_pass &= C_ASSERT(NULL != p_tp);
+    if (NULL == p_tp)
+    {
+        goto EXIT;
+    }
+    
+    for (size_t idx = 0; idx < (sizeof(ranges) / sizeof(*ranges)); ++idx)
+    {
+        b_pass &= test_parallel_for_range(p_tp, ranges[idx]);
+        b_pass &= test_parallel_reduce_range(p_tp, ranges[idx]);
+    }
+    b_pass &= C_ASSERT(-1 == threadpool_parallel_for(NULL, 0, 10, 1,
+                                                     test_parallel_visit,
+                                                     NULL));
+    
+    b_pass &= C_ASSERT(0 == threadpool_destroy(p_tp));
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= test_parallel_pool(THREADPOOL_MODE_SHARED, 1);
+    b_pass &= test_parallel_pool(THREADPOOL_MODE_SHARED,
+                                 TEST_PARALLEL_THREADS);
+    b_pass &= test_parallel_pool(THREADPOOL_MODE_STEALING, 1);
+    b_pass &= test_parallel_pool(THREADPOOL_MODE_STEALING,
+                                 TEST_PARALLEL_THREADS);
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
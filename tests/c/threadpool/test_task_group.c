@@ -0,0 +1,264 @@
+/*!
+ * @file tests/c/threadpool/test_task_group.c
+ *
+ * @brief This file tests threadpool task groups.
+ */
+
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/threadpool/threadpool.h"
+
+/*** Number of threads in the stress test's threadpool. ***/
+#define TEST_GROUP_THREADS 2
+
+/*** Number of threads submitting to the shared group. ***/
+#define TEST_GROUP_PRODUCERS 4
+
+/*** Number of parent jobs each producer submits. ***/
+#define TEST_GROUP_PARENTS 64
+
+/*** Number of child jobs each parent submits and waits on. ***/
+#define TEST_GROUP_CHILDREN 16
+
+/*!
+ * @brief This datatype defines the state shared by the stress test.
+ *
+ * @param group The group every producer submits its parent jobs to.
+ * @param count The number of child jobs run.
+ * @param failures The number of calls that returned an error.
+ */
+typedef struct _test_group_shared
+{
+    threadpool_group_t group;
+    _Atomic size_t     count;
+    _Atomic size_t     failures;
+} test_group_shared_t;
+
+/*!
+ * @brief This datatype defines one producer in the stress test.
+ *
+ * @param p_shared The shared state.
+ * @param tasks The task handles of the producer's parent jobs.
+ */
+typedef struct _test_group_producer
+{
+    test_group_shared_t * p_shared;
+    threadpool_task_t     tasks[TEST_GROUP_PARENTS];
+} test_group_producer_t;
+
+/*!
+ * @brief This is a static function that counts one run.
+ *
+ * @param[in] pb_shutdown Unused.
+ * @param[in/out] p_arg The counter to increment.
+ *
+ * @return No return value expected.
+ */
+static void
+test_group_count (_Atomic bool * pb_shutdown, void * p_arg)
+{
+    (void) pb_shutdown;
+    atomic_fetch_add((_Atomic size_t *) p_arg, 1);
+}
+
+/*!
+ * @brief This is a static function that marks one unit of a group's
+ *          added work as complete.
+ *
+ * @param[in] pb_shutdown Unused.
+ * @param[in/out] p_arg The task group.
+ *
+ * @return No return value expected.
+ */
+static void
+test_group_done (_Atomic bool * pb_shutdown, void * p_arg)
+{
+    (void) pb_shutdown;
+    threadpool_group_done(p_arg);
+}
+
+/*!
+ * @brief This is a static function run as a parent job. It submits its
+ *          children to a group of its own and waits on them from inside
+ *          the threadpool.
+ *
+ * @param[in] pb_shutdown Unused.
+ * @param[in/out] p_arg The shared state.
+ *
+ * @return No return value expected.
+ */
+static void
+test_group_parent (_Atomic bool * pb_shutdown, void * p_arg)
+{
+    (void) pb_shutdown;
+    test_group_shared_t * p_shared = p_arg;
+    threadpool_task_t tasks[TEST_GROUP_CHILDREN];
+    threadpool_group_t group;
+    int status = threadpool_group_init(p_shared->group.p_tp, &group);
+    for (size_t idx = 0; idx < TEST_GROUP_CHILDREN; ++idx)
+    {
+        status |= threadpool_group_submit(&group, &(tasks[idx]),
+                                          test_group_count,
+                                          &(p_shared->count));
+    }
+    status |= threadpool_wait_all(&group);
+    if ((0 != status) ||
+        (!threadpool_try_wait_all(&group)))
+    {
+        atomic_fetch_add(&(p_shared->failures), 1);
+    }
+}
+
+/*!
+ * @brief This is a static function run by each producer thread. It
+ *          submits its parent jobs to the shared group.
+ *
+ * @param[in/out] p_arg The producer.
+ *
+ * @return Always NULL.
+ */
+static void *
+test_group_producer (void * p_arg)
+{
+    test_group_producer_t * p_producer = p_arg;
+    test_group_shared_t * p_shared = p_producer->p_shared;
+    for (size_t idx = 0; idx < TEST_GROUP_PARENTS; ++idx)
+    {
+        if (0 != threadpool_group_submit(&(p_shared->group),
+                                         &(p_producer->tasks[idx]),
+                                         test_group_parent, p_shared))
+        {
+            atomic_fetch_add(&(p_shared->failures), 1);
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * @brief This is a static function that checks a task group's behaviour
+ *          on a threadpool with a single thread.
+ *
+ * @param[in] mode The job distribution mode.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_group_single (const threadpool_mode_t mode)
+{
+    C_BOOL b_pass = C_TRUE;
+    _Atomic size_t count = 0;
+    threadpool_task_t tasks[8];
+    threadpool_group_t group;
+    threadpool_t * p_tp = threadpool_create_mode(1, mode);
+    b_pass &= C_ASSERT(NULL != p_tp);
+    if (NULL == p_tp)
+    {
+        goto EXIT;
+    }
+    
+    b_pass &= C_ASSERT(-1 == threadpool_group_init(NULL, &group));
+    b_pass &= C_ASSERT(-1 == threadpool_group_init(p_tp, NULL));
+    b_pass &= C_ASSERT(0 == threadpool_group_init(p_tp, &group));
+    b_pass &= C_ASSERT(threadpool_try_wait_all(&group));
+    b_pass &= C_ASSERT(0 == threadpool_wait_all(&group));
+    
+    for (size_t idx = 0; idx < 8; ++idx)
+    {
+        b_pass &= C_ASSERT(0 == threadpool_group_submit(&group,
+                                                        &(tasks[idx]),
+                                                        test_group_count,
+                                                        &count));
+    }
+    b_pass &= C_ASSERT(0 == threadpool_wait_all(&group));
+    b_pass &= C_ASSERT(8 == atomic_load(&count));
+    b_pass &= C_ASSERT(threadpool_try_wait_all(&group));
+    for (size_t idx = 0; idx < 8; ++idx)
+    {
+        b_pass &= C_ASSERT(threadpool_try_wait(&(tasks[idx])));
+    }
+    
+    // Work added by hand keeps the group open until each unit is done.
+    b_pass &= C_ASSERT(0 == threadpool_group_add(&group, 2));
+    b_pass &= C_ASSERT(!threadpool_try_wait_all(&group));
+    b_pass &= C_ASSERT(0 == threadpool_group_done(&group));
+    b_pass &= C_ASSERT(!threadpool_try_wait_all(&group));
+    b_pass &= C_ASSERT(0 == threadpool_enq(p_tp, test_group_done, &group));
+    b_pass &= C_ASSERT(0 == threadpool_wait_all(&group));
+    b_pass &= C_ASSERT(threadpool_try_wait_all(&group));
+    
+    b_pass &= C_ASSERT(0 == threadpool_destroy(p_tp));
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks that nested groups
+ *          submitted from several threads at once all complete.
+ *
+ *          Every parent job waits on its children from inside the
+ *              threadpool, and there are more parents than threads, so
+ *              this deadlocks unless waiting threads run queued jobs.
+ *
+ * @param[in] mode The job distribution mode.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_group_stress (const threadpool_mode_t mode)
+{
+    C_BOOL b_pass = C_TRUE;
+    pthread_t threads[TEST_GROUP_PRODUCERS];
+    test_group_shared_t shared;
+    test_group_producer_t * p_producers = calloc(TEST_GROUP_PRODUCERS,
+                                                 sizeof(*p_producers));
+    threadpool_t * p_tp = threadpool_create_mode(TEST_GROUP_THREADS, mode);
+    b_pass &= C_ASSERT(NULL != p_producers);
+    b_pass &= C_ASSERT(NULL != p_tp);
+    if ((NULL == p_producers) ||
+        (NULL == p_tp))
+    {
+        free(p_producers);
+        threadpool_destroy(p_tp);
+        goto EXIT;
+    }
+    
+    b_pass &= C_ASSERT(0 == threadpool_group_init(p_tp, &(shared.group)));
+    atomic_init(&(shared.count), 0);
+    atomic_init(&(shared.failures), 0);
+    for (size_t idx = 0; idx < TEST_GROUP_PRODUCERS; ++idx)
+    {
+        p_producers[idx].p_shared = &shared;
+        pthread_create(&(threads[idx]), NULL, test_group_producer,
+                       &(p_producers[idx]));
+    }
+    for (size_t idx = 0; idx < TEST_GROUP_PRODUCERS; ++idx)
+    {
+        pthread_join(threads[idx], NULL);
+    }
+    
+    b_pass &= C_ASSERT(0 == threadpool_wait_all(&(shared.group)));
+    b_pass &= C_ASSERT(0 == atomic_load(&(shared.failures)));
+    b_pass &= C_ASSERT((TEST_GROUP_PRODUCERS * TEST_GROUP_PARENTS *
+                        TEST_GROUP_CHILDREN) == atomic_load(&(shared.count)));
+    
+    b_pass &= C_ASSERT(0 == threadpool_destroy(p_tp));
+    free(p_producers);
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= test_group_single(THREADPOOL_MODE_SHARED);
+    b_pass &= test_group_single(THREADPOOL_MODE_STEALING);
+    b_pass &= test_group_stress(THREADPOOL_MODE_SHARED);
+    b_pass &= test_group_stress(THREADPOOL_MODE_STEALING);
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
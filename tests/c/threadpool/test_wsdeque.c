@@ -0,0 +1,220 @@
+/*!
+ * @file tests/c/threadpool/test_wsdeque.c
+ *
+ * @brief This file tests the work-stealing deque.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/threadpool/wsdeque.h"
+
+/*** Number of jobs the owner pushes in the stress test. ***/
+#define TEST_WSDEQUE_JOBS 100000
+
+/*** Number of thief threads in the stress test. ***/
+#define TEST_WSDEQUE_THIEVES 3
+
+/*!
+ * @brief This datatype defines the state shared by the stress test.
+ *
+ * @param p_deque The deque under test.
+ * @param taken The number of jobs taken so far by any thread.
+ * @param seen How many times each job has been taken.
+ */
+typedef struct _test_wsdeque_shared
+{
+    wsdeque_t *    p_deque;
+    _Atomic size_t taken;
+    _Atomic int    seen[TEST_WSDEQUE_JOBS];
+} test_wsdeque_shared_t;
+
+/*!
+ * @brief This is a static function used as the job function of every
+ *          pushed job. It is never run, only compared against.
+ *
+ * @param[in] pb_shutdown Unused.
+ * @param[in] p_arg Unused.
+ *
+ * @return No return value expected.
+ */
+static void
+test_wsdeque_job (_Atomic bool * pb_shutdown, void * p_arg)
+{
+    (void) pb_shutdown;
+    (void) p_arg;
+}
+
+/*!
+ * @brief This is a static function that records a job taken from the
+ *          deque in the stress test.
+ *
+ * @param[in/out] p_shared The shared state.
+ * @param[in] p_job The job taken.
+ *
+ * @return No return value expected.
+ */
+static void
+test_wsdeque_take (test_wsdeque_shared_t * p_shared, const job_t * p_job)
+{
+    size_t idx = (size_t) (uintptr_t) p_job->p_arg - 1;
+    if ((test_wsdeque_job == p_job->job_func) &&
+        (idx < TEST_WSDEQUE_JOBS))
+    {
+        atomic_fetch_add(&(p_shared->seen[idx]), 1);
+    }
+    atomic_fetch_add(&(p_shared->taken), 1);
+}
+
+/*!
+ * @brief This is a static function run by each thief thread. It steals
+ *          until every job has been taken.
+ *
+ * @param[in/out] p_arg The shared state.
+ *
+ * @return Always NULL.
+ */
+static void *
+test_wsdeque_thief (void * p_arg)
+{
+    test_wsdeque_shared_t * p_shared = p_arg;
+    job_t job;
+    while (TEST_WSDEQUE_JOBS > atomic_load(&(p_shared->taken)))
+    {
+        if (0 == wsdeque_steal(p_shared->p_deque, &job))
+        {
+            test_wsdeque_take(p_shared, &job);
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * @brief This is a static function that checks the deque's behaviour
+ *          on a single thread.
+ *
+ *          The owner pops the newest job and a thief steals the oldest,
+ *              and the buffer grows past its initial capacity.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_wsdeque_single (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    job_t job;
+    wsdeque_t * p_deque = wsdeque_create(2);
+    b_pass &= C_ASSERT(NULL != p_deque);
+    if (NULL == p_deque)
+    {
+        goto EXIT;
+    }
+    
+    b_pass &= C_ASSERT(0 == wsdeque_size(p_deque));
+    b_pass &= C_ASSERT(-1 == wsdeque_pop(p_deque, &job));
+    b_pass &= C_ASSERT(-1 == wsdeque_steal(p_deque, &job));
+    b_pass &= C_ASSERT(-1 == wsdeque_push(p_deque, NULL, NULL));
+    
+    for (uintptr_t idx = 1; idx <= 100; ++idx)
+    {
+        b_pass &= C_ASSERT(0 == wsdeque_push(p_deque, test_wsdeque_job,
+                                             (void *) idx));
+    }
+    b_pass &= C_ASSERT(100 == wsdeque_size(p_deque));
+    
+    b_pass &= C_ASSERT(0 == wsdeque_steal(p_deque, &job));
+    b_pass &= C_ASSERT(test_wsdeque_job == job.job_func);
+    b_pass &= C_ASSERT((void *) 1 == job.p_arg);
+    for (uintptr_t idx = 100; idx >= 2; --idx)
+    {
+        b_pass &= C_ASSERT(0 == wsdeque_pop(p_deque, &job));
+        b_pass &= C_ASSERT((void *) idx == job.p_arg);
+    }
+    b_pass &= C_ASSERT(0 == wsdeque_size(p_deque));
+    b_pass &= C_ASSERT(-1 == wsdeque_pop(p_deque, &job));
+    
+    wsdeque_destroy(p_deque);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks that, with one owner
+ *          pushing and popping while several thieves steal, every job
+ *          is taken exactly once.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_wsdeque_stress (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    pthread_t thieves[TEST_WSDEQUE_THIEVES];
+    job_t job;
+    test_wsdeque_shared_t * p_shared = calloc(1,
+                                              sizeof(test_wsdeque_shared_t));
+    b_pass &= C_ASSERT(NULL != p_shared);
+    if (NULL == p_shared)
+    {
+        goto EXIT;
+    }
+    p_shared->p_deque = wsdeque_create(16);
+    b_pass &= C_ASSERT(NULL != p_shared->p_deque);
+    if (NULL == p_shared->p_deque)
+    {
+        free(p_shared);
+        goto EXIT;
+    }
+    
+    for (size_t idx = 0; idx < TEST_WSDEQUE_THIEVES; ++idx)
+    {
+        pthread_create(&(thieves[idx]), NULL, test_wsdeque_thief, p_shared);
+    }
+    
+    // The owner pops every fourth push so both ends of the deque race.
+    for (uintptr_t idx = 1; idx <= TEST_WSDEQUE_JOBS; ++idx)
+    {
+        b_pass &= C_ASSERT(0 == wsdeque_push(p_shared->p_deque,
+                                             test_wsdeque_job,
+                                             (void *) idx));
+        if ((0 == (idx % 4)) &&
+            (0 == wsdeque_pop(p_shared->p_deque, &job)))
+        {
+            test_wsdeque_take(p_shared, &job);
+        }
+    }
+    while (0 == wsdeque_pop(p_shared->p_deque, &job))
+    {
+        test_wsdeque_take(p_shared, &job);
+    }
+    
+    for (size_t idx = 0; idx < TEST_WSDEQUE_THIEVES; ++idx)
+    {
+        pthread_join(thieves[idx], NULL);
+    }
+    
+    b_pass &= C_ASSERT(TEST_WSDEQUE_JOBS == atomic_load(&(p_shared->taken)));
+    for (size_t idx = 0; idx < TEST_WSDEQUE_JOBS; ++idx)
+    {
+        b_pass &= C_ASSERT(1 == atomic_load(&(p_shared->seen[idx])));
+    }
+    
+    wsdeque_destroy(p_shared->p_deque);
+    free(p_shared);
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= test_wsdeque_single();
+    b_pass &= test_wsdeque_stress();
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,261 @@
+/*!
+ * @file tests/c/vector/test_conc_vector.c
+ *
+ * @brief This file tests the grow-only concurrent vector.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/vector/conc_vector.h"
+
+/*** Number of appending threads in the stress test. ***/
+#define TEST_CONC_WRITERS 4
+
+/*** Number of reading threads in the stress test. ***/
+#define TEST_CONC_READERS 2
+
+/*** Number of elements each writer appends. ***/
+#define TEST_CONC_ITEMS 20000
+
+/*!
+ * @brief This datatype defines an element appended in the stress test.
+ *
+ * @param writer The index of the writer that appended it.
+ * @param seq Its position in that writer's sequence.
+ */
+typedef struct _test_conc_item
+{
+    uint64_t writer;
+    uint64_t seq;
+} test_conc_item_t;
+
+/*!
+ * @brief This datatype defines the state shared by the stress test.
+ *
+ * @param p_vector The vector under test.
+ * @param b_done Set once every writer has finished.
+ * @param failures The number of failed appends and bad reads.
+ */
+typedef struct _test_conc_shared
+{
+    conc_vector_t * p_vector;
+    _Atomic bool    b_done;
+    _Atomic size_t  failures;
+} test_conc_shared_t;
+
+/*!
+ * @brief This datatype defines one writer in the stress test.
+ *
+ * @param p_shared The shared state.
+ * @param writer The writer's index.
+ * @param indices The index each of the writer's appends returned.
+ */
+typedef struct _test_conc_writer
+{
+    test_conc_shared_t * p_shared;
+    uint64_t             writer;
+    size_t               indices[TEST_CONC_ITEMS];
+} test_conc_writer_t;
+
+/*!
+ * @brief This is a static function run by each writer thread.
+ *
+ * @param[in/out] p_arg The writer.
+ *
+ * @return Always NULL.
+ */
+static void *
+test_conc_writer (void * p_arg)
+{
+    test_conc_writer_t * p_writer = p_arg;
+    test_conc_shared_t * p_shared = p_writer->p_shared;
+    for (uint64_t seq = 0; seq < TEST_CONC_ITEMS; ++seq)
+    {
+        test_conc_item_t item = { p_writer->writer, seq };
+        if (0 != conc_vector_push_back(p_shared->p_vector, &item,
+                                       &(p_writer->indices[seq])))
+        {
+            atomic_fetch_add(&(p_shared->failures), 1);
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * @brief This is a static function run by each reader thread. Until the
+ *          writers finish it scans every claimed index, checking that
+ *          any published element is one a writer appended.
+ *
+ * @param[in/out] p_arg The shared state.
+ *
+ * @return Always NULL.
+ */
+static void *
+test_conc_reader (void * p_arg)
+{
+    test_conc_shared_t * p_shared = p_arg;
+    while (!atomic_load(&(p_shared->b_done)))
+    {
+        size_t size = conc_vector_size(p_shared->p_vector);
+        for (size_t idx = 0; idx < size; ++idx)
+        {
+            const test_conc_item_t * p_item = conc_vector_at(
+                                                    p_shared->p_vector, idx);
+            if ((NULL != p_item) &&
+                ((p_item->writer >= TEST_CONC_WRITERS) ||
+                 (p_item->seq >= TEST_CONC_ITEMS)))
+            {
+                atomic_fetch_add(&(p_shared->failures), 1);
+            }
+        }
+        sched_yield();
+    }
+    return NULL;
+}
+
+/*!
+ * @brief This is a static function that checks the vector's behaviour
+ *          on a single thread, across several blocks.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_conc_single (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    size_t idx = 0;
+    b_pass &= C_ASSERT(NULL == conc_vector_create(0));
+    
+    conc_vector_t * p_vector = conc_vector_create(sizeof(uint64_t));
+    b_pass &= C_ASSERT(NULL != p_vector);
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    b_pass &= C_ASSERT(0 == conc_vector_size(p_vector));
+    b_pass &= C_ASSERT(NULL == conc_vector_at(p_vector, 0));
+    b_pass &= C_ASSERT(-1 == conc_vector_push_back(p_vector, NULL, &idx));
+    b_pass &= C_ASSERT(0 == conc_vector_reserve(p_vector, 100));
+    b_pass &= C_ASSERT(NULL == conc_vector_at(p_vector, 0));
+    
+    // Enough elements to fill the first few blocks of doubling size.
+    for (uint64_t value = 0; value < 1000; ++value)
+    {
+        b_pass &= C_ASSERT(0 == conc_vector_push_back(p_vector, &value,
+                                                      &idx));
+        b_pass &= C_ASSERT(value == idx);
+    }
+    b_pass &= C_ASSERT(1000 == conc_vector_size(p_vector));
+    for (uint64_t value = 0; value < 1000; ++value)
+    {
+        const uint64_t * p_value = conc_vector_at(p_vector, value);
+        b_pass &= C_ASSERT((NULL != p_value) &&
+                           (value == *p_value));
+    }
+    b_pass &= C_ASSERT(NULL == conc_vector_at(p_vector, 1000));
+    b_pass &= C_ASSERT(NULL == conc_vector_at(p_vector, SIZE_MAX));
+    
+    // Element addresses are stable across growth.
+    const uint64_t * p_first = conc_vector_at(p_vector, 0);
+    b_pass &= C_ASSERT(0 == conc_vector_reserve(p_vector, 5000));
+    b_pass &= C_ASSERT(p_first == conc_vector_at(p_vector, 0));
+    b_pass &= C_ASSERT(1000 == conc_vector_size(p_vector));
+    
+    conc_vector_destroy(p_vector);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks that, with several
+ *          threads appending while others read, every append lands at
+ *          the index it returned and no index is handed out twice.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_conc_stress (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    pthread_t writers[TEST_CONC_WRITERS];
+    pthread_t readers[TEST_CONC_READERS];
+    test_conc_shared_t shared;
+    test_conc_writer_t * p_writers = calloc(TEST_CONC_WRITERS,
+                                            sizeof(*p_writers));
+    shared.p_vector = conc_vector_create(sizeof(test_conc_item_t));
+    b_pass &= C_ASSERT(NULL != p_writers);
+    b_pass &= C_ASSERT(NULL != shared.p_vector);
+    if ((NULL == p_writers) ||
+        (NULL == shared.p_vector))
+    {
+        free(p_writers);
+        conc_vector_destroy(shared.p_vector);
+        goto EXIT;
+    }
+    atomic_init(&(shared.b_done), false);
+    atomic_init(&(shared.failures), 0);
+    
+    for (size_t idx = 0; idx < TEST_CONC_READERS; ++idx)
+    {
+        pthread_create(&(readers[idx]), NULL, test_conc_reader, &shared);
+    }
+    for (size_t idx = 0; idx < TEST_CONC_WRITERS; ++idx)
+    {
+        p_writers[idx].p_shared = &shared;
+        p_writers[idx].writer = idx;
+        pthread_create(&(writers[idx]), NULL, test_conc_writer,
+                       &(p_writers[idx]));
+    }
+    for (size_t idx = 0; idx < TEST_CONC_WRITERS; ++idx)
+    {
+        pthread_join(writers[idx], NULL);
+    }
+    atomic_store(&(shared.b_done), true);
+    for (size_t idx = 0; idx < TEST_CONC_READERS; ++idx)
+    {
+        pthread_join(readers[idx], NULL);
+    }
+    
+    b_pass &= C_ASSERT(0 == atomic_load(&(shared.failures)));
+    b_pass &= C_ASSERT((TEST_CONC_WRITERS * TEST_CONC_ITEMS) ==
+                       conc_vector_size(shared.p_vector));
+    
+    // Every element is published at the index its append returned. As
+    // there are exactly as many indices as appends, none was reused.
+    C_BOOL b_found = C_TRUE;
+    for (uint64_t writer = 0; writer < TEST_CONC_WRITERS; ++writer)
+    {
+        for (uint64_t seq = 0; seq < TEST_CONC_ITEMS; ++seq)
+        {
+            const test_conc_item_t * p_item = conc_vector_at(
+                                        shared.p_vector,
+                                        p_writers[writer].indices[seq]);
+            b_found &= ((NULL != p_item) &&
+                        (writer == p_item->writer) &&
+                        (seq == p_item->seq));
+        }
+    }
+    b_pass &= C_ASSERT(b_found);
+    
+    conc_vector_destroy(shared.p_vector);
+    free(p_writers);
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= test_conc_single();
+    b_pass &= test_conc_stress();
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,302 @@
+/*!
+ * @file tests/c/vector/test_rcu_vector.c
+ *
+ * @brief This file tests the read-mostly vector.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/vector/rcu_vector.h"
+
+/*** Number of updating threads in the stress test. ***/
+#define TEST_RCU_WRITERS 2
+
+/*** Number of reading threads in the stress test. ***/
+#define TEST_RCU_READERS 4
+
+/*** Number of updates each writer makes. ***/
+#define TEST_RCU_UPDATES 1000
+
+/*** Number of updates a writer makes between synchronizations. ***/
+#define TEST_RCU_SYNC_EVERY 16
+
+/*!
+ * @brief This datatype defines the state shared by the stress test.
+ *
+ * @param p_rcu The vector under test.
+ * @param b_done Set once every writer has finished.
+ * @param failures The number of failed calls and inconsistent snapshots.
+ */
+typedef struct _test_rcu_shared
+{
+    rcu_vector_t * p_rcu;
+    _Atomic bool   b_done;
+    _Atomic size_t failures;
+} test_rcu_shared_t;
+
+/*!
+ * @brief This is a static function used as an update. It appends one
+ *          more than the vector's size, so every version holds 1 to n
+ *          in order.
+ *
+ * @param[in/out] p_vector The copy being updated.
+ * @param[in] p_arg Unused.
+ *
+ * @return 0 on success, -1 on error.
+ */
+static int
+test_rcu_append (vector_t * p_vector, void * p_arg)
+{
+    (void) p_arg;
+    return vector_push_back(p_vector, (void *) (p_vector->size + 1));
+}
+
+/*!
+ * @brief This is a static function used as an update that discards the
+ *          copy.
+ *
+ * @param[in/out] p_vector Unused.
+ * @param[in] p_arg Unused.
+ *
+ * @return Always -1.
+ */
+static int
+test_rcu_discard (vector_t * p_vector, void * p_arg)
+{
+    (void) p_vector;
+    (void) p_arg;
+    return -1;
+}
+
+/*!
+ * @brief This is a static function that checks a version holds 1 to n
+ *          in order.
+ *
+ * @param[in] p_vector The version.
+ *
+ * @return true if the version is consistent, false otherwise.
+ */
+static bool
+test_rcu_consistent (const vector_t * p_vector)
+{
+    bool b_consistent = (NULL != p_vector);
+    for (size_t idx = 0; b_consistent && (idx < p_vector->size); ++idx)
+    {
+        b_consistent = ((void *) (idx + 1) == vector_at(p_vector, idx));
+    }
+    return b_consistent;
+}
+
+/*!
+ * @brief This is a static function run by each writer thread.
+ *
+ * @param[in/out] p_arg The shared state.
+ *
+ * @return Always NULL.
+ */
+static void *
+test_rcu_writer (void * p_arg)
+{
+    test_rcu_shared_t * p_shared = p_arg;
+    for (size_t count = 1; count <= TEST_RCU_UPDATES; ++count)
+    {
+        if ((0 != rcu_vector_update(p_shared->p_rcu, test_rcu_append,
+                                    NULL)) ||
+            ((0 == (count % TEST_RCU_SYNC_EVERY)) &&
+             (0 != rcu_vector_synchronize(p_shared->p_rcu))))
+        {
+            atomic_fetch_add(&(p_shared->failures), 1);
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * @brief This is a static function run by each reader thread. Until the
+ *          writers finish it checks snapshots, which must never change
+ *          or be freed while held, and must never shrink.
+ *
+ * @param[in/out] p_arg The shared state.
+ *
+ * @return Always NULL.
+ */
+static void *
+test_rcu_reader (void * p_arg)
+{
+    test_rcu_shared_t * p_shared = p_arg;
+    size_t last_size = 0;
+    rcu_vector_reader_t * p_reader = rcu_vector_register(p_shared->p_rcu);
+    if (NULL == p_reader)
+    {
+        atomic_fetch_add(&(p_shared->failures), 1);
+        goto EXIT;
+    }
+    
+    while (!atomic_load(&(p_shared->b_done)))
+    {
+        const vector_t * p_vector = rcu_vector_read_lock(p_shared->p_rcu,
+                                                         p_reader);
+        size_t size = (NULL == p_vector) ? 0 : p_vector->size;
+        sched_yield();
+        if ((size < last_size) ||
+            (!test_rcu_consistent(p_vector)) ||
+            (size != p_vector->size))
+        {
+            atomic_fetch_add(&(p_shared->failures), 1);
+        }
+        last_size = size;
+        rcu_vector_read_unlock(p_reader);
+    }
+    rcu_vector_unregister(p_reader);
+    
+    EXIT:
+        return NULL;
+}
+
+/*!
+ * @brief This is a static function that checks the vector's behaviour
+ *          on a single thread.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_rcu_single (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    rcu_vector_reader_t * readers[RCU_VECTOR_MAX_READERS];
+    rcu_vector_t * p_rcu = rcu_vector_create();
+    b_pass &= C_ASSERT(NULL != p_rcu);
+    if (NULL == p_rcu)
+    {
+        goto EXIT;
+    }
+    
+    rcu_vector_reader_t * p_reader = rcu_vector_register(p_rcu);
+    b_pass &= C_ASSERT(NULL != p_reader);
+    b_pass &= C_ASSERT(NULL == rcu_vector_read_lock(NULL, p_reader));
+    b_pass &= C_ASSERT(NULL == rcu_vector_read_lock(p_rcu, NULL));
+    const vector_t * p_old = rcu_vector_read_lock(p_rcu, p_reader);
+    b_pass &= C_ASSERT((NULL != p_old) &&
+                       (0 == p_old->size));
+    
+    // A reader keeps its snapshot while updates publish new versions.
+    b_pass &= C_ASSERT(0 == rcu_vector_update(p_rcu, test_rcu_append, NULL));
+    b_pass &= C_ASSERT(0 == rcu_vector_update(p_rcu, test_rcu_append, NULL));
+    b_pass &= C_ASSERT(-1 == rcu_vector_update(p_rcu, test_rcu_discard,
+                                               NULL));
+    b_pass &= C_ASSERT(-1 == rcu_vector_update(p_rcu, NULL, NULL));
+    b_pass &= C_ASSERT(0 == p_old->size);
+    rcu_vector_read_unlock(p_reader);
+    
+    const vector_t * p_new = rcu_vector_read_lock(p_rcu, p_reader);
+    b_pass &= C_ASSERT((NULL != p_new) &&
+                       (2 == p_new->size) &&
+                       test_rcu_consistent(p_new));
+    rcu_vector_read_unlock(p_reader);
+    b_pass &= C_ASSERT(0 == rcu_vector_synchronize(p_rcu));
+    
+    // A published version replaces the current one outright.
+    vector_t * p_vector = vector_create();
+    b_pass &= C_ASSERT(NULL != p_vector);
+    b_pass &= C_ASSERT(-1 == rcu_vector_publish(p_rcu, NULL));
+    b_pass &= C_ASSERT(0 == rcu_vector_publish(p_rcu, p_vector));
+    b_pass &= C_ASSERT(p_vector == rcu_vector_read_lock(p_rcu, p_reader));
+    rcu_vector_read_unlock(p_reader);
+    rcu_vector_unregister(p_reader);
+    
+    // Every reader slot can be claimed once, and reused after release.
+    for (size_t idx = 0; idx < RCU_VECTOR_MAX_READERS; ++idx)
+    {
+        readers[idx] = rcu_vector_register(p_rcu);
+        b_pass &= C_ASSERT(NULL != readers[idx]);
+    }
+    b_pass &= C_ASSERT(NULL == rcu_vector_register(p_rcu));
+    rcu_vector_unregister(readers[0]);
+    readers[0] = rcu_vector_register(p_rcu);
+    b_pass &= C_ASSERT(NULL != readers[0]);
+    for (size_t idx = 0; idx < RCU_VECTOR_MAX_READERS; ++idx)
+    {
+        rcu_vector_unregister(readers[idx]);
+    }
+    
+    b_pass &= C_ASSERT(-1 == rcu_vector_synchronize(NULL));
+    rcu_vector_destroy(p_rcu);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks that readers always see
+ *          a whole, live version while several writers update and
+ *          reclaim old versions.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_rcu_stress (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    pthread_t writers[TEST_RCU_WRITERS];
+    pthread_t readers[TEST_RCU_READERS];
+    test_rcu_shared_t shared;
+    shared.p_rcu = rcu_vector_create();
+    b_pass &= C_ASSERT(NULL != shared.p_rcu);
+    if (NULL == shared.p_rcu)
+    {
+        goto EXIT;
+    }
+    atomic_init(&(shared.b_done), false);
+    atomic_init(&(shared.failures), 0);
+    
+    for (size_t idx = 0; idx < TEST_RCU_READERS; ++idx)
+    {
+        pthread_create(&(readers[idx]), NULL, test_rcu_reader, &shared);
+    }
+    for (size_t idx = 0; idx < TEST_RCU_WRITERS; ++idx)
+    {
+        pthread_create(&(writers[idx]), NULL, test_rcu_writer, &shared);
+    }
+    for (size_t idx = 0; idx < TEST_RCU_WRITERS; ++idx)
+    {
+        pthread_join(writers[idx], NULL);
+    }
+    atomic_store(&(shared.b_done), true);
+    for (size_t idx = 0; idx < TEST_RCU_READERS; ++idx)
+    {
+        pthread_join(readers[idx], NULL);
+    }
+    
+    b_pass &= C_ASSERT(0 == atomic_load(&(shared.failures)));
+    b_pass &= C_ASSERT(0 == rcu_vector_synchronize(shared.p_rcu));
+    b_pass &= C_ASSERT(NULL == shared.p_rcu->p_retired);
+    
+    // Every update was applied to the version before it.
+    rcu_vector_reader_t * p_reader = rcu_vector_register(shared.p_rcu);
+    const vector_t * p_vector = rcu_vector_read_lock(shared.p_rcu, p_reader);
+    b_pass &= C_ASSERT((NULL != p_vector) &&
+                       ((TEST_RCU_WRITERS * TEST_RCU_UPDATES) ==
+                        p_vector->size) &&
+                       test_rcu_consistent(p_vector));
+    rcu_vector_read_unlock(p_reader);
+    rcu_vector_unregister(p_reader);
+    
+    rcu_vector_destroy(shared.p_rcu);
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= test_rcu_single();
+    b_pass &= test_rcu_stress();
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
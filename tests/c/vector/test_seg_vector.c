@@ -0,0 +1,333 @@
+/*!
+ * @file tests/c/vector/test_seg_vector.c
+ *
+ * @brief This file tests the segmented vector.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/vector/seg_vector.h"
+
+/*** Number of elements in the growth test, spanning several blocks. ***/
+#define TEST_SEG_VECTOR_COUNT 5000
+
+/*** Number of blocks the failing allocator lets a vector allocate. ***/
+#define TEST_SEG_VECTOR_BUDGET 3
+
+/*!
+ * @brief This datatype defines an element wider than a machine word, so
+ *          that offsets within a block are scaled by the element size.
+ *
+ * @param value The value stored.
+ * @param check The value inverted, to catch overlapping elements.
+ */
+typedef struct _test_seg_vector_elem
+{
+    uint64_t value;
+    uint64_t check;
+    uint64_t pad;
+} test_seg_vector_elem_t;
+
+/*!
+ * @brief This is a static function that allocates while a budget of
+ *          allocations lasts.
+ *
+ * @param[in/out] p_ctx A void pointer to the number of allocations left.
+ * @param[in] size The size in bytes of the block.
+ *
+ * @return Pointer to the block. NULL once the budget is spent.
+ */
+static void *
+test_seg_vector_alloc (void * p_ctx, size_t size)
+{
+    size_t * p_budget = p_ctx;
+    void * p_block = NULL;
+    if (0 != *p_budget)
+    {
+        --*p_budget;
+        p_block = malloc(size);
+    }
+    return p_block;
+}
+
+/*!
+ * @brief This is a static function that frees a block of the failing
+ *          allocator.
+ *
+ * @param[in/out] p_ctx Unused.
+ * @param[in/out] p_ptr The block.
+ * @param[in] size Unused.
+ *
+ * @return No return value expected.
+ */
+static void
+test_seg_vector_free (void * p_ctx, void * p_ptr, size_t size)
+{
+    (void) p_ctx;
+    (void) size;
+    free(p_ptr);
+}
+
+/*!
+ * @brief This is a static function that pushes elements holding their
+ *          own indices until the vector has a given size.
+ *
+ * @param[in/out] p_vector The segmented vector context.
+ * @param[in] size The size wanted.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_seg_vector_fill (seg_vector_t * p_vector, const size_t size)
+{
+    C_BOOL b_filled = C_TRUE;
+    for (uint64_t idx = p_vector->size; b_filled && (idx < size); ++idx)
+    {
+        test_seg_vector_elem_t elem = { idx, ~idx, 0 };
+        b_filled = (0 == seg_vector_push_back(p_vector, &elem));
+    }
+    return b_filled;
+}
+
+/*!
+ * @brief This is a static function that checks every element holds its
+ *          own index.
+ *
+ * @param[in] p_vector The segmented vector context.
+ *
+ * @return C_TRUE if every element does, C_FALSE otherwise.
+ */
+static C_BOOL
+test_seg_vector_intact (seg_vector_t * p_vector)
+{
+    C_BOOL b_intact = C_TRUE;
+    for (uint64_t idx = 0; b_intact && (idx < p_vector->size); ++idx)
+    {
+        test_seg_vector_elem_t * p_elem = seg_vector_at(p_vector, idx);
+        b_intact = (NULL != p_elem) &&
+                   (idx == p_elem->value) &&
+                   (~idx == p_elem->check);
+    }
+    return b_intact;
+}
+
+/*!
+ * @brief This is a static function that checks the block and offset of
+ *          the indices on either side of the first block boundaries.
+ *
+ *          Block 0 holds indices 0 to 15, block 1 holds 16 to 47 and
+ *              block 2 holds 48 to 111.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_seg_vector_edges (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    const size_t elem_size = sizeof(test_seg_vector_elem_t);
+    seg_vector_t * p_vector = seg_vector_create(elem_size);
+    b_pass &= C_ASSERT(NULL != p_vector);
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    b_pass &= C_ASSERT((0 == p_vector->num_blocks) &&
+                       (0 == p_vector->cap));
+    b_pass &= C_ASSERT(NULL == seg_vector_at(p_vector, 0));
+    
+    b_pass &= C_ASSERT(test_seg_vector_fill(p_vector, 49));
+    b_pass &= C_ASSERT((3 == p_vector->num_blocks) &&
+                       (112 == p_vector->cap));
+    unsigned char ** pp_blocks = p_vector->pp_blocks;
+    b_pass &= C_ASSERT(pp_blocks[0] == seg_vector_at(p_vector, 0));
+    b_pass &= C_ASSERT((pp_blocks[0] + (15 * elem_size)) ==
+                       seg_vector_at(p_vector, 15));
+    b_pass &= C_ASSERT(pp_blocks[1] == seg_vector_at(p_vector, 16));
+    b_pass &= C_ASSERT((pp_blocks[1] + (31 * elem_size)) ==
+                       seg_vector_at(p_vector, 47));
+    b_pass &= C_ASSERT(pp_blocks[2] == seg_vector_at(p_vector, 48));
+    b_pass &= C_ASSERT(NULL == seg_vector_at(p_vector, 49));
+    b_pass &= C_ASSERT(test_seg_vector_intact(p_vector));
+    
+    // Every index maps into its block, in order, walking block by block.
+    size_t idx = 0;
+    for (size_t block = 0; block < p_vector->num_blocks; ++block)
+    {
+        size_t block_cap = SEG_VECTOR_FIRST_CAP << block;
+        for (size_t offset = 0;
+             (offset < block_cap) && (idx < p_vector->size);
+             ++offset, ++idx)
+        {
+            b_pass &= C_ASSERT((pp_blocks[block] + (offset * elem_size)) ==
+                               seg_vector_at(p_vector, idx));
+        }
+    }
+    seg_vector_destroy(p_vector);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks elements keep their
+ *          addresses while the vector grows and shrinks around them.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_seg_vector_stable (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    void ** pp_addrs = calloc(TEST_SEG_VECTOR_COUNT, sizeof(void *));
+    seg_vector_t * p_vector = seg_vector_create(
+                                  sizeof(test_seg_vector_elem_t));
+    b_pass &= C_ASSERT((NULL != p_vector) &&
+                       (NULL != pp_addrs));
+    if ((NULL == p_vector) ||
+        (NULL == pp_addrs))
+    {
+        goto EXIT;
+    }
+    
+    for (size_t idx = 0; idx < TEST_SEG_VECTOR_COUNT; ++idx)
+    {
+        b_pass &= C_ASSERT(test_seg_vector_fill(p_vector, idx + 1));
+        pp_addrs[idx] = seg_vector_at(p_vector, idx);
+    }
+    for (size_t idx = 0; idx < TEST_SEG_VECTOR_COUNT; ++idx)
+    {
+        b_pass &= C_ASSERT(pp_addrs[idx] == seg_vector_at(p_vector, idx));
+    }
+    b_pass &= C_ASSERT(test_seg_vector_intact(p_vector));
+    
+    // Popping and pushing again reuses the same slots.
+    test_seg_vector_elem_t elem = { 0 };
+    for (size_t idx = 0; idx < (TEST_SEG_VECTOR_COUNT / 2); ++idx)
+    {
+        b_pass &= C_ASSERT(0 == seg_vector_pop_back(p_vector, &elem));
+    }
+    b_pass &= C_ASSERT(((TEST_SEG_VECTOR_COUNT / 2) == elem.value));
+    b_pass &= C_ASSERT(test_seg_vector_fill(p_vector,
+                                            TEST_SEG_VECTOR_COUNT));
+    for (size_t idx = 0; idx < TEST_SEG_VECTOR_COUNT; ++idx)
+    {
+        b_pass &= C_ASSERT(pp_addrs[idx] == seg_vector_at(p_vector, idx));
+    }
+    b_pass &= C_ASSERT(test_seg_vector_intact(p_vector));
+    
+    EXIT:
+        seg_vector_destroy(p_vector);
+        free(pp_addrs);
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks seg_vector_shrink_to_fit
+ *          keeps exactly the blocks holding elements.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_seg_vector_shrink (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    seg_vector_t * p_vector = seg_vector_create(
+                                  sizeof(test_seg_vector_elem_t));
+    b_pass &= C_ASSERT(NULL != p_vector);
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    b_pass &= C_ASSERT(0 == seg_vector_reserve(p_vector, 200));
+    b_pass &= C_ASSERT((4 == p_vector->num_blocks) &&
+                       (240 == p_vector->cap));
+    b_pass &= C_ASSERT(test_seg_vector_fill(p_vector, 49));
+    void * p_last = seg_vector_at(p_vector, 48);
+    
+    // 49 elements need three blocks, and 48 need two.
+    b_pass &= C_ASSERT(0 == seg_vector_shrink_to_fit(p_vector));
+    b_pass &= C_ASSERT((3 == p_vector->num_blocks) &&
+                       (112 == p_vector->cap) &&
+                       (NULL == p_vector->pp_blocks[3]));
+    b_pass &= C_ASSERT(p_last == seg_vector_at(p_vector, 48));
+    b_pass &= C_ASSERT(0 == seg_vector_pop_back(p_vector, NULL));
+    b_pass &= C_ASSERT(0 == seg_vector_shrink_to_fit(p_vector));
+    b_pass &= C_ASSERT((2 == p_vector->num_blocks) &&
+                       (48 == p_vector->cap));
+    b_pass &= C_ASSERT(test_seg_vector_intact(p_vector));
+    
+    // Growing after a shrink allocates the freed block again.
+    b_pass &= C_ASSERT(test_seg_vector_fill(p_vector, 49));
+    b_pass &= C_ASSERT((3 == p_vector->num_blocks) &&
+                       test_seg_vector_intact(p_vector));
+    
+    while (0 == seg_vector_pop_back(p_vector, NULL))
+    {
+        // Empty the vector.
+    }
+    b_pass &= C_ASSERT(0 == seg_vector_shrink_to_fit(p_vector));
+    b_pass &= C_ASSERT((0 == p_vector->num_blocks) &&
+                       (0 == p_vector->cap));
+    b_pass &= C_ASSERT(test_seg_vector_fill(p_vector, 17));
+    b_pass &= C_ASSERT(test_seg_vector_intact(p_vector));
+    b_pass &= C_ASSERT(-1 == seg_vector_shrink_to_fit(NULL));
+    seg_vector_destroy(p_vector);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks a reservation that runs
+ *          out of memory leaves the vector as it was.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_seg_vector_fail (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    size_t budget = TEST_SEG_VECTOR_BUDGET;
+    allocator_t alloc = { test_seg_vector_alloc, NULL, test_seg_vector_free,
+                          &budget };
+    seg_vector_t * p_vector = seg_vector_create_with_allocator(
+                                  sizeof(test_seg_vector_elem_t), &alloc);
+    b_pass &= C_ASSERT(NULL != p_vector);
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    // The context and block 0 take two allocations, and the reservation
+    // gets block 1 before block 2 fails.
+    b_pass &= C_ASSERT(test_seg_vector_fill(p_vector, 10));
+    b_pass &= C_ASSERT(-1 == seg_vector_reserve(p_vector, 100));
+    b_pass &= C_ASSERT((1 == p_vector->num_blocks) &&
+                       (16 == p_vector->cap) &&
+                       (NULL == p_vector->pp_blocks[1]));
+    budget = 1;
+    b_pass &= C_ASSERT(test_seg_vector_fill(p_vector, 48));
+    b_pass &= C_ASSERT(!test_seg_vector_fill(p_vector, 49));
+    b_pass &= C_ASSERT((48 == p_vector->size) &&
+                       test_seg_vector_intact(p_vector));
+    b_pass &= C_ASSERT(-1 == seg_vector_reserve(p_vector, SIZE_MAX));
+    seg_vector_destroy(p_vector);
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= C_ASSERT(NULL == seg_vector_create(0));
+    b_pass &= test_seg_vector_edges();
+    b_pass &= test_seg_vector_stable();
+    b_pass &= test_seg_vector_shrink();
+    b_pass &= test_seg_vector_fail();
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
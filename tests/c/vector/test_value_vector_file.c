@@ -0,0 +1,426 @@
+/*!
+ * @file tests/c/vector/test_value_vector_file.c
+ *
+ * @brief This file tests value vector snapshots and mapped vectors, which
+ *          share one on-disk format.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/vector/value_vector.h"
+#include "src/c/vector/value_vector_file.h"
+#include "src/c/vector/mapped_vector.h"
+
+/*** Number of elements in the test snapshot. ***/
+#define TEST_FILE_COUNT 1000
+
+/*** Size of the buffers holding test paths. ***/
+#define TEST_FILE_PATH_MAX 512
+
+/*** Size of the buffer holding the test directory, leaving room for names. ***/
+#define TEST_FILE_DIR_MAX (TEST_FILE_PATH_MAX / 2)
+
+/*** Directory the test files are created under, absent TEST_TMPDIR. ***/
+#define TEST_FILE_TMPDIR "/tmp"
+
+/*!
+ * @brief This is a static function that reads the header of a file.
+ *
+ * @param[in] p_path The path of the file.
+ * @param[out] p_header Receives the header.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_file_header (const char * p_path, value_vector_file_header_t * p_header)
+{
+    C_BOOL b_read = C_FALSE;
+    int fd = open(p_path, O_RDONLY);
+    if (-1 != fd)
+    {
+        b_read = (sizeof(*p_header) == pread(fd, p_header, sizeof(*p_header),
+                                             0));
+        close(fd);
+    }
+    return b_read;
+}
+
+/*!
+ * @brief This is a static function that overwrites one byte of a file.
+ *
+ * @param[in] p_path The path of the file.
+ * @param[in] offset The offset of the byte.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_file_flip (const char * p_path, const off_t offset)
+{
+    C_BOOL b_written = C_FALSE;
+    unsigned char byte = 0;
+    int fd = open(p_path, O_RDWR);
+    if ((-1 != fd) &&
+        (1 == pread(fd, &byte, 1, offset)))
+    {
+        byte ^= 0xFF;
+        b_written = (1 == pwrite(fd, &byte, 1, offset));
+    }
+    if (-1 != fd)
+    {
+        close(fd);
+    }
+    return b_written;
+}
+
+/*!
+ * @brief This is a static function that copies a file.
+ *
+ * @param[in] p_src The path of the file to copy.
+ * @param[in] p_dst The path of the copy.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_file_copy (const char * p_src, const char * p_dst)
+{
+    C_BOOL b_copied = C_FALSE;
+    unsigned char buf[4096];
+    FILE * p_in = fopen(p_src, "rb");
+    FILE * p_out = fopen(p_dst, "wb");
+    if ((NULL != p_in) &&
+        (NULL != p_out))
+    {
+        size_t len = 0;
+        b_copied = C_TRUE;
+        while (0 != (len = fread(buf, 1, sizeof(buf), p_in)))
+        {
+            b_copied &= (len == fwrite(buf, 1, len, p_out));
+        }
+    }
+    if (NULL != p_in)
+    {
+        fclose(p_in);
+    }
+    if ((NULL != p_out) &&
+        (0 != fclose(p_out)))
+    {
+        b_copied = C_FALSE;
+    }
+    return b_copied;
+}
+
+/*!
+ * @brief This is a static function that counts the entries of a
+ *          directory, other than "." and "..".
+ *
+ * @param[in] p_dir The path of the directory.
+ *
+ * @return The number of entries.
+ */
+static size_t
+test_file_entries (const char * p_dir)
+{
+    size_t count = 0;
+    DIR * p_handle = opendir(p_dir);
+    struct dirent * p_entry = NULL;
+    while ((NULL != p_handle) &&
+           (NULL != (p_entry = readdir(p_handle))))
+    {
+        if ((0 != strcmp(".", p_entry->d_name)) &&
+            (0 != strcmp("..", p_entry->d_name)))
+        {
+            ++count;
+        }
+    }
+    if (NULL != p_handle)
+    {
+        closedir(p_handle);
+    }
+    return count;
+}
+
+/*!
+ * @brief This is a static function that checks a vector of uint64_t holds
+ *          0, 1, 2 and so on.
+ *
+ * @param[in] p_data The elements.
+ * @param[in] count The number of elements.
+ *
+ * @return C_TRUE if it does, C_FALSE otherwise.
+ */
+static C_BOOL
+test_file_sequence (const void * p_data, const size_t count)
+{
+    C_BOOL b_match = C_TRUE;
+    for (uint64_t idx = 0; b_match && (idx < count); ++idx)
+    {
+        uint64_t value = 0;
+        memcpy(&value, (const unsigned char *) p_data +
+                       (idx * sizeof(uint64_t)), sizeof(value));
+        b_match = (idx == value);
+    }
+    return b_match;
+}
+
+/*!
+ * @brief This is a static function that checks a snapshot survives a
+ *          save and load unchanged, and that saving keeps permissions
+ *          and leaves no temporary file behind.
+ *
+ * @param[in] p_dir The directory to work in.
+ * @param[in] p_path The path of the snapshot to write.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_file_round_trip (const char * p_dir, const char * p_path)
+{
+    C_BOOL b_pass = C_TRUE;
+    struct stat st;
+    value_vector_t * p_vector = value_vector_create(sizeof(uint64_t));
+    b_pass &= C_ASSERT(NULL != p_vector);
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    
+    // An empty vector round-trips too.
+    b_pass &= C_ASSERT(0 == value_vector_save(p_vector, p_path));
+    value_vector_t * p_loaded = value_vector_load(p_path);
+    b_pass &= C_ASSERT((NULL != p_loaded) &&
+                       (sizeof(uint64_t) == p_loaded->elem_size) &&
+                       (0 == p_loaded->size));
+    value_vector_destroy(p_loaded);
+    b_pass &= C_ASSERT((0 == stat(p_path, &st)) &&
+                       (0644 == (st.st_mode & 07777)));
+    
+    for (uint64_t value = 0; value < TEST_FILE_COUNT; ++value)
+    {
+        b_pass &= C_ASSERT(0 == value_vector_push_back(p_vector, &value));
+    }
+    
+    // Replacing a snapshot keeps the permissions of the old file.
+    b_pass &= C_ASSERT(0 == chmod(p_path, 0600));
+    b_pass &= C_ASSERT(0 == value_vector_save(p_vector, p_path));
+    b_pass &= C_ASSERT((0 == stat(p_path, &st)) &&
+                       (0600 == (st.st_mode & 07777)));
+    b_pass &= C_ASSERT(1 == test_file_entries(p_dir));
+    
+    p_loaded = value_vector_load(p_path);
+    b_pass &= C_ASSERT((NULL != p_loaded) &&
+                       (sizeof(uint64_t) == p_loaded->elem_size) &&
+                       (TEST_FILE_COUNT == p_loaded->size) &&
+                       test_file_sequence(p_loaded->p_data,
+                                          p_loaded->size));
+    value_vector_destroy(p_loaded);
+    
+    value_vector_file_header_t header;
+    b_pass &= C_ASSERT(test_file_header(p_path, &header));
+    b_pass &= C_ASSERT(0 != (header.flags & VALUE_VECTOR_FILE_CHECKSUMMED));
+    b_pass &= C_ASSERT(TEST_FILE_COUNT == header.size);
+    
+    b_pass &= C_ASSERT(-1 == value_vector_save(NULL, p_path));
+    b_pass &= C_ASSERT(NULL == value_vector_load(NULL));
+    value_vector_destroy(p_vector);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks corrupted and truncated
+ *          copies of a snapshot are rejected.
+ *
+ * @param[in] p_path The path of a valid snapshot.
+ * @param[in] p_copy A path to write damaged copies to.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_file_damage (const char * p_path, const char * p_copy)
+{
+    C_BOOL b_pass = C_TRUE;
+    off_t full = VALUE_VECTOR_FILE_HEADER_SIZE +
+                 (TEST_FILE_COUNT * sizeof(uint64_t));
+    
+    // A changed element fails the checksum.
+    b_pass &= C_ASSERT(test_file_copy(p_path, p_copy));
+    b_pass &= C_ASSERT(test_file_flip(p_copy, full - 3));
+    b_pass &= C_ASSERT(NULL == value_vector_load(p_copy));
+    
+    // A changed header is malformed.
+    b_pass &= C_ASSERT(test_file_copy(p_path, p_copy));
+    b_pass &= C_ASSERT(test_file_flip(p_copy, 0));
+    b_pass &= C_ASSERT(NULL == value_vector_load(p_copy));
+    b_pass &= C_ASSERT(NULL == mapped_vector_open(p_copy, 0, false));
+    
+    // A file cut short of its counted elements, or of its header, is
+    // refused by both readers.
+    b_pass &= C_ASSERT(test_file_copy(p_path, p_copy));
+    b_pass &= C_ASSERT(0 == truncate(p_copy, full - 1));
+    b_pass &= C_ASSERT(NULL == value_vector_load(p_copy));
+    b_pass &= C_ASSERT(NULL == mapped_vector_open(p_copy, 0, false));
+    b_pass &= C_ASSERT(0 == truncate(p_copy,
+                                     VALUE_VECTOR_FILE_HEADER_SIZE - 1));
+    b_pass &= C_ASSERT(NULL == value_vector_load(p_copy));
+    b_pass &= C_ASSERT(NULL == mapped_vector_open(p_copy, 0, false));
+    
+    b_pass &= C_ASSERT(0 == unlink(p_copy));
+    return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks a snapshot may be opened
+ *          as a mapped vector, read-only and then writable.
+ *
+ *          Opening it writable clears the checksum flag, since the
+ *              elements may then change without the checksum following.
+ *
+ * @param[in] p_path The path of a valid snapshot.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_file_mapped_snapshot (const char * p_path)
+{
+    C_BOOL b_pass = C_TRUE;
+    value_vector_file_header_t header;
+    uint64_t value = TEST_FILE_COUNT;
+    
+    b_pass &= C_ASSERT(NULL == mapped_vector_open(p_path, 4, false));
+    mapped_vector_t * p_mapped = mapped_vector_open(p_path, 0, false);
+    b_pass &= C_ASSERT(NULL != p_mapped);
+    if (NULL == p_mapped)
+    {
+        goto EXIT;
+    }
+    b_pass &= C_ASSERT(sizeof(uint64_t) == p_mapped->elem_size);
+    b_pass &= C_ASSERT(TEST_FILE_COUNT == p_mapped->size);
+    b_pass &= C_ASSERT(test_file_sequence(p_mapped->p_data,
+                                          p_mapped->size));
+    b_pass &= C_ASSERT(NULL == mapped_vector_at(p_mapped, TEST_FILE_COUNT));
+    b_pass &= C_ASSERT(-1 == mapped_vector_push_back(p_mapped, &value));
+    b_pass &= C_ASSERT(-1 == mapped_vector_pop_back(p_mapped, NULL));
+    b_pass &= C_ASSERT(-1 == mapped_vector_reserve(p_mapped, 1));
+    b_pass &= C_ASSERT(-1 == mapped_vector_sync(p_mapped));
+    b_pass &= C_ASSERT(0 == mapped_vector_close(p_mapped));
+    b_pass &= C_ASSERT(test_file_header(p_path, &header) &&
+                       (0 != (header.flags &
+                              VALUE_VECTOR_FILE_CHECKSUMMED)));
+    
+    p_mapped = mapped_vector_open(p_path, sizeof(uint64_t), true);
+    b_pass &= C_ASSERT(NULL != p_mapped);
+    if (NULL == p_mapped)
+    {
+        goto EXIT;
+    }
+    b_pass &= C_ASSERT(test_file_header(p_path, &header) &&
+                       (0 == (header.flags &
+                              VALUE_VECTOR_FILE_CHECKSUMMED)));
+    for (; value < (TEST_FILE_COUNT + 10); ++value)
+    {
+        b_pass &= C_ASSERT(0 == mapped_vector_push_back(p_mapped, &value));
+    }
+    b_pass &= C_ASSERT(0 == mapped_vector_close(p_mapped));
+    
+    // The extended file loads without a checksum to verify.
+    value_vector_t * p_loaded = value_vector_load(p_path);
+    b_pass &= C_ASSERT((NULL != p_loaded) &&
+                       ((TEST_FILE_COUNT + 10) == p_loaded->size) &&
+                       test_file_sequence(p_loaded->p_data,
+                                          p_loaded->size));
+    value_vector_destroy(p_loaded);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks a mapped vector created
+ *          from scratch keeps exactly its checkpointed elements.
+ *
+ * @param[in] p_path The path of the file to create.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_file_mapped_create (const char * p_path)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= C_ASSERT(NULL == mapped_vector_open(p_path, 0, true));
+    b_pass &= C_ASSERT(NULL == mapped_vector_open(p_path, 8, false));
+    mapped_vector_t * p_mapped = mapped_vector_open(p_path, sizeof(uint64_t),
+                                                    true);
+    b_pass &= C_ASSERT(NULL != p_mapped);
+    if (NULL == p_mapped)
+    {
+        goto EXIT;
+    }
+    
+    for (uint64_t value = 0; value < TEST_FILE_COUNT; ++value)
+    {
+        b_pass &= C_ASSERT(0 == mapped_vector_push_back(p_mapped, &value));
+    }
+    uint64_t last = 0;
+    b_pass &= C_ASSERT(0 == mapped_vector_pop_back(p_mapped, &last));
+    b_pass &= C_ASSERT((TEST_FILE_COUNT - 1) == last);
+    b_pass &= C_ASSERT(0 == mapped_vector_sync(p_mapped));
+    b_pass &= C_ASSERT(0 == mapped_vector_close(p_mapped));
+    
+    p_mapped = mapped_vector_open(p_path, 0, false);
+    b_pass &= C_ASSERT((NULL != p_mapped) &&
+                       ((TEST_FILE_COUNT - 1) == p_mapped->size) &&
+                       test_file_sequence(p_mapped->p_data,
+                                          p_mapped->size));
+    mapped_vector_close(p_mapped);
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    char dir[TEST_FILE_DIR_MAX];
+    char snapshot[TEST_FILE_PATH_MAX];
+    char copy[TEST_FILE_PATH_MAX];
+    char mapped[TEST_FILE_PATH_MAX];
+    const char * p_tmpdir = getenv("TEST_TMPDIR");
+    if (NULL == p_tmpdir)
+    {
+        p_tmpdir = TEST_FILE_TMPDIR;
+    }
+    snprintf(dir, sizeof(dir), "%s/value_vector_file.XXXXXX", p_tmpdir);
+    b_pass &= C_ASSERT(NULL != mkdtemp(dir));
+    if (C_TRUE != b_pass)
+    {
+        goto EXIT;
+    }
+    snprintf(snapshot, sizeof(snapshot), "%s/snapshot", dir);
+    snprintf(copy, sizeof(copy), "%s/copy", dir);
+    snprintf(mapped, sizeof(mapped), "%s/mapped", dir);
+    
+    // New files get 0644 less the umask, so fix the umask.
+    umask(022);
+    b_pass &= test_file_round_trip(dir, snapshot);
+    b_pass &= test_file_damage(snapshot, copy);
+    b_pass &= test_file_mapped_snapshot(snapshot);
+    b_pass &= test_file_mapped_create(mapped);
+    
+    unlink(snapshot);
+    unlink(mapped);
+    b_pass &= C_ASSERT(0 == rmdir(dir));
+    
+    EXIT:
+        return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
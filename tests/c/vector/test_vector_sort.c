@@ -0,0 +1,499 @@
+/*!
+ * @file tests/c/vector/test_vector_sort.c
+ *
+ * @brief This file tests the vector introsort, the parallel merge sort
+ *          and the value vector radix sort against qsort.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "src/c/ctest/ctest.h"
+#include "src/c/vector/vector.h"
+#include "src/c/vector/value_vector.h"
+#include "src/c/vector/vector_parallel_sort.h"
+#include "src/c/threadpool/threadpool.h"
+
+/*** Number of elements in each radix sort test. ***/
+#define TEST_SORT_RADIX_COUNT 3000
+
+/*!
+ * @brief This enumeration defines the orders the input is generated in.
+ *
+ * @param TEST_SORT_RANDOM Pseudo-random values with many duplicates.
+ * @param TEST_SORT_SORTED Values already in ascending order.
+ * @param TEST_SORT_REVERSE Values in descending order.
+ * @param TEST_SORT_EQUAL Every value the same.
+ * @param TEST_SORT_PATTERNS The number of orders.
+ */
+typedef enum _test_sort_pattern
+{
+    TEST_SORT_RANDOM = 0,
+    TEST_SORT_SORTED,
+    TEST_SORT_REVERSE,
+    TEST_SORT_EQUAL,
+    TEST_SORT_PATTERNS,
+} test_sort_pattern_t;
+
+/*!
+ * @brief This datatype defines an element of the radix sort tests.
+ *
+ * @param order The element's position in the input, to check stability.
+ * @param key The key, of which the first bytes are used.
+ */
+typedef struct _test_sort_elem
+{
+    uint32_t      order;
+    unsigned char key[8];
+} test_sort_elem_t;
+
+/*** Key size the radix sort reference comparison uses. ***/
+static size_t g_key_size = 1;
+
+/*** Key signedness the radix sort reference comparison uses. ***/
+static bool gb_key_signed = false;
+
+/*!
+ * @brief This is a static function that advances a xorshift generator.
+ *
+ * @param[in/out] p_state The generator state. Must not be zero.
+ *
+ * @return The next pseudo-random value.
+ */
+static uint64_t
+test_sort_random (uint64_t * p_state)
+{
+    *p_state ^= *p_state << 13;
+    *p_state ^= *p_state >> 7;
+    *p_state ^= *p_state << 17;
+    return *p_state;
+}
+
+/*!
+ * @brief This is a static function that compares two references holding
+ *          integers, as vector_cmp_f.
+ *
+ * @param[in] p_lhs The first reference.
+ * @param[in] p_rhs The second reference.
+ *
+ * @return Negative, zero or positive as p_lhs is less, equal or greater.
+ */
+static int
+test_sort_cmp (const void * p_lhs, const void * p_rhs)
+{
+    uintptr_t lhs = (uintptr_t) p_lhs;
+    uintptr_t rhs = (uintptr_t) p_rhs;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/*!
+ * @brief This is a static function that compares two array slots holding
+ *          integers, as qsort expects.
+ *
+ * @param[in] p_lhs Pointer to the first integer.
+ * @param[in] p_rhs Pointer to the second integer.
+ *
+ * @return Negative, zero or positive as p_lhs is less, equal or greater.
+ */
+static int
+test_sort_qsort_cmp (const void * p_lhs, const void * p_rhs)
+{
+    return test_sort_cmp((const void *) *(const uintptr_t *) p_lhs,
+                         (const void *) *(const uintptr_t *) p_rhs);
+}
+
+/*!
+ * @brief This is a static function that reads an element's key as a
+ *          signed or unsigned integer of the configured size.
+ *
+ * @param[in] p_elem The element.
+ * @param[out] p_signed Receives the key if it is signed.
+ * @param[out] p_unsigned Receives the key if it is unsigned.
+ *
+ * @return No return value expected.
+ */
+static void
+test_sort_key (const test_sort_elem_t * p_elem,
+               int64_t * p_signed,
+               uint64_t * p_unsigned)
+{
+    int8_t s8 = 0;
+    int16_t s16 = 0;
+    int32_t s32 = 0;
+    uint8_t u8 = 0;
+    uint16_t u16 = 0;
+    uint32_t u32 = 0;
+    switch (g_key_size)
+    {
+        case 1:
+            memcpy(&s8, p_elem->key, 1);
+            memcpy(&u8, p_elem->key, 1);
+            *p_signed = s8;
+            *p_unsigned = u8;
+            break;
+        case 2:
+            memcpy(&s16, p_elem->key, 2);
+            memcpy(&u16, p_elem->key, 2);
+            *p_signed = s16;
+            *p_unsigned = u16;
+            break;
+        case 4:
+            memcpy(&s32, p_elem->key, 4);
+            memcpy(&u32, p_elem->key, 4);
+            *p_signed = s32;
+            *p_unsigned = u32;
+            break;
+        default:
+            memcpy(p_signed, p_elem->key, 8);
+            memcpy(p_unsigned, p_elem->key, 8);
+            break;
+    }
+}
+
+/*!
+ * @brief This is a static function that orders radix sort elements by
+ *          key and then by input position, as a stable sort would.
+ *
+ * @param[in] p_lhs The first element.
+ * @param[in] p_rhs The second element.
+ *
+ * @return Negative, zero or positive as p_lhs goes before, with or after.
+ */
+static int
+test_sort_elem_cmp (const void * p_lhs, const void * p_rhs)
+{
+    const test_sort_elem_t * p_left = p_lhs;
+    const test_sort_elem_t * p_right = p_rhs;
+    int64_t lhs_signed = 0;
+    int64_t rhs_signed = 0;
+    uint64_t lhs_unsigned = 0;
+    uint64_t rhs_unsigned = 0;
+    test_sort_key(p_left, &lhs_signed, &lhs_unsigned);
+    test_sort_key(p_right, &rhs_signed, &rhs_unsigned);
+    
+    int result = 0;
+    if (gb_key_signed)
+    {
+        result = (lhs_signed > rhs_signed) - (lhs_signed < rhs_signed);
+    }
+    else
+    {
+        result = (lhs_unsigned > rhs_unsigned) -
+                 (lhs_unsigned < rhs_unsigned);
+    }
+    if (0 == result)
+    {
+        result = (p_left->order > p_right->order) -
+                 (p_left->order < p_right->order);
+    }
+    return result;
+}
+
+/*!
+ * @brief This is a static function that builds a vector in a given order
+ *          along with the same values sorted by qsort.
+ *
+ * @param[in] pattern The order of the input.
+ * @param[in] count The number of elements.
+ * @param[out] pp_expected Receives the sorted values. Freed by the
+ *              caller.
+ *
+ * @return Pointer to the new vector. NULL on error.
+ */
+static vector_t *
+test_sort_fill (const test_sort_pattern_t pattern,
+                const size_t count,
+                uintptr_t ** pp_expected)
+{
+    uint64_t state = 0x9e3779b97f4a7c15u + count;
+    vector_t * p_vector = vector_create();
+    uintptr_t * p_expected = malloc((count + 1) * sizeof(uintptr_t));
+    if ((NULL == p_vector) ||
+        (NULL == p_expected))
+    {
+        goto ERROR;
+    }
+    
+    // Values start at one, since a vector cannot hold a NULL reference.
+    for (size_t idx = 0; idx < count; ++idx)
+    {
+        uintptr_t value = 7;
+        if (TEST_SORT_RANDOM == pattern)
+        {
+            value = (test_sort_random(&state) % ((count / 4) + 1)) + 1;
+        }
+        else if (TEST_SORT_SORTED == pattern)
+        {
+            value = idx + 1;
+        }
+        else if (TEST_SORT_REVERSE == pattern)
+        {
+            value = count - idx;
+        }
+        p_expected[idx] = value;
+        if (0 != vector_push_back(p_vector, (void *) value))
+        {
+            goto ERROR;
+        }
+    }
+    qsort(p_expected, count, sizeof(uintptr_t), test_sort_qsort_cmp);
+    *pp_expected = p_expected;
+    return p_vector;
+    
+    ERROR:
+        vector_destroy(p_vector);
+        free(p_expected);
+        return NULL;
+}
+
+/*!
+ * @brief This is a static function that checks a vector holds the given
+ *          values in order.
+ *
+ * @param[in] p_vector The vector.
+ * @param[in] p_expected The expected values.
+ * @param[in] count The number of expected values.
+ *
+ * @return C_TRUE if they match, C_FALSE otherwise.
+ */
+static C_BOOL
+test_sort_matches (const vector_t * p_vector,
+                   const uintptr_t * p_expected,
+                   const size_t count)
+{
+    C_BOOL b_match = (count == p_vector->size);
+    for (size_t idx = 0; b_match && (idx < count); ++idx)
+    {
+        b_match = ((void *) p_expected[idx] == vector_at(p_vector, idx));
+    }
+    return b_match;
+}
+
+/*!
+ * @brief This is a static function that checks vector_sort and
+ *          vector_sort_range on a single thread.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_sort_serial (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    const size_t sizes[] = { 0, 1, 2, 3, 16, 17, 100, 1000, 5000 };
+    for (int pattern = 0; pattern < TEST_SORT_PATTERNS; ++pattern)
+    {
+        for (size_t idx = 0; idx < (sizeof(sizes) / sizeof(*sizes)); ++idx)
+        {
+            uintptr_t * p_expected = NULL;
+            vector_t * p_vector = test_sort_fill(pattern, sizes[idx],
+                                                 &p_expected);
+            b_pass &= C_ASSERT(NULL != p_vector);
+            if (NULL == p_vector)
+            {
+                continue;
+            }
+            b_pass &= C_ASSERT(0 == vector_sort(p_vector, test_sort_cmp));
+            b_pass &= C_ASSERT(test_sort_matches(p_vector, p_expected,
+                                                 sizes[idx]));
+            vector_destroy(p_vector);
+            free(p_expected);
+        }
+    }
+    
+    // A range sort leaves the elements outside the range alone.
+    uintptr_t * p_expected = NULL;
+    vector_t * p_vector = test_sort_fill(TEST_SORT_REVERSE, 100,
+                                         &p_expected);
+    b_pass &= C_ASSERT(NULL != p_vector);
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    b_pass &= C_ASSERT(-1 == vector_sort(p_vector, NULL));
+    b_pass &= C_ASSERT(-1 == vector_sort_range(p_vector, 90, 11,
+                                               test_sort_cmp));
+    b_pass &= C_ASSERT(0 == vector_sort_range(p_vector, 10, 80,
+                                              test_sort_cmp));
+    for (size_t idx = 0; idx < 100; ++idx)
+    {
+        uintptr_t value = 100 - idx;
+        if ((idx >= 10) &&
+            (idx < 90))
+        {
+            value = idx + 1;
+        }
+        b_pass &= C_ASSERT((void *) value == vector_at(p_vector, idx));
+    }
+    vector_destroy(p_vector);
+    free(p_expected);
+    
+    EXIT:
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks vector_sort_parallel on
+ *          threadpools of one, two and three threads.
+ *
+ *          The sizes straddle VECTOR_PARALLEL_SORT_MIN and include ones
+ *              that the runs do not divide evenly, so the last run of a
+ *              round is short or missing.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_sort_parallel (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    const size_t sizes[] = {
+        VECTOR_PARALLEL_SORT_MIN - 1,
+        VECTOR_PARALLEL_SORT_MIN,
+        VECTOR_PARALLEL_SORT_MIN + 1,
+        (3 * VECTOR_PARALLEL_SORT_MIN) + 5,
+        (5 * VECTOR_PARALLEL_SORT_MIN) + 3,
+    };
+    for (size_t threads = 1; threads <= 3; ++threads)
+    {
+        threadpool_t * p_tp = threadpool_create(threads);
+        b_pass &= C_ASSERT(NULL != p_tp);
+        if (NULL == p_tp)
+        {
+            continue;
+        }
+        for (int pattern = 0; pattern < TEST_SORT_PATTERNS; ++pattern)
+        {
+            for (size_t idx = 0; idx < (sizeof(sizes) / sizeof(*sizes));
+                 ++idx)
+            {
+                uintptr_t * p_expected = NULL;
+                vector_t * p_vector = test_sort_fill(pattern, sizes[idx],
+                                                     &p_expected);
+                b_pass &= C_ASSERT(NULL != p_vector);
+                if (NULL == p_vector)
+                {
+                    continue;
+                }
+                b_pass &= C_ASSERT(0 == vector_sort_parallel(p_vector,
+                                                             test_sort_cmp,
+                                                             p_tp));
+                b_pass &= C_ASSERT(test_sort_matches(p_vector, p_expected,
+                                                     sizes[idx]));
+                vector_destroy(p_vector);
+                free(p_expected);
+            }
+        }
+        b_pass &= C_ASSERT(-1 == vector_sort_parallel(NULL, test_sort_cmp,
+                                                      p_tp));
+        b_pass &= C_ASSERT(0 == threadpool_destroy(p_tp));
+    }
+    return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks value_vector_radix_sort
+ *          against a stable qsort for one key size and signedness.
+ *
+ * @param[in] key_size The size in bytes of the key.
+ * @param[in] b_signed Whether the key is signed.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_sort_radix_key (const size_t key_size, const bool b_signed)
+{
+    C_BOOL b_pass = C_TRUE;
+    uint64_t state = 0x2545f4914f6cdd1du + key_size;
+    test_sort_elem_t * p_expected = calloc(TEST_SORT_RADIX_COUNT,
+                                           sizeof(test_sort_elem_t));
+    value_vector_t * p_vector = value_vector_create(sizeof(test_sort_elem_t));
+    b_pass &= C_ASSERT(NULL != p_expected);
+    b_pass &= C_ASSERT(NULL != p_vector);
+    if ((NULL == p_expected) ||
+        (NULL == p_vector))
+    {
+        goto EXIT;
+    }
+    
+    // Every third element repeats the key before it, so ties are common
+    // whatever the key size.
+    for (uint32_t idx = 0; idx < TEST_SORT_RADIX_COUNT; ++idx)
+    {
+        test_sort_elem_t elem = { .order = idx };
+        uint64_t key = test_sort_random(&state);
+        if ((0 != idx) &&
+            (0 == (idx % 3)))
+        {
+            memcpy(elem.key, p_expected[idx - 1].key, sizeof(elem.key));
+        }
+        else
+        {
+            memcpy(elem.key, &key, key_size);
+        }
+        p_expected[idx] = elem;
+        b_pass &= C_ASSERT(0 == value_vector_push_back(p_vector, &elem));
+    }
+    g_key_size = key_size;
+    gb_key_signed = b_signed;
+    qsort(p_expected, TEST_SORT_RADIX_COUNT, sizeof(test_sort_elem_t),
+          test_sort_elem_cmp);
+    
+    b_pass &= C_ASSERT(0 == value_vector_radix_sort(
+                                p_vector,
+                                offsetof(test_sort_elem_t, key),
+                                key_size, b_signed));
+    b_pass &= C_ASSERT(TEST_SORT_RADIX_COUNT == p_vector->size);
+    b_pass &= C_ASSERT(0 == memcmp(p_vector->p_data, p_expected,
+                                   TEST_SORT_RADIX_COUNT *
+                                   sizeof(test_sort_elem_t)));
+    
+    EXIT:
+        value_vector_destroy(p_vector);
+        free(p_expected);
+        return b_pass;
+}
+
+/*!
+ * @brief This is a static function that checks value_vector_radix_sort
+ *          on every supported key, and that bad keys are rejected.
+ *
+ * @return C_TRUE on success, C_FALSE on failure.
+ */
+static C_BOOL
+test_sort_radix (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    const size_t key_sizes[] = { 1, 2, 4, 8 };
+    for (size_t idx = 0; idx < (sizeof(key_sizes) / sizeof(*key_sizes));
+         ++idx)
+    {
+        b_pass &= test_sort_radix_key(key_sizes[idx], false);
+        b_pass &= test_sort_radix_key(key_sizes[idx], true);
+    }
+    
+    value_vector_t * p_vector = value_vector_create(sizeof(uint32_t));
+    b_pass &= C_ASSERT(NULL != p_vector);
+    if (NULL == p_vector)
+    {
+        goto EXIT;
+    }
+    b_pass &= C_ASSERT(0 == value_vector_radix_sort(p_vector, 0, 4, false));
+    b_pass &= C_ASSERT(-1 == value_vector_radix_sort(p_vector, 0, 3, false));
+    b_pass &= C_ASSERT(-1 == value_vector_radix_sort(p_vector, 0, 8, false));
+    b_pass &= C_ASSERT(-1 == value_vector_radix_sort(p_vector, 2, 4, false));
+    value_vector_destroy(p_vector);
+    
+    EXIT:
+        return b_pass;
+}
+
+int
+main (void)
+{
+    C_BOOL b_pass = C_TRUE;
+    b_pass &= test_sort_serial();
+    b_pass &= test_sort_parallel();
+    b_pass &= test_sort_radix();
+    return (C_TRUE == b_pass) ? EXIT_SUCCESS : EXIT_FAILURE;
+}